@@ -211,9 +211,12 @@ R_API RAnal *r_anal_free(RAnal *a) {
 	r_syscall_free (a->syscall);
 	r_reg_free (a->reg);
 	r_anal_op_free (a->queued);
+	r_anal_op_cache_set_size (a, 0);
 	r_rbtree_free (a->rb_hints_ranges, __anal_hint_range_tree_free);
-	ht_up_free (a->dict_refs);
-	ht_up_free (a->dict_xrefs);
+	r_anal_hint_clear (a);
+	r_meta_free (a);
+	r_anal_var_clear (a);
+	r_anal_xrefs_fini (a);
 	r_list_free (a->leaddrs);
 	a->sdb = NULL;
 	sdb_ns_free (a->sdb);
@@ -275,6 +278,10 @@ R_API char *r_anal_get_reg_profile(RAnal *anal) {
 // deprecate.. or at least reuse get_reg_profile...
 R_API bool r_anal_set_reg_profile(RAnal *anal) {
 	bool ret = false;
+	if (anal) {
+		// cached ops point to the register items
+		r_anal_op_cache_flush (anal);
+	}
 	if (anal && anal->cur && anal->cur->set_reg_profile) {
 		ret = anal->cur->set_reg_profile (anal);
 	} else {
@@ -365,6 +372,7 @@ R_API bool r_anal_set_bits(RAnal *anal, int bits) {
 R_API void r_anal_set_cpu(RAnal *anal, const char *cpu) {
 	free (anal->cpu);
 	anal->cpu = cpu ? strdup (cpu) : NULL;
+	r_anal_op_cache_flush (anal);
 	int v = r_anal_archinfo (anal, R_ANAL_ARCHINFO_ALIGN);
 	if (v != -1) {
 		anal->pcalign = v;
@@ -374,6 +382,7 @@ R_API void r_anal_set_cpu(RAnal *anal, const char *cpu) {
 R_API int r_anal_set_big_endian(RAnal *anal, int bigend) {
 	anal->big_endian = bigend;
 	anal->reg->big_endian = bigend;
+	r_anal_op_cache_flush (anal);
 	return true;
 }
 
@@ -484,7 +493,10 @@ R_API bool r_anal_op_is_eob(RAnalOp *op) {
 R_API int r_anal_purge (RAnal *anal) {
 	sdb_reset (anal->sdb_fcns);
 	sdb_reset (anal->sdb_meta);
+	r_meta_free (anal);
+	r_anal_var_clear (anal);
 	sdb_reset (anal->sdb_hints);
+	r_anal_hint_clear (anal);
 	sdb_reset (anal->sdb_types);
 	sdb_reset (anal->sdb_zigns);
 	sdb_reset (anal->sdb_classes);
@@ -765,28 +777,41 @@ R_API int r_anal_range_tree_find_bits_at(RBNode *root, ut64 addr) {
 	return bits;
 }
 
+typedef struct {
+	ut64 addr;
+	int bits;
+} HintBits;
+
+static bool __anal_hint_bits_cb(const RAnalHint *hint, void *user) {
+	HintBits hb = { hint->addr, hint->bits };
+	return r_vector_push (user, &hb);
+}
+
 R_API void r_anal_merge_hint_ranges(RAnal *a) {
 	if (a->merge_hints) {
-		SdbListIter *iter;
-		SdbKv *kv;
-		SdbList *sdb_range = sdb_foreach_list (a->sdb_hints, true);
+		HintBits *hb;
 		int range_bits = 0;
+		// unsetting bits can drop the hint, so walk a copy
+		RVector *hints = r_vector_new (sizeof (HintBits), NULL, NULL);
+		if (!hints) {
+			return;
+		}
+		r_anal_hint_foreach (a, __anal_hint_bits_cb, hints);
 		r_rbtree_free (a->rb_hints_ranges, __anal_hint_range_tree_free);
 		a->rb_hints_ranges = NULL;
-		ls_foreach (sdb_range, iter, kv) {
-			ut64 addr = sdb_atoi (sdbkv_key (kv) + 5);
-			int bits = r_anal_hint_get_bits_at (a, addr,  sdbkv_value (kv));
+		r_vector_foreach (hints, hb) {
+			int bits = a->opt.ignbithints? 0: hb->bits;
 			if (bits && range_bits == bits) {
-				r_anal_hint_unset_bits (a, addr);
+				r_anal_hint_unset_bits (a, hb->addr);
 			} else {
 				RAnalRange *range = R_NEW0 (RAnalRange);
 				range->bits = bits;
-				range->from = addr;
+				range->from = hb->addr;
 				__anal_range_hint_tree_insert (&a->rb_hints_ranges, range);
 			}
 			range_bits = bits;
 		}
-		ls_free (sdb_range);
+		r_vector_free (hints);
 		a->merge_hints = false;
 	}
 }
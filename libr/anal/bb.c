@@ -74,7 +74,7 @@ R_API int r_anal_bb(RAnal *anal, RAnalBlock *bb, ut64 addr, const ut8 *buf, ut64
 		}
 		r_anal_bb_set_offset (bb, bb->ninstr++, at - bb->addr);
 		idx += oplen;
-		bb->size += oplen;
+		r_anal_bb_set_size (anal, bb, bb->size + oplen);
 		if (head) {
 			bb->type = R_ANAL_BB_TYPE_HEAD;
 		}
@@ -142,33 +142,13 @@ R_API inline int r_anal_bb_is_in_offset (RAnalBlock *bb, ut64 off) {
 	return (off >= bb->addr && off < bb->addr + bb->size);
 }
 
-R_API RAnalBlock *r_anal_bb_from_offset(RAnal *anal, ut64 off) {
-	RListIter *iter, *iter2;
-	RAnalFunction *fcn;
-	RAnalBlock *bb;
-	const bool x86 = anal->cur->arch && !strcmp (anal->cur->arch, "x86");
-	if (anal->opt.jmpmid && x86) {
-		RAnalBlock *nearest_bb = NULL;
-		r_list_foreach (anal->fcns, iter, fcn) {
-			r_list_foreach (fcn->bbs, iter2, bb) {
-				if (r_anal_bb_op_starts_at (bb, off)) {
-					return bb;
-				} else if (r_anal_bb_is_in_offset (bb, off)
-				           && (!nearest_bb || nearest_bb->addr < bb->addr)) {
-					nearest_bb = bb;
-				}
-			}
-		}
-		return nearest_bb;
+// Block sizes must be set with this function, r_anal_fcn_bbget_in uses
+// the largest one to know where to stop looking for the containing block
+R_API void r_anal_bb_set_size(RAnal *anal, RAnalBlock *bb, int size) {
+	bb->size = size;
+	if (size > anal->bb_maxsize) {
+		anal->bb_maxsize = size;
 	}
-	r_list_foreach (anal->fcns, iter, fcn) {
-		r_list_foreach (fcn->bbs, iter2, bb) {
-			if (r_anal_bb_is_in_offset (bb, off)) {
-				return bb;
-			}
-		}
-	}
-	return NULL;
 }
 
 R_API RAnalBlock *r_anal_bb_get_jumpbb(RAnalFunction *fcn, RAnalBlock *bb) {
@@ -178,35 +158,27 @@ R_API RAnalBlock *r_anal_bb_get_jumpbb(RAnalFunction *fcn, RAnalBlock *bb) {
 	if (bb->jumpbb) {
 		return bb->jumpbb;
 	}
-	RListIter *iter;
-	RAnalBlock *b;
-	r_list_foreach (fcn->bbs, iter, b) {
-		if (b->addr == bb->jump) {
-			bb->jumpbb = b;
-			b->prev = bb;
-			return b;
-		}
+	RAnalBlock *b = r_anal_fcn_bbget_at (fcn, bb->jump);
+	if (b) {
+		bb->jumpbb = b;
+		b->prev = bb;
 	}
-	return NULL;
+	return b;
 }
 
 R_API RAnalBlock *r_anal_bb_get_failbb(RAnalFunction *fcn, RAnalBlock *bb) {
-	RListIter *iter;
-	RAnalBlock *b;
 	if (bb->fail == UT64_MAX) {
 		return NULL;
 	}
 	if (bb->failbb) {
 		return bb->failbb;
 	}
-	r_list_foreach (fcn->bbs, iter, b) {
-		if (b->addr == bb->fail) {
-			bb->failbb = b;
-			b->prev = bb;
-			return b;
-		}
+	RAnalBlock *b = r_anal_fcn_bbget_at (fcn, bb->fail);
+	if (b) {
+		bb->failbb = b;
+		b->prev = bb;
 	}
-	return NULL;
+	return b;
 }
 
 /* return the offset of the i-th instruction in the basicblock bb.
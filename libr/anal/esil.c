@@ -116,6 +116,8 @@ R_API bool r_anal_esil_set_op(RAnalEsil *esil, const char *op, RAnalEsilOpCb cod
 			free (eop);
 			return false;
 		}
+		// compiled expressions may push this word instead of running it
+		r_anal_esil_codes_flush (esil);
 	}
 	eop->push = push;
 	eop->pop = pop;
@@ -168,6 +170,7 @@ R_API void r_anal_esil_free(RAnalEsil *esil) {
 	if (esil->anal && esil == esil->anal->esil) {
 		esil->anal->esil = NULL;
 	}
+	r_anal_esil_codes_flush (esil);
 	sdb_foreach (esil->ops, esil_ops_free_cb, NULL);
 	sdb_free (esil->ops);
 	esil->ops = NULL;
@@ -353,6 +356,9 @@ R_API int r_anal_esil_mem_write(RAnalEsil *esil, ut64 addr, const ut8 *buf, int
 		return 0;
 	}
 	addr &= esil->addrmask;
+	if (addr < esil->code_to && addr + len > esil->code_from) {
+		esil->code_dirty = true;
+	}
 	IFDBG {
 		eprintf ("0x%08" PFMT64x " <W ", addr);
 		for (i = 0; i < len; i++) {
@@ -2805,43 +2811,19 @@ static int iscommand(RAnalEsil *esil, const char *word, RAnalEsilOp **op) {
 	return false;
 }
 
-static int runword(RAnalEsil *esil, const char *word) {
-	RAnalEsilOp *op = NULL;
-	if (!word) {
-		return 0;
-	}
+static bool countword(RAnalEsil *esil) {
 	esil->parse_goto_count--;
 	if (esil->parse_goto_count < 1) {
 		ERR ("ESIL infinite loop detected\n");
 		esil->trap = 1;       // INTERNAL ERROR
 		esil->parse_stop = 1; // INTERNAL ERROR
-		return 0;
-	}
-
-	// Don't push anything onto stack when processing if statements
-	if (!strcmp (word, "?{") && esil->Reil) {
-		esil->Reil->skip = esil->Reil->skip? 0: 1;
-		if (esil->Reil->skip) {
-			esil->Reil->cmd_count = 0;
-			memset (esil->Reil->if_buf, 0, sizeof (esil->Reil->if_buf));
-		}
-	}
-
-	if (esil->Reil && esil->Reil->skip) {
-		char *if_buf = esil->Reil->if_buf;
-		strncat (if_buf, word, sizeof (esil->Reil->if_buf) - strlen (if_buf) - 1);
-		strncat (if_buf, ",", sizeof (esil->Reil->if_buf) - strlen (if_buf) - 1);
-		if (!strcmp (word, "}")) {
-			r_anal_esil_pushnum (esil, esil->Reil->addr + esil->Reil->cmd_count + 1);
-			r_anal_esil_parse (esil, esil->Reil->if_buf);
-			return 1;
-		}
-		if (iscommand (esil, word, &op)) {
-			esil->Reil->cmd_count++;
-		}
-		return 1;
+		return false;
 	}
+	return true;
+}
 
+// op is the operation named word, if any
+static int runword_op(RAnalEsil *esil, const char *word, RAnalEsilOp *op) {
 	//eprintf ("WORD (%d) (%s)\n", esil->skip, word);
 	if (!strcmp (word, "}{")) {
 		if (esil->skip == 1) {
@@ -2860,27 +2842,25 @@ static int runword(RAnalEsil *esil, const char *word) {
 		return 1;
 	}
 
-	if (iscommand (esil, word, &op)) {
+	if (op) {
 		// run action
-		if (op) {
-			if (esil->cb.hook_command) {
-				if (esil->cb.hook_command (esil, word)) {
-					return 1; // XXX cannot return != 1
-				}
+		if (esil->cb.hook_command) {
+			if (esil->cb.hook_command (esil, word)) {
+				return 1; // XXX cannot return != 1
 			}
-			esil->current_opstr = strdup (word);
-			//so this is basically just sharing what's the operation with the operation
-			//useful for wrappers
-			const bool ret = op->code (esil);
-			free (esil->current_opstr);
-			esil->current_opstr = NULL;
-			if (!ret) {
-				if (esil->verbose) {
-					eprintf ("%s returned 0\n", word);
-				}
+		}
+		//so this is basically just sharing what's the operation with the operation
+		//useful for wrappers
+		char *old_opstr = esil->current_opstr;
+		esil->current_opstr = (char *)word;
+		const bool ret = op->code (esil);
+		esil->current_opstr = old_opstr;
+		if (!ret) {
+			if (esil->verbose) {
+				eprintf ("%s returned 0\n", word);
 			}
-			return ret;
 		}
+		return ret;
 	}
 	if (!*word || *word == ',') {
 		// skip empty words
@@ -2896,6 +2876,42 @@ static int runword(RAnalEsil *esil, const char *word) {
 	return 1;
 }
 
+static int runword(RAnalEsil *esil, const char *word) {
+	RAnalEsilOp *op = NULL;
+	if (!word) {
+		return 0;
+	}
+	if (!countword (esil)) {
+		return 0;
+	}
+
+	// Don't push anything onto stack when processing if statements
+	if (!strcmp (word, "?{") && esil->Reil) {
+		esil->Reil->skip = esil->Reil->skip? 0: 1;
+		if (esil->Reil->skip) {
+			esil->Reil->cmd_count = 0;
+			memset (esil->Reil->if_buf, 0, sizeof (esil->Reil->if_buf));
+		}
+	}
+
+	if (esil->Reil && esil->Reil->skip) {
+		char *if_buf = esil->Reil->if_buf;
+		strncat (if_buf, word, sizeof (esil->Reil->if_buf) - strlen (if_buf) - 1);
+		strncat (if_buf, ",", sizeof (esil->Reil->if_buf) - strlen (if_buf) - 1);
+		if (!strcmp (word, "}")) {
+			r_anal_esil_pushnum (esil, esil->Reil->addr + esil->Reil->cmd_count + 1);
+			r_anal_esil_parse (esil, esil->Reil->if_buf);
+			return 1;
+		}
+		if (iscommand (esil, word, &op)) {
+			esil->Reil->cmd_count++;
+		}
+		return 1;
+	}
+
+	return runword_op (esil, word, iscommand (esil, word, &op)? op: NULL);
+}
+
 static const char *gotoWord(const char *str, int n) {
 	const char *ostr = str;
 	int count = 0;
@@ -2965,6 +2981,146 @@ static bool __stepOut(RAnalEsil *esil, const char *cmd) {
 	return false;
 }
 
+// Compiled expressions
+//
+// r_anal_esil_parse walks the expression char by char and looks every word up
+// in the ops sdb, which is most of the time spent emulating an instruction.
+// Expressions are split once into words with their operation resolved, and
+// cached by their text, which already depends on the address and the bytes
+// of the instruction. Running one does what the string walker does for it.
+
+#define ESIL_CODES_MAX 0x20000
+
+typedef struct {
+	const char *str;
+	RAnalEsilOp *op;
+	int off; // in the expression
+} RAnalEsilCodeWord;
+
+typedef struct {
+	char *expr;
+	char *words_buf; // expr with its commas replaced by \0
+	RAnalEsilCodeWord *words;
+	int count;
+} RAnalEsilCode;
+
+static void esil_code_free(RAnalEsilCode *code) {
+	if (code) {
+		free (code->expr);
+		free (code->words_buf);
+		free (code->words);
+		free (code);
+	}
+}
+
+static void esil_code_kv_free(HtPPKv *kv) {
+	free (kv->key);
+	esil_code_free (kv->value);
+}
+
+R_API void r_anal_esil_codes_flush(RAnalEsil *esil) {
+	ht_pp_free (esil->codes);
+	esil->codes = NULL;
+}
+
+static RAnalEsilCode *esil_code_new(RAnalEsil *esil, const char *expr) {
+	// leave what the string walker handles in special ways to it
+	if (*expr == ',' || strstr (expr, ",,") || strchr (expr, ';') || strstr (expr, "#!")) {
+		return NULL;
+	}
+	RAnalEsilCode *code = R_NEW0 (RAnalEsilCode);
+	if (!code) {
+		return NULL;
+	}
+	code->expr = strdup (expr);
+	code->words_buf = strdup (expr);
+	code->words = R_NEWS0 (RAnalEsilCodeWord, r_str_char_count (expr, ',') + 1);
+	if (!code->expr || !code->words_buf || !code->words) {
+		goto fail;
+	}
+	char *word = code->words_buf;
+	while (*word) {
+		char *next = strchr (word, ',');
+		if (next) {
+			*next++ = 0;
+		}
+		if (strlen (word) > 62) {
+			goto fail;
+		}
+		RAnalEsilCodeWord *w = &code->words[code->count++];
+		w->str = word;
+		w->off = word - code->words_buf;
+		if (!iscommand (esil, word, &w->op)) {
+			w->op = NULL;
+		}
+		if (!next) {
+			break;
+		}
+		word = next;
+	}
+	return code;
+fail:
+	esil_code_free (code);
+	return NULL;
+}
+
+static RAnalEsilCode *esil_code_get(RAnalEsil *esil, const char *expr) {
+	if (!esil->codes) {
+		esil->codes = ht_pp_new (NULL, esil_code_kv_free, NULL);
+		if (!esil->codes) {
+			return NULL;
+		}
+	}
+	bool found = false;
+	RAnalEsilCode *code = ht_pp_find (esil->codes, expr, &found);
+	if (found || esil->codes->count >= ESIL_CODES_MAX) {
+		// cached ones can't be dropped, they may be running
+		return code;
+	}
+	code = esil_code_new (esil, expr);
+	// remember the ones which can't be compiled too
+	ht_pp_insert (esil->codes, expr, code);
+	return code;
+}
+
+static int esil_code_run(RAnalEsil *esil, RAnalEsilCode *code) {
+	int i;
+loop:
+	esil->repeat = 0;
+	esil->skip = 0;
+	esil->parse_goto = -1;
+	esil->parse_stop = 0;
+	esil->parse_goto_count = esil->anal? esil->anal->esil_goto_limit: R_ANAL_ESIL_GOTO_LIMIT;
+	for (i = 0; i < code->count;) {
+		RAnalEsilCodeWord *w = &code->words[i++];
+		if (!countword (esil) || !runword_op (esil, w->str, w->op)) {
+			return 0;
+		}
+		if (esil->repeat) {
+			goto loop;
+		}
+		if (esil->parse_goto != -1) {
+			if (esil->parse_goto < 0 || esil->parse_goto >= code->count) {
+				if (esil->verbose) {
+					eprintf ("Cannot find word %d\n", esil->parse_goto);
+				}
+				return 0;
+			}
+			i = esil->parse_goto;
+			esil->parse_goto = -1;
+			continue;
+		}
+		if (esil->parse_stop) {
+			if (esil->parse_stop == 2) {
+				eprintf ("[esil at 0x%08"PFMT64x"] TODO: %s\n", esil->address,
+					i < code->count? code->expr + code->words[i].off: "");
+			}
+			return 0;
+		}
+	}
+	return 1;
+}
+
 R_API int r_anal_esil_parse(RAnalEsil *esil, const char *str) {
 	int wordi = 0;
 	int dorunword;
@@ -2976,13 +3132,21 @@ R_API int r_anal_esil_parse(RAnalEsil *esil, const char *str) {
 		(void)__stepOut (esil, esil->cmd_step_out);
 		return true;
 	}
-	const char *hashbang = strstr (str, "#!");
 	esil->trap = 0;
 	if (esil->cmd && esil->cmd_todo) {
 		if (!strncmp (str, "TODO", 4)) {
 			esil->cmd (esil, esil->cmd_todo, esil->address, 0);
 		}
 	}
+	if (!esil->Reil) {
+		RAnalEsilCode *code = esil_code_get (esil, str);
+		if (code) {
+			int ret = esil_code_run (esil, code);
+			__stepOut (esil, esil->cmd_step_out);
+			return ret;
+		}
+	}
+	const char *hashbang = strstr (str, "#!");
 loop:
 	esil->repeat = 0;
 	esil->skip = 0;
@@ -107,14 +107,148 @@ static int cmpaddr(const void *_a, const void *_b) {
 	return (a->addr - b->addr);
 }
 
+// Function ranges
+//
+// anal->fcn_ranges indexes the merged block ranges (the fcn->bbr pairs) and
+// the entrypoint of every function in the anal, so finding the functions
+// containing an address is one interval tree descent however far apart their
+// blocks are.
+// The nodes live in fcn->ranges, they are added and removed with the
+// function by r_anal_fcn_tree_insert/delete and replaced every time
+// r_anal_fcn_update_tinyrange_bbs rebuilds fcn->bbr.
+
+#define RANGE_CONTAINER(x) container_of ((RBNode*)(x), RAnalFcnRange, rb)
+
+static bool bbindex_fresh(RAnalFunction *fcn);
+static void bbindex_snapshot(RAnalBlockIndex *x, const RList *list);
+static ut32 bbindex_upper(const RAnalBlockIndex *x, ut64 addr);
+
+static int fcn_range_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	const RAnalFcnRange *a = incoming;
+	const RAnalFcnRange *b = RANGE_CONTAINER (in_tree);
+	if (a->from != b->from) {
+		return a->from < b->from? -1: 1;
+	}
+	if (a->to != b->to) {
+		return a->to < b->to? -1: 1;
+	}
+	// not fcn->addr, it may change while the function is indexed
+	return (a->fcn > b->fcn) - (a->fcn < b->fcn);
+}
+
+static void fcn_range_sum(RBNode *node) {
+	int i;
+	RAnalFcnRange *r = RANGE_CONTAINER (node);
+	r->rb_max_to = r->to;
+	for (i = 0; i < 2; i++) {
+		if (node->child[i]) {
+			RAnalFcnRange *c = RANGE_CONTAINER (node->child[i]);
+			if (c->rb_max_to > r->rb_max_to) {
+				r->rb_max_to = c->rb_max_to;
+			}
+		}
+	}
+}
+
+static void fcn_ranges_remove(RAnalFunction *fcn) {
+	int i;
+	for (i = 0; fcn->anal && i < fcn->nranges; i++) {
+		r_rbtree_aug_delete (&fcn->anal->fcn_ranges, &fcn->ranges[i], fcn_range_cmp, NULL, fcn_range_sum, NULL);
+	}
+	R_FREE (fcn->ranges);
+	fcn->nranges = 0;
+}
+
+static void fcn_ranges_insert(RAnalFunction *fcn) {
+	int i;
+	fcn_ranges_remove (fcn);
+	// the entrypoint always belongs to the function, blocks or not
+	const bool entry = !r_tinyrange_in (&fcn->bbr, fcn->addr);
+	const int n = fcn->bbr.pairs + entry;
+	if (!fcn->anal || !(fcn->ranges = R_NEWS0 (RAnalFcnRange, n))) {
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		RAnalFcnRange *r = &fcn->ranges[fcn->nranges];
+		if (i < fcn->bbr.pairs) {
+			r->from = fcn->bbr.ranges[i * 2];
+			r->to = fcn->bbr.ranges[i * 2 + 1];
+		} else {
+			r->from = fcn->addr;
+			r->to = fcn->addr + 1;
+		}
+		r->fcn = fcn;
+		// overlapping blocks can repeat a pair, the slot is reused then
+		if (r_rbtree_aug_insert (&fcn->anal->fcn_ranges, r, &r->rb, fcn_range_cmp, fcn_range_sum, NULL)) {
+			fcn->nranges++;
+		}
+	}
+}
+
+typedef struct {
+	int type;
+	bool bounds; // skip the entrypoint ranges, only blocks count
+	RAnalFunction *first; // lowest meta.min, the order the fcn_tree used to give
+	RList *list;
+} FcnRangeQuery;
+
+static int fcn_order_cmp(const RAnalFunction *a, const RAnalFunction *b) {
+	if (a->meta.min != b->meta.min) {
+		return a->meta.min < b->meta.min? -1: 1;
+	}
+	return (a->addr > b->addr) - (a->addr < b->addr);
+}
+
+static void fcn_range_found(FcnRangeQuery *q, RAnalFunction *fcn, ut64 addr) {
+	if (q->type && !(fcn->type & q->type)) {
+		return;
+	}
+	if (q->bounds && !r_tinyrange_in (&fcn->bbr, addr)) {
+		return;
+	}
+	if (q->list) {
+		if (!r_list_contains (q->list, fcn)) {
+			r_list_append (q->list, fcn);
+		}
+	} else if (!q->first || fcn_order_cmp (fcn, q->first) < 0) {
+		q->first = fcn;
+	}
+}
+
+// Report the functions with a range containing addr, O(log(n) + k)
+static void fcn_ranges_query(RBNode *node, ut64 addr, FcnRangeQuery *q) {
+	while (node) {
+		RAnalFcnRange *r = RANGE_CONTAINER (node);
+		if (r->rb_max_to <= addr) {
+			return;
+		}
+		fcn_ranges_query (node->child[0], addr, q);
+		if (r->from > addr) {
+			return;
+		}
+		if (addr < r->to) {
+			fcn_range_found (q, r->fcn, addr);
+		}
+		node = node->child[1];
+	}
+}
+
 R_API void r_anal_fcn_update_tinyrange_bbs(RAnalFunction *fcn) {
 	RAnalBlock *bb;
 	RListIter *iter;
-	r_list_sort (fcn->bbs, &cmpaddr);
+	if (fcn->bbs) {
+		// same blocks in another order, the index is still good
+		const bool fresh = bbindex_fresh (fcn);
+		r_list_sort (fcn->bbs, &cmpaddr);
+		if (fresh) {
+			bbindex_snapshot (fcn->bbindex, fcn->bbs);
+		}
+	}
 	r_tinyrange_fini (&fcn->bbr);
 	r_list_foreach (fcn->bbs, iter, bb) {
 		r_tinyrange_add (&fcn->bbr, bb->addr, bb->addr + bb->size);
 	}
+	fcn_ranges_insert (fcn);
 }
 
 static void set_meta_if_needed(RAnalFunction *x) {
@@ -219,6 +353,8 @@ static RBNode *_fcn_tree_probe(FcnTreeIter *it, RBNode *x_, ut64 from, ut64 to)
 }
 
 R_API bool r_anal_fcn_tree_delete(RAnal *anal, RAnalFunction *fcn) {
+	fcn_ranges_remove (fcn);
+	fcn->anal = NULL;
 	bool ret_min = !!r_rbtree_aug_delete (&anal->fcn_tree, fcn, _fcn_tree_cmp, _fcn_tree_free, _fcn_tree_calc_max_addr, NULL);
 	bool ret_addr = !!r_rbtree_delete (&anal->fcn_addr_tree, fcn, _fcn_addr_tree_cmp, NULL, NULL);
 	if (ret_min != ret_addr) {
@@ -232,6 +368,9 @@ R_API bool r_anal_fcn_tree_delete(RAnal *anal, RAnalFunction *fcn) {
 R_API void r_anal_fcn_tree_insert(RAnal *anal, RAnalFunction *fcn) {
 	r_rbtree_aug_insert (&anal->fcn_tree, fcn, &(fcn->rb), _fcn_tree_cmp, _fcn_tree_calc_max_addr, NULL);
 	r_rbtree_insert (&anal->fcn_addr_tree, fcn, &(fcn->addr_rb), _fcn_addr_tree_cmp, NULL);
+	fcn_ranges_remove (fcn);
+	fcn->anal = anal;
+	fcn_ranges_insert (fcn);
 }
 
 static void _fcn_tree_update_size(RAnal *anal, RAnalFunction *fcn) {
@@ -357,6 +496,7 @@ R_API int r_anal_fcn_resize(RAnal *anal, RAnalFunction *fcn, int newsize) {
 		if (bb->addr >= eof) {
 			// already called by r_list_delete r_anal_bb_free (bb);
 			r_list_delete (fcn->bbs, iter);
+			r_anal_fcn_bbindex_invalidate (fcn);
 			continue;
 		}
 		if (bb->addr + bb->size >= eof) {
@@ -403,6 +543,152 @@ R_API RList *r_anal_fcn_list_new() {
 	return r_list_newf (r_anal_fcn_free);
 }
 
+// Block index
+//
+// fcn->bbs stays the list every user walks, and r_anal_fcn_bbindex keeps
+// a copy of it sorted by address. Blocks appended with r_anal_fcn_bbadd are
+// inserted in place, and the functions here which delete blocks or move
+// their address drop the index with r_anal_fcn_bbindex_invalidate. Other
+// changes to the list (replacing it, deleting or appending blocks by hand)
+// are noticed from its length and ends on the next lookup. Since blocks
+// grow while being analyzed, lookups walk back from the nearest block
+// starting at or before the address until anal->bb_maxsize (the largest
+// size ever set with r_anal_bb_set_size) proves no earlier block can reach it.
+
+static void bbindex_free(RAnalBlockIndex *x) {
+	if (x) {
+		free (x->bbs);
+		free (x);
+	}
+}
+
+// Blocks are kept sorted by address, so their addresses must not change
+// while indexed. Sizes can, lookups read them from the blocks.
+R_API void r_anal_fcn_bbindex_invalidate(RAnalFunction *fcn) {
+	r_return_if_fail (fcn);
+	bbindex_free (fcn->bbindex);
+	fcn->bbindex = NULL;
+}
+
+static bool bbindex_fresh(RAnalFunction *fcn) {
+	const RAnalBlockIndex *x = fcn->bbindex;
+	const RList *list = fcn->bbs;
+	return x && x->list == list && (!list || (x->length == list->length
+		&& x->head == list->head && x->tail == list->tail));
+}
+
+static int bbindex_cmp(const void *a, const void *b) {
+	const RAnalBlock *ba = *(const RAnalBlock **)a, *bb = *(const RAnalBlock **)b;
+	return (ba->addr > bb->addr) - (ba->addr < bb->addr);
+}
+
+// Number of blocks starting at or before addr
+static ut32 bbindex_upper(const RAnalBlockIndex *x, ut64 addr) {
+	ut32 lo = 0, hi = x->count;
+	while (lo < hi) {
+		ut32 mid = lo + (hi - lo) / 2;
+		if (x->bbs[mid]->addr <= addr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static ut32 bbindex_at(const RAnalBlockIndex *x, ut64 addr) {
+	ut32 i = bbindex_upper (x, addr);
+	return (i && x->bbs[i - 1]->addr == addr)? i - 1: UT32_MAX;
+}
+
+static void bbindex_snapshot(RAnalBlockIndex *x, const RList *list) {
+	x->list = list;
+	if (list) {
+		x->length = list->length;
+		x->head = list->head;
+		x->tail = list->tail;
+	}
+}
+
+// Called right after bb was appended to fcn->bbs
+static void bbindex_insert(RAnalFunction *fcn, RAnalBlock *bb) {
+	RAnalBlockIndex *x = fcn->bbindex;
+	const RList *list = fcn->bbs;
+	if (!x) {
+		return;
+	}
+	if (x->list != list || !list->tail || x->length + 1 != list->length || x->tail != list->tail->p) {
+		r_anal_fcn_bbindex_invalidate (fcn);
+		return;
+	}
+	if (x->count == x->capacity) {
+		ut32 capacity = x->capacity? x->capacity * 2: 8;
+		RAnalBlock **bbs = realloc (x->bbs, capacity * sizeof (RAnalBlock *));
+		if (!bbs) {
+			r_anal_fcn_bbindex_invalidate (fcn);
+			return;
+		}
+		x->bbs = bbs;
+		x->capacity = capacity;
+	}
+	ut32 i = bbindex_upper (x, bb->addr);
+	memmove (x->bbs + i + 1, x->bbs + i, (x->count - i) * sizeof (RAnalBlock *));
+	x->bbs[i] = bb;
+	x->count++;
+	bbindex_snapshot (x, list);
+}
+
+R_API const RAnalBlockIndex *r_anal_fcn_bbindex(RAnalFunction *fcn) {
+	r_return_val_if_fail (fcn, NULL);
+	RAnalBlockIndex *x = fcn->bbindex;
+	RList *list = fcn->bbs;
+	if (bbindex_fresh (fcn)) {
+		return x;
+	}
+	r_anal_fcn_bbindex_invalidate (fcn);
+	if (!(x = R_NEW0 (RAnalBlockIndex))) {
+		return NULL;
+	}
+	bbindex_snapshot (x, list);
+	if (list && list->length > 0) {
+		RListIter *iter;
+		RAnalBlock *bb;
+		x->capacity = list->length;
+		if (!(x->bbs = malloc (x->capacity * sizeof (RAnalBlock *)))) {
+			bbindex_free (x);
+			return NULL;
+		}
+		r_list_foreach (list, iter, bb) {
+			x->bbs[x->count++] = bb;
+		}
+		qsort (x->bbs, x->count, sizeof (RAnalBlock *), bbindex_cmp);
+	}
+	fcn->bbindex = x;
+	return x;
+}
+
+// Nearest block containing addr, where an op starts at addr if jumpmid is set.
+// Empty blocks contain their address when empty is set
+static RAnalBlock *bbindex_in(RAnal *anal, RAnalFunction *fcn, ut64 addr, bool jumpmid, bool empty) {
+	const RAnalBlockIndex *x = r_anal_fcn_bbindex (fcn);
+	const ut64 maxsize = R_MAX (anal->bb_maxsize, 1);
+	if (!x) {
+		return NULL;
+	}
+	ut32 i = bbindex_upper (x, addr);
+	while (i-- > 0) {
+		RAnalBlock *bb = x->bbs[i];
+		if (addr - bb->addr >= maxsize) {
+			break;
+		}
+		if (((empty && bb->size <= 0 && addr == bb->addr) || r_anal_bb_is_in_offset (bb, addr))
+		    && (!jumpmid || r_anal_bb_op_starts_at (bb, addr))) {
+			return bb;
+		}
+	}
+	return NULL;
+}
+
 R_API void r_anal_fcn_free(void *_fcn) {
 	RAnalFunction *fcn = _fcn;
 	if (!_fcn) {
@@ -411,8 +697,10 @@ R_API void r_anal_fcn_free(void *_fcn) {
 	fcn->_size = 0;
 	free (fcn->name);
 	free (fcn->attr);
+	fcn_ranges_remove (fcn);
 	r_tinyrange_fini (&fcn->bbr);
 	r_list_free (fcn->fcn_locs);
+	bbindex_free (fcn->bbindex);
 	if (fcn->bbs) {
 		fcn->bbs->free = (RListFree)r_anal_bb_free;
 		r_list_free (fcn->bbs);
@@ -424,18 +712,8 @@ R_API void r_anal_fcn_free(void *_fcn) {
 	free (fcn);
 }
 
-static RAnalBlock *bbget(RAnalFunction *fcn, ut64 addr, bool jumpmid) {
-	RListIter *iter;
-	RAnalBlock *bb;
-	r_list_foreach (fcn->bbs, iter, bb) {
-		ut64 eaddr = bb->addr + bb->size;
-		if (((bb->addr >= eaddr && addr == bb->addr)
-		     || r_anal_bb_is_in_offset (bb, addr))
-		    && (!jumpmid || r_anal_bb_op_starts_at (bb, addr))) {
-			return bb;
-		}
-	}
-	return NULL;
+static RAnalBlock *bbget(RAnal *anal, RAnalFunction *fcn, ut64 addr, bool jumpmid) {
+	return bbindex_in (anal, fcn, addr, jumpmid, true);
 }
 
 // TODO: split between bb.new and append_bb()
@@ -597,6 +875,7 @@ static int skip_hp(RAnal *anal, RAnalFunction *fcn, RAnalOp *op, RAnalBlock *bb,
 			fcn->addr += oplen;
 			bb->size -= oplen;
 			bb->addr += oplen;
+			r_anal_fcn_bbindex_invalidate (fcn);
 			*idx = un_idx;
 			return 1;
 		}
@@ -735,7 +1014,7 @@ static int fcn_recurse(RAnal *anal, RAnalFunction *fcn, ut64 addr, ut64 len, int
 	if (fcn_at_addr && fcn_at_addr != fcn) {
 		return R_ANAL_RET_ERROR; // MUST BE NOT FOUND
 	}
-	bb = bbget (fcn, addr, anal->opt.jmpmid && is_x86);
+	bb = bbget (anal, fcn, addr, anal->opt.jmpmid && is_x86);
 	if (bb) {
 		r_anal_fcn_split_bb (anal, fcn, bb, addr);
 		if (anal->opt.recont) {
@@ -836,6 +1115,7 @@ repeat:
 					fcn->addr += oplen;
 					bb->size -= oplen;
 					bb->addr += oplen;
+					r_anal_fcn_bbindex_invalidate (fcn);
 					idx = delay.un_idx;
 					goto repeat;
 				}
@@ -845,6 +1125,7 @@ repeat:
 			case R_ANAL_OP_TYPE_ILL:
 			case R_ANAL_OP_TYPE_NOP:
 				bb->addr = fcn->addr = addr = at + op.size;
+				r_anal_fcn_bbindex_invalidate (fcn);
 				goto repeat;
 			}
 		}
@@ -852,7 +1133,7 @@ repeat:
 			r_anal_hint_set_bits (anal, op.jump, op.hint.new_bits);
 		}
 		if (idx > 0 && !overlapped) {
-			bbg = bbget (fcn, at, anal->opt.jmpmid && is_x86);
+			bbg = bbget (anal, fcn, at, anal->opt.jmpmid && is_x86);
 			if (bbg && bbg != bb) {
 				bb->jump = at;
 				if (anal->opt.jmpmid && is_x86) {
@@ -867,7 +1148,7 @@ repeat:
 		}
 		if (!overlapped) {
 			r_anal_bb_set_offset (bb, bb->ninstr++, at - bb->addr);
-			bb->size += oplen;
+			r_anal_bb_set_size (anal, bb, bb->size + oplen);
 			fcn->ninstr++;
 			// FITFCNSZ(); // defer this, in case this instruction is a branch delay entry
 			// fcn->size += oplen; /// XXX. must be the sum of all the bblocks
@@ -1689,14 +1970,36 @@ R_API int r_anal_fcn_del(RAnal *a, ut64 addr) {
 }
 
 R_API RList *r_anal_get_fcn_in_list(RAnal *anal, ut64 addr, int type) {
+	FcnRangeQuery q = { type, false, NULL, r_list_newf (NULL) };
+	if (!q.list) {
+		return NULL;
+	}
+	fcn_ranges_query (anal->fcn_ranges, addr, &q);
+	r_list_sort (q.list, (RListComparator)fcn_order_cmp);
+	return q.list;
+}
+
+// Functions with a basic block intersecting [from, to)
+R_API RList *r_anal_get_fcn_in_range(RAnal *anal, ut64 from, ut64 to) {
 	RList *list = r_list_newf (NULL);
-	// Interval tree query
 	RAnalFunction *fcn;
+	RAnalBlock *bb;
 	FcnTreeIter it;
-	fcn_tree_foreach_intersect (anal->fcn_tree, it, fcn, addr, addr + 1) {
-		if (!type || (fcn && fcn->type & type)) {
-			if (r_tinyrange_in (&fcn->bbr, addr) || fcn->addr == addr) {
+	if (!list || from >= to) {
+		return list;
+	}
+	const ut64 maxsize = R_MAX (anal->bb_maxsize, 1);
+	fcn_tree_foreach_intersect (anal->fcn_tree, it, fcn, from, to) {
+		const RAnalBlockIndex *x = r_anal_fcn_bbindex (fcn);
+		ut32 i = x? bbindex_upper (x, to - 1): 0;
+		while (i-- > 0) {
+			bb = x->bbs[i];
+			if (bb->addr < from && from - bb->addr >= maxsize) {
+				break;
+			}
+			if (from < bb->addr + bb->size) {
 				r_list_append (list, fcn);
+				break;
 			}
 		}
 	}
@@ -1704,44 +2007,12 @@ R_API RList *r_anal_get_fcn_in_list(RAnal *anal, ut64 addr, int type) {
 }
 
 R_API RAnalFunction *r_anal_get_fcn_in(RAnal *anal, ut64 addr, int type) {
-#if 0
-  // Linear scan
-	RAnalFunction *fcn, *ret = NULL;
-	RListIter *iter;
-	if (type == R_ANAL_FCN_TYPE_ROOT) {
-		r_list_foreach (anal->fcns, iter, fcn) {
-			if (addr == fcn->addr) {
-				return fcn;
-			}
-		}
-		return NULL;
-	}
-	r_list_foreach (anal->fcns, iter, fcn) {
-		if (!type || (fcn && fcn->type & type)) {
-			if (r_tinyrange_in (&fcn->bbr, addr) || fcn->addr == addr) {
-				ret = fcn;
-				break;
-			}
-		}
-	}
-	return ret;
-
-#else
-	// Interval tree query
-	RAnalFunction *fcn;
-	FcnTreeIter it;
+	FcnRangeQuery q = { type };
 	if (type == R_ANAL_FCN_TYPE_ROOT) {
 		return _fcn_addr_tree_find_addr (anal, addr);
 	}
-	fcn_tree_foreach_intersect (anal->fcn_tree, it, fcn, addr, addr + 1) {
-		if (!type || (fcn && fcn->type & type)) {
-			if (r_tinyrange_in (&fcn->bbr, addr) || fcn->addr == addr) {
-				return fcn;
-			}
-		}
-	}
-	return NULL;
-#endif
+	fcn_ranges_query (anal->fcn_ranges, addr, &q);
+	return q.first;
 }
 
 R_API bool r_anal_fcn_in(RAnalFunction *fcn, ut64 addr) {
@@ -1749,24 +2020,74 @@ R_API bool r_anal_fcn_in(RAnalFunction *fcn, ut64 addr) {
 }
 
 R_API RAnalFunction *r_anal_get_fcn_in_bounds(RAnal *anal, ut64 addr, int type) {
-	RAnalFunction *fcn, *ret = NULL;
-	RListIter *iter;
+	FcnRangeQuery q = { type, true };
 	if (type == R_ANAL_FCN_TYPE_ROOT) {
-		r_list_foreach (anal->fcns, iter, fcn) {
-			if (addr == fcn->addr) {
-				return fcn;
-			}
+		return _fcn_addr_tree_find_addr (anal, addr);
+	}
+	fcn_ranges_query (anal->fcn_ranges, addr, &q);
+	return q.first;
+}
+
+typedef struct {
+	ut64 addr;
+	ut64 maxsize;
+	bool jmpmid;
+	RAnalBlock *nearest;
+} BlockRangeQuery;
+
+// Looks for the block of fcn containing q->addr, true when it's the answer
+static bool bb_range_found(RAnalFunction *fcn, BlockRangeQuery *q) {
+	const RAnalBlockIndex *x = r_anal_fcn_bbindex (fcn);
+	ut32 i = x? bbindex_upper (x, q->addr): 0;
+	while (i-- > 0) {
+		RAnalBlock *bb = x->bbs[i];
+		if (q->addr - bb->addr >= q->maxsize) {
+			break;
+		}
+		if (!r_anal_bb_is_in_offset (bb, q->addr)) {
+			continue;
+		}
+		if (!q->jmpmid || r_anal_bb_op_starts_at (bb, q->addr)) {
+			q->nearest = bb;
+			return true;
+		}
+		if (!q->nearest || q->nearest->addr < bb->addr) {
+			q->nearest = bb;
 		}
-		return NULL;
 	}
-	r_list_foreach (anal->fcns, iter, fcn) {
-		if (!type || (fcn && fcn->type & type)) {
-			if (r_anal_fcn_in (fcn, addr)) {
-				return fcn;
-			}
+	return false;
+}
+
+// Same walk as fcn_ranges_query, only the functions with a block range
+// containing the address are looked into. Stops at the first answer
+static bool bb_ranges_query(RBNode *node, BlockRangeQuery *q) {
+	while (node) {
+		RAnalFcnRange *r = RANGE_CONTAINER (node);
+		if (r->rb_max_to <= q->addr) {
+			return false;
+		}
+		if (bb_ranges_query (node->child[0], q)) {
+			return true;
+		}
+		if (r->from > q->addr) {
+			return false;
+		}
+		if (q->addr < r->to && bb_range_found (r->fcn, q)) {
+			return true;
 		}
+		node = node->child[1];
 	}
-	return ret;
+	return false;
+}
+
+// O(log(functions) + log(blocks)): anal->fcn_ranges gives the functions
+// with a block around off, their block index the block itself
+R_API RAnalBlock *r_anal_bb_from_offset(RAnal *anal, ut64 off) {
+	r_return_val_if_fail (anal, NULL);
+	const bool x86 = anal->cur && anal->cur->arch && !strcmp (anal->cur->arch, "x86");
+	BlockRangeQuery q = { off, R_MAX (anal->bb_maxsize, 1), anal->opt.jmpmid && x86, NULL };
+	bb_ranges_query (anal->fcn_ranges, &q);
+	return q.nearest;
 }
 
 R_API RAnalFunction *r_anal_fcn_find_name(RAnal *anal, const char *name) {
@@ -1821,6 +2142,7 @@ R_API bool r_anal_fcn_add_bb(RAnal *anal, RAnalFunction *fcn, ut64 addr, ut64 si
 	if (is_x86) {
 		if (bb) {
 			r_list_delete_data (fcn->bbs, bb);
+			r_anal_fcn_bbindex_invalidate (fcn);
 		}
 		r_anal_fcn_invalidate_read_ahead_cache ();
 		fcn_recurse (anal, fcn, addr, size, 1);
@@ -1860,7 +2182,7 @@ R_API bool r_anal_fcn_add_bb(RAnal *anal, RAnalFunction *fcn, ut64 addr, ut64 si
 	r_anal_fcn_update_tinyrange_bbs (fcn);
 	r_anal_fcn_set_size (anal, fcn, r_anal_fcn_size (fcn));
 #endif
-	bb->size = size;
+	r_anal_bb_set_size (anal, bb, size);
 	bb->jump = jump;
 	bb->fail = fail;
 	bb->type = type;
@@ -1954,6 +2276,7 @@ R_API int r_anal_fcn_bb_overlaps(RAnalFunction *fcn, RAnalBlock *bb) {
 				bb->type = R_ANAL_BB_TYPE_BODY;
 			}
 			r_list_append (fcn->bbs, bb);
+			bbindex_insert (fcn, bb);
 			return R_ANAL_RET_END;
 		}
 	}
@@ -2118,15 +2441,7 @@ R_API RAnalBlock *r_anal_fcn_bbget_in(const RAnal *anal, RAnalFunction *fcn, ut6
 		return NULL;
 	}
 	const bool is_x86 = anal->cur->arch && !strcmp (anal->cur->arch, "x86");
-	RListIter *iter;
-	RAnalBlock *bb;
-	r_list_foreach (fcn->bbs, iter, bb) {
-		if (addr >= bb->addr && addr < (bb->addr + bb->size)
-		    && (!anal->opt.jmpmid || !is_x86 || r_anal_bb_op_starts_at (bb, addr))) {
-			return bb;
-		}
-	}
-	return NULL;
+	return bbindex_in ((RAnal *)anal, fcn, addr, anal->opt.jmpmid && is_x86, false);
 }
 
 R_API RAnalBlock *r_anal_fcn_bbget_at(RAnalFunction *fcn, ut64 addr) {
@@ -2134,14 +2449,9 @@ R_API RAnalBlock *r_anal_fcn_bbget_at(RAnalFunction *fcn, ut64 addr) {
 #if USE_SDB_CACHE
 	return sdb_ptr_get (HB, sdb_fmt (SDB_KEY_BB, fcn->addr, addr), NULL);
 #else
-	RListIter *iter;
-	RAnalBlock *bb;
-	r_list_foreach (fcn->bbs, iter, bb) {
-		if (addr == bb->addr) {
-			return bb;
-		}
-	}
-	return NULL;
+	const RAnalBlockIndex *x = r_anal_fcn_bbindex (fcn);
+	ut32 i = x? bbindex_at (x, addr): UT32_MAX;
+	return i != UT32_MAX? x->bbs[i]: NULL;
 #endif
 }
 
@@ -2151,6 +2461,7 @@ R_API bool r_anal_fcn_bbadd(RAnalFunction *fcn, RAnalBlock *bb) {
 	return sdb_ptr_set (HB, sdb_fmt (SDB_KEY_BB, fcn->addr, bb->addr), bb, NULL);
 #endif
 	r_list_append (fcn->bbs, bb);
+	bbindex_insert (fcn, bb);
 	return true;
 }
 
@@ -2,120 +2,382 @@
 
 #include <r_anal.h>
 
-#define DB a->sdb_hints
-#define setf(x,...) snprintf(x,sizeof(x)-1,##__VA_ARGS__)
+// Hints are kept in a red-black tree of typed records sorted by address, so
+// r_anal_hint_get is a tree descent and a miss costs no string work at all.
+// The "hint.0x%08x" sdb arrays ("jump:,0x1234,esil:,<base64>,...") are only
+// used to import and export them (r_anal_hint_save, r_anal_hint_load).
+
+enum {
+	HINT_IMMBASE,
+	HINT_JUMP,
+	HINT_FAIL,
+	HINT_STACKFRAME,
+	HINT_PTR,
+	HINT_NWORD,
+	HINT_RET,
+	HINT_BITS,
+	HINT_NEW_BITS,
+	HINT_SIZE,
+	HINT_SYNTAX,
+	HINT_TYPE,
+	HINT_OPCODE,
+	HINT_OFFSET,
+	HINT_ESIL,
+	HINT_ARCH,
+	HINT_HIGH,
+	HINT_VAL,
+	HINT_LAST
+};
+
+// sdb array keys, only the first char is checked when parsing
+static const char *hint_keys[HINT_LAST] = {
+	"immbase:", "jump:", "fail:", "Frame:", "ptr:", "nword:", "ret:", "bits:", "Bits:",
+	"size:", "Syntax:", "type:", "opcode:", "Offset:", "esil:", "arch:", "high:", "val:"
+};
+
+typedef struct {
+	RBNode rb;
+	ut32 set; // 1 << HINT_* for every field present
+	RAnalHint hint;
+} HintNode;
+
+#define HINT_NODE(x) container_of (x, HintNode, rb)
+
+static void hint_init(RAnalHint *hint, ut64 addr) {
+	memset (hint, 0, sizeof (RAnalHint));
+	hint->addr = addr;
+	hint->jump = UT64_MAX;
+	hint->fail = UT64_MAX;
+	hint->ret = UT64_MAX;
+	hint->val = UT64_MAX;
+	hint->stackframe = UT64_MAX;
+}
 
-R_API void r_anal_hint_clear(RAnal *a) {
-	sdb_reset (a->sdb_hints);
+static void hint_fini(RAnalHint *hint) {
+	free (hint->arch);
+	free (hint->esil);
+	free (hint->opcode);
+	free (hint->syntax);
+	free (hint->offset);
+}
+
+static bool hint_copy(RAnalHint *dst, const RAnalHint *src) {
+	*dst = *src;
+	dst->arch = src->arch? strdup (src->arch): NULL;
+	dst->esil = src->esil? strdup (src->esil): NULL;
+	dst->opcode = src->opcode? strdup (src->opcode): NULL;
+	dst->syntax = src->syntax? strdup (src->syntax): NULL;
+	dst->offset = src->offset? strdup (src->offset): NULL;
+	return (!src->arch || dst->arch) && (!src->esil || dst->esil) && (!src->opcode || dst->opcode)
+		&& (!src->syntax || dst->syntax) && (!src->offset || dst->offset);
+}
+
+static char **hint_str(RAnalHint *hint, int kind) {
+	switch (kind) {
+	case HINT_SYNTAX: return &hint->syntax;
+	case HINT_OPCODE: return &hint->opcode;
+	case HINT_OFFSET: return &hint->offset;
+	case HINT_ESIL: return &hint->esil;
+	case HINT_ARCH: return &hint->arch;
+	}
+	return NULL;
+}
+
+static ut64 hint_num(const RAnalHint *hint, int kind) {
+	switch (kind) {
+	case HINT_IMMBASE: return hint->immbase;
+	case HINT_JUMP: return hint->jump;
+	case HINT_FAIL: return hint->fail;
+	case HINT_STACKFRAME: return hint->stackframe;
+	case HINT_PTR: return hint->ptr;
+	case HINT_NWORD: return hint->nword;
+	case HINT_RET: return hint->ret;
+	case HINT_BITS: return hint->bits;
+	case HINT_NEW_BITS: return hint->new_bits;
+	case HINT_SIZE: return hint->size;
+	case HINT_TYPE: return hint->type;
+	case HINT_HIGH: return hint->high;
+	case HINT_VAL: return hint->val;
+	}
+	return 0;
+}
+
+static void hint_set_num(RAnalHint *hint, int kind, ut64 v) {
+	switch (kind) {
+	case HINT_IMMBASE: hint->immbase = v; break;
+	case HINT_JUMP: hint->jump = v; break;
+	case HINT_FAIL: hint->fail = v; break;
+	case HINT_STACKFRAME: hint->stackframe = v; break;
+	case HINT_PTR: hint->ptr = v; break;
+	case HINT_NWORD: hint->nword = v; break;
+	case HINT_RET: hint->ret = v; break;
+	case HINT_BITS: hint->bits = v; break;
+	case HINT_NEW_BITS: hint->new_bits = v; break;
+	case HINT_SIZE: hint->size = v; break;
+	case HINT_TYPE: hint->type = v; break;
+	case HINT_HIGH: hint->high = v; break;
+	case HINT_VAL: hint->val = v; break;
+	}
 }
 
-R_API void r_anal_hint_del(RAnal *a, ut64 addr, int size) {
-	char key[128];
-	if (size > 1) {
-		eprintf ("TODO: r_anal_hint_del: in range\n");
+// Store one field, s for the string ones and v for the others
+static bool hint_field_set(RAnalHint *hint, int kind, const char *s, ut64 v) {
+	char **str = hint_str (hint, kind);
+	if (str) {
+		char *dup = strdup (s? s: "");
+		if (!dup) {
+			return false;
+		}
+		free (*str);
+		*str = dup;
 	} else {
-		setf (key, "hint.0x%08"PFMT64x, addr);
-		sdb_unset (a->sdb_hints, key, 0);
+		hint_set_num (hint, kind, v);
 	}
+	return true;
 }
 
-static void unsetHint(RAnal *a, const char *type, ut64 addr) {
-	char key[128];
-	setf (key, "hint.0x%08"PFMT64x, addr);
-	int idx = sdb_array_indexof (DB, key, type, 0);
-	if (idx != -1) {
-		sdb_array_delete (DB, key, idx, 0);
-		sdb_array_delete (DB, key, idx, 0);
+static void hint_field_unset(RAnalHint *hint, int kind) {
+	char **str = hint_str (hint, kind);
+	if (str) {
+		R_FREE (*str);
+		return;
+	}
+	switch (kind) {
+	case HINT_JUMP:
+	case HINT_FAIL:
+	case HINT_STACKFRAME:
+	case HINT_RET:
+	case HINT_VAL:
+		hint_set_num (hint, kind, UT64_MAX);
+		break;
+	default:
+		hint_set_num (hint, kind, 0);
+		break;
 	}
 }
 
-static void setHint(RAnal *a, const char *type, ut64 addr, const char *s, ut64 ptr) {
-	char key[128], val[128], *nval = NULL;
-	setf (key, "hint.0x%08"PFMT64x, addr);
-	int idx = sdb_array_indexof (DB, key, type, 0);
-	if (s) {
-		nval = sdb_encode ((const ut8*)s, -1);
-	} else {
-		nval = sdb_itoa (ptr, val, 16);
+static int hint_kind(int token) {
+	int i;
+	for (i = 0; i < HINT_LAST; i++) {
+		if (*hint_keys[i] == token) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Parse an sdb hint array into hint, returns the mask of the fields found
+static ut32 hint_parse(RAnalHint *hint, const char *str) {
+	char *r, *nxt, *nxt2;
+	ut32 set = 0;
+	char *s = strdup (str);
+	if (!s) {
+		return 0;
+	}
+	int token = *s;
+	for (r = s; ; r = nxt2) {
+		r = sdb_anext (r, &nxt);
+		if (!nxt) {
+			break;
+		}
+		sdb_anext (nxt, &nxt2); // tokenize value
+		int kind = hint_kind (token);
+		if (kind != -1) {
+			if (hint_str (hint, kind)) {
+				char **str = hint_str (hint, kind);
+				free (*str);
+				*str = (char *)sdb_decode (nxt, 0);
+			} else {
+				hint_set_num (hint, kind, kind == HINT_TYPE? r_num_get (NULL, nxt): sdb_atoi (nxt));
+			}
+			set |= 1 << kind;
+		}
+		if (!nxt || !nxt2) {
+			break;
+		}
+		token = *nxt2;
+	}
+	free (s);
+	return set;
+}
+
+static char *hint_node_tostring(HintNode *node) {
+	char num[SDB_NUM_BUFSZ];
+	int kind;
+	RStrBuf *sb = r_strbuf_new ("");
+	if (!sb) {
+		return NULL;
+	}
+	for (kind = 0; kind < HINT_LAST; kind++) {
+		if (!(node->set & (1 << kind))) {
+			continue;
+		}
+		char **str = hint_str (&node->hint, kind);
+		char *val = str? sdb_encode ((const ut8 *)(*str? *str: ""), -1)
+			: sdb_itoa (hint_num (&node->hint, kind), num, 16);
+		r_strbuf_appendf (sb, "%s%s,%s", r_strbuf_length (sb)? ",": "", hint_keys[kind], val? val: "");
+		if (str) {
+			free (val);
+		}
+	}
+	return r_strbuf_drain (sb);
+}
+
+static int hint_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	ut64 addr = *(const ut64 *)incoming;
+	ut64 at = container_of (in_tree, const HintNode, rb)->hint.addr;
+	return (addr > at) - (addr < at);
+}
+
+static void hint_node_free(RBNode *node) {
+	HintNode *n = HINT_NODE (node);
+	hint_fini (&n->hint);
+	free (n);
+}
+
+static HintNode *hint_node_get(RAnal *a, ut64 addr) {
+	RBNode *node = a->hints? r_rbtree_find (a->hints, &addr, hint_cmp, NULL): NULL;
+	return node? HINT_NODE (node): NULL;
+}
+
+static HintNode *hint_node_ensure(RAnal *a, ut64 addr) {
+	HintNode *node = hint_node_get (a, addr);
+	if (node) {
+		return node;
 	}
-	if (idx != -1) {
-		if (!s) {
-			nval = sdb_itoa (ptr, val, 16);
+	if (!(node = R_NEW0 (HintNode))) {
+		return NULL;
+	}
+	hint_init (&node->hint, addr);
+	r_rbtree_insert (&a->hints, &addr, &node->rb, hint_cmp, NULL);
+	a->hints_count++;
+	return node;
+}
+
+static void hint_node_del(RAnal *a, ut64 addr) {
+	if (r_rbtree_delete (&a->hints, &addr, hint_cmp, hint_node_free, NULL)) {
+		a->hints_count--;
+	}
+}
+
+R_API void r_anal_hint_clear(RAnal *a) {
+	r_rbtree_free (a->hints, hint_node_free);
+	a->hints = NULL;
+	a->hints_count = 0;
+}
+
+R_API void r_anal_hint_del(RAnal *a, ut64 addr, int size) {
+	if (size > 1) {
+		HintNode *node;
+		ut64 *at;
+		RVector *addrs = r_vector_new (sizeof (ut64), NULL, NULL);
+		RBIter it = r_rbtree_lower_bound_forward (a->hints, &addr, hint_cmp, NULL);
+		if (!addrs) {
+			return;
 		}
-		sdb_array_set (DB, key, idx + 1, nval, 0);
+		// collect them first, deleting would break the iterator
+		r_rbtree_iter_while (it, node, HintNode, rb) {
+			if (node->hint.addr - addr >= size) {
+				break;
+			}
+			r_vector_push (addrs, &node->hint.addr);
+		}
+		r_vector_foreach (addrs, at) {
+			hint_node_del (a, *at);
+		}
+		r_vector_free (addrs);
 	} else {
-		sdb_array_push (DB, key, nval, 0);
-		sdb_array_push (DB, key, type, 0);
+		hint_node_del (a, addr);
 	}
-	if (s) {
-		free (nval);
+}
+
+static void unsetHint(RAnal *a, int kind, ut64 addr) {
+	HintNode *node = hint_node_get (a, addr);
+	if (node && (node->set & (1 << kind))) {
+		hint_field_unset (&node->hint, kind);
+		node->set &= ~(1 << kind);
+		if (!node->set) {
+			hint_node_del (a, addr);
+		}
+	}
+}
+
+static void setHint(RAnal *a, int kind, ut64 addr, const char *s, ut64 ptr) {
+	HintNode *node = hint_node_ensure (a, addr);
+	if (!node) {
+		return;
+	}
+	if (hint_field_set (&node->hint, kind, s, ptr)) {
+		node->set |= 1 << kind;
+	} else if (!node->set) {
+		hint_node_del (a, addr);
 	}
 }
 
 R_API void r_anal_hint_set_offset(RAnal *a, ut64 addr, const char* typeoff) {
-	setHint (a, "Offset:", addr, r_str_trim_ro (typeoff), 0);
+	setHint (a, HINT_OFFSET, addr, r_str_trim_ro (typeoff), 0);
 }
 
 R_API void r_anal_hint_set_nword(RAnal *a, ut64 addr, int nword) {
-	setHint (a, "nword:", addr, NULL, nword);
+	setHint (a, HINT_NWORD, addr, NULL, nword);
 }
 
 R_API void r_anal_hint_set_jump(RAnal *a, ut64 addr, ut64 ptr) {
-	setHint (a, "jump:", addr, NULL, ptr);
+	setHint (a, HINT_JUMP, addr, NULL, ptr);
 }
 
 R_API void r_anal_hint_set_newbits(RAnal *a, ut64 addr, int bits) {
-	setHint (a, "Bits:", addr, NULL, bits);
+	setHint (a, HINT_NEW_BITS, addr, NULL, bits);
 }
 
 // TODO: add helpers for newendian and newbank
 
 R_API void r_anal_hint_set_fail(RAnal *a, ut64 addr, ut64 ptr) {
-	setHint (a, "fail:", addr, NULL, ptr);
+	setHint (a, HINT_FAIL, addr, NULL, ptr);
 }
 
 R_API void r_anal_hint_set_high(RAnal *a, ut64 addr) {
-	setHint (a, "high:", addr, NULL, 1);
+	setHint (a, HINT_HIGH, addr, NULL, 1);
 }
 
 R_API void r_anal_hint_set_immbase(RAnal *a, ut64 addr, int base) {
 	if (base) {
-		setHint (a, "immbase:", addr, NULL, (ut64)base);
+		setHint (a, HINT_IMMBASE, addr, NULL, (ut64)base);
 	} else {
-		unsetHint (a, "immbase:", addr);
+		unsetHint (a, HINT_IMMBASE, addr);
 	}
 }
 
 R_API void r_anal_hint_set_pointer(RAnal *a, ut64 addr, ut64 ptr) {
-	setHint (a, "ptr:", addr, NULL, ptr);
+	setHint (a, HINT_PTR, addr, NULL, ptr);
 }
 
 R_API void r_anal_hint_set_ret(RAnal *a, ut64 addr, ut64 val) {
-	setHint (a, "ret:", addr, NULL, val);
+	setHint (a, HINT_RET, addr, NULL, val);
 }
 
 R_API void r_anal_hint_set_arch(RAnal *a, ut64 addr, const char *arch) {
-	setHint (a, "arch:", addr, r_str_trim_ro (arch), 0);
+	setHint (a, HINT_ARCH, addr, r_str_trim_ro (arch), 0);
 }
 
 R_API void r_anal_hint_set_syntax(RAnal *a, ut64 addr, const char *syn) {
-	setHint (a, "Syntax:", addr, syn, 0);
+	setHint (a, HINT_SYNTAX, addr, syn, 0);
 }
 
 R_API void r_anal_hint_set_opcode(RAnal *a, ut64 addr, const char *opcode) {
-	setHint (a, "opcode:", addr, r_str_trim_ro (opcode), 0);
+	setHint (a, HINT_OPCODE, addr, r_str_trim_ro (opcode), 0);
 }
 
 R_API void r_anal_hint_set_esil(RAnal *a, ut64 addr, const char *esil) {
-	setHint (a, "esil:", addr, r_str_trim_ro (esil), 0);
+	setHint (a, HINT_ESIL, addr, r_str_trim_ro (esil), 0);
 }
 
 R_API void r_anal_hint_set_type (RAnal *a, ut64 addr, int type) {
-	setHint (a, "type:", addr, NULL, (ut64)type);
+	setHint (a, HINT_TYPE, addr, NULL, (ut64)type);
 }
 
 R_API void r_anal_hint_set_bits(RAnal *a, ut64 addr, int bits) {
-	setHint (a, "bits:", addr, NULL, bits);
+	setHint (a, HINT_BITS, addr, NULL, bits);
 	if (a && a->hint_cbs.on_bits) {
 		a->hint_cbs.on_bits (a, addr, bits, true);
 	}
@@ -123,23 +385,23 @@ R_API void r_anal_hint_set_bits(RAnal *a, ut64 addr, int bits) {
 }
 
 R_API void r_anal_hint_set_size(RAnal *a, ut64 addr, int size) {
-	setHint (a, "size:", addr, NULL, size);
+	setHint (a, HINT_SIZE, addr, NULL, size);
 }
 
 R_API void r_anal_hint_set_stackframe(RAnal *a, ut64 addr, ut64 size) {
-	setHint (a, "Frame:", addr, NULL, size);
+	setHint (a, HINT_STACKFRAME, addr, NULL, size);
 }
 
 R_API void r_anal_hint_set_val(RAnal *a, ut64 addr, ut64 v) {
-	setHint (a, "val:", addr, NULL, v);
+	setHint (a, HINT_VAL, addr, NULL, v);
 }
 
 R_API void r_anal_hint_unset_size(RAnal *a, ut64 addr) {
-	unsetHint(a, "size:", addr);
+	unsetHint (a, HINT_SIZE, addr);
 }
 
 R_API void r_anal_hint_unset_bits(RAnal *a, ut64 addr) {
-	unsetHint(a, "bits:", addr);
+	unsetHint (a, HINT_BITS, addr);
 	if (a && a->hint_cbs.on_bits) {
 		a->hint_cbs.on_bits (a, addr, 0, false);
 	}
@@ -147,68 +409,64 @@ R_API void r_anal_hint_unset_bits(RAnal *a, ut64 addr) {
 }
 
 R_API void r_anal_hint_unset_esil(RAnal *a, ut64 addr) {
-	unsetHint(a, "esil:", addr);
+	unsetHint (a, HINT_ESIL, addr);
 }
 
 R_API void r_anal_hint_unset_opcode(RAnal *a, ut64 addr) {
-	unsetHint(a, "opcode:", addr);
+	unsetHint (a, HINT_OPCODE, addr);
 }
 
 R_API void r_anal_hint_unset_high(RAnal *a, ut64 addr) {
-	unsetHint(a, "high:", addr);
+	unsetHint (a, HINT_HIGH, addr);
 }
 
 R_API void r_anal_hint_unset_arch(RAnal *a, ut64 addr) {
-	unsetHint(a, "arch:", addr);
+	unsetHint (a, HINT_ARCH, addr);
 }
 
 R_API void r_anal_hint_unset_nword(RAnal *a, ut64 addr) {
-	unsetHint(a, "nword:", addr);
+	unsetHint (a, HINT_NWORD, addr);
 }
 
 R_API void r_anal_hint_unset_syntax(RAnal *a, ut64 addr) {
-	unsetHint(a, "Syntax:", addr);
+	unsetHint (a, HINT_SYNTAX, addr);
 }
 
 R_API void r_anal_hint_unset_pointer(RAnal *a, ut64 addr) {
-	unsetHint(a, "ptr:", addr);
+	unsetHint (a, HINT_PTR, addr);
 }
 
 R_API void r_anal_hint_unset_ret(RAnal *a, ut64 addr) {
-	unsetHint(a, "ret:", addr);
+	unsetHint (a, HINT_RET, addr);
 }
 
 R_API void r_anal_hint_unset_offset(RAnal *a, ut64 addr) {
-	unsetHint (a, "Offset:", addr);
+	unsetHint (a, HINT_OFFSET, addr);
 }
 
 R_API void r_anal_hint_unset_jump(RAnal *a, ut64 addr) {
-	unsetHint (a, "jump:", addr);
+	unsetHint (a, HINT_JUMP, addr);
 }
 
 R_API void r_anal_hint_unset_fail(RAnal *a, ut64 addr) {
-	unsetHint (a, "fail:", addr);
+	unsetHint (a, HINT_FAIL, addr);
 }
 
 R_API void r_anal_hint_unset_val (RAnal *a, ut64 v) {
-	unsetHint (a, "val:", v);
+	unsetHint (a, HINT_VAL, v);
 }
 
 R_API void r_anal_hint_unset_type (RAnal *a, ut64 addr) {
-	unsetHint (a, "type:", addr);
+	unsetHint (a, HINT_TYPE, addr);
 }
 
 R_API void r_anal_hint_unset_stackframe(RAnal *a, ut64 addr) {
-	unsetHint (a, "Frame:", addr);
+	unsetHint (a, HINT_STACKFRAME, addr);
 }
 
 R_API void r_anal_hint_free(RAnalHint *h) {
 	if (h) {
-		free (h->arch);
-		free (h->esil);
-		free (h->opcode);
-		free (h->syntax);
-		free (h->offset);
+		hint_fini (h);
 		free (h);
 	}
 }
@@ -217,95 +475,97 @@ R_API int r_anal_hint_get_bits_at(RAnal *a, ut64 addr, const char *str) {
 	if (a->opt.ignbithints) {
 		return 0;
 	}
-	char *r, *nxt, *nxt2;
-	char *s = strdup (str);
-	int token = 0, bits = 0;
-	if (!s) {
-		return 0;
-	}
-	token = *s;
-	for (r = s; ; r = nxt2) {
-		r = sdb_anext (r, &nxt);
-		if (!nxt) {
-			break;
-		}
-		sdb_anext (nxt, &nxt2); // tokenize value
-		if (token) {
-			switch (token) {
-			case 'b':
-				bits = sdb_atoi (nxt);
-				break;
-			}
-		}
-		if (!nxt || !nxt2) {
-			break;
-		}
-		token = *nxt2;
-	}
-	free (s);
-	return bits;
+	RAnalHint hint;
+	hint_init (&hint, addr);
+	hint_parse (&hint, str);
+	hint_fini (&hint);
+	return hint.bits;
 }
 
-// TODO: missing to_string ()
 R_API RAnalHint *r_anal_hint_from_string(RAnal *a, ut64 addr, const char *str) {
-	char *r, *nxt, *nxt2;
-	int token = 0;
 	RAnalHint *hint = R_NEW0 (RAnalHint);
 	if (!hint) {
 		return NULL;
 	}
-	hint->jump = UT64_MAX;
-	hint->fail = UT64_MAX;
-	hint->ret = UT64_MAX;
-	hint->val = UT64_MAX;
-	hint->stackframe = UT64_MAX;
-	char *s = strdup (str);
-	if (!s) {
-		free (hint);
+	hint_init (hint, addr);
+	hint_parse (hint, str);
+	return hint;
+}
+
+R_API RAnalHint *r_anal_hint_get(RAnal *a, ut64 addr) {
+	if (!a->hints_count) {
 		return NULL;
 	}
-	hint->addr = addr;
-	token = *s;
-	for (r = s; ; r = nxt2) {
-		r = sdb_anext (r, &nxt);
-		if (!nxt) {
-			break;
+	HintNode *node = hint_node_get (a, addr);
+	if (!node) {
+		return NULL;
+	}
+	RAnalHint *hint = R_NEW0 (RAnalHint);
+	if (hint && !hint_copy (hint, &node->hint)) {
+		r_anal_hint_free (hint);
+		return NULL;
+	}
+	return hint;
+}
+
+// Sdb array of the hints at addr, as stored under "hint.0x%08"PFMT64x
+R_API char *r_anal_hint_to_string(RAnal *a, ut64 addr) {
+	HintNode *node = hint_node_get (a, addr);
+	return node? hint_node_tostring (node): NULL;
+}
+
+// Walk the hints in address order, stops when cb returns false
+R_API bool r_anal_hint_foreach(RAnal *a, RAnalHintCb cb, void *user) {
+	RBIter it;
+	HintNode *node;
+	r_rbtree_foreach (a->hints, it, node, HintNode, rb) {
+		if (!cb (&node->hint, user)) {
+			return false;
 		}
-		sdb_anext (nxt, &nxt2); // tokenize value
-		if (token) {
-			switch (token) {
-			case 'i': hint->immbase = sdb_atoi (nxt); break;
-			case 'j': hint->jump = sdb_atoi (nxt); break;
-			case 'f': hint->fail = sdb_atoi (nxt); break;
-			case 'F': hint->stackframe = sdb_atoi (nxt); break;
-			case 'p': hint->ptr = sdb_atoi (nxt); break;
-			case 'n': hint->nword = sdb_atoi (nxt); break;
-			case 'r': hint->ret = sdb_atoi (nxt); break;
-			case 'b': hint->bits = sdb_atoi (nxt); break;
-			case 'B': hint->new_bits = sdb_atoi (nxt); break;
-			case 's': hint->size = sdb_atoi (nxt); break;
-			case 'S': hint->syntax = (char*)sdb_decode (nxt, 0); break;
-			case 't': hint->type = r_num_get (NULL, nxt);  break;
-			case 'o': hint->opcode = (char*)sdb_decode (nxt, 0); break;
-			case 'O': hint->offset = (char*)sdb_decode (nxt, 0); break;
-			case 'e': hint->esil = (char*)sdb_decode (nxt, 0); break;
-			case 'a': hint->arch = (char*)sdb_decode (nxt, 0); break;
-			case 'h': hint->high = sdb_atoi (nxt); break;
-			case 'v': hint->val = sdb_atoi (nxt); break;
-			}
+	}
+	return true;
+}
+
+R_API int r_anal_hint_count(RAnal *a) {
+	return a->hints_count;
+}
+
+// Replace the contents of db with the hints, one "hint.0x%08"PFMT64x" array per address
+R_API void r_anal_hint_save(RAnal *a, Sdb *db) {
+	RBIter it;
+	HintNode *node;
+	char key[64];
+	sdb_reset (db);
+	r_rbtree_foreach (a->hints, it, node, HintNode, rb) {
+		char *val = hint_node_tostring (node);
+		if (val) {
+			snprintf (key, sizeof (key), "hint.0x%08"PFMT64x, node->hint.addr);
+			sdb_set_owned (db, key, val, 0);
 		}
-		if (!nxt || !nxt2) {
-			break;
+	}
+}
+
+static int hint_load_cb(void *user, const char *k, const char *v) {
+	RAnal *a = user;
+	if (!strncmp (k, "hint.", 5) && v && *v) {
+		ut64 addr = sdb_atoi (k + 5);
+		HintNode *node = hint_node_ensure (a, addr);
+		if (node) {
+			node->set |= hint_parse (&node->hint, v);
+			if (!node->set) {
+				hint_node_del (a, addr);
+			} else if (node->set & (1 << HINT_BITS)) {
+				if (a->hint_cbs.on_bits) {
+					a->hint_cbs.on_bits (a, addr, node->hint.bits, true);
+				}
+				a->merge_hints = true;
+			}
 		}
-		token = *nxt2;
 	}
-	free (s);
-	return hint;
+	return 1;
 }
 
-R_API RAnalHint *r_anal_hint_get(RAnal *a, ut64 addr) {
-	char key[64];
-	setf (key, "hint.0x%08"PFMT64x, addr);
-	const char *s = sdb_const_get (DB, key, 0);
-	return s? r_anal_hint_from_string (a, addr, s): NULL;
+// Add the hints stored in db, as written by r_anal_hint_save
+R_API void r_anal_hint_load(RAnal *a, Sdb *db) {
+	sdb_foreach (db, hint_load_cb, a);
 }
@@ -15,92 +15,178 @@
 DatabaseName:
   'anal.meta'
 Keys:
-  'meta.<type>.count=<int>'     number of added metas where 'type' is a single char
-  'meta.<type>.<last>=<array>'  split array, each block contains K elements
+  'meta.0x<addr>=<array>'       types of the metas added with r_meta_add at addr
   'meta.<type>.<addr>=<string>' string representing extra information of the meta type at given address
-  'range.<baddr>=<array>'       store valid addresses in a base range array
 #endif
 
 #include <r_anal.h>
 #include <r_core.h>
 #include <r_util.h>
 
-#define META_RANGE_BASE(x) ((x)>>5)
 #undef DB
 #define DB a->sdb_meta
 
-static char *meta_inrange_get (RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return NULL;
+// The items stored in sdb are mirrored in an interval tree keyed by (from, type),
+// so the lookups done for every disassembled line are a tree descent instead of
+// key formatting, array parsing and base64 decoding. sdb is still the canonical
+// store used for listing and serialization, every writer in this file calls
+// meta_tree_sync after touching a record and r_meta_reindex rebuilds the whole
+// tree after sdb_meta is modified behind our back (snapshots, purge).
+typedef struct {
+	RBNode rb;
+	ut64 rb_max_addr; // maximum meta_node_last in the subtree
+	bool listed; // type is in meta.0x<addr>, so r_meta_find reports it
+	RAnalMetaItem item;
+} RAnalMetaNode;
+
+#define META_NODE(x) container_of (x, RAnalMetaNode, rb)
+
+static inline ut64 meta_node_last(const RAnalMetaNode *node) {
+	// empty strings are stored with size 0, they still cover their address
+	const ut64 size = node->item.size;
+	return node->item.from + (size? size - 1: 0);
+}
+
+static int meta_node_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	const RAnalMetaNode *a = incoming;
+	const RAnalMetaNode *b = container_of (in_tree, const RAnalMetaNode, rb);
+	if (a->item.from != b->item.from) {
+		return a->item.from < b->item.from? -1: 1;
 	}
-	ut64 base = META_RANGE_BASE (addr);
-	ut64 base2 = META_RANGE_BASE (addr + size - 1);
-	char *res = NULL;
-	// return string array of all the offsets where there are stuff
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		char *r = sdb_get (DB, key, 0);
-		if (r) {
-			if (res) {
-				res = r_str_append (res, ",");
+	return a->item.type - b->item.type;
+}
+
+static void meta_node_sum(RBNode *node) {
+	int i;
+	RAnalMetaNode *n = META_NODE (node);
+	n->rb_max_addr = meta_node_last (n);
+	for (i = 0; i < 2; i++) {
+		if (node->child[i]) {
+			RAnalMetaNode *c = META_NODE (node->child[i]);
+			if (c->rb_max_addr > n->rb_max_addr) {
+				n->rb_max_addr = c->rb_max_addr;
 			}
-			res = r_str_append (res, r);
-			free (r);
 		}
 	}
-	return res;
 }
 
-static bool meta_inrange_add (RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return false;
+static void meta_node_free(RBNode *node) {
+	RAnalMetaNode *n = META_NODE (node);
+	free (n->item.str);
+	free (n);
+}
+
+static RAnalMetaNode *meta_node_get(RAnal *a, int type, ut64 addr) {
+	RAnalMetaNode key = { .item = { .from = addr, .type = type } };
+	RBNode *node = r_rbtree_find (a->meta, &key, meta_node_cmp, NULL);
+	return node? META_NODE (node): NULL;
+}
+
+// Mirror the sdb record meta.<type>.0x<addr> in the tree
+static void meta_tree_sync(RAnal *a, int type, ut64 addr) {
+	RAnalMetaNode key = { .item = { .from = addr, .type = type } };
+	r_rbtree_aug_delete (&a->meta, &key, meta_node_cmp, meta_node_free, meta_node_sum, NULL);
+	const char *v = sdb_const_get (DB, sdb_fmt ("meta.%c.0x%"PFMT64x, type, addr), 0);
+	if (!v) {
+		return;
 	}
-	bool set = false;
-	ut64 base, base2;
-	base = META_RANGE_BASE (addr);
-	base2 = META_RANGE_BASE (addr + size - 1);
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		if (sdb_array_add_num (DB, key, addr, 0)) {
-			set = true;
-		}
+	RAnalMetaNode *node = R_NEW0 (RAnalMetaNode);
+	if (!node) {
+		return;
+	}
+	if (!r_meta_deserialize_val (a, &node->item, type, addr, v)) {
+		free (node);
+		return;
 	}
-	return set;
+	const char *types = sdb_const_get (DB, sdb_fmt ("meta.0x%"PFMT64x, addr), 0);
+	node->listed = types && strchr (types, type);
+	r_rbtree_aug_insert (&a->meta, node, &node->rb, meta_node_cmp, meta_node_sum, NULL);
 }
 
-static bool meta_inrange_del (RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return false;
+// Sync every item at addr plus the given type, deleting one type may change
+// the meta.0x<addr> list the others are checked against
+static void meta_tree_sync_at(RAnal *a, ut64 addr, int type) {
+	char types[32];
+	int i, n = 0;
+	RAnalMetaNode key = { .item = { .from = addr, .type = R_META_TYPE_NONE } };
+	RAnalMetaNode *node;
+	if (type != R_META_TYPE_ANY) {
+		types[n++] = type;
+	}
+	RBIter it = r_rbtree_lower_bound_forward (a->meta, &key, meta_node_cmp, NULL);
+	r_rbtree_iter_while (it, node, RAnalMetaNode, rb) {
+		if (node->item.from != addr || n >= sizeof (types)) {
+			break;
+		}
+		if (node->item.type != type) {
+			types[n++] = node->item.type;
+		}
 	}
-	bool set = false;
-	ut64 base = META_RANGE_BASE (addr);
-	ut64 base2 = META_RANGE_BASE (addr + size - 1);
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		if (sdb_array_remove_num (DB, key, addr, 0)) {
-			set = true;
+	for (i = 0; i < n; i++) {
+		meta_tree_sync (a, types[i], addr);
+	}
+}
+
+// Walk the items intersecting [from, to] (to is inclusive) in address order, O(log(n) + k)
+static bool meta_tree_foreach_in(RBNode *node, int type, ut64 from, ut64 to, bool listed, RAnalMetaCb cb, void *user) {
+	while (node) {
+		RAnalMetaNode *n = META_NODE (node);
+		if (n->rb_max_addr < from) {
+			return true;
 		}
+		if (!meta_tree_foreach_in (node->child[0], type, from, to, listed, cb, user)) {
+			return false;
+		}
+		if (n->item.from > to) {
+			return true;
+		}
+		if (from <= meta_node_last (n) && (type == R_META_TYPE_ANY || n->item.type == type)
+				&& (!listed || n->listed)) {
+			if (!cb (&n->item, user)) {
+				return false;
+			}
+		}
+		node = node->child[1];
 	}
-	return set;
+	return true;
+}
+
+static int meta_reindex_cb(void *user, const char *k, const char *v) {
+	RAnal *a = user;
+	// meta.<type>.0x<addr>, var comments have a trailing .0x<idx> and stay out
+	if (strlen (k) > 9 && !strncmp (k, "meta.", 5) && !strncmp (k + 6, ".0x", 3) && !strchr (k + 7, '.')) {
+		meta_tree_sync (a, k[5], sdb_atoi (k + 7));
+	}
+	return 1;
+}
+
+R_API void r_meta_reindex(RAnal *a) {
+	r_rbtree_free (a->meta, meta_node_free);
+	a->meta = NULL;
+	sdb_foreach (DB, meta_reindex_cb, a);
 }
 
-// 512 = 1.5s
-// 256 = 1.3s
-// 128 = 1.2s
-// 64 = 1.14
-// 32 = 1.12
-// not storing any = 1
-#define K 256
+R_API void r_meta_free(RAnal *a) {
+	r_rbtree_free (a->meta, meta_node_free);
+	a->meta = NULL;
+}
 
-static int meta_type_add(RAnal *a, char type, ut64 addr) {
-	char key[32];
-	ut32 count, last;
-	snprintf (key, sizeof (key)-1, "meta.%c.count", type);
-	count = (ut32)sdb_num_inc (DB, key, 1, 0);
-	last = count/K;
+R_API bool r_meta_foreach_in(RAnal *a, int type, ut64 from, ut64 to, RAnalMetaCb cb, void *user) {
+	r_return_val_if_fail (a && cb, false);
+	if (to <= from) {
+		return true;
+	}
+	return meta_tree_foreach_in (a->meta, type, from, to - 1, false, cb, user);
+}
+
+static bool meta_count_in_cb(const RAnalMetaItem *item, void *user) {
+	(*(int *)user)++;
+	return true;
+}
 
-	snprintf (key, sizeof (key)-1, "meta.%c.%d", type, last);
-	sdb_array_add_num (DB, key, addr, 0);
+R_API int r_meta_count(RAnal *a, int type, ut64 from, ut64 to) {
+	int count = 0;
+	r_meta_foreach_in (a, type, from, to, meta_count_in_cb, &count);
 	return count;
 }
 
@@ -110,13 +196,11 @@ R_API int r_meta_set_string(RAnal *a, int type, ut64 addr, const char *s) {
 	int ret;
 	ut64 size;
 	const char *space = r_spaces_current_name (&a->meta_spaces);
-	meta_type_add (a, type, addr);
 
 	snprintf (key, sizeof (key)-1, "meta.%c.0x%"PFMT64x, type, addr);
 	size = sdb_array_get_num (DB, key, 0, 0);
 	if (!size) {
 		size = strlen (s);
-		meta_inrange_add (a, addr, size);
 		ret = true;
 	} else {
 		ret = false;
@@ -130,6 +214,7 @@ R_API int r_meta_set_string(RAnal *a, int type, ut64 addr, const char *s) {
 	snprintf (val, sizeof (val)-1, "%d,%s,%s", (int)size, space, e_str);
 	sdb_set (DB, key, val, 0);
 	free ((void*)e_str);
+	meta_tree_sync (a, type, addr);
 
 	/* send event */
 	REventMeta rems = {
@@ -147,13 +232,11 @@ R_API int r_meta_set_var_comment(RAnal *a, int type, ut64 idx, ut64 addr, const
 	int ret;
 	ut64 size;
 	const char *space = r_spaces_current_name (&a->meta_spaces);
-	meta_type_add (a, type, addr);
 
 	snprintf (key, sizeof (key)-1, "meta.%c.0x%"PFMT64x".0x%"PFMT64x, type, addr, idx);
 	size = sdb_array_get_num (DB, key, 0, 0);
 	if (!size) {
 		size = strlen (s);
-		meta_inrange_add (a, addr, size);
 		ret = true;
 	} else {
 		ret = false;
@@ -166,30 +249,8 @@ R_API int r_meta_set_var_comment(RAnal *a, int type, ut64 idx, ut64 addr, const
 }
 
 R_API char *r_meta_get_string(RAnal *a, int type, ut64 addr) {
-	char key[100];
-	const char *k, *p, *p2, *p3;
-	snprintf (key, sizeof (key)-1, "meta.%c.0x%"PFMT64x, type, addr);
-	k = sdb_const_get (DB, key, NULL);
-	if (!k) {
-		return NULL;
-	}
-	p = strchr (k, SDB_RS);
-	if (!p) {
-		return NULL;
-	}
-	k = p + 1;
-	p2 = strchr (k, SDB_RS);
-	if (!p2) {
-		return (char *)sdb_decode (k, NULL);
-	}
-	k = p2 + 1;
-	if (type == R_META_TYPE_STRING) {
-		p3 = strchr (k, SDB_RS);
-		if (p3) {
-			return (char *)sdb_decode (p3 + 1, NULL);
-		}
-	}
-	return (char *)sdb_decode (k, NULL);
+	RAnalMetaNode *node = meta_node_get (a, type, addr);
+	return (node && node->item.str)? strdup (node->item.str): NULL;
 }
 
 R_API char *r_meta_get_var_comment (RAnal *a, int type, ut64 idx, ut64 addr) {
@@ -212,19 +273,6 @@ R_API char *r_meta_get_var_comment (RAnal *a, int type, ut64 idx, ut64 addr) {
 	return (char *)sdb_decode (p2+1, NULL);
 }
 
-static bool mustDeleteMetaEntry(RAnal *a, ut64 addr) {
-	const char *tt = sdb_const_get (DB, sdb_fmt ("meta.t.0x%"PFMT64x, addr), NULL);
-	const char *ss = sdb_const_get (DB, sdb_fmt ("meta.s.0x%"PFMT64x, addr), NULL);
-	const char *dd = sdb_const_get (DB, sdb_fmt ("meta.d.0x%"PFMT64x, addr), NULL);
-	const char *cc = sdb_const_get (DB, sdb_fmt ("meta.C.0x%"PFMT64x, addr), NULL);
-	int count = 0;
-	if (tt) count++;
-	if (ss) count++;
-	if (dd) count++;
-	if (cc) count++;
-	return (count == 0);
-}
-
 // delete all the metas of a specific type, addr is ignored,
 static void r_meta_del_cb (RAnal *a, int type, int rad, SdbForeachCallback cb, void *user, ut64 addr) {
 	SdbList *ls = sdb_foreach_list (DB, true);
@@ -236,6 +284,7 @@ static void r_meta_del_cb (RAnal *a, int type, int rad, SdbForeachCallback cb, v
 		}
 	}
 	ls_free (ls);
+	r_meta_reindex (a);
 }
 
 R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
@@ -253,6 +302,7 @@ R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
 		// XXX: this thing ignores the type
 		if (type == R_META_TYPE_ANY) {
 			sdb_reset (DB);
+			r_meta_free (a);
 		} else {
 			r_meta_del_cb (a, type, type, NULL, NULL, UT64_MAX);
 		}
@@ -282,6 +332,7 @@ R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
 				}
 			}
 			sdb_unset (DB, key, 0);
+			meta_tree_sync_at (a, addr, type);
 			return false;
 		}
 		if (strchr (val, ',')) {
@@ -301,9 +352,7 @@ R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
 		sdb_unset (DB, key, 0);
 	}
 	sdb_unset (DB, key, 0);
-	if (mustDeleteMetaEntry (a, addr)) {
-		meta_inrange_del (a, addr, size);
-	}
+	meta_tree_sync_at (a, addr, type);
 	return false;
 }
 
@@ -430,7 +479,7 @@ static int meta_add(RAnal *a, int type, int subtype, ut64 from, ut64 to, const c
 	val[0] = type;
 	val[1] = '\0';
 	sdb_array_add (DB, key, val, 0);
-	meta_inrange_add (a, from, to - from);
+	meta_tree_sync_at (a, from, type);
 	return true;
 }
 
@@ -442,42 +491,43 @@ R_API int r_meta_add_with_subtype(RAnal *a, int type, int subtype, ut64 from, ut
 	return meta_add (a, type, subtype, from, to, str);
 }
 
+static bool meta_item_copy(RAnalMetaItem *dst, const RAnalMetaItem *src) {
+	*dst = *src;
+	dst->str = src->str? strdup (src->str): NULL;
+	return !src->str || dst->str;
+}
+
+static RAnalMetaItem *meta_item_dup(const RAnalMetaItem *item) {
+	RAnalMetaItem *mi = R_NEW0 (RAnalMetaItem);
+	if (mi && !meta_item_copy (mi, item)) {
+		R_FREE (mi);
+	}
+	return mi;
+}
+
 static RAnalMetaItem *r_meta_find_(RAnal *a, ut64 at, int type, int where, int excl_type) {
-	const char *infos, *metas;
-	char key[100];
-	Sdb *s = a->sdb_meta;
-	RAnalMetaItem *mi = NULL;
+	RAnalMetaNode key = { .item = { .from = at, .type = R_META_TYPE_NONE } };
+	RAnalMetaNode *node;
 	if (where != R_META_WHERE_HERE) {
 		eprintf ("THIS WAS NOT SUPPOSED TO HAPPEN\n");
 		return NULL;
 	}
-
-	snprintf (key, sizeof (key), "meta.0x%" PFMT64x, at);
-	infos = sdb_const_get (s, key, 0);
-	if (!infos) {
-		return NULL;
-	}
-	mi =  R_NEW0 (RAnalMetaItem);
-	for (; *infos; infos++) {
-		if (*infos == ',') {
-			continue;
+	RBIter it = r_rbtree_lower_bound_forward (a->meta, &key, meta_node_cmp, NULL);
+	r_rbtree_iter_while (it, node, RAnalMetaNode, rb) {
+		if (node->item.from != at) {
+			break;
 		}
-		if (type != R_META_TYPE_ANY && type != *infos) {
+		if (!node->listed) {
 			continue;
 		}
-		if (excl_type && excl_type == *infos) {
+		if (type != R_META_TYPE_ANY && type != node->item.type) {
 			continue;
 		}
-		snprintf (key, sizeof (key), "meta.%c.0x%" PFMT64x, *infos, at);
-		metas = sdb_const_get (s, key, 0);
-		if (metas) {
-			if (!r_meta_deserialize_val (a, mi, *infos, at, metas)) {
-				continue;
-			}
-			return mi;
+		if (excl_type && excl_type == node->item.type) {
+			continue;
 		}
+		return meta_item_dup (&node->item);
 	}
-	r_meta_item_free (mi);
 	return NULL;
 }
 
@@ -490,71 +540,40 @@ R_API RAnalMetaItem *r_meta_find_any_except(RAnal *a, ut64 at, int type, int whe
 	return r_meta_find_ (a, at, R_META_TYPE_ANY, where, type);
 }
 
-R_API RAnalMetaItem *r_meta_find_in(RAnal *a, ut64 at, int type, int where) {
-	char *res = meta_inrange_get (a, at, 1);
-	if (!res) {
-		return NULL;
+static bool meta_find_in_cb(const RAnalMetaItem *item, void *user) {
+	RAnalMetaItem **out = user;
+	if (item->size > 0) {
+		*out = meta_item_dup (item);
+		return false;
 	}
-	RList *list = r_str_split_list (res, ",", 0);
-	RListIter *iter;
-	const char *meta;
-	r_list_foreach (list, iter, meta) {
-		ut64 mia = r_num_math (NULL, meta);
-		RAnalMetaItem *mi = r_meta_find (a, mia, type, where);
+	return true;
+}
+
+R_API RAnalMetaItem *r_meta_find_in(RAnal *a, ut64 at, int type, int where) {
+	RAnalMetaItem *mi = NULL;
+	meta_tree_foreach_in (a->meta, type, at, at, true, meta_find_in_cb, &mi);
+	return mi;
+}
+
+static bool meta_find_list_in_cb(const RAnalMetaItem *item, void *user) {
+	RList *out = user;
+	if (item->size > 0) {
+		RAnalMetaItem *mi = meta_item_dup (item);
 		if (mi) {
-			if ((at >= mi->from && at < mi->to)) {
-				free (res);
-				return mi;
-			}
-			r_meta_item_free (mi);
+			r_list_append (out, mi);
 		}
 	}
-	r_list_free (list);
-	free (res);
-	return NULL;
+	return true;
 }
 
 R_API RList *r_meta_find_list_in(RAnal *a, ut64 at, int type, int where) {
-	char *res = meta_inrange_get (a, at, 1);
-	if (!res) {
+	if (!a->meta) {
 		return NULL;
 	}
-	RList *list = r_str_split_list (res, ",", 0);
 	RList *out = r_list_newf (r_meta_item_free);
-	if (!out) {
-		return NULL;
+	if (out) {
+		meta_tree_foreach_in (a->meta, type, at, at, true, meta_find_list_in_cb, out);
 	}
-	RListIter *iter;
-	const char *meta;
-	r_list_foreach (list, iter, meta) {
-		Sdb *s = a->sdb_meta;
-		ut64 mia = r_num_math (NULL, meta);
-		const char *key = sdb_fmt ("meta.0x%" PFMT64x, mia);
-		const char *infos = sdb_const_get (s, key, 0);
-		if (!infos) {
-			continue;
-		}
-		for (; *infos; infos++) {
-			if (*infos == ',') {
-				continue;
-			}
-			const char *key = sdb_fmt ("meta.%c.0x%" PFMT64x, *infos, mia);
-			const char *metas = sdb_const_get (s, key, 0);
-			if (metas) {
-				RAnalMetaItem *mi = R_NEW0 (RAnalMetaItem);
-				if (mi) {
-					if (r_meta_deserialize_val (a, mi, *infos, mia, metas) &&
-						(at >= mi->from && at < mi->to)) {
-						r_list_append (out, mi);
-					} else {
-						r_meta_item_free (mi);
-					}
-				}
-			}
-		}
-	}
-	r_list_free (list);
-	free (res);
 	return out;
 }
 
@@ -922,18 +941,24 @@ static int meta_unset_cb(void *user, const char *k, const char *v) {
 	if (!strstr (k, ".0x")) {
 		return 1;
 	}
-	meta_deserialize (ui->anal, &it, k, v);
+	if (!meta_deserialize (ui->anal, &it, k, v)) {
+		return 1;
+	}
 	if (it.space && it.space == ui->user) {
+		char *e_str = it.str? sdb_encode ((const ut8 *)it.str, -1): NULL;
+		free (it.str);
+		it.str = e_str;
 		it.space = NULL;
 		meta_serialize (&it, nk, sizeof (nk), nv, sizeof (nv));
 		sdb_set (DB, nk, nv, 0);
+		meta_tree_sync (a, it.type, it.from);
 	}
+	r_meta_item_fini (&it);
 	return 1;
 }
 
 R_API void r_meta_space_unset_for(RAnal *a, const RSpace *space) {
-	RAnalMetaUserItem ui = { .anal = a, .user = (void *)space };
-	r_meta_list_cb (a, R_META_TYPE_ANY, 0, meta_unset_cb, &ui, UT64_MAX);
+	r_meta_list_cb (a, R_META_TYPE_ANY, 0, meta_unset_cb, (void *)space, UT64_MAX);
 }
 
 typedef struct {
@@ -4,14 +4,6 @@
 #include <r_util.h>
 #include <r_list.h>
 
-#define SDB_VARUSED_FMT "qzdq"
-struct VarUsedType {
-	ut64 fcn_addr;
-	char *type;
-	ut32 scope;
-	st64 delta;
-};
-
 R_API RAnalOp *r_anal_op_new() {
 	RAnalOp *op = R_NEW (RAnalOp);
 	r_anal_op_init (op);
@@ -70,41 +62,16 @@ R_API void r_anal_op_free(void *_op) {
 	free (_op);
 }
 
-R_API RAnalVar *get_link_var(RAnal *anal, ut64 faddr, RAnalVar *var) {
-	const char *var_local = sdb_fmt ("var.0x%"PFMT64x".%d.%d.%s",
-			faddr, 1, var->delta, "reads");
-	const char *xss = sdb_const_get (anal->sdb_fcns, var_local, 0);
-	ut64 addr = r_num_math (NULL, xss);
-	char *inst_key = r_str_newf ("inst.0x%"PFMT64x".lvar", addr);
-	char *var_def = sdb_get (anal->sdb_fcns, inst_key, 0);
-
-	if (!var_def) {
-		free (inst_key);
-		return NULL;
-	}
-	struct VarUsedType vut;
-	RAnalVar *res = NULL;
-	if (sdb_fmt_tobin (var_def, SDB_VARUSED_FMT, &vut) == 4) {
-		res = r_anal_var_get (anal, vut.fcn_addr, vut.type[0], vut.scope, vut.delta);
-		sdb_fmt_free (&vut, SDB_VARUSED_FMT);
-	}
-	free (inst_key);
-	free (var_def);
-	return res;
+static bool used_var_cb(const RAnalVar *var, void *user) {
+	*(const RAnalVar **)user = var;
+	return true;
 }
 
+// the var accessed last by the instruction
 static RAnalVar *get_used_var(RAnal *anal, RAnalOp *op) {
-	char *inst_key = r_str_newf ("inst.0x%"PFMT64x".vars", op->addr);
-	char *var_def = sdb_get (anal->sdb_fcns, inst_key, 0);
-	struct VarUsedType vut;
-	RAnalVar *res = NULL;
-	if (sdb_fmt_tobin (var_def, SDB_VARUSED_FMT, &vut) == 4) {
-		res = r_anal_var_get (anal, vut.fcn_addr, vut.type[0], vut.scope, vut.delta);
-		sdb_fmt_free (&vut, SDB_VARUSED_FMT);
-	}
-	free (inst_key);
-	free (var_def);
-	return res;
+	const RAnalVar *var = NULL;
+	r_anal_var_foreach_at (anal, op->addr, used_var_cb, &var);
+	return var? r_anal_var_get (anal, var->addr, var->kind, var->scope, var->delta): NULL;
 }
 
 static int defaultCycles(RAnalOp *op) {
@@ -133,6 +100,114 @@ static int defaultCycles(RAnalOp *op) {
 	}
 }
 
+// Decode cache
+//
+// Direct mapped by address. A slot is used when the address, the bits and
+// the bytes consumed by the plugin are the same, and it was decoded with at
+// least the requested mask, so patched or remapped code is decoded again.
+// Vars and hints are applied to the copy, they change without the bytes.
+// Flushed when the plugin, cpu, endianness or register profile change (the
+// values point to register items), and on writes, because a few plugins
+// read the memory around the op.
+
+#define OPCACHE_BYTES 32
+
+typedef struct r_anal_op_cache_slot_t {
+	RAnalOp op;
+	RAnalOpMask mask;
+	int bits;
+	int ret;
+	ut8 bytes[OPCACHE_BYTES];
+} RAnalOpCacheSlot;
+
+static void opcache_copy(RAnalOp *dst, RAnalOp *src) {
+	int i;
+	*dst = *src;
+	dst->mnemonic = src->mnemonic? strdup (src->mnemonic): NULL;
+	for (i = 0; i < 3; i++) {
+		dst->src[i] = src->src[i]? r_anal_value_copy (src->src[i]): NULL;
+	}
+	dst->dst = src->dst? r_anal_value_copy (src->dst): NULL;
+	r_strbuf_init (&dst->esil);
+	r_strbuf_copy (&dst->esil, &src->esil);
+	r_strbuf_init (&dst->opex);
+	r_strbuf_copy (&dst->opex, &src->opex);
+}
+
+R_API void r_anal_op_cache_flush(RAnal *anal) {
+	ut32 i;
+	RAnalOpCache *c = &anal->opcache;
+	for (i = 0; i < c->size; i++) {
+		RAnalOpCacheSlot *slot = &c->slots[i];
+		if (slot->op.addr != UT64_MAX) {
+			r_anal_op_fini (&slot->op);
+			r_anal_op_init (&slot->op);
+		}
+	}
+}
+
+// size is rounded up to a power of two, 0 disables the cache
+R_API bool r_anal_op_cache_set_size(RAnal *anal, int size) {
+	ut32 i, n = 0;
+	RAnalOpCache *c = &anal->opcache;
+	if (size > 0) {
+		n = 1;
+		while (n < size && n < 0x100000) {
+			n <<= 1;
+		}
+	}
+	if (n == c->size) {
+		return true;
+	}
+	r_anal_op_cache_flush (anal);
+	R_FREE (c->slots);
+	c->size = 0;
+	if (!n) {
+		return true;
+	}
+	c->slots = R_NEWS0 (RAnalOpCacheSlot, n);
+	if (!c->slots) {
+		return false;
+	}
+	for (i = 0; i < n; i++) {
+		r_anal_op_init (&c->slots[i].op);
+	}
+	c->size = n;
+	return true;
+}
+
+static inline RAnalOpCacheSlot *opcache_slot(RAnal *anal, ut64 addr) {
+	RAnalOpCache *c = &anal->opcache;
+	if (!c->size) {
+		return NULL;
+	}
+	return &c->slots[(addr ^ (addr >> 13)) & (c->size - 1)];
+}
+
+static bool opcache_get(RAnal *anal, RAnalOpCacheSlot *slot, RAnalOp *op, ut64 addr, const ut8 *data, int len, RAnalOpMask mask, int *ret) {
+	if (slot->op.addr != addr || slot->bits != anal->bits || (slot->mask & mask) != mask
+			|| slot->op.size > len || memcmp (slot->bytes, data, slot->op.size)) {
+		return false;
+	}
+	opcache_copy (op, &slot->op);
+	*ret = slot->ret;
+	anal->opcache.hits++;
+	return true;
+}
+
+static void opcache_set(RAnal *anal, RAnalOpCacheSlot *slot, RAnalOp *op, const ut8 *data, int len, RAnalOpMask mask, int ret) {
+	anal->opcache.misses++;
+	if (ret < 1 || op->size < 1 || op->size > R_MIN (len, OPCACHE_BYTES) || op->var || op->switch_op) {
+		return;
+	}
+	r_anal_op_fini (&slot->op);
+	opcache_copy (&slot->op, op);
+	memcpy (slot->bytes, data, op->size);
+	slot->mask = mask;
+	slot->bits = anal->bits;
+	slot->ret = ret;
+}
+
 R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int len, RAnalOpMask mask) {
 	r_anal_op_init (op);
 	r_return_val_if_fail (anal && op && len > 0, -1);
@@ -151,14 +226,20 @@ R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int le
 		if (anal && anal->coreb.archbits) {
 			anal->coreb.archbits (anal->coreb.core, addr);
 		}
-		ret = anal->cur->op (anal, op, addr, data, len, mask);
-		if (ret < 1) {
-			op->type = R_ANAL_OP_TYPE_ILL;
-		}
-		op->addr = addr;
-		/* consider at least 1 byte to be part of the opcode */
-		if (op->nopcode < 1) {
-			op->nopcode = 1;
+		RAnalOpCacheSlot *slot = opcache_slot (anal, addr);
+		if (!slot || !opcache_get (anal, slot, op, addr, data, len, mask, &ret)) {
+			ret = anal->cur->op (anal, op, addr, data, len, mask);
+			if (ret < 1) {
+				op->type = R_ANAL_OP_TYPE_ILL;
+			}
+			op->addr = addr;
+			/* consider at least 1 byte to be part of the opcode */
+			if (op->nopcode < 1) {
+				op->nopcode = 1;
+			}
+			if (slot) {
+				opcache_set (anal, slot, op, data, len, mask, ret);
+			}
 		}
 		if (mask & R_ANAL_OP_MASK_VAL) {
 			//free the previous var in op->var
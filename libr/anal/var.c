@@ -5,7 +5,16 @@
 #include <r_cons.h>
 #include <r_list.h>
 
-#define DB a->sdb_fcns
+// Variables
+//
+// anal->vars maps a function address to the table of its variables, kept in
+// creation order and indexed by kind, scope and delta, plus the addresses of
+// the instructions reading and writing every stack slot. anal->var_refs maps
+// an instruction address to the vars it accesses, so r_anal_op can attach
+// the var used by every instruction with a single lookup.
+//
+// The fcn.0x*.<kind>, var.0x* and inst.0x* keys of sdb_fcns are only used
+// to serialize them, see r_anal_var_save and r_anal_var_load.
 
 struct VarType {
 	bool isarg;
@@ -16,10 +25,203 @@ struct VarType {
 
 #define SDB_VARTYPE_FMT "bzdz"
 
-#define EXISTS(x, ...) snprintf (key, sizeof (key) - 1, x, ## __VA_ARGS__), sdb_exists (DB, key)
-#define SETKEY(x, ...) snprintf (key, sizeof (key) - 1, x, ## __VA_ARGS__);
-#define SETKEY2(x, ...) snprintf (key2, sizeof (key) - 1, x, ## __VA_ARGS__);
-#define SETVAL(x, ...) snprintf (val, sizeof (val) - 1, x, ## __VA_ARGS__);
+typedef struct {
+	RVector reads; // ut64 instruction addresses, in access order
+	RVector writes;
+} VarAccesses;
+
+typedef struct {
+	ut64 addr;
+	RPVector vars; // RAnalVar
+	HtUP *index; // var_key (kind, scope, delta) => RAnalVar
+	HtUP *accesses; // var_key (0, scope, delta) => VarAccesses, shared by all kinds
+} FcnVars;
+
+typedef struct {
+	ut64 fcn;
+	int scope;
+	int delta;
+	char kind;
+} VarRef;
+
+typedef struct {
+	RVector used; // VarRef, the most recently accessed last
+	VarRef link; // local var a register argument is stored to, kind is 0 if none
+} InstVars;
+
+static inline ut64 var_key(char kind, int scope, int delta) {
+	return ((ut64)(ut8)kind << 56) | ((ut64)(scope & 0xffffff) << 32) | (ut32)delta;
+}
+
+static void var_accesses_free(HtUPKv *kv) {
+	VarAccesses *xs = kv->value;
+	r_vector_clear (&xs->reads);
+	r_vector_clear (&xs->writes);
+	free (xs);
+}
+
+static void fcn_vars_free(HtUPKv *kv) {
+	FcnVars *fv = kv->value;
+	ht_up_free (fv->index);
+	ht_up_free (fv->accesses);
+	r_pvector_clear (&fv->vars);
+	free (fv);
+}
+
+static void inst_vars_free(HtUPKv *kv) {
+	InstVars *iv = kv->value;
+	r_vector_clear (&iv->used);
+	free (iv);
+}
+
+static FcnVars *fcn_vars(RAnal *a, ut64 addr, bool create) {
+	FcnVars *fv = a->vars? ht_up_find (a->vars, addr, NULL): NULL;
+	if (fv || !create) {
+		return fv;
+	}
+	if (!a->vars && !(a->vars = ht_up_new (NULL, fcn_vars_free, NULL))) {
+		return NULL;
+	}
+	fv = R_NEW0 (FcnVars);
+	if (!fv) {
+		return NULL;
+	}
+	fv->addr = addr;
+	r_pvector_init (&fv->vars, (RPVectorFree)r_anal_var_free);
+	fv->index = ht_up_new0 ();
+	fv->accesses = ht_up_new (NULL, var_accesses_free, NULL);
+	if (!fv->index || !fv->accesses) {
+		ht_up_free (fv->index);
+		ht_up_free (fv->accesses);
+		free (fv);
+		return NULL;
+	}
+	ht_up_insert (a->vars, addr, fv);
+	return fv;
+}
+
+static InstVars *inst_vars(RAnal *a, ut64 addr, bool create) {
+	InstVars *iv = a->var_refs? ht_up_find (a->var_refs, addr, NULL): NULL;
+	if (iv || !create) {
+		return iv;
+	}
+	if (!a->var_refs && !(a->var_refs = ht_up_new (NULL, inst_vars_free, NULL))) {
+		return NULL;
+	}
+	iv = R_NEW0 (InstVars);
+	if (!iv) {
+		return NULL;
+	}
+	r_vector_init (&iv->used, sizeof (VarRef), NULL, NULL);
+	ht_up_insert (a->var_refs, addr, iv);
+	return iv;
+}
+
+static RAnalVar *fcn_var_get(FcnVars *fv, char kind, int scope, int delta) {
+	return fv? ht_up_find (fv->index, var_key (kind, scope, delta), NULL): NULL;
+}
+
+static RAnalVar *fcn_var_get_byname(FcnVars *fv, int scope, const char *name) {
+	void **it;
+	if (!fv) {
+		return NULL;
+	}
+	r_pvector_foreach (&fv->vars, it) {
+		RAnalVar *v = *it;
+		if (v->scope == scope && !strcmp (v->name, name)) {
+			return v;
+		}
+	}
+	return NULL;
+}
+
+static RAnalVar *var_ref_get(RAnal *a, const VarRef *ref) {
+	return fcn_var_get (fcn_vars (a, ref->fcn, false), ref->kind, ref->scope, ref->delta);
+}
+
+static inline bool var_ref_is(const VarRef *ref, const RAnalVar *v) {
+	return ref->fcn == v->addr && ref->kind == v->kind && ref->scope == v->scope && ref->delta == v->delta;
+}
+
+// drop what the instructions accessing the var keep about it
+static void var_refs_remove(RAnal *a, FcnVars *fv, const RAnalVar *v) {
+	VarAccesses *xs = ht_up_find (fv->accesses, var_key (0, v->scope, v->delta), NULL);
+	if (!xs) {
+		return;
+	}
+	RVector *addrs[2] = { &xs->reads, &xs->writes };
+	size_t i, j;
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < addrs[i]->len; j++) {
+			const ut64 addr = *(ut64 *)r_vector_index_ptr (addrs[i], j);
+			InstVars *iv = inst_vars (a, addr, false);
+			if (!iv) {
+				continue;
+			}
+			size_t k = 0;
+			while (k < iv->used.len) {
+				if (var_ref_is (r_vector_index_ptr (&iv->used, k), v)) {
+					r_vector_remove_at (&iv->used, k, NULL);
+				} else {
+					k++;
+				}
+			}
+			if (var_ref_is (&iv->link, v)) {
+				iv->link.kind = 0;
+			}
+			if (!iv->used.len && !iv->link.kind) {
+				ht_up_delete (a->var_refs, addr);
+			}
+		}
+	}
+}
+
+static RAnalVar *var_dup(const RAnalVar *v) {
+	RAnalVar *av = R_NEW0 (RAnalVar);
+	if (!av) {
+		return NULL;
+	}
+	av->addr = v->addr;
+	av->kind = v->kind;
+	av->scope = v->scope;
+	av->delta = v->delta;
+	av->isarg = v->isarg;
+	av->size = v->size;
+	av->name = strdup (v->name);
+	av->type = strdup (v->type);
+	return av;
+}
+
+static RAnalVar *var_set(RAnal *a, ut64 addr, int scope, int delta, char kind, const char *type, int size, bool isarg, const char *name) {
+	FcnVars *fv = fcn_vars (a, addr, true);
+	if (!fv) {
+		return NULL;
+	}
+	RAnalVar *v = fcn_var_get (fv, kind, scope, delta);
+	if (!v) {
+		v = R_NEW0 (RAnalVar);
+		if (!v) {
+			return NULL;
+		}
+		v->addr = addr;
+		v->kind = kind;
+		v->scope = scope;
+		v->delta = delta;
+		r_pvector_push (&fv->vars, v);
+		ht_up_insert (fv->index, var_key (kind, scope, delta), v);
+	}
+	// name and type may point to the old ones
+	char *n = strdup (name);
+	char *t = strdup (type);
+	free (v->name);
+	free (v->type);
+	v->name = n;
+	v->type = t;
+	v->size = size;
+	v->isarg = isarg;
+	return v;
+}
+
 R_API bool r_anal_var_display(RAnal *anal, int delta, char kind, const char *type) {
 	char *fmt = r_type_format (anal->sdb_types, type);
 	RRegItem *i;
@@ -101,38 +303,12 @@ R_API bool r_anal_var_add(RAnal *a, ut64 addr, int scope, int delta, char kind,
 		eprintf ("Invalid var kind '%c'\n", kind);
 		return false;
 	}
-	const char *var_def = sdb_fmt ("%d,%s,%d,%s", isarg, type, size, name);
-	if (scope > 0) {
-		const char *sign = "";
-		if (delta < 0) {
-			delta = -delta;
-			sign = "_";
-		}
-		/* local variable */
-		const char *fcn_key = sdb_fmt ("fcn.0x%"PFMT64x ".%c", addr, kind);
-		const char *var_key = sdb_fmt ("var.0x%"PFMT64x ".%c.%d.%s%d", addr, kind, scope, sign, delta);
-		const char *name_key = sdb_fmt ("var.0x%"PFMT64x ".%d.%s", addr, scope, name);
-		const char *shortvar = sdb_fmt ("%d.%s%d", scope, sign, delta);
-		sdb_array_add (DB, fcn_key, shortvar, 0);
-		sdb_set (DB, var_key, var_def, 0);
-		if (*sign) {
-			delta = -delta;
-		}
-		char *name_val = r_str_newf ("%c,%d", kind, delta);
-		sdb_set (DB, name_key, name_val, 0);
-		free (name_val);
-	} else {
-		/* global variable */
-		const char *var_global = sdb_fmt ("var.0x%"PFMT64x, addr);
-		const char *var_def = sdb_fmt ("%c.%s,%d,%s", kind, type, size, name);
-		sdb_array_add (DB, var_global, var_def, 0);
-	}
-	return true;
+	return var_set (a, addr, scope, delta, kind, type, size, isarg, name) != NULL;
 }
 
 R_API int r_anal_var_retype(RAnal *a, ut64 addr, int scope, int delta, char kind, const char *type, int size, 
 		bool isarg, const char *name) {
-	if (!a) {
+	if (!a || !name) {
 		return false;
 	}
 	if (kind < 1) {
@@ -167,18 +343,10 @@ R_API int r_anal_var_retype(RAnal *a, ut64 addr, int scope, int delta, char kind
 		eprintf ("Invalid var kind '%c'\n", kind);
 		return false;
 	}
-	const char *var_def = sdb_fmt ("%d,%s,%d,%s", isarg, type, size, name);
+	if (!var_set (a, fcn->addr, scope, delta, kind, type, size, isarg, name)) {
+		return false;
+	}
 	if (scope > 0) {
-		char *sign = delta >= 0 ? "": "_";
-		/* local variable */
-		const char *fcn_key = sdb_fmt ("fcn.0x%"PFMT64x ".%c", fcn->addr, kind);
-		const char *var_key = sdb_fmt ("var.0x%"PFMT64x ".%c.%d.%s%d", fcn->addr, kind, scope, sign, R_ABS(delta));
-		const char *name_key = sdb_fmt ("var.0x%"PFMT64x ".%d.%s", fcn->addr, scope, name);
-		const char *shortvar = sdb_fmt ("%d.%s%d", scope, sign, R_ABS(delta));
-		const char *name_val = sdb_fmt ("%c,%d", kind, delta);
-		sdb_array_add (DB, fcn_key, shortvar, 0);
-		sdb_set (DB, var_key, var_def, 0);
-		sdb_set (DB, name_key, name_val, 0);
 		Sdb *TDB = a->sdb_types;
 		const char *type_kind = sdb_const_get (TDB, type, 0);
 		if (type_kind && r_str_startswith (type_kind, "struct")) {
@@ -198,10 +366,6 @@ R_API int r_anal_var_retype(RAnal *a, ut64 addr, int scope, int delta, char kind
 			}
 			free (type_key);
 		}
-	} else {
-		/* global variable */
-		const char *var_global = sdb_fmt ("var.0x%"PFMT64x, fcn->addr);
-		sdb_array_add (DB, var_global, var_def, 0);
 	}
 	return true;
 }
@@ -224,148 +388,52 @@ R_API int r_anal_var_delete_all(RAnal *a, ut64 addr, const char kind) {
 }
 
 R_API int r_anal_var_delete(RAnal *a, ut64 addr, const char kind, int scope, int delta) {
-	RAnalVar *av = r_anal_var_get (a, addr, kind, scope, delta);
+	FcnVars *fv = fcn_vars (a, addr, false);
+	RAnalVar *av = fcn_var_get (fv, kind, scope, delta);
 	if (!av) {
 		return false;
 	}
-	if (scope > 0) {
-		char *sign = "";
-		if (delta < 0) {
-			delta = -delta;
-			sign = "_";
-		}
-		char *fcn_key = sdb_fmt ("fcn.0x%"PFMT64x ".%c", addr, kind);
-		char *var_key = sdb_fmt ("var.0x%"PFMT64x ".%c.%d.%s%d", addr, kind, scope, sign, delta);
-		char *name_key = sdb_fmt ("var.0x%"PFMT64x ".%d.%s", addr, scope, av->name);
-		char *shortvar = sdb_fmt ("%d.%s%d", scope, sign, delta);
-		sdb_array_remove (DB, fcn_key, shortvar, 0);
-		sdb_unset (DB, var_key, 0);
-		sdb_unset (DB, name_key, 0);
-		if (*sign) {
-			delta = -delta;
-		}
-	} else {
-		const char *var_global = sdb_fmt ("var.0x%"PFMT64x, addr);
-		const char *var_def = sdb_fmt ("%c.%s,%d,%s", kind, av->type, av->size, av->name);
-		sdb_array_remove (DB, var_global, var_def, 0);
-	}
+	ht_up_delete (fv->index, var_key (kind, scope, delta));
+	r_pvector_remove_data (&fv->vars, av);
+	var_refs_remove (a, fv, av);
 	r_anal_var_free (av);
 	r_anal_var_access_clear (a, addr, scope, delta);
 	return true;
 }
 
 R_API bool r_anal_var_delete_byname(RAnal *a, RAnalFunction *fcn, int kind, const char *name) {
-	char *varlist;
+	void **it;
 	if (!a || !fcn) {
 		return false;
 	}
-	varlist = sdb_get (DB, sdb_fmt ("fcn.0x%"PFMT64x ".%c",
-			fcn->addr, kind), 0);
-	if (varlist) {
-		char *next, *ptr = varlist;
-		if (varlist && *varlist) {
-			do {
-				char *word = sdb_anext (ptr, &next);
-				char *sign = strstr (word, "_");
-				const char *vardef = sdb_const_get (DB, sdb_fmt (
-						"var.0x%"PFMT64x ".%c.%s",
-						fcn->addr, kind, word), 0);
-				if (sign) {
-					*sign = '-';
-				}
-				int delta = strlen (word) < 3? -1: atoi (word + 2);
-				if (vardef) {
-					const char *p = strchr (vardef, ',');
-					if (p) {
-						p = strchr (p + 1, ',');
-						if (p) {
-							p = strchr (p + 1, ',');
-							if (p) {
-								if (!strcmp (p + 1, name)) {
-									return r_anal_var_delete (a, fcn->addr,
-										kind, 1, delta);
-								}
-							}
-						}
-					}
-				} else {
-					eprintf ("Inconsistent Sdb storage, Cannot find '%s'\n", word);
-				}
-				ptr = next;
-			} while (next);
+	FcnVars *fv = fcn_vars (a, fcn->addr, false);
+	if (!fv) {
+		return false;
+	}
+	r_pvector_foreach (&fv->vars, it) {
+		RAnalVar *v = *it;
+		if (v->kind == kind && !strcmp (v->name, name)) {
+			return r_anal_var_delete (a, fcn->addr, kind, v->scope, v->delta);
 		}
 	}
-	free (varlist);
 	return false;
 }
 
 R_API RAnalVar *r_anal_var_get_byname(RAnal *a, ut64 addr, const char *name) {
 	if (!a || !name) {
-		// eprintf ("No something\n");
-		return NULL;
-	}
-	char *name_key = sdb_fmt ("var.0x%"PFMT64x ".%d.%s", addr, 1, name);
-	char *name_value = sdb_get (DB, name_key, 0);
-	if (!name_value) {
-		// eprintf ("Can't find key for %s\n", name_key);
 		return NULL;
 	}
-	const char *comma = strchr (name_value, ',');
-	if (comma && *comma) {
-		int delta = r_num_math (NULL, comma + 1);
-		RAnalVar *res = r_anal_var_get (a, addr, *name_value, 1, delta);
-		free (name_value);
-		return res;
-	}
-	free (name_value);
-	return NULL;
+	RAnalVar *v = fcn_var_get_byname (fcn_vars (a, addr, false), 1, name);
+	return v? var_dup (v): NULL;
 }
 
 R_API RAnalVar *r_anal_var_get(RAnal *a, ut64 addr, char kind, int scope, int delta) {
-	struct VarType vt = {
-		0
-	};
-	char *sign = "";
 	RAnalFunction *fcn = r_anal_get_fcn_in (a, addr, 0);
 	if (!fcn) {
 		return NULL;
 	}
-	if (delta < 0) {
-		delta = -delta;
-		sign = "_";
-	}
-	const char *varkey = sdb_fmt ("var.0x%"PFMT64x ".%c.%d.%s%d",
-			fcn->addr, kind, scope, sign, delta);
-	char *vardef = sdb_get (DB, varkey, 0);
-	if (!vardef) {
-		return NULL;
-	}
-	if (*sign) {
-		delta = -delta;
-	}
-	sdb_fmt_init (&vt, SDB_VARTYPE_FMT);
-	sdb_fmt_tobin (vardef, SDB_VARTYPE_FMT, &vt);
-	free (vardef);
-
-	RAnalVar *av = R_NEW0 (RAnalVar);
-	if (!av) {
-		sdb_fmt_free (&vt, SDB_VARTYPE_FMT);
-		return NULL;
-	}
-	av->addr = fcn->addr;
-	av->scope = scope;
-	av->delta = delta;
-	av->isarg = vt.isarg;
-	av->name = vt.name? strdup (vt.name): strdup ("unkown_var");
-	av->size = vt.size;
-	av->type = vt.type? strdup (vt.type): strdup ("unkown_type");
-	av->kind = kind;
-	sdb_fmt_free (&vt, SDB_VARTYPE_FMT);
-	// TODO:
-	// get name from sdb
-	// get size from sdb
-	// get type from sdb
-	return av;
+	RAnalVar *v = fcn_var_get (fcn_vars (a, fcn->addr, false), kind, scope, delta);
+	return v? var_dup (v): NULL;
 }
 
 R_API void r_anal_var_free(RAnalVar *av) {
@@ -395,148 +463,374 @@ R_API ut64 r_anal_var_addr(RAnal *a, RAnalFunction *fcn, const char *name) {
 	return ret;
 }
 
-/* (columns) elements in the array value */
-#define R_ANAL_VAR_SDB_KIND 0 /* char */
-#define R_ANAL_VAR_SDB_TYPE 1 /* string */
-#define R_ANAL_VAR_SDB_SIZE 2 /* number */
-#define R_ANAL_VAR_SDB_NAME 3 /* string */
-
 R_API bool r_anal_var_check_name(const char *name) {
 	return !isdigit (*name) && strcspn (name, "., =/");
 }
 
 // afvn local_48 counter
 R_API int r_anal_var_rename(RAnal *a, ut64 addr, int scope, char kind, const char *old_name, const char *new_name, bool verbose) {
-	char key[128];
-
 	if (!r_anal_var_check_name (new_name)) {
 		return 0;
 	}
-	RAnalVar *v1 = r_anal_var_get_byname (a, addr, new_name);
-	if (v1) {
-		r_anal_var_free (v1);
+	FcnVars *fv = fcn_vars (a, addr, false);
+	if (fcn_var_get_byname (fv, 1, new_name)) {
 		if (verbose) {
 			eprintf ("variable or arg with name `%s` already exist\n", new_name);
 		}
 		return false;
 	}
-	// XXX: This is hardcoded because ->kind seems to be 0
-	scope = 1;
-	// XXX. this is pretty weak, because oldname may not exist  too and error returned.
-	if (scope > 0) { // local
-		const char *sign = "";
-		SETKEY ("var.0x%"PFMT64x ".%d.%s", addr, scope, old_name);
-		char *name_val = sdb_get (DB, key, 0);
-		if (!name_val) {
-			return 0;
-		}
-		char *comma = strchr (name_val, ',');
-		if (comma) {
-			int delta = r_num_math (NULL, comma + 1);
-			sdb_unset (DB, key, 0);
-			SETKEY ("var.0x%"PFMT64x ".%d.%s", addr, scope, new_name);
-			sdb_set (DB, key, name_val, 0);
-			free (name_val);
-			if (delta < 0) {
-				delta = -delta;
-				sign = "_";
-			}
-			SETKEY ("var.0x%"PFMT64x ".%c.%d.%s%d", addr, kind, scope, sign, delta);
-			sdb_array_set (DB, key, R_ANAL_VAR_SDB_NAME, new_name, 0);
-		}
-	} else { // global
-		SETKEY ("var.0x%"PFMT64x, addr);
-		char *stored_name = sdb_array_get (DB, key, R_ANAL_VAR_SDB_NAME, 0);
-		if (!stored_name) {
-			return 0;
-		}
-		if (!old_name) {
-			old_name = stored_name;
-		}
-		if (strcmp (stored_name, old_name)) {
-			return 0;
-		}
-		sdb_unset (DB, key, 0);
-		SETKEY ("var.0x%"PFMT64x, addr);
-		sdb_array_set (DB, key, R_ANAL_VAR_SDB_NAME, new_name, 0);
+	// XXX: scope is hardcoded because ->kind seems to be 0, the var is found by name
+	RAnalVar *v = old_name? fcn_var_get_byname (fv, 1, old_name): NULL;
+	char *name = strdup (new_name);
+	if (!v || !name) {
+		free (name);
+		return 0;
 	}
+	free (v->name);
+	v->name = name;
 	return 1;
 }
 
 // Used for linking reg based arg and local-var like "mov [local_8h], rsi"
 static void r_anal_var_link(RAnal *a, ut64 addr, RAnalVar *var) {
-	const char *inst_key = sdb_fmt ("inst.0x%" PFMT64x ".lvar", addr);
-	const char *var_def = sdb_fmt ("0x%" PFMT64x ",%c,0x%x,0x%x", var->addr,
-		var->kind, var->scope, var->delta);
-	sdb_set (DB, inst_key, var_def, 0);
+	InstVars *iv = inst_vars (a, addr, true);
+	if (iv) {
+		iv->link.fcn = var->addr;
+		iv->link.kind = var->kind;
+		iv->link.scope = var->scope;
+		iv->link.delta = var->delta;
+	}
+}
+
+// accesses are tracked by scope and delta, like the sdb keys were
+static bool var_access_add(FcnVars *fv, int scope, int delta, int xs_type, ut64 xs_addr) {
+	const ut64 key = var_key (0, scope, delta);
+	VarAccesses *xs = ht_up_find (fv->accesses, key, NULL);
+	if (!xs) {
+		xs = R_NEW0 (VarAccesses);
+		if (!xs) {
+			return false;
+		}
+		r_vector_init (&xs->reads, sizeof (ut64), NULL, NULL);
+		r_vector_init (&xs->writes, sizeof (ut64), NULL, NULL);
+		ht_up_insert (fv->accesses, key, xs);
+	}
+	RVector *addrs = xs_type? &xs->writes: &xs->reads;
+	ut64 *x;
+	r_vector_foreach (addrs, x) {
+		if (*x == xs_addr) {
+			return false;
+		}
+	}
+	return r_vector_push (addrs, &xs_addr) != NULL;
 }
 
 // avr
 R_API int r_anal_var_access(RAnal *a, ut64 var_addr, char kind, int scope, int delta, int xs_type, ut64 xs_addr) {
-	const char *var_global;
-	const char *xs_type_str = xs_type? "writes": "reads";
-	// TODO: kind is not used
-	if (scope > 0) { // local
-		const char *var_local = sdb_fmt ("var.0x%"PFMT64x ".%d.%d.%s",
-			var_addr, scope, delta, xs_type_str);
-		const char *inst_key = sdb_fmt ("inst.0x%"PFMT64x ".vars", xs_addr);
-		const char *var_def = sdb_fmt ("0x%"PFMT64x ",%c,0x%x,0x%x", var_addr,
-			kind, scope, delta);
-		sdb_set (DB, inst_key, var_def, 0);
-		return sdb_array_add_num (DB, var_local, xs_addr, 0);
-	}
-	// global
-	sdb_add (DB, sdb_fmt ("var.0x%"PFMT64x, var_addr), "a,", 0);
-	var_global = sdb_fmt ("var.0x%"PFMT64x ".%s", var_addr, xs_type_str);
-	return sdb_array_add_num (DB, var_global, xs_addr, 0);
+	FcnVars *fv = fcn_vars (a, var_addr, true);
+	InstVars *iv = inst_vars (a, xs_addr, true);
+	if (!fv || !iv) {
+		return false;
+	}
+	VarRef *ref;
+	size_t i = 0;
+	r_vector_foreach (&iv->used, ref) {
+		if (ref->fcn == var_addr && ref->kind == kind && ref->scope == scope && ref->delta == delta) {
+			r_vector_remove_at (&iv->used, i, NULL);
+			break;
+		}
+		i++;
+	}
+	VarRef used = { var_addr, scope, delta, kind };
+	r_vector_push (&iv->used, &used);
+	return var_access_add (fv, scope, delta, xs_type, xs_addr);
 }
 
 R_API void r_anal_var_access_clear(RAnal *a, ut64 var_addr, int scope, int delta) {
-	char key[128], key2[128];
-	if (scope > 0) { // local arg or var
-		SETKEY ("var.0x%"PFMT64x ".%d.%d.%s", var_addr, scope, delta, "writes");
-		SETKEY2 ("var.0x%"PFMT64x ".%d.%d.%s", var_addr, scope, delta, "reads");
-	} else { // global
-		SETKEY ("var.0x%"PFMT64x ".%s", var_addr, "writes");
-		SETKEY2 ("var.0x%"PFMT64x ".%s", var_addr, "reads");
+	FcnVars *fv = fcn_vars (a, var_addr, false);
+	if (fv) {
+		ht_up_delete (fv->accesses, var_key (0, scope, delta));
 	}
-	sdb_unset (DB, key, 0);
-	sdb_unset (DB, key2, 0);
 }
 
-R_API int r_anal_fcn_var_del_bydelta(RAnal *a, ut64 fna, const char kind, int scope, ut32 delta) {
-	int idx;
-	char key[128], val[128], *v;
-	SETKEY ("fcn.0x%08"PFMT64x ".%c", fna, kind);
-	v = sdb_itoa (delta, val, 10);
-	idx = sdb_array_indexof (DB, key, v, 0);
-	if (idx != -1) {
-		sdb_array_delete (DB, key, idx, 0);
-		SETKEY ("fcn.0x%08"PFMT64x ".%c.%d", fna, kind, delta);
-		sdb_unset (DB, key, 0);
+// Addresses of the instructions reading (xs_type 0) or writing the var
+R_API RVector *r_anal_var_accesses(RAnal *a, ut64 var_addr, int scope, int delta, int xs_type) {
+	FcnVars *fv = fcn_vars (a, var_addr, false);
+	VarAccesses *xs = fv? ht_up_find (fv->accesses, var_key (0, scope, delta), NULL): NULL;
+	if (!xs) {
+		return NULL;
 	}
-	return false;
+	return xs_type? &xs->writes: &xs->reads;
+}
+
+R_API bool r_anal_var_foreach_at(RAnal *a, ut64 addr, RAnalVarCb cb, void *user) {
+	r_return_val_if_fail (a && cb, false);
+	InstVars *iv = inst_vars (a, addr, false);
+	VarRef *ref;
+	if (!iv) {
+		return true;
+	}
+	r_vector_foreach (&iv->used, ref) {
+		RAnalVar *v = var_ref_get (a, ref);
+		if (v && !cb (v, user)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// The local var the register arg var is stored to at its first read
+R_API RAnalVar *get_link_var(RAnal *anal, ut64 faddr, RAnalVar *var) {
+	RVector *reads = r_anal_var_accesses (anal, faddr, 1, var->delta, 0);
+	if (!reads || r_vector_empty (reads)) {
+		return NULL;
+	}
+	InstVars *iv = inst_vars (anal, *(ut64 *)r_vector_index_ptr (reads, 0), false);
+	if (!iv || !iv->link.kind) {
+		return NULL;
+	}
+	return r_anal_var_get (anal, iv->link.fcn, iv->link.kind, iv->link.scope, iv->link.delta);
+}
+
+R_API int r_anal_fcn_var_del_bydelta(RAnal *a, ut64 fna, const char kind, int scope, ut32 delta) {
+	return r_anal_var_delete (a, fna, kind, scope, (int)delta);
 }
 
 R_API int r_anal_var_count(RAnal *a, RAnalFunction *fcn, int kind, int type) {
 	// type { local: 0, arg: 1 };
-	RList *list = r_anal_var_list (a, fcn, kind);
-	RAnalVar *var;
-	RListIter *iter;
+	FcnVars *fv = fcn? fcn_vars (a, fcn->addr, false): NULL;
+	void **it;
 	int count[2] = {
 		0
 	};
-	r_list_foreach (list, iter, var) {
+	if (!fv) {
+		return 0;
+	}
+	if (kind < 1) {
+		kind = R_ANAL_VAR_KIND_BPV;
+	}
+	r_pvector_foreach (&fv->vars, it) {
+		RAnalVar *var = *it;
+		if (var->kind != kind || var->scope < 1) {
+			continue;
+		}
 		if (kind == R_ANAL_VAR_KIND_REG) {
 			count[1]++;
 			continue;
 		}
 		count[var->isarg]++;
 	}
-	r_list_free (list);
 	return count[type];
 }
 
+R_API void r_anal_var_clear(RAnal *a) {
+	ht_up_free (a->vars);
+	ht_up_free (a->var_refs);
+	a->vars = NULL;
+	a->var_refs = NULL;
+}
+
+typedef struct {
+	Sdb *db;
+	ut64 addr;
+	RStrBuf sb;
+} VarSaveCtx;
+
+static void var_save_addrs(VarSaveCtx *ctx, const char *key, RVector *addrs) {
+	ut64 *x;
+	if (r_vector_empty (addrs)) {
+		return;
+	}
+	r_strbuf_set (&ctx->sb, "");
+	r_vector_foreach (addrs, x) {
+		r_strbuf_appendf (&ctx->sb, "%s0x%"PFMT64x, r_strbuf_length (&ctx->sb)? ",": "", *x);
+	}
+	sdb_set (ctx->db, key, r_strbuf_get (&ctx->sb), 0);
+}
+
+static bool var_save_accesses_cb(void *user, const ut64 key, const void *value) {
+	VarSaveCtx *ctx = user;
+	const VarAccesses *xs = value;
+	const int scope = (key >> 32) & 0xffffff;
+	const int delta = (int)(ut32)key;
+	var_save_addrs (ctx, sdb_fmt ("var.0x%"PFMT64x".%d.%d.reads", ctx->addr, scope, delta), (RVector *)&xs->reads);
+	var_save_addrs (ctx, sdb_fmt ("var.0x%"PFMT64x".%d.%d.writes", ctx->addr, scope, delta), (RVector *)&xs->writes);
+	return true;
+}
+
+static bool var_save_fcn_cb(void *user, const ut64 addr, const void *value) {
+	VarSaveCtx *ctx = user;
+	const FcnVars *fv = value;
+	void **it;
+	r_pvector_foreach (&fv->vars, it) {
+		RAnalVar *v = *it;
+		const char *sign = v->delta < 0? "_": "";
+		sdb_array_append (ctx->db, sdb_fmt ("fcn.0x%"PFMT64x".%c", addr, v->kind),
+			sdb_fmt ("%d.%s%d", v->scope, sign, R_ABS (v->delta)), 0);
+		sdb_set (ctx->db, sdb_fmt ("var.0x%"PFMT64x".%c.%d.%s%d", addr, v->kind, v->scope, sign, R_ABS (v->delta)),
+			sdb_fmt ("%d,%s,%d,%s", v->isarg, v->type, v->size, v->name), 0);
+		sdb_set (ctx->db, sdb_fmt ("var.0x%"PFMT64x".%d.%s", addr, v->scope, v->name),
+			sdb_fmt ("%c,%d", v->kind, v->delta), 0);
+	}
+	ctx->addr = addr;
+	ht_up_foreach (fv->accesses, var_save_accesses_cb, ctx);
+	return true;
+}
+
+static bool var_save_inst_cb(void *user, const ut64 addr, const void *value) {
+	VarSaveCtx *ctx = user;
+	const InstVars *iv = value;
+	VarRef *ref;
+	if (iv->used.len) {
+		// one fcn,kind,scope,delta tuple per var, the last one is what inst.*.vars used to hold
+		r_strbuf_set (&ctx->sb, "");
+		r_vector_foreach (&iv->used, ref) {
+			r_strbuf_appendf (&ctx->sb, "%s0x%"PFMT64x",%c,0x%x,0x%x", r_strbuf_length (&ctx->sb)? ",": "",
+				ref->fcn, ref->kind, ref->scope, ref->delta);
+		}
+		sdb_set (ctx->db, sdb_fmt ("inst.0x%"PFMT64x".vars", addr), r_strbuf_get (&ctx->sb), 0);
+	}
+	if (iv->link.kind) {
+		sdb_set (ctx->db, sdb_fmt ("inst.0x%"PFMT64x".lvar", addr), sdb_fmt ("0x%"PFMT64x",%c,0x%x,0x%x",
+			iv->link.fcn, iv->link.kind, iv->link.scope, iv->link.delta), 0);
+	}
+	return true;
+}
+
+R_API void r_anal_var_save(RAnal *a, Sdb *db) {
+	r_return_if_fail (a && db);
+	VarSaveCtx ctx = { .db = db };
+	r_strbuf_init (&ctx.sb);
+	if (a->vars) {
+		ht_up_foreach (a->vars, var_save_fcn_cb, &ctx);
+	}
+	if (a->var_refs) {
+		ht_up_foreach (a->var_refs, var_save_inst_cb, &ctx);
+	}
+	r_strbuf_fini (&ctx.sb);
+}
+
+static bool var_kind_valid(char kind) {
+	return kind == R_ANAL_VAR_KIND_BPV || kind == R_ANAL_VAR_KIND_SPV || kind == R_ANAL_VAR_KIND_REG;
+}
+
+static void var_load_fcn(RAnal *a, Sdb *db, ut64 addr, char kind, const char *list) {
+	char *words = strdup (list);
+	char *next, *ptr = words;
+	if (!words) {
+		return;
+	}
+	do {
+		char *word = sdb_anext (ptr, &next);
+		const char *vardef = sdb_const_get (db, sdb_fmt ("var.0x%"PFMT64x".%c.%s", addr, kind, word), 0);
+		char *dot = strchr (word, '.');
+		if (vardef && dot) {
+			struct VarType vt = { 0 };
+			int scope = atoi (word);
+			int delta = dot[1] == '_'? -atoi (dot + 2): atoi (dot + 1);
+			sdb_fmt_init (&vt, SDB_VARTYPE_FMT);
+			sdb_fmt_tobin (vardef, SDB_VARTYPE_FMT, &vt);
+			if (vt.name && vt.type) {
+				var_set (a, addr, scope, delta, kind, vt.type, vt.size, vt.isarg, vt.name);
+			}
+			sdb_fmt_free (&vt, SDB_VARTYPE_FMT);
+		}
+		ptr = next;
+	} while (next);
+	free (words);
+}
+
+static void var_load_accesses(FcnVars *fv, int scope, int delta, int xs_type, const char *list) {
+	const char *p = list;
+	while (p && *p) {
+		char *end;
+		ut64 xs_addr = strtoull (p, &end, 0);
+		if (end == p) {
+			break;
+		}
+		var_access_add (fv, scope, delta, xs_type, xs_addr);
+		p = *end == ','? end + 1: NULL;
+	}
+}
+
+static void var_load_inst(RAnal *a, ut64 addr, bool link, const char *defs) {
+	const char *p = defs;
+	while (p && *p) {
+		ut64 fcn;
+		char kind;
+		ut32 scope, delta;
+		int n = 0;
+		if (sscanf (p, "0x%"PFMT64x",%c,0x%x,0x%x%n", &fcn, &kind, &scope, &delta, &n) != 4 || !n) {
+			break;
+		}
+		InstVars *iv = inst_vars (a, addr, true);
+		if (!iv) {
+			break;
+		}
+		VarRef ref = { fcn, (int)scope, (int)delta, kind };
+		if (link) {
+			iv->link = ref;
+		} else {
+			r_vector_push (&iv->used, &ref);
+		}
+		p = p[n] == ','? p + n + 1: NULL;
+	}
+}
+
+typedef struct {
+	RAnal *a;
+	Sdb *db;
+	RList *keys;
+} VarLoadCtx;
+
+static int var_load_cb(void *user, const char *k, const char *v) {
+	VarLoadCtx *ctx = user;
+	ut64 addr;
+	char kind;
+	int scope, delta, n = 0;
+	if (r_str_startswith (k, "fcn.")) {
+		if (sscanf (k, "fcn.0x%"PFMT64x".%c%n", &addr, &kind, &n) == 2 && !k[n] && var_kind_valid (kind)) {
+			var_load_fcn (ctx->a, ctx->db, addr, kind, v);
+			r_list_append (ctx->keys, strdup (k));
+		}
+	} else if (r_str_startswith (k, "var.0x")) {
+		if (sscanf (k, "var.0x%"PFMT64x".%d.%d.%n", &addr, &scope, &delta, &n) == 3 && n) {
+			if (!strcmp (k + n, "reads") || !strcmp (k + n, "writes")) {
+				FcnVars *fv = fcn_vars (ctx->a, addr, true);
+				if (fv) {
+					var_load_accesses (fv, scope, delta, k[n] == 'w', v);
+				}
+			}
+		}
+		// vars are loaded from the fcn.* lists, name keys are rebuilt
+		r_list_append (ctx->keys, strdup (k));
+	} else if (r_str_startswith (k, "inst.0x")) {
+		if (sscanf (k, "inst.0x%"PFMT64x".%n", &addr, &n) == 1 && n) {
+			if (!strcmp (k + n, "vars") || !strcmp (k + n, "lvar")) {
+				var_load_inst (ctx->a, addr, k[n] == 'l', v);
+				r_list_append (ctx->keys, strdup (k));
+			}
+		}
+	}
+	return true;
+}
+
+// Import the vars stored in db with r_anal_var_save, removing their keys
+R_API void r_anal_var_load(RAnal *a, Sdb *db) {
+	r_return_if_fail (a && db);
+	VarLoadCtx ctx = { a, db, r_list_newf (free) };
+	RListIter *iter;
+	char *k;
+	if (!ctx.keys) {
+		return;
+	}
+	sdb_foreach (db, var_load_cb, &ctx);
+	r_list_foreach (ctx.keys, iter, k) {
+		sdb_unset (db, k, 0);
+	}
+	r_list_free (ctx.keys);
+}
+
 static void var_add_structure_fields_to_list(RAnal *a, RAnalVar *av, const char *base_name, int delta, RList *list) {
 	/* ATTENTION: av->name might be freed and reassigned */
 	Sdb *TDB = a->sdb_types;
@@ -581,26 +875,14 @@ static void var_add_structure_fields_to_list(RAnal *a, RAnalVar *av, const char
 //Variable recovery functions
 static char *get_varname(RAnal *a, RAnalFunction *fcn, char type, const char *pfx, int idx) {
 	char *varname = r_str_newf ("%s_%xh", pfx, idx);
+	FcnVars *fv = fcn_vars (a, fcn->addr, false);
+	RAnalVar *v;
 	int i = 2;
-	char v_kind = 0;
-	int v_delta = 0;
-	while (1) {
-		char *name_key = sdb_fmt ("var.0x%"PFMT64x ".%d.%s", fcn->addr, 1, varname);
-		char *name_value = sdb_get (a->sdb_fcns, name_key, 0);
-		if (!name_value) {
-			break;
-		}
-		const char *comma = strchr (name_value, ',');
-		if (comma && *comma) {
-			v_delta = r_num_math (NULL, comma + 1);
-			v_kind = *name_value;
-		}
-		if (v_kind == type && R_ABS (v_delta) == idx) {
-			free (name_value);
+	while ((v = fcn_var_get_byname (fv, 1, varname))) {
+		if (v->kind == type && R_ABS (v->delta) == idx) {
 			return varname;
 		}
 		free (varname);
-		free (name_value);
 		varname = r_str_newf ("%s_%xh_%d", pfx, idx, i);
 		i++;
 	}
@@ -818,60 +1100,29 @@ static RList *var_generate_list(RAnal *a, RAnalFunction *fcn, int kind, bool dyn
 		return NULL;
 	}
 	RList *list = r_list_newf ((RListFree) r_anal_var_free);
+	FcnVars *fv = fcn_vars (a, fcn->addr, false);
+	void **it;
+	if (!list || !fv) {
+		return list;
+	}
 	if (kind < 1) {
 		kind = R_ANAL_VAR_KIND_BPV; // by default show vars
 	}
-	char *varlist = sdb_get (DB, sdb_fmt ("fcn.0x%"PFMT64x ".%c", fcn->addr, kind), 0);
-	if (varlist && *varlist) {
-		char *next, *ptr = varlist;
-		do {
-			char *word = sdb_anext (ptr, &next);
-			if (r_str_nlen (word, 3) < 3) {
-				return NULL;
-			}
-			const char *vardef = sdb_const_get (DB, sdb_fmt (
-				"var.0x%"PFMT64x ".%c.%s",
-				fcn->addr, kind, word), 0);
-			if (word[2] == '_') {
-				word[2] = '-';
-			}
-			int delta = atoi (word + 2);
-			if (vardef) {
-				struct VarType vt = { 0 };
-				sdb_fmt_init (&vt, SDB_VARTYPE_FMT);
-				sdb_fmt_tobin (vardef, SDB_VARTYPE_FMT, &vt);
-				RAnalVar *av = R_NEW0 (RAnalVar);
-				if (!av) {
-					free (varlist);
-					r_list_free (list);
-					return NULL;
-				}
-				if (!vt.name || !vt.type) {
-					// This should be properly fixed
-					eprintf ("Warning null var in fcn.0x%"PFMT64x ".%c.%s\n",
-						fcn->addr, kind, word);
-					free (av);
-					continue;
-				}
-				av->addr = fcn->addr;
-				av->delta = delta;
-				av->kind = kind;
-				av->name = strdup (vt.name);
-				av->isarg = vt.isarg;
-				av->size = vt.size;
-				av->type = strdup (vt.type);
-				r_list_append (list, av);
-				if (dynamicVars) { // make dynamic variables like structure fields
-					var_add_structure_fields_to_list (a, av, vt.name, delta, list);
-				}
-				sdb_fmt_free (&vt, SDB_VARTYPE_FMT);
-			} else {
-				eprintf ("Cannot find var definition for '%s'\n", word);
-			}
-			ptr = next;
-		} while (next);
+	r_pvector_foreach (&fv->vars, it) {
+		RAnalVar *v = *it;
+		if (v->kind != kind || v->scope < 1) {
+			continue;
+		}
+		RAnalVar *av = var_dup (v);
+		if (!av) {
+			r_list_free (list);
+			return NULL;
+		}
+		r_list_append (list, av);
+		if (dynamicVars) { // make dynamic variables like structure fields
+			var_add_structure_fields_to_list (a, av, v->name, v->delta, list);
+		}
 	}
-	free (varlist);
 	return list;
 }
 
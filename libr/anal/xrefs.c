@@ -24,6 +24,31 @@ xrefs
 // XXX: is it possible to have multiple type for the same (from, to) pair?
 //      if it is, things need to be adjusted
 
+// Refs are stored once, as (from, to, type) rows sorted by (from, to) in
+// RAnalXrefs.{from,to,type}, plus RAnalXrefs.rev: row indices sorted by
+// (to, from) to answer xref queries. That's 21 bytes per ref.
+//
+// New refs go to a write buffer (two rbtrees over the same nodes, one per
+// direction) which is merged into the arrays in bulk once it grows past
+// an eighth of the arrays. Deletions of merged refs leave a tombstone that
+// is dropped by the next merge. Queries walk the arrays and the buffer at
+// the same time, so they never need to merge nor allocate.
+
+#define XREFS_DELETED 0xff
+#define XREFS_MIN_MERGE 4096
+
+#define PENDING_FWD(x) container_of ((RBNode*)(x), XrefsPending, fwd)
+#define PENDING_REV(x) container_of ((RBNode*)(x), XrefsPending, rev)
+
+typedef struct xrefs_pending_t {
+	ut64 from;
+	ut64 to;
+	ut8 type;
+	ut32 idx; // row assigned while merging
+	RBNode fwd;
+	RBNode rev;
+} XrefsPending;
+
 static RAnalRef *r_anal_ref_new(ut64 addr, ut64 at, ut64 type) {
 	RAnalRef *ref = R_NEW (RAnalRef);
 	if (ref) {
@@ -42,17 +67,298 @@ R_API RList *r_anal_ref_list_new() {
 	return r_list_newf (r_anal_ref_free);
 }
 
-static void xrefs_ht_free(HtUPKv *kv) {
-	ht_up_free (kv->value);
+static inline int pair_cmp(ut64 a0, ut64 a1, ut64 b0, ut64 b1) {
+	if (a0 != b0) {
+		return a0 < b0 ? -1 : 1;
+	}
+	if (a1 != b1) {
+		return a1 < b1 ? -1 : 1;
+	}
+	return 0;
+}
+
+static int _pending_fwd_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	const XrefsPending *a = incoming;
+	const XrefsPending *b = PENDING_FWD (in_tree);
+	return pair_cmp (a->from, a->to, b->from, b->to);
+}
+
+static int _pending_rev_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	const XrefsPending *a = incoming;
+	const XrefsPending *b = PENDING_REV (in_tree);
+	return pair_cmp (a->to, a->from, b->to, b->from);
+}
+
+static void _pending_free(RBNode *node) {
+	free (PENDING_FWD (node));
+}
+
+static void _pending_nop(RBNode *node) {
+	// nodes are owned by pending_fwd
 }
 
-static void xrefs_ref_free(HtUPKv *kv) {
-	r_anal_ref_free (kv->value);
+// First row whose from is >= from
+static ut32 rows_lower_from(RAnalXrefs *x, ut64 from) {
+	ut32 lo = 0, hi = x->len;
+	while (lo < hi) {
+		ut32 mid = lo + (hi - lo) / 2;
+		if (x->from[mid] < from) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// First position in rev whose to is >= to
+static ut32 rows_lower_to(RAnalXrefs *x, ut64 to) {
+	ut32 lo = 0, hi = x->len;
+	while (lo < hi) {
+		ut32 mid = lo + (hi - lo) / 2;
+		if (x->to[x->rev[mid]] < to) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// Row holding (from, to) or UT32_MAX
+static ut32 rows_find(RAnalXrefs *x, ut64 from, ut64 to) {
+	ut32 lo = 0, hi = x->len;
+	while (lo < hi) {
+		ut32 mid = lo + (hi - lo) / 2;
+		int d = pair_cmp (x->from[mid], x->to[mid], from, to);
+		if (!d) {
+			return mid;
+		}
+		if (d < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return UT32_MAX;
+}
+
+static XrefsPending *pending_find(RAnalXrefs *x, ut64 from, ut64 to) {
+	XrefsPending key = { .from = from, .to = to };
+	RBNode *node = r_rbtree_find (x->pending_fwd, &key, _pending_fwd_cmp, NULL);
+	return node? PENDING_FWD (node): NULL;
+}
+
+static void rows_free(RAnalXrefs *x) {
+	R_FREE (x->from);
+	R_FREE (x->to);
+	R_FREE (x->type);
+	R_FREE (x->rev);
+	x->len = 0;
+	x->deleted = 0;
+}
+
+static void pending_free(RAnalXrefs *x) {
+	r_rbtree_free (x->pending_rev, _pending_nop);
+	r_rbtree_free (x->pending_fwd, _pending_free);
+	x->pending_fwd = NULL;
+	x->pending_rev = NULL;
+	x->npending = 0;
+}
+
+// Merge the write buffer into the arrays and drop the tombstones, in O(n + m)
+static bool xrefs_merge(RAnalXrefs *x) {
+	const ut32 n = x->len - x->deleted + x->npending;
+	ut64 *from = NULL, *to = NULL;
+	ut8 *type = NULL;
+	ut32 *rev = NULL, *remap = NULL;
+	RBIter it;
+	XrefsPending *p;
+	ut32 i, j, k;
+	if (n || x->len) {
+		from = malloc ((n + 1) * sizeof (ut64));
+		to = malloc ((n + 1) * sizeof (ut64));
+		type = malloc (n + 1);
+		rev = malloc ((n + 1) * sizeof (ut32));
+		remap = malloc ((x->len + 1) * sizeof (ut32));
+		if (!from || !to || !type || !rev || !remap) {
+			free (from);
+			free (to);
+			free (type);
+			free (rev);
+			free (remap);
+			return false;
+		}
+	}
+	// rows, sorted by (from, to)
+	i = k = 0;
+	it = r_rbtree_first (x->pending_fwd);
+	for (;;) {
+		p = r_rbtree_iter_has (it)? r_rbtree_iter_get (&it, XrefsPending, fwd): NULL;
+		while (i < x->len && x->type[i] == XREFS_DELETED) {
+			remap[i++] = UT32_MAX;
+		}
+		if (i < x->len && (!p || pair_cmp (x->from[i], x->to[i], p->from, p->to) < 0)) {
+			from[k] = x->from[i];
+			to[k] = x->to[i];
+			type[k] = x->type[i];
+			remap[i++] = k++;
+		} else if (p) {
+			from[k] = p->from;
+			to[k] = p->to;
+			type[k] = p->type;
+			p->idx = k++;
+			r_rbtree_iter_next (&it);
+		} else {
+			break;
+		}
+	}
+	// rev, sorted by (to, from)
+	j = k = 0;
+	it = r_rbtree_first (x->pending_rev);
+	for (;;) {
+		p = r_rbtree_iter_has (it)? r_rbtree_iter_get (&it, XrefsPending, rev): NULL;
+		while (j < x->len && remap[x->rev[j]] == UT32_MAX) {
+			j++;
+		}
+		if (j < x->len) {
+			ut32 r = remap[x->rev[j]];
+			if (!p || pair_cmp (to[r], from[r], p->to, p->from) < 0) {
+				rev[k++] = r;
+				j++;
+				continue;
+			}
+		}
+		if (!p) {
+			break;
+		}
+		rev[k++] = p->idx;
+		r_rbtree_iter_next (&it);
+	}
+	free (remap);
+	rows_free (x);
+	pending_free (x);
+	x->from = from;
+	x->to = to;
+	x->type = type;
+	x->rev = rev;
+	x->len = n;
+	return true;
+}
+
+static void setxref(RAnalXrefs *x, ut64 from, ut64 to, int type) {
+	ut32 row = rows_find (x, from, to);
+	if (row != UT32_MAX) {
+		if (x->type[row] == XREFS_DELETED) {
+			x->deleted--;
+		}
+		x->type[row] = type;
+		return;
+	}
+	XrefsPending *p = pending_find (x, from, to);
+	if (p) {
+		p->type = type;
+		return;
+	}
+	p = R_NEW0 (XrefsPending);
+	if (!p) {
+		return;
+	}
+	p->from = from;
+	p->to = to;
+	p->type = type;
+	r_rbtree_insert (&x->pending_fwd, p, &p->fwd, _pending_fwd_cmp, NULL);
+	r_rbtree_insert (&x->pending_rev, p, &p->rev, _pending_rev_cmp, NULL);
+	x->npending++;
+	if (x->npending > R_MAX (XREFS_MIN_MERGE, x->len / 8)) {
+		xrefs_merge (x);
+	}
+}
+
+static bool delxref(RAnalXrefs *x, ut64 from, ut64 to) {
+	ut32 row = rows_find (x, from, to);
+	if (row != UT32_MAX) {
+		if (x->type[row] == XREFS_DELETED) {
+			return false;
+		}
+		x->type[row] = XREFS_DELETED;
+		x->deleted++;
+		if (x->deleted > R_MAX (XREFS_MIN_MERGE, x->len / 2)) {
+			xrefs_merge (x);
+		}
+		return true;
+	}
+	XrefsPending *p = pending_find (x, from, to);
+	if (!p) {
+		return false;
+	}
+	r_rbtree_delete (&x->pending_rev, p, _pending_rev_cmp, NULL, NULL);
+	r_rbtree_delete (&x->pending_fwd, p, _pending_fwd_cmp, _pending_free, NULL);
+	x->npending--;
+	return true;
+}
+
+// Walk the refs whose key (from, or to when rev is set) equals key, or all
+// of them when key is UT64_MAX, sorted by (key, other end). Both the rows and
+// the write buffer are sorted the same way, so they are merged on the fly.
+static bool xrefs_walk(RAnalXrefs *x, bool rev, ut64 key, RAnalRefCmp cb, void *user) {
+	const bool all = key == UT64_MAX;
+	const ut64 *k0 = rev? x->to: x->from;
+	const ut64 *k1 = rev? x->from: x->to;
+	XrefsPending pkey = { .from = rev? 0: key, .to = rev? key: 0 };
+	RBIter it;
+	ut32 i;
+	if (all) {
+		i = 0;
+		it = r_rbtree_first (rev? x->pending_rev: x->pending_fwd);
+	} else {
+		i = rev? rows_lower_to (x, key): rows_lower_from (x, key);
+		it = rev
+			? r_rbtree_lower_bound_forward (x->pending_rev, &pkey, _pending_rev_cmp, NULL)
+			: r_rbtree_lower_bound_forward (x->pending_fwd, &pkey, _pending_fwd_cmp, NULL);
+	}
+	for (;;) {
+		XrefsPending *p = NULL;
+		RAnalRef ref;
+		ut32 row = UT32_MAX;
+		if (r_rbtree_iter_has (it)) {
+			p = rev? r_rbtree_iter_get (&it, XrefsPending, rev): r_rbtree_iter_get (&it, XrefsPending, fwd);
+			if (!all && (rev? p->to: p->from) != key) {
+				p = NULL;
+			}
+		}
+		if (i < x->len) {
+			row = rev? x->rev[i]: i;
+			if (!all && k0[row] != key) {
+				row = UT32_MAX;
+			}
+		}
+		if (row != UT32_MAX && (!p || pair_cmp (k0[row], k1[row],
+				rev? p->to: p->from, rev? p->from: p->to) < 0)) {
+			i++;
+			if (x->type[row] == XREFS_DELETED) {
+				continue;
+			}
+			ref.at = k0[row];
+			ref.addr = k1[row];
+			ref.type = x->type[row];
+		} else if (p) {
+			r_rbtree_iter_next (&it);
+			ref.at = rev? p->to: p->from;
+			ref.addr = rev? p->from: p->to;
+			ref.type = p->type;
+		} else {
+			break;
+		}
+		if (!cb (&ref, user)) {
+			return false;
+		}
+	}
+	return true;
 }
 
-static bool appendRef(void *u, const ut64 k, const void *v) {
-	RList *list = (RList *)u;
-	RAnalRef *ref = (RAnalRef *)v;
+static bool appendRef(RAnalRef *ref, void *user) {
+	RList *list = (RList *)user;
 	RAnalRef *cloned = r_anal_ref_new (ref->addr, ref->at, ref->type);
 	if (cloned) {
 		r_list_append (list, cloned);
@@ -61,12 +367,6 @@ static bool appendRef(void *u, const ut64 k, const void *v) {
 	return false;
 }
 
-static bool mylistrefs_cb(void *list, const ut64 k, const void *v) {
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach (ht, appendRef, list);
-	return true;
-}
-
 static int ref_cmp(const RAnalRef *a, const RAnalRef *b) {
 	if (a->at < b->at) {
 		return -1;
@@ -87,36 +387,6 @@ static void sortxrefs(RList *list) {
 	r_list_sort (list, (RListComparator)ref_cmp);
 }
 
-static void listxrefs(HtUP *m, ut64 addr, RList *list) {
-	if (addr == UT64_MAX) {
-		ht_up_foreach (m, mylistrefs_cb, list);
-	} else {
-		bool found;
-		HtUP *d = ht_up_find (m, addr, &found);
-		if (!found) {
-			return;
-		}
-
-		ht_up_foreach (d, appendRef, list);
-	}
-}
-
-static void setxref(HtUP *m, ut64 from, ut64 to, int type) {
-	bool found;
-	HtUP *ht = ht_up_find (m, from, &found);
-	if (!found) {
-		ht = ht_up_new (NULL, xrefs_ref_free, NULL);
-		if (!ht) {
-			return;
-		}
-		ht_up_insert (m, from, ht);
-	}
-	RAnalRef *ref = r_anal_ref_new (to, from, type);
-	if (ref) {
-		ht_up_update (ht, to, ref);
-	}
-}
-
 // set a reference from FROM to TO and a cross-reference(xref) from TO to FROM.
 R_API int r_anal_xrefs_set(RAnal *anal, ut64 from, ut64 to, const RAnalRefType type) {
 	if (!anal || from == to) {
@@ -128,8 +398,11 @@ R_API int r_anal_xrefs_set(RAnal *anal, ut64 from, ut64 to, const RAnalRefType t
 	if (!anal->iob.is_valid_offset (anal->iob.io, to, 0)) {
 		return false;
 	}
-	setxref (anal->dict_xrefs, to, from, type);
-	setxref (anal->dict_refs, from, to, type);
+	if ((ut8)type == XREFS_DELETED) {
+		// -1 would be stored as a tombstone
+		return false;
+	}
+	setxref (&anal->xrefs, from, to, type);
 	return true;
 }
 
@@ -137,34 +410,61 @@ R_API int r_anal_xrefs_deln(RAnal *anal, ut64 from, ut64 to, const RAnalRefType
 	if (!anal) {
 		return false;
 	}
-	ht_up_delete (anal->dict_refs, from);
-	ht_up_delete (anal->dict_xrefs, to);
-	return true;
+	return delxref (&anal->xrefs, from, to);
 }
 
 R_API int r_anal_xref_del(RAnal *anal, ut64 from, ut64 to) {
-	bool res = false;
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_NULL);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_CODE);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_CALL);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_DATA);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_STRING);
-	return res;
+	return r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_NULL);
+}
+
+// Delete the refs whose source is in [from, to), returns how many were deleted
+R_API int r_anal_refs_del_range(RAnal *anal, ut64 from, ut64 to) {
+	r_return_val_if_fail (anal, 0);
+	RAnalXrefs *x = &anal->xrefs;
+	ut32 i;
+	int n = 0;
+	if (x->npending && !xrefs_merge (x)) {
+		return 0;
+	}
+	for (i = rows_lower_from (x, from); i < x->len && x->from[i] < to; i++) {
+		if (x->type[i] != XREFS_DELETED) {
+			x->type[i] = XREFS_DELETED;
+			x->deleted++;
+			n++;
+		}
+	}
+	if (x->deleted > R_MAX (XREFS_MIN_MERGE, x->len / 2)) {
+		xrefs_merge (x);
+	}
+	return n;
+}
+
+// Iterate the refs from FROM (every ref when FROM is UT64_MAX) without allocating.
+// ref->at is the source and ref->addr the target. Stops when cb returns false.
+R_API bool r_anal_refs_foreach(RAnal *anal, ut64 from, RAnalRefCmp cb, void *user) {
+	r_return_val_if_fail (anal && cb, false);
+	return xrefs_walk (&anal->xrefs, false, from, cb, user);
+}
+
+// Iterate the xrefs to TO (every xref when TO is UT64_MAX) without allocating.
+// ref->at is the target and ref->addr the source. Stops when cb returns false.
+R_API bool r_anal_xrefs_foreach(RAnal *anal, ut64 to, RAnalRefCmp cb, void *user) {
+	r_return_val_if_fail (anal && cb, false);
+	return xrefs_walk (&anal->xrefs, true, to, cb, user);
 }
 
 R_API int r_anal_xrefs_from(RAnal *anal, RList *list, const char *kind, const RAnalRefType type, ut64 addr) {
-	listxrefs (anal->dict_refs, addr, list);
+	xrefs_walk (&anal->xrefs, false, addr, appendRef, list);
 	sortxrefs (list);
 	return true;
 }
 
-R_API RList *r_anal_xrefs_get(RAnal *anal, ut64 to) {
+static RList *xrefs_get(RAnal *anal, bool rev, ut64 addr) {
 	RList *list = r_anal_ref_list_new ();
 	if (!list) {
 		return NULL;
 	}
-	listxrefs (anal->dict_xrefs, to, list);
-	sortxrefs (list);
+	xrefs_walk (&anal->xrefs, rev, addr, appendRef, list);
 	if (r_list_empty (list)) {
 		r_list_free (list);
 		list = NULL;
@@ -172,32 +472,16 @@ R_API RList *r_anal_xrefs_get(RAnal *anal, ut64 to) {
 	return list;
 }
 
+R_API RList *r_anal_xrefs_get(RAnal *anal, ut64 to) {
+	return xrefs_get (anal, true, to);
+}
+
 R_API RList *r_anal_refs_get(RAnal *anal, ut64 from) {
-	RList *list = r_anal_ref_list_new ();
-	if (!list) {
-		return NULL;
-	}
-	listxrefs (anal->dict_refs, from, list);
-	sortxrefs (list);
-	if (r_list_empty (list)) {
-		r_list_free (list);
-		list = NULL;
-	}
-	return list;
+	return xrefs_get (anal, false, from);
 }
 
 R_API RList *r_anal_xrefs_get_from(RAnal *anal, ut64 to) {
-	RList *list = r_anal_ref_list_new ();
-	if (!list) {
-		return NULL;
-	}
-	listxrefs (anal->dict_refs, to, list);
-	sortxrefs (list);
-	if (r_list_empty (list)) {
-		r_list_free (list);
-		list = NULL;
-	}
-	return list;
+	return xrefs_get (anal, false, to);
 }
 
 R_API void r_anal_xrefs_list(RAnal *anal, int rad) {
@@ -205,8 +489,7 @@ R_API void r_anal_xrefs_list(RAnal *anal, int rad) {
 	RAnalRef *ref;
 	PJ *pj = NULL;
 	RList *list = r_anal_ref_list_new();
-	listxrefs (anal->dict_refs, UT64_MAX, list);
-	sortxrefs (list);
+	xrefs_walk (&anal->xrefs, false, UT64_MAX, appendRef, list);
 	if (rad == 'j') {
 		pj = pj_new ();
 		if (!pj) {
@@ -307,32 +590,21 @@ R_API RAnalRefType r_anal_xrefs_type(char ch) {
 }
 
 R_API bool r_anal_xrefs_init(RAnal *anal) {
-	ht_up_free (anal->dict_refs);
-	anal->dict_refs = NULL;
-	ht_up_free (anal->dict_xrefs);
-	anal->dict_xrefs = NULL;
-
-	HtUP *tmp = ht_up_new (NULL, xrefs_ht_free, NULL);
-	if (!tmp) {
-		return false;
-	}
-	anal->dict_refs = tmp;
-
-	tmp = ht_up_new (NULL, xrefs_ht_free, NULL);
-	if (!tmp) {
-		ht_up_free (anal->dict_refs);
-		anal->dict_refs = NULL;
-		return false;
-	}
-	anal->dict_xrefs = tmp;
+	r_anal_xrefs_fini (anal);
 	return true;
 }
 
+R_API void r_anal_xrefs_fini(RAnal *anal) {
+	rows_free (&anal->xrefs);
+	pending_free (&anal->xrefs);
+}
+
 R_API int r_anal_xrefs_count(RAnal *anal) {
-	return anal->dict_xrefs->count;
+	RAnalXrefs *x = &anal->xrefs;
+	return x->len - x->deleted + x->npending;
 }
 
-static RList *fcn_get_refs(RAnalFunction *fcn, HtUP *ht) {
+static RList *fcn_get_refs(RAnalFunction *fcn, RAnalXrefs *x, bool rev) {
 	RListIter *iter;
 	RAnalBlock *bb;
 	RList *list = r_anal_ref_list_new ();
@@ -345,7 +617,7 @@ static RList *fcn_get_refs(RAnalFunction *fcn, HtUP *ht) {
 
 		for (i = 0; i < bb->ninstr; ++i) {
 			ut64 at = bb->addr + r_anal_bb_offset_inst (bb, i);
-			listxrefs (ht, at, list);
+			xrefs_walk (x, rev, at, appendRef, list);
 		}
 	}
 	sortxrefs (list);
@@ -354,11 +626,11 @@ static RList *fcn_get_refs(RAnalFunction *fcn, HtUP *ht) {
 
 R_API RList *r_anal_fcn_get_refs(RAnal *anal, RAnalFunction *fcn) {
 	r_return_val_if_fail (anal && fcn, NULL);
-	return fcn_get_refs (fcn, anal->dict_refs);
+	return fcn_get_refs (fcn, &anal->xrefs, false);
 }
 
 R_API RList *r_anal_fcn_get_xrefs(RAnal *anal, RAnalFunction *fcn) {
-	return fcn_get_refs (fcn, anal->dict_xrefs);
+	return fcn_get_refs (fcn, &anal->xrefs, true);
 }
 
 R_API const char *r_anal_ref_type_tostring(RAnalRefType t) {
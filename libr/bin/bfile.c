@@ -108,45 +108,148 @@ static void print_string(RBinFile *bf, RBinString *string, int raw) {
 	}
 }
 
-static int string_scan_range(RList *list, RBinFile *bf, int min,
-			      const ut64 from, const ut64 to, int type, int raw, RBinSection *section) {
-	RBin *bin = bf->rbin;
-	ut8 tmp[R_STRING_SCAN_BUFFER_SIZE];
-	ut64 str_start, needle = from;
-	int count = 0, i, rc, runes;
-	int str_type = R_STRING_TYPE_DETECT;
-
-	// if list is null it means its gonna dump
-	r_return_val_if_fail (bf, -1);
+// Parallel string scan
+//
+// The range is split in one chunk per thread. The scan is a state machine
+// over (needle, ascii_only), so a worker starting at the beginning of its
+// chunk with ascii_only unset may not follow the same path as the serial
+// scan, which enters the chunk wherever the previous string ended. Workers
+// record in a bitmap which of the first STR_SYNC_WINDOW positions their scan
+// went through with ascii_only unset: once the serial path lands on one of
+// those, both walk the same bytes from there on, so the hits found before it
+// are dropped and the rest are kept. When the paths don't meet in the window
+// the chunk is scanned again from the right place. Hits are emitted in order
+// by the calling thread, which assigns the ordinals and resolves sections, so
+// the result is the same as with a single thread. Only the calling thread
+// polls for breaks, workers just check the stop flag it raises.
+
+#define STR_MIN_CHUNK 0x100000
+#define STR_SYNC_WINDOW 0x10000
+
+#if defined(__GNUC__)
+#define STR_FLAG_GET(x) __atomic_load_n (&(x), __ATOMIC_ACQUIRE)
+#define STR_FLAG_SET(x) __atomic_store_n (&(x), 1, __ATOMIC_RELEASE)
+#else
+#define STR_FLAG_GET(x) (x)
+#define STR_FLAG_SET(x) ((x) = 1)
+#endif
+
+typedef struct {
+	RBinFile *bf;
+	const ut8 *buf;
+	ut64 from;
+	ut64 to;
+	int min;
+	int type;
+	volatile int stop; // set by the calling thread on break
+} RBinStrScan;
+
+typedef struct {
+	ut64 at; // where the scan that found the string started
+	RBinString *bs; // paddr is the file offset, vaddr is not set
+} RBinStrHit;
+
+typedef struct {
+	RBinStrScan *ss;
+	ut64 start;
+	ut64 end; // strings are looked for at [start, end) but can go past it
+	ut64 next; // where the scan goes on after this chunk
+	bool next_ascii_only;
+	bool broken;
+	volatile int done; // the worker is over
+	RVector hits; // RBinStrHit
+	ut8 sync[STR_SYNC_WINDOW / 8];
+} RBinStrChunk;
+
+static void str_hit_fini(void *e, void *user) {
+	RBinStrHit *hit = e;
+	r_bin_string_free (hit->bs);
+}
 
-	if (type == -1) {
-		type = R_STRING_TYPE_DETECT;
+static inline void str_sync(RBinStrChunk *c, ut64 needle) {
+	const ut64 d = needle - c->start;
+	if (d < STR_SYNC_WINDOW) {
+		c->sync[d >> 3] |= 1 << (d & 7);
 	}
-	if (from == to) {
-		return 0;
-	}
-	if (from > to) {
-		eprintf ("Invalid range to find strings 0x%"PFMT64x" .. 0x%"PFMT64x"\n", from, to);
-		return -1;
-	}
-	int len = to - from;
-	ut8 *buf = calloc (len, 1);
-	if (!buf || !min) {
-		free (buf);
-		return -1;
+}
+
+// Step over the bytes which can't start a string when looking for any type:
+// zeros and control codes not followed by a zero (or followed by many), utf8
+// continuation bytes and 0xf8..0xff. Most of the data in binaries is one of
+// those, so this checks 8 bytes at a time when it can.
+static ut64 str_skip(RBinStrChunk *c, ut64 needle, bool *ascii_only) {
+	const RBinStrScan *ss = c->ss;
+	while (needle < c->end) {
+		const ut8 *p = ss->buf + needle - ss->from;
+		const ut64 left = ss->to - needle;
+		if (left >= 12) {
+			const ut64 w = r_read_le64 (p);
+			if ((!w && !r_read_le32 (p + 8))
+			|| (w & 0xc0c0c0c0c0c0c0c0ULL) == 0x8080808080808080ULL
+			|| (w & 0xf8f8f8f8f8f8f8f8ULL) == 0xf8f8f8f8f8f8f8f8ULL) {
+				if (!w) {
+					*ascii_only = false;
+				}
+				if (!*ascii_only) {
+					int j;
+					for (j = 0; j < 8; j++) {
+						str_sync (c, needle + j);
+					}
+				}
+				needle += 8;
+				continue;
+			}
+		}
+		const ut8 b = *p;
+		if ((b & 0xc0) == 0x80 || b >= 0xf8) {
+			// r_utf8_decode returns 0 for those
+		} else if ((b < 0x20 && b != 0x1b && (b < 7 || b > 0xd)) || b == 0x7f) {
+			if (left < 5 || (!p[1] && (p[2] || p[3] || p[4]))) {
+				// may start a wide string
+				break;
+			}
+			*ascii_only = false;
+		} else {
+			break;
+		}
+		if (!*ascii_only) {
+			str_sync (c, needle);
+		}
+		needle++;
 	}
-	st64 vdelta = 0, pdelta = 0;
-	RBinSection *s = NULL;
-	bool ascii_only = false;
-	r_buf_read_at (bf->buf, from, buf, len);
-	// may oobread
-	while (needle < to) {
-		if (bin && bin->consb.is_breaked) {
-			if (bin->consb.is_breaked ()) {
+	return needle;
+}
+
+static bool str_scan(RBinStrChunk *c, ut64 needle, bool ascii_only, bool poll) {
+	RBinStrScan *ss = c->ss;
+	RBin *bin = poll? ss->bf->rbin: NULL;
+	const ut8 *buf = ss->buf;
+	const ut64 from = ss->from, to = ss->to;
+	const int type = ss->type;
+	ut8 tmp[R_STRING_SCAN_BUFFER_SIZE];
+	ut64 str_start;
+	int i, rc, runes;
+	int str_type = R_STRING_TYPE_DETECT;
+
+	while (needle < c->end) {
+		if (bin && bin->consb.is_breaked && bin->consb.is_breaked ()) {
+			STR_FLAG_SET (ss->stop);
+		}
+		if (STR_FLAG_GET (ss->stop)) {
+			c->broken = true;
+			break;
+		}
+		if (type == R_STRING_TYPE_DETECT) {
+			needle = str_skip (c, needle, &ascii_only);
+			if (needle >= c->end) {
 				break;
 			}
 		}
-		rc = r_utf8_decode (buf + needle - from, to - needle, NULL);
+		if (!ascii_only) {
+			str_sync (c, needle);
+		}
+		// decoders never look further than 4 bytes
+		rc = r_utf8_decode (buf + needle - from, R_MIN (to - needle, 8), NULL);
 		if (!rc) {
 			needle++;
 			continue;
@@ -173,19 +276,20 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 		/* Eat a whole C string */
 		for (i = 0; i < sizeof (tmp) - 4 && needle < to; i += rc) {
 			RRune r = {0};
+			const int left = R_MIN (to - needle, 8);
 
 			if (str_type == R_STRING_TYPE_WIDE32) {
-				rc = r_utf32le_decode (buf + needle - from, to - needle, &r);
+				rc = r_utf32le_decode (buf + needle - from, left, &r);
 				if (rc) {
 					rc = 4;
 				}
 			} else if (str_type == R_STRING_TYPE_WIDE) {
-				rc = r_utf16le_decode (buf + needle - from, to - needle, &r);
+				rc = r_utf16le_decode (buf + needle - from, left, &r);
 				if (rc == 1) {
 					rc = 2;
 				}
 			} else {
-				rc = r_utf8_decode (buf + needle - from, to - needle, &r);
+				rc = r_utf8_decode (buf + needle - from, left, &r);
 				if (rc > 1) {
 					str_type = R_STRING_TYPE_UTF8;
 				}
@@ -229,24 +333,14 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 
 		tmp[i++] = '\0';
 
-		if (runes < min && runes >= 2 && str_type == R_STRING_TYPE_ASCII && needle < to) {
+		if (runes < ss->min && runes >= 2 && str_type == R_STRING_TYPE_ASCII && needle < to) {
 			// back up past the \0 to the last char just in case it starts a wide string
 			needle -= 2;
 		}
-		if (runes >= min) {
+		if (runes >= ss->min) {
 			// reduce false positives
 			int j, num_blocks, *block_list;
 			int *freq_list = NULL, expected_ascii, actual_ascii, num_chars;
-			if (str_type == R_STRING_TYPE_ASCII) {
-				for (j = 0; j < i; j++) {
-					char ch = tmp[j];
-					if (ch != '\n' && ch != '\r' && ch != '\t') {
-						if (!IS_PRINTABLE (tmp[j])) {
-							continue;
-						}
-					}
-				}
-			}
 			switch (str_type) {
 			case R_STRING_TYPE_UTF8:
 			case R_STRING_TYPE_WIDE:
@@ -282,14 +376,15 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 					continue;
 				}
 			}
-			RBinString *bs = R_NEW0 (RBinString);
+			RBinStrHit hit = { str_start, R_NEW0 (RBinString) };
+			RBinString *bs = hit.bs;
 			if (!bs) {
+				c->broken = true;
 				break;
 			}
 			bs->type = str_type;
 			bs->length = runes;
 			bs->size = needle - str_start;
-			bs->ordinal = count++;
 			// TODO: move into adjust_offset
 			switch (str_type) {
 			case R_STRING_TYPE_WIDE:
@@ -309,20 +404,130 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 				}
 				break;
 			}
+			bs->paddr = str_start;
+			bs->string = r_str_ndup ((const char *)tmp, i);
+			if (!r_vector_push (&c->hits, &hit)) {
+				r_bin_string_free (bs);
+				c->broken = true;
+				break;
+			}
+		}
+		ascii_only = false;
+	}
+	c->next = needle;
+	c->next_ascii_only = ascii_only;
+	return !c->broken;
+}
+
+static RThreadFunctionRet str_scan_th(RThread *th) {
+	RBinStrChunk *c = th->user;
+	str_scan (c, c->start, false, false);
+	STR_FLAG_SET (c->done);
+	return R_TH_STOP;
+}
+
+static int string_scan_range(RList *list, RBinFile *bf, int min,
+			      const ut64 from, const ut64 to, int type, int raw, RBinSection *section) {
+	RBin *bin = bf->rbin;
+	int count = 0, i;
+
+	// if list is null it means its gonna dump
+	r_return_val_if_fail (bf, -1);
+
+	if (type == -1) {
+		type = R_STRING_TYPE_DETECT;
+	}
+	if (from == to) {
+		return 0;
+	}
+	if (from > to) {
+		eprintf ("Invalid range to find strings 0x%"PFMT64x" .. 0x%"PFMT64x"\n", from, to);
+		return -1;
+	}
+	if (!min) {
+		return -1;
+	}
+	const ut64 len = to - from;
+	ut8 *copy = NULL;
+	const ut8 *buf = r_buf_borrow_at (bf->buf, from, len);
+	if (!buf) {
+		copy = calloc (len, 1);
+		if (!copy) {
+			return -1;
+		}
+		r_buf_read_at (bf->buf, from, copy, len);
+		buf = copy;
+	}
+	int nthreads = bin? bin->strthreads: 1;
+	nthreads = R_MAX (1, R_MIN (nthreads, len / STR_MIN_CHUNK));
+	const ut64 per = (len + nthreads - 1) / nthreads;
+	RBinStrScan ss = { bf, buf, from, to, min, type, 0 };
+	RBinStrChunk *chunks = R_NEWS0 (RBinStrChunk, nthreads);
+	RThread **ths = R_NEWS0 (RThread *, nthreads);
+	if (!chunks || !ths) {
+		free (chunks);
+		free (ths);
+		free (copy);
+		return -1;
+	}
+	for (i = 0; i < nthreads; i++) {
+		RBinStrChunk *c = &chunks[i];
+		c->ss = &ss;
+		c->start = from + i * per;
+		c->end = R_MIN (c->start + per, to);
+		r_vector_init (&c->hits, sizeof (RBinStrHit), str_hit_fini, NULL);
+	}
+	for (i = 1; i < nthreads; i++) {
+		ths[i] = r_th_new (str_scan_th, &chunks[i], 0);
+	}
+
+	st64 vdelta = 0, pdelta = 0;
+	RBinSection *s = NULL;
+	ut64 needle = from;
+	bool ascii_only = false;
+	bool stop = false;
+	for (i = 0; i < nthreads && !stop; i++) {
+		RBinStrChunk *c = &chunks[i];
+		const ut64 d = needle - c->start;
+		if (ths[i]) {
+			// keep polling for breaks while the worker runs
+			while (!STR_FLAG_GET (c->done)) {
+				if (bin && bin->consb.is_breaked && bin->consb.is_breaked ()) {
+					STR_FLAG_SET (ss.stop);
+				}
+				r_sys_usleep (1000);
+			}
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+			ths[i] = NULL;
+		}
+		if (!i || c->broken || ascii_only || d >= STR_SYNC_WINDOW || !(c->sync[d >> 3] & (1 << (d & 7)))) {
+			// not scanned yet, interrupted, or the scans didn't meet in the
+			// sync window: go on from where the serial scan is
+			r_vector_clear (&c->hits);
+			c->broken = false;
+			stop = !str_scan (c, needle, ascii_only, true);
+		}
+		RBinStrHit *hit;
+		r_vector_foreach (&c->hits, hit) {
+			RBinString *bs = hit->bs;
+			if (hit->at < needle) {
+				continue;
+			}
+			hit->bs = NULL;
+			bs->ordinal = count++;
 			if (!s) {
 				if (section) {
 					s = section;
 				} else if (bf->o) {
-					s = r_bin_get_section_at (bf->o, str_start, false);
+					s = r_bin_get_section_at (bf->o, bs->paddr, false);
 				}
 				if (s) {
 					vdelta = s->vaddr;
 					pdelta = s->paddr;
 				}
 			}
-			bs->paddr = str_start;
-			bs->vaddr = str_start - pdelta + vdelta;
-			bs->string = r_str_ndup ((const char *)tmp, i);
+			bs->vaddr = bs->paddr - pdelta + vdelta;
 			if (list) {
 				r_list_append (list, bs);
 				if (bf->o) {
@@ -337,9 +542,21 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 				s = NULL;
 			}
 		}
-		ascii_only = false;
+		needle = c->next;
+		ascii_only = c->next_ascii_only;
+	}
+	STR_FLAG_SET (ss.stop);
+	for (i = 0; i < nthreads; i++) {
+		if (ths[i]) {
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+		}
+		// emitted hits were taken out
+		r_vector_clear (&chunks[i].hits);
 	}
-	free (buf);
+	free (chunks);
+	free (ths);
+	free (copy);
 	return count;
 }
 
@@ -684,6 +901,8 @@ R_API void r_bin_file_free(void /*RBinFile*/ *_bf) {
 		bf->curxtr->free_xtr ((void *)(bf->xtr_obj));
 	}
 	// TODO: unset related sdb namespaces
+	r_bin_dwarf_index_free (bf->dwarf);
+	bf->dwarf = NULL;
 	if (bf->sdb_addrinfo) {
 		sdb_free (bf->sdb_addrinfo);
 		bf->sdb_addrinfo = NULL;
@@ -1021,6 +1240,11 @@ R_API RList *r_bin_file_get_trycatch(RBinFile *bf) {
 
 R_API RList *r_bin_file_get_symbols(RBinFile *bf) {
 	r_return_val_if_fail (bf, NULL);
-	RBinObject *o = bf->o;
-	return o? o->symbols: NULL;
+	return r_bin_object_get_symbols (bf);
+}
+
+// the returned list belongs to the caller
+R_API RList *r_bin_file_get_image_symbols(RBinFile *bf, ut64 vaddr) {
+	r_return_val_if_fail (bf, NULL);
+	return r_bin_object_get_image_symbols (bf, vaddr);
 }
@@ -324,6 +324,22 @@ R_API bool r_bin_open_io(RBin *bin, RBinOptions *opt) {
 	if (!buf) {
 		return false;
 	}
+	// Map plain files, so the parsers can borrow pointers into them instead of
+	// copying every header and symbol table through the io layer. Only when
+	// io reads the same bytes from disk: a plain read-only file descriptor.
+	ut64 iosz = r_buf_size (buf);
+	RIODesc *desc = iob->desc_get (io, opt->fd);
+	bool plain = desc && desc->plugin && desc->plugin->name
+		&& !strcmp (desc->plugin->name, "default") && !(desc->perm & R_PERM_W);
+	if (bin->use_mmap && plain && iosz && iosz != UT64_MAX && fname && r_file_is_regular (fname)) {
+		RBuffer *mbuf = r_buf_new_mmap (fname, R_PERM_R);
+		if (mbuf && r_buf_size (mbuf) == iosz) {
+			r_buf_free (buf);
+			buf = mbuf;
+		} else {
+			r_buf_free (mbuf);
+		}
+	}
 
 	if (!opt->sz) {
 		opt->sz = r_buf_size (buf);
@@ -672,8 +688,8 @@ R_API RList *r_bin_get_fields(RBin *bin) {
 
 R_API RList *r_bin_get_imports(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
-	return o ? o->imports : NULL;
+	RBinFile *bf = r_bin_cur (bin);
+	return bf? r_bin_object_get_imports (bf): NULL;
 }
 
 R_API RBinInfo *r_bin_get_info(RBin *bin) {
@@ -714,8 +730,8 @@ R_API RList *r_bin_patch_relocs_list(RBin *bin) {
 
 R_API RBNode *r_bin_get_relocs(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
-	return o ? o->relocs : NULL;
+	RBinFile *bf = r_bin_cur (bin);
+	return bf? r_bin_object_get_relocs (bf): NULL;
 }
 
 // return a list of <const RBinReloc> that needs to be freed by the caller
@@ -773,16 +789,17 @@ R_API RList *r_bin_reset_strings(RBin *bin) {
 	} else {
 		bf->o->strings = r_bin_file_get_strings (bf, bin->minstrlen, 0, bf->rawstr);
 	}
-	if (bin->debase64) {
+	if (bin->debase64 && bf->o->strings) {
 		r_bin_object_filter_strings (bf->o);
 	}
+	bf->o->loaded |= R_BIN_REQ_STRINGS;
 	return bf->o->strings;
 }
 
 R_API RList *r_bin_get_strings(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
-	return o ? o->strings : NULL;
+	RBinFile *bf = r_bin_cur (bin);
+	return bf? r_bin_object_get_strings (bf): NULL;
 }
 
 R_API int r_bin_is_string(RBin *bin, ut64 va) {
@@ -805,8 +822,20 @@ R_API int r_bin_is_string(RBin *bin, ut64 va) {
 
 R_API RList *r_bin_get_symbols(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
-	return o? o->symbols: NULL;
+	RBinFile *bf = r_bin_cur (bin);
+	return bf? r_bin_object_get_symbols (bf): NULL;
+}
+
+R_API RBinSymbol *r_bin_get_symbol_at(RBin *bin, ut64 vaddr) {
+	r_return_val_if_fail (bin, NULL);
+	RBinFile *bf = r_bin_cur (bin);
+	return bf? r_bin_object_find_symbol (bf, NULL, vaddr): NULL;
+}
+
+R_API RBinSymbol *r_bin_get_symbol_by_name(RBin *bin, const char *name) {
+	r_return_val_if_fail (bin && name, NULL);
+	RBinFile *bf = r_bin_cur (bin);
+	return bf? r_bin_object_find_symbol (bf, name, 0): NULL;
 }
 
 R_API RList *r_bin_get_mem(RBin *bin) {
@@ -849,6 +878,7 @@ R_API RBin *r_bin_new() {
 	bin->minstrlen = 0;
 	bin->strpurge = NULL;
 	bin->want_dbginfo = true;
+	bin->use_mmap = true;
 	bin->cur = NULL;
 	bin->ids = r_id_storage_new (0, ST32_MAX);
 
@@ -1226,6 +1256,10 @@ R_API RBuffer *r_bin_package(RBin *bin, const char *type, const char *file, RLis
 R_API RList * /*<RBinClass>*/ r_bin_get_classes(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
 	RBinObject *o = r_bin_cur_object (bin);
+	if (o) {
+		// some of them are made from the symbols
+		r_bin_object_get_symbols (bin->cur);
+	}
 	return o ? o->classes : NULL;
 }
 
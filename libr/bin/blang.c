@@ -1,6 +1,7 @@
 /* radare2 - LGPL - Copyright 2018-2019 - pancake */
 
 #include <r_bin.h>
+#include "i/private.h"
 
 typedef struct {
 	bool rust;
@@ -88,7 +89,7 @@ R_API int r_bin_load_languages(RBinFile *binfile) {
 	}
 
 	// check in imports . can be slow
-	r_list_foreach (o->imports, iter, sym) {
+	r_list_foreach (r_bin_object_get_imports (binfile), iter, sym) {
 		const char *name = sym->name;
 		if (!strcmp (name, "_NSConcreteGlobalBlock")) {
 			isBlocks = true;
@@ -233,3 +234,52 @@ R_API const char *r_bin_lang_tostring(int lang) {
 	return NULL;
 }
 
+/* Guess the language before the symbols are loaded, from the imports and the
+ * linked libraries only. Unlike r_bin_load_languages, info->lang is left for
+ * the guess made with the symbols once they are there. */
+R_API const char *r_bin_lang_guess(RBinFile *binfile) {
+	r_return_val_if_fail (binfile && binfile->o && binfile->o->info, NULL);
+	RBinObject *o = binfile->o;
+	RBinInfo *info = o->info;
+	RBinImport *imp;
+	RListIter *iter;
+	char *lib;
+	bool isBlocks = false;
+	bool isObjC = false;
+	bool hasCxx = false;
+
+	if (info->lang) {
+		return info->lang;
+	}
+	char *ft = info->rclass? info->rclass: "";
+	if (!strstr (ft, "mach") && !strstr (ft, "elf") && !strstr (ft, "pe")) {
+		return NULL;
+	}
+	r_list_foreach (o->libs, iter, lib) {
+		if (strstr (lib, "swift")) {
+			return r_bin_lang_tostring (R_BIN_NM_SWIFT);
+		}
+		if (strstr (lib, "msvcp")) {
+			return r_bin_lang_tostring (R_BIN_NM_MSVC);
+		}
+		if (strstr (lib, "phobos")) {
+			return r_bin_lang_tostring (R_BIN_NM_DLANG);
+		}
+		if (strstr (lib, "stdc++") || strstr (lib, "c++")) {
+			hasCxx = true;
+		}
+	}
+	r_list_foreach (r_bin_object_get_imports (binfile), iter, imp) {
+		const char *name = imp->name;
+		if (!strcmp (name, "_NSConcreteGlobalBlock")) {
+			isBlocks = true;
+		} else if (!strncmp (name, "objc_", 5)) {
+			isObjC = true;
+		}
+	}
+	const int blocks = isBlocks? R_BIN_NM_BLOCKS: 0;
+	if (isObjC) {
+		return r_bin_lang_tostring (R_BIN_NM_OBJC | blocks);
+	}
+	return r_bin_lang_tostring ((hasCxx? R_BIN_NM_CXX: R_BIN_NM_C) | blocks);
+}
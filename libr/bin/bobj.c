@@ -30,9 +30,18 @@ static void reloc_free(RBNode *rbn) {
 	free (container_of (rbn, RBinReloc, vrb));
 }
 
+static void symbols_index_free(RBinObject *o) {
+	ht_up_free (o->symbols_by_addr);
+	ht_pp_free (o->symbols_by_name);
+	o->symbols_by_addr = NULL;
+	o->symbols_by_name = NULL;
+	o->symbols_indexed = NULL;
+}
+
 static void object_delete_items(RBinObject *o) {
 	ut32 i = 0;
 	r_return_if_fail (o);
+	symbols_index_free (o);
 	sdb_free (o->addr2klassmethod);
 	r_list_free (o->entries);
 	r_list_free (o->fields);
@@ -93,7 +102,7 @@ static char *swiftField(const char *dn, const char *cn) {
 static RList *classes_from_symbols(RBinFile *bf) {
 	RBinSymbol *sym;
 	RListIter *iter;
-	r_list_foreach (bf->o->symbols, iter, sym) {
+	r_list_foreach (r_bin_object_get_symbols (bf), iter, sym) {
 		if (sym->name[0] != '_') {
 			continue;
 		}
@@ -246,14 +255,205 @@ static RBNode *list2rbtree(RList *relocs) {
 	return res;
 }
 
+static void classes_index(RBinFile *bf, RBinObject *o) {
+	RListIter *iter, *iter2;
+	RBinClass *klass;
+	RBinSymbol *method;
+	if (bf->rbin->filter) {
+		filter_classes (bf, o->classes);
+	}
+	// cache addr=class+method
+	sdb_free (o->addr2klassmethod);
+	o->addr2klassmethod = NULL;
+	if (r_list_empty (o->classes)) {
+		return;
+	}
+	// this is slow. must be optimized, but at least its cached
+	o->addr2klassmethod = sdb_new0 ();
+	r_list_foreach (o->classes, iter, klass) {
+		r_list_foreach (klass->methods, iter2, method) {
+			char *km = sdb_fmt ("method.%s.%s", klass->name, method->name);
+			char *at = sdb_fmt ("0x%08"PFMT64x, method->vaddr);
+			sdb_set (o->addr2klassmethod, at, km, 0);
+		}
+	}
+}
+
+#define LAZY_ITEMS (R_BIN_REQ_IMPORTS | R_BIN_REQ_SYMBOLS | R_BIN_REQ_RELOCS | R_BIN_REQ_STRINGS)
+
+// Imports, symbols, relocs and strings can take most of the loading time of
+// big binaries, so r_bin_object_set_items leaves them out and they are built
+// by the plugin the first time they are asked for. The bit is set before
+// calling the plugin, so plugins asking for them while loading don't recurse.
+
+R_IPI RList *r_bin_object_get_imports(RBinFile *bf) {
+	r_return_val_if_fail (bf, NULL);
+	RBinObject *o = bf->o;
+	if (!o || !o->plugin) {
+		return NULL;
+	}
+	if (!(o->loaded & R_BIN_REQ_IMPORTS)) {
+		o->loaded |= R_BIN_REQ_IMPORTS;
+		if (o->plugin->imports) {
+			r_list_free (o->imports);
+			o->imports = o->plugin->imports (bf);
+			if (o->imports) {
+				o->imports->free = r_bin_import_free;
+			}
+		}
+	}
+	return o->imports;
+}
+
+R_IPI RList *r_bin_object_get_symbols(RBinFile *bf) {
+	r_return_val_if_fail (bf, NULL);
+	RBinObject *o = bf->o;
+	if (!o || !o->plugin) {
+		return NULL;
+	}
+	if (!(o->loaded & R_BIN_REQ_SYMBOLS)) {
+		RBin *bin = bf->rbin;
+		o->loaded |= R_BIN_REQ_SYMBOLS;
+		symbols_index_free (o);
+		if (o->plugin->symbols) {
+			o->symbols = o->plugin->symbols (bf); // 5s
+			if (o->symbols) {
+				o->symbols->free = r_bin_symbol_free;
+				REBASE_PADDR (o, o->symbols, RBinSymbol);
+				if (bin->filter) {
+					r_bin_filter_symbols (bf, o->symbols); // 5s
+				}
+			}
+		}
+		// plugins without classes, and swift ones, get them from the symbols
+		if (bin->filter_rules & R_BIN_REQ_CLASSES && (!o->plugin->classes || r_bin_lang_swift (bf))) {
+			if (o->plugin->classes) {
+				o->lang = R_BIN_NM_SWIFT;
+			}
+			classes_from_symbols (bf);
+			classes_index (bf, o);
+		}
+		// the language is guessed from the import and symbol names
+		if (!o->lang && o->info && (bin->filter_rules & (R_BIN_REQ_INFO | R_BIN_REQ_SYMBOLS | R_BIN_REQ_IMPORTS))) {
+			r_bin_object_get_imports (bf);
+			o->lang = r_bin_load_languages (bf);
+			if (!o->info->lang) {
+				o->info->lang = r_bin_lang_tostring (o->lang);
+			}
+		}
+	}
+	return o->symbols;
+}
+
+// Caches holding hundreds of images (dyld, kernelcache) can hand out the
+// symbols of the image at a given address instead. Once the whole list is
+// loaded there is nothing left to hand out.
+R_IPI RList *r_bin_object_get_image_symbols(RBinFile *bf, ut64 vaddr) {
+	r_return_val_if_fail (bf, NULL);
+	RBinObject *o = bf->o;
+	if (!o || !o->plugin || !o->plugin->image_symbols || (o->loaded & R_BIN_REQ_SYMBOLS)) {
+		return NULL;
+	}
+	RList *symbols = o->plugin->image_symbols (bf, vaddr);
+	if (symbols) {
+		symbols->free = r_bin_symbol_free;
+		REBASE_PADDR (o, symbols, RBinSymbol);
+		if (bf->rbin->filter) {
+			r_bin_filter_symbols (bf, symbols);
+		}
+	}
+	return symbols;
+}
+
+R_IPI RBNode *r_bin_object_get_relocs(RBinFile *bf) {
+	r_return_val_if_fail (bf, NULL);
+	RBinObject *o = bf->o;
+	if (!o || !o->plugin) {
+		return NULL;
+	}
+	if (!(o->loaded & R_BIN_REQ_RELOCS)) {
+		o->loaded |= R_BIN_REQ_RELOCS;
+		if (o->plugin->relocs) {
+			RList *l = o->plugin->relocs (bf);
+			if (l) {
+				REBASE_PADDR (o, l, RBinReloc);
+				o->relocs = list2rbtree (l);
+				l->free = NULL;
+				r_list_free (l);
+			}
+		}
+	}
+	return o->relocs;
+}
+
+R_IPI RList *r_bin_object_get_strings(RBinFile *bf) {
+	r_return_val_if_fail (bf, NULL);
+	RBinObject *o = bf->o;
+	if (!o || !o->plugin) {
+		return NULL;
+	}
+	if (!(o->loaded & R_BIN_REQ_STRINGS)) {
+		RBin *bin = bf->rbin;
+		RBinPlugin *p = o->plugin;
+		int minlen = (bin->minstrlen > 0) ? bin->minstrlen : p->minstrlen;
+		o->loaded |= R_BIN_REQ_STRINGS;
+		o->strings = p->strings
+			? p->strings (bf)
+			: r_bin_file_get_strings (bf, minlen, 0, bf->rawstr);
+		if (bin->debase64 && o->strings) {
+			r_bin_object_filter_strings (o);
+		}
+		REBASE_PADDR (o, o->strings, RBinString);
+	}
+	return o->strings;
+}
+
+// Symbol lookups by name or address. The indices grow as they are used: symbols
+// are hashed in list order only until the one asked for is found, so early
+// symbols are cheap and the list is walked at most once. The first symbol
+// with a given name or address wins.
+R_IPI RBinSymbol *r_bin_object_find_symbol(RBinFile *bf, const char *name, ut64 vaddr) {
+	r_return_val_if_fail (bf, NULL);
+	RList *symbols = r_bin_object_get_symbols (bf);
+	RBinObject *o = bf->o;
+	RBinSymbol *sym;
+	RListIter *iter;
+	if (!symbols) {
+		return NULL;
+	}
+	if (!o->symbols_by_addr) {
+		o->symbols_by_addr = ht_up_new0 ();
+		o->symbols_by_name = ht_pp_new0 ();
+		if (!o->symbols_by_addr || !o->symbols_by_name) {
+			symbols_index_free (o);
+			return NULL;
+		}
+	}
+	sym = name? ht_pp_find (o->symbols_by_name, name, NULL): ht_up_find (o->symbols_by_addr, vaddr, NULL);
+	if (sym) {
+		return sym;
+	}
+	iter = o->symbols_indexed? o->symbols_indexed->n: symbols->head;
+	for (; iter; iter = iter->n) {
+		sym = iter->data;
+		o->symbols_indexed = iter;
+		ht_up_insert (o->symbols_by_addr, sym->vaddr, sym);
+		if (sym->name) {
+			ht_pp_insert (o->symbols_by_name, sym->name, sym);
+		}
+		if (name? (sym->name && !strcmp (sym->name, name)): sym->vaddr == vaddr) {
+			return sym;
+		}
+	}
+	return NULL;
+}
+
 R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 	r_return_val_if_fail (bf && o && o->plugin, false);
 
 	int i;
-	bool isSwift = false;
 	RBin *bin = bf->rbin;
 	RBinPlugin *p = o->plugin;
-	int minlen = (bf->rbin->minstrlen > 0) ? bf->rbin->minstrlen : p->minstrlen;
 	bf->o = o;
 
 	if (p->file_type) {
@@ -297,23 +497,10 @@ R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 			REBASE_PADDR (o, o->fields, RBinField);
 		}
 	}
-	if (p->imports) {
-		r_list_free (o->imports);
-		o->imports = p->imports (bf);
-		if (o->imports) {
-			o->imports->free = r_bin_import_free;
-		}
-	}
-	if (p->symbols) {
-		o->symbols = p->symbols (bf); // 5s
-		if (o->symbols) {
-			o->symbols->free = r_bin_symbol_free;
-			REBASE_PADDR (o, o->symbols, RBinSymbol);
-			if (bin->filter) {
-				r_bin_filter_symbols (bf, o->symbols); // 5s
-			}
-		}
-	}
+	// imports, symbols, relocs and strings are built on first use
+	o->loaded &= ~LAZY_ITEMS;
+	o->lang = 0;
+	symbols_index_free (o);
 	o->info = p->info? p->info (bf): NULL;
 	if (p->libs) {
 		o->libs = p->libs (bf);
@@ -328,26 +515,6 @@ R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 			r_bin_filter_sections (bf, o->sections);
 		}
 	}
-	if (bin->filter_rules & (R_BIN_REQ_RELOCS | R_BIN_REQ_IMPORTS)) {
-		if (p->relocs) {
-			RList *l = p->relocs (bf);
-			if (l) {
-				REBASE_PADDR (o, l, RBinReloc);
-				o->relocs = list2rbtree (l);
-				l->free = NULL;
-				r_list_free (l);
-			}
-		}
-	}
-	if (bin->filter_rules & R_BIN_REQ_STRINGS) {
-		o->strings = p->strings
-			? p->strings (bf)
-			: r_bin_file_get_strings (bf, minlen, 0, bf->rawstr);
-		if (bin->debase64) {
-			r_bin_object_filter_strings (o);
-		}
-		REBASE_PADDR (o, o->strings, RBinString);
-	}
 	if (bin->filter_rules & R_BIN_REQ_CLASSES) {
 		if (p->classes) {
 			RList *classes = p->classes (bf);
@@ -356,37 +523,9 @@ R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 				r_list_free (o->classes);
 				o->classes = classes;
 			}
-			isSwift = r_bin_lang_swift (bf);
-			if (isSwift) {
-				o->classes = classes_from_symbols (bf);
-			}
-		} else {
-			RList *classes = classes_from_symbols (bf);
-			if (classes) {
-				o->classes = classes;
-			}
-		}
-		if (bin->filter) {
-			filter_classes (bf, o->classes);
-		}
-		// cache addr=class+method
-		if (o->classes) {
-			RList *klasses = o->classes;
-			RListIter *iter, *iter2;
-			RBinClass *klass;
-			RBinSymbol *method;
-			if (!o->addr2klassmethod) {
-				// this is slow. must be optimized, but at least its cached
-				o->addr2klassmethod = sdb_new0 ();
-				r_list_foreach (klasses, iter, klass) {
-					r_list_foreach (klass->methods, iter2, method) {
-						char *km = sdb_fmt ("method.%s.%s", klass->name, method->name);
-						char *at = sdb_fmt ("0x%08"PFMT64x, method->vaddr);
-						sdb_set (o->addr2klassmethod, at, km, 0);
-					}
-				}
-			}
 		}
+		// the ones made from symbols are added when these are loaded
+		classes_index (bf, o);
 	}
 	if (p->lines) {
 		o->lines = p->lines (bf);
@@ -401,9 +540,6 @@ R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 	if (p->mem)  {
 		o->mem = p->mem (bf);
 	}
-	if (bin->filter_rules & (R_BIN_REQ_INFO | R_BIN_REQ_SYMBOLS | R_BIN_REQ_IMPORTS)) {
-		o->lang = isSwift? R_BIN_NM_SWIFT: r_bin_load_languages (bf);
-	}
 	return true;
 }
 
@@ -411,6 +547,11 @@ R_IPI RBNode *r_bin_object_patch_relocs(RBin *bin, RBinObject *o) {
 	r_return_val_if_fail (bin && o, NULL);
 
 	static bool first = true;
+	RBinFile *bf = r_bin_cur (bin);
+	if (bf && bf->o == o) {
+		// relocs are lazy, load them before patching or falling back
+		r_bin_object_get_relocs (bf);
+	}
 	// r_bin_object_set_items set o->relocs but there we don't have access
 	// to io so we need to be run from bin_relocs, free the previous reloc and get
 	// the patched ones
@@ -423,6 +564,7 @@ R_IPI RBNode *r_bin_object_patch_relocs(RBin *bin, RBinObject *o) {
 		r_rbtree_free (o->relocs, reloc_free);
 		REBASE_PADDR (o, tmp, RBinReloc);
 		o->relocs = list2rbtree (tmp);
+		o->loaded |= R_BIN_REQ_RELOCS;
 		first = false;
 	}
 	return o->relocs;
@@ -15,6 +15,8 @@ R_API int r_bin_addr2line(RBin *bin, ut64 addr, char *file, int len, int *line)
 					bin->cur, addr, file, len, line);
 			}
 		}
+	} else if (binfile && binfile->dwarf) {
+		return r_bin_dwarf_addr2line (binfile, addr, file, len, line);
 	}
 	return false;
 }
@@ -17,6 +17,8 @@
 #include <r_bin_dwarf.h>
 #include <r_core.h>
 
+#define DWARF_LINE_MIN_CHUNK 0x10000
+
 #define STANDARD_OPERAND_COUNT_DWARF2 9
 #define STANDARD_OPERAND_COUNT_DWARF3 12
 #define R_BIN_DWARF_INFO 1
@@ -215,14 +217,14 @@ static void r_bin_dwarf_header_fini(RBinDwarfLNPHeader *hdr) {
 }
 
 static const ut8 *r_bin_dwarf_parse_lnp_header(
-	RBinFile *bf, const ut8 *buf, const ut8 *buf_end,
+	const char *comp_dir, const ut8 *buf, const ut8 *buf_end,
 	RBinDwarfLNPHeader *hdr, FILE *f, int mode) {
 	int i;
 	Sdb *s;
 	size_t count;
 	const ut8 *tmp_buf = NULL;
 
-	if (!hdr || !bf || !buf) {
+	if (!hdr || !buf) {
 		return NULL;
 	}
 
@@ -246,7 +248,9 @@ static const ut8 *r_bin_dwarf_parse_lnp_header(
 		return NULL;
 	}
 	hdr->min_inst_len = READ8 (buf);
-	//hdr->max_ops_per_inst = READ (buf, ut8);
+	if (hdr->version >= 4) {
+		hdr->max_ops_per_inst = READ8 (buf);
+	}
 	hdr->file_names = NULL;
 	hdr->default_is_stmt = READ8 (buf);
 	hdr->line_base = READ (buf, char);
@@ -328,12 +332,11 @@ static const ut8 *r_bin_dwarf_parse_lnp_header(
 			if (buf>=buf_end) { buf = NULL; goto beach; }
 
 			if (i) {
-				char *include_dir = NULL, *comp_dir = NULL, *pinclude_dir = NULL;
+				char *include_dir = NULL, *pinclude_dir = NULL;
 				char *allocated_id = NULL;
 				if (id_idx > 0) {
 					include_dir = pinclude_dir = sdb_array_get (s, "includedirs", id_idx - 1, 0);
 					if (include_dir && include_dir[0] != '/') {
-						comp_dir = sdb_get (bf->sdb_addrinfo, "DW_AT_comp_dir", 0);
 						if (comp_dir) {
 							allocated_id = calloc (1, strlen (comp_dir) +
 									strlen (include_dir) + 8);
@@ -343,7 +346,7 @@ static const ut8 *r_bin_dwarf_parse_lnp_header(
 						}
 					}
 				} else {
-					include_dir = pinclude_dir = sdb_get (bf->sdb_addrinfo, "DW_AT_comp_dir", 0);
+					include_dir = pinclude_dir = comp_dir? strdup (comp_dir): NULL;
 					if (!include_dir) {
 						include_dir = "./";
 					}
@@ -361,7 +364,6 @@ static const ut8 *r_bin_dwarf_parse_lnp_header(
 					hdr->file_names[count].mod_time = mod_time;
 					hdr->file_names[count].file_len = file_len;
 				}
-				free (comp_dir);
 				free (pinclude_dir);
 			}
 			count++;
@@ -390,14 +392,15 @@ beach:
 	return buf;
 }
 
-static inline void add_sdb_addrline(Sdb *s, ut64 addr, const char *file, ut64 line, FILE *f, int mode) {
+static inline bool add_sdb_addrline(Sdb *s, ut64 addr, const char *file, ut64 line, FILE *f, int mode) {
 	const char *p;
 	char *fileline;
 	char offset[64];
 	char *offset_ptr;
+	bool added;
 
 	if (!s || !file) {
-		return;
+		return false;
 	}
 	p = r_str_rchr (file, NULL, '/');
 	if (p) {
@@ -426,32 +429,66 @@ static inline void add_sdb_addrline(Sdb *s, ut64 addr, const char *file, ut64 li
 #endif
 	fileline = r_str_newf ("%s|%"PFMT64d, p, line);
 	offset_ptr = sdb_itoa (addr, offset, 16);
-	sdb_add (s, offset_ptr, fileline, 0);
+	added = sdb_add (s, offset_ptr, fileline, 0);
 	sdb_add (s, fileline, offset_ptr, 0);
 	free (fileline);
+	return added;
+}
+
+// The line programs are decoded into a RBinDwarfLineTable, the full pass
+// replays it into the addrinfo sdb and the indexed reader sorts and keeps it
+typedef struct {
+	RBinDwarfLineTable *lines;
+	ut32 files; // index of the first file name of the current unit
+	ut32 addr_size;
+	// rows for address lookups: end_sequence rows point past the last
+	// instruction and are dropped, and the last row of an address wins
+	bool lookup;
+} DwarfLineSink;
+
+static void dwarf_line_row(DwarfLineSink *sink, const RBinDwarfLNPHeader *hdr, const RBinDwarfSMRegisters *regs, bool end) {
+	const int fnidx = regs->file - 1;
+	if (!hdr->file_names || fnidx < 0 || fnidx >= hdr->file_names_count) {
+		return;
+	}
+	RBinDwarfLineRow row = { regs->address, sink->files + fnidx, regs->line };
+	if (sink->lookup) {
+		RVector *rows = &sink->lines->rows;
+		RBinDwarfLineRow *last = rows->len? r_vector_index_ptr (rows, rows->len - 1): NULL;
+		if (end) {
+			return;
+		}
+		if (last && last->address == row.address) {
+			*last = row;
+			return;
+		}
+	}
+	r_vector_push (&sink->lines->rows, &row);
 }
 
-static const ut8* r_bin_dwarf_parse_ext_opcode(const RBin *a, const ut8 *obuf,
+static const ut8* r_bin_dwarf_parse_ext_opcode(DwarfLineSink *sink, const ut8 *obuf,
 		size_t len, const RBinDwarfLNPHeader *hdr,
 		RBinDwarfSMRegisters *regs, FILE *f, int mode) {
-	// XXX - list is an unused parameter.
 	const ut8 *buf;
 	const ut8 *buf_end;
 	ut8 opcode;
 	ut64 addr;
 	buf = obuf;
-	st64 op_len;
-	RBinFile *binfile = a ? a->cur : NULL;
-	RBinObject *o = binfile ? binfile->o : NULL;
-	ut32 addr_size = o && o->info && o->info->bits ? o->info->bits / 8 : 4;
+	ut64 op_len;
+	ut32 addr_size = sink->addr_size;
 	const char *filename;
 
-	if (!binfile || !obuf || !hdr || !regs) {
+	if (!obuf || !hdr || !regs) {
 		return NULL;
 	}
 
-	buf = r_leb128 (buf, &op_len);
-	buf_end = buf+len;
+	buf_end = obuf + len;
+	buf = r_uleb128 (buf, len, &op_len);
+	if (!buf || buf >= buf_end || op_len < 1 || op_len > buf_end - buf) {
+		return NULL;
+	}
+	// the length covers the opcode, unknown ones are skipped whole
+	const ut8 *op_end = buf + op_len;
 	opcode = *buf++;
 
 	if (f) {
@@ -461,20 +498,16 @@ static const ut8* r_bin_dwarf_parse_ext_opcode(const RBin *a, const ut8 *obuf,
 	switch (opcode) {
 	case DW_LNE_end_sequence:
 		regs->end_sequence = DWARF_TRUE;
-
-		if (binfile && binfile->sdb_addrinfo && hdr->file_names) {
-			int fnidx = regs->file - 1;
-			if (fnidx >= 0 && fnidx < hdr->file_names_count) {
-				add_sdb_addrline(binfile->sdb_addrinfo, regs->address,
-						hdr->file_names[fnidx].name, regs->line, f, mode);
-			}
-		}
+		dwarf_line_row (sink, hdr, regs, true);
 
 		if (f) {
 			fprintf (f, "End of Sequence\n");
 		}
 		break;
 	case DW_LNE_set_address:
+		if (op_len == 5 || op_len == 9) {
+			addr_size = op_len - 1;
+		}
 		if (addr_size == 8) {
 			addr = READ64 (buf);
 		} else {
@@ -513,19 +546,17 @@ static const ut8* r_bin_dwarf_parse_ext_opcode(const RBin *a, const ut8 *obuf,
 		break;
 	}
 
-	return buf;
+	return op_end;
 }
 
 static const ut8* r_bin_dwarf_parse_spec_opcode(
-		const RBin *a, const ut8 *obuf, size_t len,
+		DwarfLineSink *sink, const ut8 *obuf, size_t len,
 		const RBinDwarfLNPHeader *hdr,
 		RBinDwarfSMRegisters *regs,
 		ut8 opcode, FILE *f, int mode) {
-	// XXX - list is not used
 	const ut8 *buf = obuf;
 	ut8 adj_opcode = 0;
 	ut64 advance_adr;
-	RBinFile *binfile = a ? a->cur : NULL;
 
 	if (!obuf || !hdr || !regs) {
 		return NULL;
@@ -536,7 +567,7 @@ static const ut8* r_bin_dwarf_parse_spec_opcode(
 		// line line-range information. move away
 		return NULL;
 	}
-	advance_adr = adj_opcode / hdr->line_range;
+	advance_adr = (adj_opcode / hdr->line_range) * hdr->min_inst_len;
 	regs->address += advance_adr;
 	regs->line += hdr->line_base + (adj_opcode % hdr->line_range);
 	if (f) {
@@ -545,14 +576,7 @@ static const ut8* r_bin_dwarf_parse_spec_opcode(
 			advance_adr, regs->address, hdr->line_base +
 			(adj_opcode % hdr->line_range), regs->line);
 	}
-	if (binfile && binfile->sdb_addrinfo && hdr->file_names) {
-		int idx = regs->file -1;
-		if (idx >= 0 && idx < hdr->file_names_count) {
-			add_sdb_addrline (binfile->sdb_addrinfo, regs->address,
-					hdr->file_names[idx].name,
-					regs->line, f, mode);
-		}
-	}
+	dwarf_line_row (sink, hdr, regs, false);
 	regs->basic_block = DWARF_FALSE;
 	regs->prologue_end = DWARF_FALSE;
 	regs->epilogue_begin = DWARF_FALSE;
@@ -562,7 +586,7 @@ static const ut8* r_bin_dwarf_parse_spec_opcode(
 }
 
 static const ut8* r_bin_dwarf_parse_std_opcode(
-		const RBin *a, const ut8 *obuf, size_t len,
+		DwarfLineSink *sink, const ut8 *obuf, size_t len,
 		const RBinDwarfLNPHeader *hdr, RBinDwarfSMRegisters *regs,
 		ut8 opcode, FILE *f, int mode) {
 	const ut8* buf = obuf;
@@ -572,9 +596,8 @@ static const ut8* r_bin_dwarf_parse_std_opcode(
 	ut8 adj_opcode;
 	ut64 op_advance;
 	ut16 operand;
-	RBinFile *binfile = a ? a->cur : NULL;
 
-	if (!binfile || !hdr || !regs || !obuf) {
+	if (!hdr || !regs || !obuf) {
 		return NULL;
 	}
 	switch (opcode) {
@@ -582,15 +605,7 @@ static const ut8* r_bin_dwarf_parse_std_opcode(
 		if (f) {
 			fprintf (f, "Copy\n");
 		}
-		if (binfile && binfile->sdb_addrinfo && hdr->file_names) {
-			int fnidx = regs->file - 1;
-			if (fnidx >= 0 && fnidx < hdr->file_names_count) {
-				add_sdb_addrline (binfile->sdb_addrinfo,
-					regs->address,
-					hdr->file_names[fnidx].name,
-					regs->line, f, mode);
-			}
-		}
+		dwarf_line_row (sink, hdr, regs, false);
 		regs->basic_block = DWARF_FALSE;
 		break;
 	case DW_LNS_advance_pc:
@@ -602,7 +617,7 @@ static const ut8* r_bin_dwarf_parse_std_opcode(
 		}
 		break;
 	case DW_LNS_advance_line:
-		buf = r_leb128(buf, &sbuf);
+		sbuf = r_sleb128 (&buf, buf_end);
 		regs->line += sbuf;
 		if (f) {
 			fprintf (f, "Advance line by %"PFMT64d", to %"PFMT64d"\n", sbuf, regs->line);
@@ -637,7 +652,7 @@ static const ut8* r_bin_dwarf_parse_std_opcode(
 	case DW_LNS_const_add_pc:
 		adj_opcode = 255 - hdr->opcode_base;
 		if (hdr->line_range > 0) {
-			op_advance = adj_opcode / hdr->line_range;
+			op_advance = (adj_opcode / hdr->line_range) * hdr->min_inst_len;
 		} else {
 			op_advance = 0;
 		}
@@ -682,13 +697,23 @@ static const ut8* r_bin_dwarf_parse_std_opcode(
 	return buf;
 }
 
-static const ut8* r_bin_dwarf_parse_opcodes(const RBin *a, const ut8 *obuf,
+static void r_bin_dwarf_set_regs_default(const RBinDwarfLNPHeader *hdr, RBinDwarfSMRegisters *regs) {
+	regs->address = 0;
+	regs->file = 1;
+	regs->line = 1;
+	regs->column = 0;
+	regs->is_stmt = hdr->default_is_stmt;
+	regs->basic_block = DWARF_FALSE;
+	regs->end_sequence = DWARF_FALSE;
+}
+
+static const ut8* r_bin_dwarf_parse_opcodes(DwarfLineSink *sink, const ut8 *obuf,
 		size_t len, const RBinDwarfLNPHeader *hdr,
 		RBinDwarfSMRegisters *regs, FILE *f, int mode) {
 	const ut8 *buf, *buf_end;
 	ut8 opcode, ext_opcode;
 
-	if (!a || !obuf || len < 8) {
+	if (!obuf || len < 8) {
 		return NULL;
 	}
 	buf = obuf;
@@ -698,72 +723,201 @@ static const ut8* r_bin_dwarf_parse_opcodes(const RBin *a, const ut8 *obuf,
 		opcode = *buf++;
 		len--;
 		if (!opcode) {
-			ext_opcode = *buf;
-			buf = r_bin_dwarf_parse_ext_opcode (a, buf, len, hdr, regs, f, mode);
+			const ut8 *op = r_uleb128 (buf, len, NULL);
+			ext_opcode = (op && op < buf_end)? *op: 0;
+			buf = r_bin_dwarf_parse_ext_opcode (sink, buf, len, hdr, regs, f, mode);
 			if (ext_opcode == DW_LNE_end_sequence) {
-				break;
+				// a unit holds one sequence per contiguous range of code
+				r_bin_dwarf_set_regs_default (hdr, regs);
 			}
 		} else if (opcode >= hdr->opcode_base) {
-			buf = r_bin_dwarf_parse_spec_opcode (a, buf, len, hdr, regs, opcode, f, mode);
+			buf = r_bin_dwarf_parse_spec_opcode (sink, buf, len, hdr, regs, opcode, f, mode);
 		} else {
-			buf = r_bin_dwarf_parse_std_opcode (a, buf, len, hdr, regs, opcode, f, mode);
+			buf = r_bin_dwarf_parse_std_opcode (sink, buf, len, hdr, regs, opcode, f, mode);
 		}
 		len = (int)(buf_end - buf);
 	}
 	return buf;
 }
 
-static void r_bin_dwarf_set_regs_default(const RBinDwarfLNPHeader *hdr, RBinDwarfSMRegisters *regs) {
-	regs->address = 0;
-	regs->file = 1;
-	regs->line = 1;
-	regs->column = 0;
-	regs->is_stmt = hdr->default_is_stmt;
-	regs->basic_block = DWARF_FALSE;
-	regs->end_sequence = DWARF_FALSE;
+static RBinDwarfRow *r_bin_dwarf_row_new(ut64 addr, const char *file, int line, int col) {
+	RBinDwarfRow *row = R_NEW0 (RBinDwarfRow);
+	if (!row) {
+		return NULL;
+	}
+	row->file = strdup (file);
+	row->address = addr;
+	row->line = line;
+	row->column = 0;
+	return row;
 }
 
-R_API int r_bin_dwarf_parse_line_raw2(const RBin *a, const ut8 *obuf,
-				       size_t len, int mode) {
+static void r_bin_dwarf_row_free(void *p) {
+	RBinDwarfRow *row = (RBinDwarfRow*)p;
+	free (row->file);
+	free (row);
+}
+
+static void dwarf_line_table_init(RBinDwarfLineTable *lt) {
+	r_vector_init (&lt->rows, sizeof (RBinDwarfLineRow), NULL, NULL);
+	r_pvector_init (&lt->files, free);
+}
+
+static void dwarf_line_table_fini(RBinDwarfLineTable *lt) {
+	r_vector_clear (&lt->rows);
+	r_pvector_clear (&lt->files);
+}
+
+// Decode the line program at buf into sink->lines, returns where the next one starts
+static const ut8 *dwarf_line_unit(DwarfLineSink *sink, const ut8 *buf, const ut8 *buf_end,
+		const char *comp_dir, FILE *f, int mode) {
 	RBinDwarfLNPHeader hdr = {{0}};
-	const ut8 *buf = NULL, *buf_tmp = NULL, *buf_end = NULL;
 	RBinDwarfSMRegisters regs;
-	int tmplen;
-	FILE *f = NULL;
-	RBinFile *binfile = a ? a->cur : NULL;
+	const ut8 *start = buf, *end;
+	size_t i;
 
-	if (!binfile || !obuf) {
-		return false;
+	buf = r_bin_dwarf_parse_lnp_header (comp_dir, buf, buf_end, &hdr, f, mode);
+	if (!buf || hdr.unit_length.part1 == DWARF_INIT_LEN_64) {
+		r_bin_dwarf_header_fini (&hdr);
+		return NULL;
 	}
-	if (mode == R_MODE_PRINT) {
-		f = stdout;
+	end = start + 4 + hdr.unit_length.part1;
+	if (end > buf_end || end <= start) {
+		end = buf_end;
 	}
-	buf = obuf;
-	buf_end = obuf + len;
-	while (buf + 1 < buf_end) {
-		buf_tmp = buf;
-		buf = r_bin_dwarf_parse_lnp_header (a->cur, buf, buf_end, &hdr, f, mode);
-		if (!buf) {
-			return false;
+	// the program follows the header, whatever the file table parser consumed
+	if (hdr.header_length < end - start - 10) {
+		buf = start + 10 + hdr.header_length;
+	}
+	if (hdr.version < 5) {
+		// the rows index the file names, which now belong to the table
+		sink->files = r_pvector_len (&sink->lines->files);
+		for (i = 0; i < hdr.file_names_count; i++) {
+			r_pvector_push (&sink->lines->files, hdr.file_names[i].name);
+			hdr.file_names[i].name = NULL;
 		}
 		r_bin_dwarf_set_regs_default (&hdr, &regs);
-		tmplen = (int)(buf_end - buf);
-		tmplen = R_MIN (tmplen, 4 + hdr.unit_length.part1);
-		if (tmplen < 1) {
-			r_bin_dwarf_header_fini (&hdr);
-			break;
-		}
-		if (!r_bin_dwarf_parse_opcodes (a, buf, tmplen, &hdr, &regs, f, mode)) {
-			r_bin_dwarf_header_fini (&hdr);
-			break;
+		if (buf < end) {
+			r_bin_dwarf_parse_opcodes (sink, buf, end - buf, &hdr, &regs, f, mode);
 		}
+	}
+	r_bin_dwarf_header_fini (&hdr);
+	return end;
+}
 
-		r_bin_dwarf_header_fini (&hdr);
-		buf = buf_tmp + tmplen;
+static ut32 dwarf_addr_size(RBinFile *bf) {
+	RBinObject *o = bf? bf->o: NULL;
+	return o && o->info && o->info->bits ? o->info->bits / 8 : 4;
+}
+
+// Full pass over .debug_line
+//
+// The section is split at unit boundaries in dbgthreads chunks of about the
+// same size, decoded in parallel into line tables and replayed in order into
+// the addrinfo sdb, so the result and the printed output are the same as a
+// serial decode. Verbose printing (R_MODE_PRINT) is done in a single chunk.
+
+typedef struct {
+	RBinDwarfLineTable lines;
+	const ut8 *from;
+	const ut8 *to;
+	const char *comp_dir;
+	ut32 addr_size;
+	FILE *f;
+	int mode;
+} DwarfLineChunk;
+
+static void dwarf_line_chunk(DwarfLineChunk *c) {
+	DwarfLineSink sink = { &c->lines, 0, c->addr_size, false };
+	const ut8 *buf = c->from;
+	while (buf && buf + 1 < c->to) {
+		buf = dwarf_line_unit (&sink, buf, c->to, c->comp_dir, c->f, c->mode);
 	}
+}
+
+static RThreadFunctionRet dwarf_line_chunk_th(RThread *th) {
+	dwarf_line_chunk (th->user);
+	return R_TH_STOP;
+}
+
+static const ut8 *dwarf_line_next(const ut8 *buf, const ut8 *buf_end) {
+	if (buf + 4 > buf_end) {
+		return buf_end;
+	}
+	ut32 length = r_read_ble32 (buf, 0);
+	if (length == DWARF_INIT_LEN_64 || length > buf_end - buf - 4) {
+		return buf_end;
+	}
+	return buf + 4 + length;
+}
+
+static bool dwarf_parse_lines(RBinFile *bf, const ut8 *obuf, size_t len, int mode, RList *list) {
+	const ut8 *buf = obuf, *buf_end = obuf + len;
+	FILE *f = (mode == R_MODE_PRINT)? stdout: NULL;
+	int i, nthreads = (f || !bf->rbin)? 1: R_MAX (1, bf->rbin->dbgthreads);
+	nthreads = R_MAX (1, R_MIN (nthreads, len / DWARF_LINE_MIN_CHUNK));
+	DwarfLineChunk *chunks = R_NEWS0 (DwarfLineChunk, nthreads);
+	RThread **ths = R_NEWS0 (RThread *, nthreads);
+	char *comp_dir = sdb_get (bf->sdb_addrinfo, "DW_AT_comp_dir", 0);
+	if (!chunks || !ths) {
+		free (chunks);
+		free (ths);
+		free (comp_dir);
+		return false;
+	}
+	for (i = 0; i < nthreads; i++) {
+		DwarfLineChunk *c = &chunks[i];
+		const ut8 *target = obuf + len / nthreads * (i + 1);
+		c->from = buf;
+		while (buf < target && buf < buf_end) {
+			buf = dwarf_line_next (buf, buf_end);
+		}
+		c->to = (i == nthreads - 1)? buf_end: buf;
+		c->comp_dir = comp_dir;
+		c->addr_size = dwarf_addr_size (bf);
+		c->f = f;
+		c->mode = mode;
+		dwarf_line_table_init (&c->lines);
+	}
+	for (i = 1; i < nthreads; i++) {
+		ths[i] = r_th_new (dwarf_line_chunk_th, &chunks[i], 0);
+	}
+	for (i = 0; i < nthreads; i++) {
+		DwarfLineChunk *c = &chunks[i];
+		RBinDwarfLineRow *row;
+		if (ths[i]) {
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+		} else {
+			dwarf_line_chunk (c);
+		}
+		r_vector_foreach (&c->lines.rows, row) {
+			const char *file = r_pvector_at (&c->lines.files, row->file);
+			if (add_sdb_addrline (bf->sdb_addrinfo, row->address, file, row->line, f, mode) && list) {
+				RBinDwarfRow *r = r_bin_dwarf_row_new (row->address, file, row->line, 0);
+				if (r) {
+					r_list_append (list, r);
+				}
+			}
+		}
+		dwarf_line_table_fini (&c->lines);
+	}
+	free (chunks);
+	free (ths);
+	free (comp_dir);
 	return true;
 }
 
+R_API int r_bin_dwarf_parse_line_raw2(const RBin *a, const ut8 *obuf,
+				       size_t len, int mode) {
+	RBinFile *binfile = a ? a->cur : NULL;
+
+	if (!binfile || !obuf) {
+		return false;
+	}
+	return dwarf_parse_lines (binfile, obuf, len, mode, NULL);
+}
+
 #define READ_BUF(x,y) if (idx+sizeof(y)>=len) { return false;} \
 	(x)=*(y*)buf; idx+=sizeof(y);buf+=sizeof(y)
 
@@ -1310,7 +1464,7 @@ static const ut8 *r_bin_dwarf_parse_attr_value(const ut8 *obuf, int obuf_len,
 		value->encoding.flag = READ (buf, ut8);
 		break;
 	case DW_FORM_sdata:
-		buf = r_leb128 (buf, &value->encoding.sdata);
+		value->encoding.sdata = r_sleb128 (&buf, buf_end);
 		break;
 	case DW_FORM_strp:
 		value->encoding.str_struct.offset = READ32 (buf);
@@ -1624,24 +1778,6 @@ R_API int r_bin_dwarf_parse_info(RBinDwarfDebugAbbrev *da, RBin *a, int mode) {
 	return false;
 }
 
-static RBinDwarfRow *r_bin_dwarf_row_new(ut64 addr, const char *file, int line, int col) {
-	RBinDwarfRow *row = R_NEW0 (RBinDwarfRow);
-	if (!row) {
-		return NULL;
-	}
-	row->file = strdup (file);
-	row->address = addr;
-	row->line = line;
-	row->column = 0;
-	return row;
-}
-
-static void r_bin_dwarf_row_free(void *p) {
-	RBinDwarfRow *row = (RBinDwarfRow*)p;
-	free (row->file);
-	free (row);
-}
-
 R_API RList *r_bin_dwarf_parse_line(RBin *a, int mode) {
 	ut8 *buf;
 	RList *list = NULL;
@@ -1662,40 +1798,13 @@ R_API RList *r_bin_dwarf_parse_line(RBin *a, int mode) {
 			free (buf);
 			return NULL;
 		}
-		list = r_list_newf (r_bin_dwarf_row_free); // always return empty list wtf
+		list = r_list_newf (r_bin_dwarf_row_free);
 		if (!list) {
 			free (buf);
 			return NULL;
 		}
-		r_bin_dwarf_parse_line_raw2 (a, buf, len, mode);
-		// k bin/cur/addrinfo/*
-		SdbListIter *iter;
-		SdbKv *kv;
-		SdbList *ls = sdb_foreach_list (binfile->sdb_addrinfo, false);
-		ls_foreach (ls, iter, kv) {
-			if (!strncmp (sdbkv_key (kv), "0x", 2)) {
-				ut64 addr;
-				RBinDwarfRow *row;
-				int line;
-				char *file = strdup (sdbkv_value (kv));
-				if (!file) {
-					free (buf);
-					ls_free (ls);
-					r_list_free (list);
-					return NULL;
-				}
-				char *tok = strchr (file, '|');
-				if (tok) {
-					*tok++ = 0;
-					line = atoi (tok);
-					addr = r_num_math (NULL, sdbkv_key (kv));
-					row = r_bin_dwarf_row_new (addr, file, line, 0);
-					r_list_append (list, row);
-				}
-				free (file);
-			}
-		}
-		ls_free (ls);
+		// the rows new to the addrinfo sdb, in the order of the line programs
+		dwarf_parse_lines (binfile, buf, len, mode, list);
 		free (buf);
 	}
 	return list;
@@ -1748,3 +1857,560 @@ R_API RBinDwarfDebugAbbrev *r_bin_dwarf_parse_abbrev(RBin *a, int mode) {
 	free (buf);
 	return da;
 }
+
+// Indexed reader
+//
+// bf->dwarf answers address to line queries without decoding the whole debug
+// info. It is built from the unit headers of .debug_info and the
+// .debug_aranges tables (or the pc range of every unit root DIE when there are
+// none), which map an address to its compilation unit. The first query in a
+// unit reads its root DIE for DW_AT_stmt_list and DW_AT_comp_dir and decodes
+// only that line program, into a line table sorted by address that answers
+// the following ones.
+
+#define DWARF_ROOT_MAX 0x10000
+
+static bool dwarf_section(RBinFile *bf, const char *name, RBinDwarfSection *ds) {
+	RListIter *iter;
+	RBinSection *section;
+	const ut64 bsize = r_buf_size (bf->buf);
+	if (!bf->o || !bf->o->sections) {
+		return false;
+	}
+	r_list_foreach (bf->o->sections, iter, section) {
+		if (strstr (section->name, name)) {
+			if (section->paddr >= bsize || !section->size) {
+				return false;
+			}
+			ds->paddr = section->paddr;
+			ds->size = R_MIN (section->size, bsize - section->paddr);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Bytes of the file, borrowed when the buffer allows it or copied in *copy
+static const ut8 *dwarf_bytes(RBinFile *bf, ut64 paddr, ut64 size, ut8 **copy) {
+	const ut8 *buf = r_buf_borrow_at (bf->buf, paddr, size);
+	*copy = NULL;
+	if (buf) {
+		return buf;
+	}
+	if (!(*copy = malloc (size))) {
+		return NULL;
+	}
+	if (r_buf_read_at (bf->buf, paddr, *copy, size) != size) {
+		R_FREE (*copy);
+		return NULL;
+	}
+	return *copy;
+}
+
+static ut64 dwarf_read(const ut8 *p, int size, bool be) {
+	switch (size) {
+	case 1: return *p;
+	case 2: return r_read_ble16 (p, be);
+	case 4: return r_read_ble32 (p, be);
+	case 8: return r_read_ble64 (p, be);
+	}
+	return 0;
+}
+
+static void dwarf_unit_fini(void *e, void *user) {
+	RBinDwarfUnit *u = e;
+	free (u->comp_dir);
+	if (u->lines) {
+		dwarf_line_table_fini (u->lines);
+		free (u->lines);
+	}
+}
+
+static int dwarf_arange_cmp(const void *a, const void *b) {
+	const RBinDwarfARange *x = a, *y = b;
+	return (x->addr > y->addr) - (x->addr < y->addr);
+}
+
+static int dwarf_row_cmp(const void *a, const void *b) {
+	const RBinDwarfLineRow *x = a, *y = b;
+	return (x->address > y->address) - (x->address < y->address);
+}
+
+static void dwarf_index_units(RBinFile *bf, RBinDwarfIndex *di) {
+	ut8 h[12];
+	ut64 off = 0;
+	while (off + sizeof (h) < di->info.size) {
+		if (r_buf_read_at (bf->buf, di->info.paddr + off, h, sizeof (h)) != sizeof (h)) {
+			break;
+		}
+		ut64 length = r_read_ble32 (h, di->big_endian), hlen = 4;
+		if (length == DWARF_INIT_LEN_64) {
+			length = r_read_ble64 (h + 4, di->big_endian);
+			hlen = 12;
+		}
+		if (!length || length > di->info.size - off - hlen) {
+			break;
+		}
+		RBinDwarfUnit u = { off, UT64_MAX };
+		if (!r_vector_push (&di->units, &u)) {
+			break;
+		}
+		off += hlen + length;
+	}
+}
+
+static void dwarf_index_aranges(RBinFile *bf, RBinDwarfIndex *di, const RBinDwarfSection *s) {
+	const bool be = di->big_endian;
+	ut8 *copy;
+	const ut8 *buf = dwarf_bytes (bf, s->paddr, s->size, &copy);
+	if (!buf) {
+		return;
+	}
+	const ut8 *p = buf, *end = buf + s->size;
+	while (p + 4 <= end) {
+		const ut8 *set = p;
+		ut64 length = r_read_ble32 (p, be);
+		int osize = 4;
+		p += 4;
+		if (length == DWARF_INIT_LEN_64) {
+			if (p + 8 > end) {
+				break;
+			}
+			length = r_read_ble64 (p, be);
+			osize = 8;
+			p += 8;
+		}
+		if (length > end - p) {
+			break;
+		}
+		const ut8 *next = p + length;
+		if (length < 2 + osize + 2) {
+			p = next;
+			continue;
+		}
+		p += 2; // version
+		const ut64 unit = dwarf_read (p, osize, be);
+		p += osize;
+		const int asize = p[0], ssize = p[1];
+		p += 2;
+		if ((asize != 2 && asize != 4 && asize != 8) || ssize) {
+			p = next;
+			continue;
+		}
+		// the tuples are aligned to their size from the start of the set
+		const int tuple = 2 * asize;
+		p = set + ((p - set) + tuple - 1) / tuple * tuple;
+		for (; p + tuple <= next; p += tuple) {
+			RBinDwarfARange ar = { dwarf_read (p, asize, be), dwarf_read (p + asize, asize, be), unit };
+			if (!ar.addr && !ar.size) {
+				break;
+			}
+			if (ar.size) {
+				r_vector_push (&di->aranges, &ar);
+			}
+		}
+		p = next;
+	}
+	free (copy);
+}
+
+// Skip an attribute value, reading it in *val or *str when it is a constant or an inline string
+static const ut8 *dwarf_form(const ut8 *p, const ut8 *end, ut64 form, int asize, int osize, int version,
+		bool be, ut64 *val, const char **str) {
+	ut64 n;
+	*val = 0;
+	*str = NULL;
+	switch (form) {
+	case DW_FORM_flag_present:
+	case DW_FORM_implicit_const:
+		return p;
+	case DW_FORM_udata:
+	case DW_FORM_ref_udata:
+	case DW_FORM_strx:
+	case DW_FORM_addrx:
+	case DW_FORM_loclistx:
+	case DW_FORM_rnglistx:
+		return r_uleb128 (p, R_MIN (end - p, ST32_MAX - 1), val);
+	case DW_FORM_sdata:
+		while (p < end && (*p & 0x80)) {
+			p++;
+		}
+		return p < end? p + 1: NULL;
+	case DW_FORM_string:
+		n = r_str_nlen ((const char *)p, end - p);
+		if (p + n >= end) {
+			return NULL;
+		}
+		*str = (const char *)p;
+		return p + n + 1;
+	case DW_FORM_block1:
+	case DW_FORM_block2:
+	case DW_FORM_block4:
+		n = form == DW_FORM_block1? 1: form == DW_FORM_block2? 2: 4;
+		if (n > end - p) {
+			return NULL;
+		}
+		ut64 blen = dwarf_read (p, n, be);
+		p += n;
+		return blen > end - p? NULL: p + blen;
+	case DW_FORM_block:
+	case DW_FORM_exprloc:
+		p = r_uleb128 (p, R_MIN (end - p, ST32_MAX - 1), &n);
+		return (!p || n > end - p)? NULL: p + n;
+	case DW_FORM_addr:
+		n = asize;
+		break;
+	case DW_FORM_data1:
+	case DW_FORM_ref1:
+	case DW_FORM_flag:
+	case DW_FORM_strx1:
+	case DW_FORM_addrx1:
+		n = 1;
+		break;
+	case DW_FORM_data2:
+	case DW_FORM_ref2:
+	case DW_FORM_strx2:
+	case DW_FORM_addrx2:
+		n = 2;
+		break;
+	case DW_FORM_strx3:
+	case DW_FORM_addrx3:
+		n = 3;
+		break;
+	case DW_FORM_data4:
+	case DW_FORM_ref4:
+	case DW_FORM_ref_sup4:
+	case DW_FORM_strx4:
+	case DW_FORM_addrx4:
+		n = 4;
+		break;
+	case DW_FORM_data8:
+	case DW_FORM_ref8:
+	case DW_FORM_ref_sig8:
+	case DW_FORM_ref_sup8:
+		n = 8;
+		break;
+	case DW_FORM_data16:
+		n = 16;
+		break;
+	case DW_FORM_strp:
+	case DW_FORM_line_strp:
+	case DW_FORM_strp_sup:
+	case DW_FORM_sec_offset:
+		n = osize;
+		break;
+	case DW_FORM_ref_addr:
+		n = version == 2? asize: osize;
+		break;
+	default:
+		return NULL;
+	}
+	if (n > end - p) {
+		return NULL;
+	}
+	*val = dwarf_read (p, n, be);
+	return p + n;
+}
+
+static const RBinDwarfAbbrevDecl *dwarf_abbrev_decl(const RBinDwarfDebugAbbrev *da, ut64 offset, ut64 code) {
+	size_t lo = 0, hi = da->length, i;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (da->decls[mid].offset < offset) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	for (i = lo; i < da->length; i++) {
+		if (da->decls[i].code == code) {
+			return &da->decls[i];
+		}
+		if (i > lo && da->decls[i].code <= da->decls[i - 1].code) {
+			break; // next table
+		}
+	}
+	return NULL;
+}
+
+static char *dwarf_str(RBinFile *bf, RBinDwarfIndex *di, ut64 offset) {
+	char str[4096];
+	if (offset >= di->str.size) {
+		return NULL;
+	}
+	const ut64 n = R_MIN (sizeof (str) - 1, di->str.size - offset);
+	if (r_buf_read_at (bf->buf, di->str.paddr + offset, (ut8 *)str, n) < 1) {
+		return NULL;
+	}
+	str[n] = 0;
+	return strdup (str);
+}
+
+// Read the attributes of the unit root DIE used by the line lookups
+static bool dwarf_unit_root(RBinFile *bf, RBinDwarfIndex *di, RBinDwarfUnit *u, ut64 *low, ut64 *high) {
+	const bool be = di->big_endian;
+	ut64 abbrev_offset, code, val, hival = 0;
+	bool hioff = false;
+	int osize = 4, asize;
+	size_t i;
+	ut8 *copy;
+
+	u->root = true;
+	if (!di->da) {
+		const ut8 *abbrev = dwarf_bytes (bf, di->abbrev.paddr, di->abbrev.size, &copy);
+		di->da = abbrev? r_bin_dwarf_parse_abbrev_raw (abbrev, di->abbrev.size, R_MODE_SET): NULL;
+		free (copy);
+		if (!di->da) {
+			return false;
+		}
+	}
+	const ut64 n = R_MIN (di->info.size - u->offset, DWARF_ROOT_MAX);
+	const ut8 *buf = dwarf_bytes (bf, di->info.paddr + u->offset, n, &copy);
+	if (!buf || n < 11) {
+		free (copy);
+		return false;
+	}
+	const ut8 *p = buf, *end = buf + n;
+	if (r_read_ble32 (p, be) == DWARF_INIT_LEN_64) {
+		osize = 8;
+		p += 12;
+	} else {
+		p += 4;
+	}
+	const int version = r_read_ble16 (p, be);
+	p += 2;
+	if (version < 2 || version > 5 || end - p < osize + 2) {
+		free (copy);
+		return false;
+	}
+	if (version == 5) {
+		const ut8 type = p[0];
+		asize = p[1];
+		abbrev_offset = dwarf_read (p + 2, osize, be);
+		p += 2 + osize;
+		if (type == 4 || type == 5) {
+			p += 8; // skeleton and split units, dwo id
+		} else if (type != 1 && type != 3) {
+			free (copy);
+			return false;
+		}
+	} else {
+		abbrev_offset = dwarf_read (p, osize, be);
+		asize = p[osize];
+		p += osize + 1;
+	}
+	p = (p < end)? r_uleb128 (p, R_MIN (end - p, ST32_MAX - 1), &code): NULL;
+	const RBinDwarfAbbrevDecl *decl = p? dwarf_abbrev_decl (di->da, abbrev_offset, code): NULL;
+	for (i = 0; decl && p && i < decl->length; i++) {
+		const char *str;
+		ut64 form = decl->specs[i].attr_form;
+		if (!decl->specs[i].attr_name && !form) {
+			break;
+		}
+		if (form == DW_FORM_indirect) {
+			p = r_uleb128 (p, R_MIN (end - p, ST32_MAX - 1), &form);
+			if (!p) {
+				break;
+			}
+		}
+		p = dwarf_form (p, end, form, asize, osize, version, be, &val, &str);
+		if (!p) {
+			break;
+		}
+		switch (decl->specs[i].attr_name) {
+		case DW_AT_stmt_list:
+			u->stmt_list = val;
+			break;
+		case DW_AT_comp_dir:
+			if (!u->comp_dir) {
+				u->comp_dir = str? strdup (str): (form == DW_FORM_strp)? dwarf_str (bf, di, val): NULL;
+			}
+			break;
+		case DW_AT_low_pc:
+			*low = val;
+			break;
+		case DW_AT_high_pc:
+			hival = val;
+			hioff = form != DW_FORM_addr;
+			break;
+		}
+	}
+	*high = hioff? *low + hival: hival;
+	free (copy);
+	return true;
+}
+
+static RBinDwarfLineTable *dwarf_unit_lines(RBinFile *bf, RBinDwarfIndex *di, RBinDwarfUnit *u) {
+	ut64 low = 0, high = 0;
+	ut8 h[4], *copy;
+	RBinDwarfLineTable *lt = R_NEW0 (RBinDwarfLineTable);
+	if (!lt) {
+		return NULL;
+	}
+	dwarf_line_table_init (lt);
+	if (!u->root) {
+		dwarf_unit_root (bf, di, u, &low, &high);
+	}
+	// units without DW_AT_stmt_list have no line program
+	if (u->stmt_list == UT64_MAX || di->line.size < sizeof (h)
+			|| u->stmt_list > di->line.size - sizeof (h)
+			|| r_buf_read_at (bf->buf, di->line.paddr + u->stmt_list, h, sizeof (h)) != sizeof (h)) {
+		return lt;
+	}
+	const ut64 n = R_MIN (4 + (ut64)r_read_ble32 (h, di->big_endian), di->line.size - u->stmt_list);
+	const ut8 *buf = dwarf_bytes (bf, di->line.paddr + u->stmt_list, n, &copy);
+	if (buf) {
+		DwarfLineSink sink = { lt, 0, dwarf_addr_size (bf), true };
+		dwarf_line_unit (&sink, buf, buf + n, u->comp_dir, NULL, R_MODE_SET);
+		qsort (lt->rows.a, lt->rows.len, lt->rows.elem_size, dwarf_row_cmp);
+		r_vector_shrink (&lt->rows);
+	}
+	free (copy);
+	return lt;
+}
+
+R_API RBinDwarfIndex *r_bin_dwarf_index_new(RBinFile *bf) {
+	r_return_val_if_fail (bf, NULL);
+	RBinDwarfSection aranges = {0};
+	RBinDwarfIndex *di = R_NEW0 (RBinDwarfIndex);
+	if (!di) {
+		return NULL;
+	}
+	r_vector_init (&di->units, sizeof (RBinDwarfUnit), dwarf_unit_fini, NULL);
+	r_vector_init (&di->aranges, sizeof (RBinDwarfARange), NULL, NULL);
+	di->big_endian = bf->o && bf->o->info && bf->o->info->big_endian;
+	if (!dwarf_section (bf, "debug_info", &di->info) || !dwarf_section (bf, "debug_abbrev", &di->abbrev)) {
+		// nothing to index, the empty index answers the queries
+		return di;
+	}
+	dwarf_section (bf, "debug_line", &di->line);
+	dwarf_section (bf, "debug_str", &di->str);
+	dwarf_index_units (bf, di);
+	if (dwarf_section (bf, "debug_aranges", &aranges)) {
+		dwarf_index_aranges (bf, di, &aranges);
+	}
+	if (r_vector_empty (&di->aranges)) {
+		RBinDwarfUnit *u;
+		r_vector_foreach (&di->units, u) {
+			ut64 low = 0, high = 0;
+			if (dwarf_unit_root (bf, di, u, &low, &high) && low < high) {
+				RBinDwarfARange ar = { low, high - low, u->offset };
+				r_vector_push (&di->aranges, &ar);
+			}
+		}
+	}
+	qsort (di->aranges.a, di->aranges.len, di->aranges.elem_size, dwarf_arange_cmp);
+	return di;
+}
+
+R_API void r_bin_dwarf_index_free(RBinDwarfIndex *di) {
+	if (!di) {
+		return;
+	}
+	r_vector_clear (&di->units);
+	r_vector_clear (&di->aranges);
+	r_bin_dwarf_free_debug_abbrev (di->da);
+	free (di->da);
+	free (di);
+}
+
+static RBinDwarfUnit *dwarf_unit_at(RBinDwarfIndex *di, ut64 addr) {
+	size_t lo = 0, hi = di->aranges.len, i;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (((RBinDwarfARange *)r_vector_index_ptr (&di->aranges, mid))->addr <= addr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	// ranges rarely overlap, look back a little for one that does
+	for (i = lo; i > 0 && lo - i < 8; i--) {
+		RBinDwarfARange *ar = r_vector_index_ptr (&di->aranges, i - 1);
+		if (addr - ar->addr < ar->size) {
+			lo = 0;
+			hi = di->units.len;
+			while (lo < hi) {
+				size_t mid = lo + (hi - lo) / 2;
+				RBinDwarfUnit *u = r_vector_index_ptr (&di->units, mid);
+				if (u->offset == ar->unit) {
+					return u;
+				}
+				if (u->offset < ar->unit) {
+					lo = mid + 1;
+				} else {
+					hi = mid;
+				}
+			}
+			return NULL;
+		}
+	}
+	return NULL;
+}
+
+R_API bool r_bin_dwarf_addr2line(RBinFile *bf, ut64 addr, char *file, int len, int *line) {
+	r_return_val_if_fail (bf && file && line, false);
+	if (!bf->dwarf && !(bf->dwarf = r_bin_dwarf_index_new (bf))) {
+		return false;
+	}
+	if (bf->dwarf->addrinfo) {
+		// CL may have edited the replayed rows
+		char offset[64];
+		char *fileline = sdb_get (bf->sdb_addrinfo, sdb_itoa (addr, offset, 16), 0);
+		char *p = fileline? strchr (fileline, '|'): NULL;
+		if (p) {
+			*p = 0;
+			r_str_ncpy (file, fileline, len);
+			*line = atoi (p + 1);
+		}
+		free (fileline);
+		return p != NULL;
+	}
+	RBinDwarfUnit *u = dwarf_unit_at (bf->dwarf, addr);
+	if (!u || (!u->lines && !(u->lines = dwarf_unit_lines (bf, bf->dwarf, u)))) {
+		return false;
+	}
+	RVector *rows = &u->lines->rows;
+	size_t lo = 0, hi = rows->len;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (((RBinDwarfLineRow *)r_vector_index_ptr (rows, mid))->address < addr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	RBinDwarfLineRow *row = (lo < rows->len)? r_vector_index_ptr (rows, lo): NULL;
+	const char *name = (row && row->address == addr)? r_pvector_at (&u->lines->files, row->file): NULL;
+	if (!name) {
+		return false;
+	}
+	r_str_ncpy (file, name, len);
+	*line = row->line;
+	return true;
+}
+
+// replays every line table into sdb_addrinfo for the consumers that list it
+R_API bool r_bin_dwarf_addrinfo(RBinFile *bf) {
+	r_return_val_if_fail (bf, false);
+	if (!bf->sdb_addrinfo || (!bf->dwarf && !(bf->dwarf = r_bin_dwarf_index_new (bf)))) {
+		return false;
+	}
+	RBinDwarfIndex *di = bf->dwarf;
+	if (di->addrinfo) {
+		return true;
+	}
+	RBinDwarfUnit *u;
+	r_vector_foreach (&di->units, u) {
+		RBinDwarfLineRow *row;
+		if (!u->lines && !(u->lines = dwarf_unit_lines (bf, di, u))) {
+			continue;
+		}
+		r_vector_foreach (&u->lines->rows, row) {
+			const char *name = r_pvector_at (&u->lines->files, row->file);
+			add_sdb_addrline (bf->sdb_addrinfo, row->address, name, row->line, NULL, R_MODE_SET);
+		}
+	}
+	di->addrinfo = true;
+	return true;
+}
@@ -61,6 +61,16 @@ static inline int UTX_MUL(ut64 *r, ut64 a, ut64 b) {
 
 #define GROWTH_FACTOR (1.5)
 
+// Entry idx of the table at off: a pointer into view when the buffer let us
+// borrow the whole table (see r_buf_borrow_at), otherwise it is read into tmp
+static inline const ut8 *table_entry(RBuffer *b, const ut8 *view, ut64 off, ut64 idx, ut8 *tmp, size_t size) {
+	if (view) {
+		return view + idx * size;
+	}
+	memset (tmp, 0, size);
+	return r_buf_read_at (b, off + idx * size, tmp, size) > 0? tmp: NULL;
+}
+
 #define round_up(a) ((((a) + (4) - (1)) / (4)) * (4))
 
 enum {
@@ -219,11 +229,12 @@ static bool read_phdr(ELFOBJ *bin, bool linux_kernel_hack) {
 	const bool is_elf64 = false;
 #endif
 
+	const ut8 *view = r_buf_borrow_at (bin->b, bin->ehdr.e_phoff, (ut64)bin->ehdr.e_phnum * sizeof (Elf_(Phdr)));
 	for (i = 0; i < bin->ehdr.e_phnum; i++) {
-		ut8 phdr[sizeof (Elf_(Phdr))] = { 0 };
+		ut8 tmp[sizeof (Elf_(Phdr))];
 		int j = 0;
-		int len = r_buf_read_at (bin->b, bin->ehdr.e_phoff + i * sizeof (Elf_(Phdr)), phdr, sizeof (Elf_(Phdr)));
-		if (len < 1) {
+		const ut8 *phdr = table_entry (bin->b, view, bin->ehdr.e_phoff, i, tmp, sizeof (Elf_(Phdr)));
+		if (!phdr) {
 			bprintf ("read (phdr)\n");
 			R_FREE (bin->phdr);
 			return false;
@@ -327,8 +338,8 @@ static int init_phdr(ELFOBJ *bin) {
 
 static int init_shdr(ELFOBJ *bin) {
 	ut32 shdr_size;
-	ut8 shdr[sizeof (Elf_(Shdr))] = { 0 };
-	int i, j, len;
+	ut8 tmp[sizeof (Elf_(Shdr))];
+	int i, j;
 
 	r_return_val_if_fail (bin && !bin->shdr, false);
 
@@ -358,10 +369,11 @@ static int init_shdr(ELFOBJ *bin) {
 			"SHT_NOBITS=8,SHT_REL=9,SHT_SHLIB=10,SHT_DYNSYM=11,SHT_LOOS=0x60000000,"
 			"SHT_HIOS=0x6fffffff,SHT_LOPROC=0x70000000,SHT_HIPROC=0x7fffffff};", 0);
 
+	const ut8 *view = r_buf_borrow_at (bin->b, bin->ehdr.e_shoff, shdr_size);
 	for (i = 0; i < bin->ehdr.e_shnum; i++) {
 		j = 0;
-		len = r_buf_read_at (bin->b, bin->ehdr.e_shoff + i * sizeof (Elf_(Shdr)), shdr, sizeof (Elf_(Shdr)));
-		if (len < 1) {
+		const ut8 *shdr = table_entry (bin->b, view, bin->ehdr.e_shoff, i, tmp, sizeof (Elf_(Shdr)));
+		if (!shdr) {
 			bprintf ("read (shdr) at 0x%" PFMT64x "\n", (ut64) bin->ehdr.e_shoff);
 			R_FREE (bin->shdr);
 			return false;
@@ -492,11 +504,13 @@ static int compute_dyn_entries(ELFOBJ *bin, Elf_(Phdr) *dyn_phdr, ut64 dyn_size)
 	Elf_(Dyn) d = { 0 };
 	int res;
 
-	for (res = 0; res < (dyn_size / sizeof (Elf_(Dyn))); res++) {
-		ut8 sdyn[sizeof (Elf_(Dyn))] = { 0 };
+	const ut64 nentries = dyn_size / sizeof (Elf_(Dyn));
+	const ut8 *view = r_buf_borrow_at (bin->b, dyn_phdr->p_offset, nentries * sizeof (Elf_(Dyn)));
+	for (res = 0; res < nentries; res++) {
+		ut8 tmp[sizeof (Elf_(Dyn))];
 		int j = 0;
-		int len = r_buf_read_at (bin->b, dyn_phdr->p_offset + res * sizeof (Elf_(Dyn)), sdyn, sizeof (Elf_(Dyn)));
-		if (len < 1) {
+		const ut8 *sdyn = table_entry (bin->b, view, dyn_phdr->p_offset, res, tmp, sizeof (Elf_(Dyn)));
+		if (!sdyn) {
 			return -1;
 		}
 		d.d_tag = READWORD (sdyn, j);
@@ -512,8 +526,8 @@ static int init_dynamic_section(ELFOBJ *bin) {
 	ut64 strtabaddr = 0;
 	char *strtab = NULL;
 	size_t relentry = 0, strsize = 0;
-	int i, len, r;
-	ut8 sdyn[sizeof (Elf_(Dyn))] = { 0 };
+	int i, r;
+	ut8 tmp[sizeof (Elf_(Dyn))];
 	ut64 dyn_size = 0, loaded_offset;
 
 	r_return_val_if_fail (bin, false);
@@ -547,10 +561,11 @@ static int init_dynamic_section(ELFOBJ *bin) {
 	if (!dyn_size || loaded_offset + dyn_size > bin->size) {
 		goto beach;
 	}
+	const ut8 *view = r_buf_borrow_at (bin->b, loaded_offset, dyn_size);
 	for (i = 0; i < entries; i++) {
 		int j = 0;
-		len = r_buf_read_at (bin->b, loaded_offset + i * sizeof (Elf_(Dyn)), sdyn, sizeof (Elf_(Dyn)));
-		if (len < 1) {
+		const ut8 *sdyn = table_entry (bin->b, view, loaded_offset, i, tmp, sizeof (Elf_(Dyn)));
+		if (!sdyn) {
 			bprintf ("read (dyn)\n");
 			goto beach;
 		}
@@ -1280,20 +1295,20 @@ static RBinElfSection *get_rel_sec(ELFOBJ *bin, const char **sects) {
 	return rel_sec;
 }
 
-static void read_rel(ELFOBJ *bin, Elf_(Rel) *rel, ut8 *rl) {
+static void read_rel(ELFOBJ *bin, Elf_(Rel) *rel, const ut8 *rl) {
 	int l = 0;
 	rel->r_offset = READWORD (rl, l);
 	rel->r_info = READWORD (rl, l);
 }
 
-static void read_rela(ELFOBJ *bin, Elf_(Rela) *rela, ut8 *rl) {
+static void read_rela(ELFOBJ *bin, Elf_(Rela) *rela, const ut8 *rl) {
 	int l = 0;
 	rela->r_offset = READWORD (rl, l);
 	rela->r_info = READWORD (rl, l);
 	rela->r_addend = READWORD (rl, l);
 }
 
-static struct ht_rel_t *read_ht_rel(ELFOBJ *bin, ut8 *rl, int k) {
+static struct ht_rel_t *read_ht_rel(ELFOBJ *bin, const ut8 *rl, int k) {
 	struct ht_rel_t *rel = R_NEW0 (struct ht_rel_t);
 	if (!rel) {
 		return NULL;
@@ -1314,7 +1329,8 @@ static void rel_cache_free(HtUPKv *kv) {
 }
 
 static HtUP *rel_cache_new(ELFOBJ *bin) {
-	ut8 rl[MAX_REL_RELA_SZ] = { 0 };
+	ut8 tmp[MAX_REL_RELA_SZ] = { 0 };
+	const ut8 *rl;
 	RBinElfSection *rel_sec = NULL;
 	int j, k, tsize, nrel;
 	const char *rel_sect[] = { ".rel.plt", ".rela.plt", ".rel.dyn", ".rela.dyn", NULL };
@@ -1344,9 +1360,13 @@ static HtUP *rel_cache_new(ELFOBJ *bin) {
 	const int htsize = R_MIN (nrel, 1024);
 	rel_cache = ht_up_new_size (htsize, NULL, rel_cache_free, NULL);
 
+	const ut8 *view = r_buf_borrow_at (bin->b, rel_sec->offset, (ut64)nrel * tsize);
 	for (j = k = 0; j < rel_sec->size && k < nrel; j += tsize, k++) {
-		int len = r_buf_read_at (bin->b, rel_sec->offset + j, rl, tsize);
-		if (len != tsize) {
+		if (view) {
+			rl = view + j;
+		} else if (r_buf_read_at (bin->b, rel_sec->offset + j, tmp, tsize) == tsize) {
+			rl = tmp;
+		} else {
 			break;
 		}
 		struct ht_rel_t *rel = read_ht_rel (bin, rl, k);
@@ -3002,9 +3022,9 @@ static void fill_symbol_bind_and_type(ELFOBJ *bin, struct r_bin_elf_symbol_t *re
 static RBinElfSymbol* get_symbols_from_phdr(ELFOBJ *bin, int type) {
 	Elf_(Sym) *sym = NULL;
 	Elf_(Addr) addr_sym_table = 0;
-	ut8 s[sizeof (Elf_(Sym))] = {0};
+	ut8 tmp[sizeof (Elf_(Sym))];
 	RBinElfSymbol *ret = NULL;
-	int i, j, r, tsize, nsym, ret_ctr;
+	int i, j, tsize, nsym, ret_ctr;
 	ut64 toffset = 0, tmp_offset;
 	ut32 size, sym_size = 0;
 
@@ -3051,6 +3071,7 @@ static RBinElfSymbol* get_symbols_from_phdr(ELFOBJ *bin, int type) {
 	if (!sym || !ret) {
 		goto beach;
 	}
+	const ut8 *view = r_buf_borrow_at (bin->b, addr_sym_table, size);
 	for (i = 1, ret_ctr = 0; i < nsym; i++) {
 		if (i >= capacity1) { // maybe grow
 			// You take what you want, but you eat what you take.
@@ -3070,8 +3091,8 @@ static RBinElfSymbol* get_symbols_from_phdr(ELFOBJ *bin, int type) {
 			capacity2 *= GROWTH_FACTOR;
 		}
 		// read in one entry
-		r = r_buf_read_at (bin->b, addr_sym_table + i * sizeof (Elf_ (Sym)), s, sizeof (Elf_ (Sym)));
-		if (r < 1) {
+		const ut8 *s = table_entry (bin->b, view, addr_sym_table, i, tmp, sizeof (Elf_(Sym)));
+		if (!s) {
 			goto beach;
 		}
 		int j = 0;
@@ -3376,7 +3397,7 @@ RBinSymbol *Elf_(_r_bin_elf_convert_symbol)(struct Elf_(r_bin_elf_obj_t) *bin,
 // TODO: return RList<RBinSymbol*> .. or run a callback with that symbol constructed, so we don't have to do it twice
 static RBinElfSymbol* Elf_(_r_bin_elf_get_symbols_imports)(ELFOBJ *bin, int type) {
 	ut32 shdr_size;
-	int tsize, nsym, ret_ctr = 0, i, j, r, k, newsize;
+	int tsize, nsym, ret_ctr = 0, i, j, k, newsize;
 	ut64 toffset;
 	ut32 size = 0;
 	RBinElfSymbol *ret = NULL, *import_ret = NULL;
@@ -3384,7 +3405,7 @@ static RBinElfSymbol* Elf_(_r_bin_elf_get_symbols_imports)(ELFOBJ *bin, int type
 	size_t ret_size = 0, prev_ret_size = 0, import_ret_ctr = 0;
 	Elf_(Shdr) *strtab_section = NULL;
 	Elf_(Sym) *sym = NULL;
-	ut8 s[sizeof (Elf_(Sym))] = { 0 };
+	ut8 tmp[sizeof (Elf_(Sym))];
 	char *strtab = NULL;
 
 	if (!bin || !bin->shdr || !bin->ehdr.e_shnum || bin->ehdr.e_shnum == 0xffff) {
@@ -3467,10 +3488,11 @@ static RBinElfSymbol* Elf_(_r_bin_elf_get_symbols_imports)(ELFOBJ *bin, int type
 			if (bin->shdr[i].sh_offset + size > bin->size) {
 				goto beach;
 			}
+			const ut8 *view = r_buf_borrow_at (bin->b, bin->shdr[i].sh_offset, size);
 			for (j = 0; j < nsym; j++) {
 				int k = 0;
-				r = r_buf_read_at (bin->b, bin->shdr[i].sh_offset + j * sizeof (Elf_(Sym)), s, sizeof (Elf_(Sym)));
-				if (r < 1) {
+				const ut8 *s = table_entry (bin->b, view, bin->shdr[i].sh_offset, j, tmp, sizeof (Elf_(Sym)));
+				if (!s) {
 					bprintf ("read (sym)\n");
 					goto beach;
 				}
@@ -325,7 +325,7 @@ static bool parse_segments(struct MACH0_(obj_t) *bin, ut64 off) {
 	int i, j, k, sect, len;
 	ut32 size_sects;
 	ut8 segcom[sizeof (struct MACH0_(segment_command))] = {0};
-	ut8 sec[sizeof (struct MACH0_(section))] = {0};
+	ut8 tmp[sizeof (struct MACH0_(section))] = {0};
 
 	if (!UT32_MUL (&size_sects, bin->nsegs, sizeof (struct MACH0_(segment_command)))) {
 		return false;
@@ -429,13 +429,17 @@ static bool parse_segments(struct MACH0_(obj_t) *bin, ut64 off) {
 			return false;
 		}
 
+		const ut8 *view = r_buf_borrow_at (bin->b, off + sizeof (struct MACH0_(segment_command)), size_sects);
 		for (k = sect, j = 0; k < bin->nsects; k++, j++) {
 			ut64 offset = off + sizeof (struct MACH0_(segment_command)) + j * sizeof (struct MACH0_(section));
-			len = r_buf_read_at (bin->b, offset, sec, sizeof (struct MACH0_(section)));
-			if (len != sizeof (struct MACH0_(section))) {
-				bprintf ("Error: read (sects)\n");
-				bin->nsects = sect;
-				return false;
+			const ut8 *sec = view? view + j * sizeof (struct MACH0_(section)): tmp;
+			if (!view) {
+				len = r_buf_read_at (bin->b, offset, tmp, sizeof (struct MACH0_(section)));
+				if (len != sizeof (struct MACH0_(section))) {
+					bprintf ("Error: read (sects)\n");
+					bin->nsects = sect;
+					return false;
+				}
 			}
 
 			i = 0;
@@ -491,7 +495,7 @@ static bool parse_symtab(struct MACH0_(obj_t) *mo, ut64 off) {
 	int i;
 	const char *errorMessage = "";
 	ut8 symt[sizeof (struct symtab_command)] = {0};
-	ut8 nlst[sizeof (struct MACH0_(nlist))] = {0};
+	ut8 tmp[sizeof (struct MACH0_(nlist))] = {0};
 	const bool be = mo->big_endian;
 
 	if (off > (ut64)mo->size || off + sizeof (struct symtab_command) > (ut64)mo->size) {
@@ -525,22 +529,37 @@ static bool parse_symtab(struct MACH0_(obj_t) *mo, ut64 off) {
 		if (st.symoff > mo->size || st.symoff + size_sym > mo->size) {
 			Error ("symoff is out of bounds");
 		}
-		if (!(mo->symstr = calloc (1, st.strsize + 2))) {
-			Error ("symoff is out of bounds");
-		}
 		mo->symstrlen = st.strsize;
-		len = r_buf_read_at (mo->b, st.stroff, (ut8*)mo->symstr, st.strsize);
-		if (len != st.strsize) {
-			Error ("Error: read (symstr)");
+		// dyld caches share one multi-megabyte string pool between all the
+		// images, so reference it in place when it is already nul terminated.
+		// Only mapped files lend it: the object holds a reference to mo->b, so
+		// the mapping outlives symstr, while byte buffers may be reallocated
+		const ut8 *pool = st.strsize && r_buf_pinned (mo->b)
+			? r_buf_borrow_at (mo->b, st.stroff, st.strsize): NULL;
+		if (pool && !pool[st.strsize - 1]) {
+			mo->symstr = (ut8 *)pool;
+			mo->symstr_borrowed = true;
+		} else {
+			if (!(mo->symstr = calloc (1, st.strsize + 2))) {
+				Error ("symoff is out of bounds");
+			}
+			len = r_buf_read_at (mo->b, st.stroff, (ut8*)mo->symstr, st.strsize);
+			if (len != st.strsize) {
+				Error ("Error: read (symstr)");
+			}
 		}
 		if (!(mo->symtab = calloc (mo->nsymtab, sizeof (struct MACH0_(nlist))))) {
 			goto error;
 		}
+		const ut8 *view = r_buf_borrow_at (mo->b, st.symoff, size_sym);
 		for (i = 0; i < mo->nsymtab; i++) {
-			ut64 at = st.symoff + (i * sizeof (struct MACH0_(nlist)));
-			len = r_buf_read_at (mo->b, at, nlst, sizeof (struct MACH0_(nlist)));
-			if (len != sizeof (struct MACH0_(nlist))) {
-				Error ("read (nlist)");
+			const ut8 *nlst = view? view + i * sizeof (struct MACH0_(nlist)): tmp;
+			if (!view) {
+				ut64 at = st.symoff + (i * sizeof (struct MACH0_(nlist)));
+				len = r_buf_read_at (mo->b, at, tmp, sizeof (struct MACH0_(nlist)));
+				if (len != sizeof (struct MACH0_(nlist))) {
+					Error ("read (nlist)");
+				}
 			}
 			//XXX not very safe what if is n_un.n_name instead?
 			mo->symtab[i].n_strx = r_read_ble32 (nlst, be);
@@ -556,6 +575,10 @@ static bool parse_symtab(struct MACH0_(obj_t) *mo, ut64 off) {
 	}
 	return true;
 error:
+	if (mo->symstr_borrowed) {
+		mo->symstr = NULL;
+		mo->symstr_borrowed = false;
+	}
 	R_FREE (mo->symstr);
 	R_FREE (mo->symtab);
 	Eprintf ("%s\n", errorMessage);
@@ -700,7 +723,12 @@ static int parse_dysymtab(struct MACH0_(obj_t) *bin, ut64 off) {
 			R_FREE (bin->indirectsyms);
 			return false;
 		}
+		const ut8 *view = r_buf_borrow_at (bin->b, bin->dysymtab.indirectsymoff, size_tab);
 		for (i = 0; i < bin->nindirectsyms; i++) {
+			if (view) {
+				bin->indirectsyms[i] = r_read_ble32 (view + i * sizeof (ut32), bin->big_endian);
+				continue;
+			}
 			len = r_buf_read_at (bin->b, bin->dysymtab.indirectsymoff + i * sizeof (ut32), idsyms, 4);
 			if (len == -1) {
 				bprintf ("Error: read (indirect syms)\n");
@@ -1584,6 +1612,9 @@ static int init_items(struct MACH0_(obj_t) *bin) {
 			break;
 		case LC_SYMTAB:
 			sdb_set (bin->kv, sdb_fmt ("mach0_cmd_%d.cmd", i), "symtab", 0);
+			if (bin->sections_only) {
+				break;
+			}
 			if (!parse_symtab (bin, off)) {
 				bprintf ("error parsing symtab\n");
 				return false;
@@ -1591,6 +1622,9 @@ static int init_items(struct MACH0_(obj_t) *bin) {
 			break;
 		case LC_DYSYMTAB:
 			sdb_set (bin->kv, sdb_fmt ("mach0_cmd_%d.cmd", i), "dysymtab", 0);
+			if (bin->sections_only) {
+				break;
+			}
 			if (!parse_dysymtab (bin, off)) {
 				bprintf ("error parsing dysymtab\n");
 				return false;
@@ -1885,7 +1919,9 @@ void *MACH0_(mach0_free)(struct MACH0_(obj_t) *mo) {
 	free (mo->segs);
 	free (mo->sects);
 	free (mo->symtab);
-	free (mo->symstr);
+	if (!mo->symstr_borrowed) {
+		free (mo->symstr);
+	}
 	free (mo->indirectsyms);
 	free (mo->imports_by_ord);
 	if (mo->imports_by_name) {
@@ -1910,6 +1946,7 @@ void MACH0_(opts_set_default)(struct MACH0_(opts_t) *options, RBinFile *bf) {
 	}
 
 	options->header_at = 0;
+	options->sections_only = false;
 	if (bf && bf->rbin) {
 		options->verbose = bf->rbin->verbose;
 	} else {
@@ -1971,6 +2008,7 @@ struct MACH0_(obj_t) *MACH0_(new_buf)(RBuffer *buf, struct MACH0_(opts_t) *optio
 		if (options) {
 			bin->verbose = options->verbose;
 			bin->header_at = options->header_at;
+			bin->sections_only = options->sections_only;
 		}
 		if (!init (bin)) {
 			return MACH0_(mach0_free)(bin);
@@ -104,6 +104,7 @@ struct super_blob_t {
 struct MACH0_(opts_t) {
 	bool verbose;
 	ut64 header_at;
+	bool sections_only; // skip LC_SYMTAB/LC_DYSYMTAB, only the layout is needed
 };
 
 struct MACH0_(obj_t) {
@@ -116,6 +117,7 @@ struct MACH0_(obj_t) {
 	int nsects;
 	struct MACH0_(nlist) *symtab;
 	ut8 *symstr;
+	bool symstr_borrowed; // symstr points into the mapped buffer, do not free it
 	ut8 *func_start; //buffer that hold the data from LC_FUNCTION_STARTS
 	int symstrlen;
 	int nsymtab;
@@ -164,6 +166,7 @@ struct MACH0_(obj_t) {
 	int func_size;
 	bool verbose;
 	ut64 header_at;
+	bool sections_only;
 	void *user;
 	ut64 (*va2pa)(ut64 p, ut32 *offset, ut32 *left, RBinFile *bf);
 	struct symbol_t *symbols;
@@ -1166,7 +1166,7 @@ static RList *parse_swift_classes(RBinFile *bf) {
 
 	int idx = 0;
 	ret = r_list_newf (r_bin_string_free);
-	r_list_foreach (bf->o->strings, iter, str) {
+	r_list_foreach (r_bin_object_get_strings (bf), iter, str) {
 		if (!strncmp (str->string, "_TtC", 4)) {
 			char *msg = strdup (str->string + 4);
 			cls = R_NEW0 (RBinClass);
@@ -2972,20 +2972,34 @@ struct r_bin_pe_export_t* PE_(r_bin_pe_get_exports)(struct PE_(r_bin_pe_obj_t)*
 		functions_paddr = bin_pe_rva_to_paddr (bin, bin->export_directory->AddressOfFunctions);
 		names_paddr = bin_pe_rva_to_paddr (bin, bin->export_directory->AddressOfNames);
 		ordinals_paddr = bin_pe_rva_to_paddr (bin, bin->export_directory->AddressOfOrdinals);
+		// the ordinals are scanned once per function, look at them in place when possible
+		const ut8 *functions = r_buf_borrow_at (bin->b, functions_paddr,
+			(ut64)bin->export_directory->NumberOfFunctions * sizeof (PE_VWord));
+		const ut8 *ordinals = r_buf_borrow_at (bin->b, ordinals_paddr,
+			(ut64)bin->export_directory->NumberOfNames * sizeof (PE_Word));
 		for (i = 0; i < bin->export_directory->NumberOfFunctions; i++) {
+			int ret;
 			// get vaddr from AddressOfFunctions array
-			int ret = r_buf_read_at (bin->b, functions_paddr + i * sizeof(PE_VWord), (ut8*) &function_rva, sizeof(PE_VWord));
-			if (ret < 1) {
-				break;
+			if (functions) {
+				function_rva = r_read_le32 (functions + i * sizeof (PE_VWord));
+			} else {
+				ret = r_buf_read_at (bin->b, functions_paddr + i * sizeof(PE_VWord), (ut8*) &function_rva, sizeof(PE_VWord));
+				if (ret < 1) {
+					break;
+				}
 			}
 			// have exports by name?
 			if (bin->export_directory->NumberOfNames != 0) {
 				// search for value of i into AddressOfOrdinals
 				name_vaddr = 0;
 				for (n = 0; n < bin->export_directory->NumberOfNames; n++) {
-					ret = r_buf_read_at (bin->b, ordinals_paddr + n * sizeof(PE_Word), (ut8*) &function_ordinal, sizeof (PE_Word));
-					if (ret < 1) {
-						break;
+					if (ordinals) {
+						function_ordinal = r_read_le16 (ordinals + n * sizeof (PE_Word));
+					} else {
+						ret = r_buf_read_at (bin->b, ordinals_paddr + n * sizeof(PE_Word), (ut8*) &function_ordinal, sizeof (PE_Word));
+						if (ret < 1) {
+							break;
+						}
 					}
 					// if exist this index into AddressOfOrdinals
 					if (i == function_ordinal) {
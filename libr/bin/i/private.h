@@ -28,6 +28,12 @@ R_IPI RBinObject *r_bin_object_new(RBinFile *binfile, RBinPlugin *plugin, ut64 b
 R_IPI RBinObject *r_bin_object_get_cur(RBin *bin);
 R_IPI RBinObject *r_bin_object_find_by_arch_bits(RBinFile *binfile, const char *arch, int bits, const char *name);
 R_IPI RBNode *r_bin_object_patch_relocs(RBin *bin, RBinObject *o);
+R_IPI RList *r_bin_object_get_imports(RBinFile *bf);
+R_IPI RList *r_bin_object_get_symbols(RBinFile *bf);
+R_IPI RList *r_bin_object_get_image_symbols(RBinFile *bf, ut64 vaddr);
+R_IPI RBNode *r_bin_object_get_relocs(RBinFile *bf);
+R_IPI RList *r_bin_object_get_strings(RBinFile *bf);
+R_IPI RBinSymbol *r_bin_object_find_symbol(RBinFile *bf, const char *name, ut64 vaddr);
 
 R_IPI const char *r_bin_lang_tostring(int lang);
 R_IPI int r_bin_lang_type(RBinFile *binfile, const char *def, const char *sym);
@@ -1,6 +1,7 @@
 /* radare - LGPL - Copyright 2013-2016 - pancake */
 
 #include <r_bin.h>
+#include "../i/private.h"
 
 R_IPI bool r_bin_lang_swift(RBinFile *binfile) {
 	RBinObject *o = binfile? binfile->o: NULL;
@@ -8,7 +9,7 @@ R_IPI bool r_bin_lang_swift(RBinFile *binfile) {
 	RBinSymbol *sym;
 	RListIter *iter;
 	if (info) {
-		r_list_foreach (o->symbols, iter, sym) {
+		r_list_foreach (r_bin_object_get_symbols (binfile), iter, sym) {
 			if (sym->name && strstr (sym->name, "swift_once")) {
 				info->lang = "swift";
 				return true;
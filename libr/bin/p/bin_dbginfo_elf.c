@@ -19,7 +19,7 @@ static int get_line(RBinFile *bf, ut64 addr, char *file, int len, int *line) {
 			}
 		}
 	}
-	return false;
+	return r_bin_dwarf_addr2line (bf, addr, file, len, line);
 }
 
 #if !R_BIN_ELF64
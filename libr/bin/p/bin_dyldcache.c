@@ -71,13 +71,21 @@ typedef struct _r_dyldcache {
 	cache_hdr_t *hdr;
 	cache_map_t *maps;
 	cache_accel_t *accel;
+	RVector *images; // RDyldImageRange sorted by address, built with the sections
 } RDyldCache;
 
 typedef struct _r_bin_image {
 	char *file;
 	ut64 header_at;
+	bool symbols_loaded;
 } RDyldBinImage;
 
+typedef struct _r_dyld_image_range {
+	ut64 from;
+	ut64 to;
+	RDyldBinImage *bin;
+} RDyldImageRange;
+
 static RList * pending_bin_files = NULL;
 
 static void free_bin(RDyldBinImage *bin) {
@@ -152,6 +160,7 @@ static void r_dyldcache_free(RDyldCache *cache) {
 	R_FREE (cache->hdr);
 	R_FREE (cache->maps);
 	R_FREE (cache->accel);
+	r_vector_free (cache->images);
 	R_FREE (cache);
 }
 
@@ -194,7 +203,7 @@ static ut64 bin_obj_va2pa(ut64 p, ut32 *offset, ut32 *left, RBinFile *bf) {
 	return res;
 }
 
-static struct MACH0_(obj_t) *bin_to_mach0(RBinFile *bf, RDyldBinImage *bin) {
+static struct MACH0_(obj_t) *bin_to_mach0(RBinFile *bf, RDyldBinImage *bin, bool sections_only) {
 	if (!bin || !bf) {
 		return NULL;
 	}
@@ -207,7 +216,11 @@ static struct MACH0_(obj_t) *bin_to_mach0(RBinFile *bf, RDyldBinImage *bin) {
 	struct MACH0_(opts_t) opts;
 	MACH0_(opts_set_default) (&opts, bf);
 	opts.header_at = bin->header_at;
+	opts.sections_only = sections_only;
 	struct MACH0_(obj_t) *mach0 = MACH0_(new_buf) (cache->buf, &opts);
+	if (!mach0) {
+		return NULL;
+	}
 	mach0->user = cache;
 	mach0->va2pa = &bin_obj_va2pa;
 	return mach0;
@@ -263,6 +276,7 @@ static ut64 estimate_slide(RBinFile *bf, RDyldCache *cache, ut64 value_mask) {
 		struct MACH0_(opts_t) opts;
 		opts.verbose = bf->rbin->verbose;
 		opts.header_at = bin->header_at;
+		opts.sections_only = true;
 
 		struct MACH0_(obj_t) *mach0 = MACH0_(new_buf) (cache->buf, &opts);
 		if (!mach0) {
@@ -1220,7 +1234,7 @@ static ut64 baddr(RBinFile *bf) {
 }
 
 void symbols_from_bin(RList *ret, RBinFile *bf, RDyldBinImage *bin) {
-	struct MACH0_(obj_t) *mach0 = bin_to_mach0 (bf, bin);
+	struct MACH0_(obj_t) *mach0 = bin_to_mach0 (bf, bin, false);
 	if (!mach0) {
 		return;
 	}
@@ -1228,6 +1242,7 @@ void symbols_from_bin(RList *ret, RBinFile *bf, RDyldBinImage *bin) {
 	// const RList*symbols = MACH0_(get_symbols_list) (mach0);
 	const struct symbol_t *symbols = MACH0_(get_symbols) (mach0);
 	if (!symbols) {
+		MACH0_(mach0_free) (mach0);
 		return;
 	}
 	int i;
@@ -1293,14 +1308,15 @@ static bool __is_data_section(const char *name) {
 	return false;
 }
 
-static void sections_from_bin(RList *ret, RBinFile *bf, RDyldBinImage *bin) {
-	struct MACH0_(obj_t) *mach0 = bin_to_mach0 (bf, bin);
+static void sections_from_bin(RList *ret, RBinFile *bf, RDyldBinImage *bin, RVector *images) {
+	struct MACH0_(obj_t) *mach0 = bin_to_mach0 (bf, bin, true);
 	if (!mach0) {
 		return;
 	}
 
 	struct section_t *sections = NULL;
 	if (!(sections = MACH0_(get_sections) (mach0))) {
+		MACH0_(mach0_free) (mach0);
 		return;
 	}
 
@@ -1329,11 +1345,34 @@ static void sections_from_bin(RList *ret, RBinFile *bf, RDyldBinImage *bin) {
 		}
 		ptr->perm = sections[i].perm;
 		r_list_append (ret, ptr);
+		if (images && sections[i].addr && sections[i].vsize) {
+			RDyldImageRange range = { sections[i].addr, sections[i].addr + sections[i].vsize, bin };
+			r_vector_push (images, &range);
+		}
 	}
 	free (sections);
 	MACH0_(mach0_free) (mach0);
 }
 
+static int image_range_cmp(const void *a, const void *b) {
+	const RDyldImageRange *ra = a, *rb = b;
+	return (ra->from > rb->from) - (ra->from < rb->from);
+}
+
+static RDyldBinImage *image_at(RDyldCache *cache, ut64 addr) {
+	RDyldImageRange *ranges = cache->images->a;
+	size_t lo = 0, hi = cache->images->len;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (ranges[mid].from <= addr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return (lo && addr < ranges[lo - 1].to)? ranges[lo - 1].bin: NULL;
+}
+
 static RList *sections(RBinFile *bf) {
 	RDyldCache *cache = (RDyldCache*) bf->o->bin_obj;
 	if (!cache) {
@@ -1345,10 +1384,17 @@ static RList *sections(RBinFile *bf) {
 		return NULL;
 	}
 
+	// the address ranges of the images come for free while their load
+	// commands are parsed, image_symbols looks them up
+	RVector *images = cache->images? NULL: r_vector_new (sizeof (RDyldImageRange), NULL, NULL);
 	RListIter *iter;
 	RDyldBinImage *bin;
 	r_list_foreach (cache->bins, iter, bin) {
-		sections_from_bin (ret, bf, bin);
+		sections_from_bin (ret, bf, bin, images);
+	}
+	if (images) {
+		qsort (images->a, images->len, images->elem_size, image_range_cmp);
+		cache->images = images;
 	}
 
 	RBinSection *ptr = NULL;
@@ -1393,6 +1439,7 @@ static RList *symbols(RBinFile *bf) {
 	RDyldBinImage *bin;
 	r_list_foreach (cache->bins, iter, bin) {
 		symbols_from_bin (ret, bf, bin);
+		bin->symbols_loaded = true;
 	}
 
 	if (cache->rebase_info->slide > 0) {
@@ -1405,6 +1452,41 @@ static RList *symbols(RBinFile *bf) {
 	return ret;
 }
 
+// Decoding the symbols of every image takes most of the time spent opening a
+// cache, so they can be asked one image at a time, as addresses get visited
+static RList *image_symbols(RBinFile *bf, ut64 vaddr) {
+	RDyldCache *cache = (RDyldCache*) bf->o->bin_obj;
+	if (!cache) {
+		return NULL;
+	}
+	if (!cache->images) {
+		r_list_free (sections (bf));
+		if (!cache->images) {
+			return NULL;
+		}
+	}
+	ut64 slide = cache->rebase_info->slide;
+	RDyldBinImage *bin = image_at (cache, vaddr - slide);
+	if (!bin || bin->symbols_loaded) {
+		return NULL;
+	}
+	bin->symbols_loaded = true;
+
+	RList *ret = r_list_newf (free);
+	if (!ret) {
+		return NULL;
+	}
+	symbols_from_bin (ret, bf, bin);
+	if (slide > 0) {
+		RListIter *iter;
+		RBinSymbol *sym;
+		r_list_foreach (ret, iter, sym) {
+			sym->vaddr += slide;
+		}
+	}
+	return ret;
+}
+
 /* static void unswizzle_io_read(RDyldCache *cache, RIO *io) {
 	if (!io || !io->desc || !io->desc->plugin || !cache->original_io_read) {
 		return;
@@ -1438,7 +1520,7 @@ static RList *classes(RBinFile *bf) {
 	RBuffer *orig_buf = bf->buf;
 	ut32 num_of_unnamed_class = 0;
 	r_list_foreach (cache->bins, iter, bin) {
-		struct MACH0_(obj_t) *mach0 = bin_to_mach0 (bf, bin);
+		struct MACH0_(obj_t) *mach0 = bin_to_mach0 (bf, bin, true);
 		if (!mach0) {
 			goto beach;
 		}
@@ -1604,6 +1686,7 @@ RBinPlugin r_bin_plugin_dyldcache = {
 	.entries = &entries,
 	.baddr = &baddr,
 	.symbols = &symbols,
+	.image_symbols = &image_symbols,
 	.sections = &sections,
 	.check_buffer = &check_buffer,
 	.destroy = &destroy,
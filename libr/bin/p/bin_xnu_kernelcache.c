@@ -28,6 +28,10 @@ typedef struct _RKernelCacheObj {
 	bool rebase_info_populated;
 	bool rebasing_buffer;
 	bool kexts_initialized;
+	HtPP *kernel_syms_by_addr; // names of the kernel symbols, the kext stubs point to them
+	RList *kernel_symbols; // built with kernel_syms_by_addr, until image_symbols hands them out
+	ut64 *kmod_inits;
+	ut64 *kmod_terms;
 } RKernelCacheObj;
 
 typedef struct _RFileRange {
@@ -55,6 +59,7 @@ typedef struct _RKext {
 	ut64 vaddr;
 	struct MACH0_(obj_t) *mach0;
 	bool own_name;
+	bool symbols_loaded;
 	ut64 pa2va_exec;
 	ut64 pa2va_data;
 } RKext;
@@ -150,7 +155,7 @@ static int prot2perm (int x);
 static void r_kext_free(RKext *kext);
 static void r_kext_fill_text_range(RKext *kext);
 static int kexts_sort_vaddr_func(const void *a, const void *b);
-static struct MACH0_(obj_t) *create_kext_mach0(RKernelCacheObj *obj, RKext *kext);
+static struct MACH0_(obj_t) *create_kext_mach0(RKernelCacheObj *obj, RKext *kext, bool sections_only);
 
 #define r_kext_index_foreach(index, i, item)\
 	if (index)\
@@ -384,7 +389,7 @@ static RList *filter_kexts(RKernelCacheObj *obj) {
 		}
 		prev_kext = kext;
 
-		kext->mach0 = create_kext_mach0 (obj, kext);
+		kext->mach0 = create_kext_mach0 (obj, kext, true);
 		if (!kext->mach0) {
 			r_kext_free (kext);
 			continue;
@@ -511,7 +516,7 @@ static RList *carve_kexts(RKernelCacheObj *obj) {
 		kext->vaddr = K_RPTR (bytes);
 		kext->range.offset = kext->vaddr - pa2va_exec;
 
-		kext->mach0 = create_kext_mach0 (obj, kext);
+		kext->mach0 = create_kext_mach0 (obj, kext, true);
 		if (!kext->mach0) {
 			r_kext_free (kext);
 			continue;
@@ -666,6 +671,9 @@ static RKext *r_kext_index_vget(RKextIndex *index, ut64 vaddr) {
 		}
 	}
 
+	if (imax < 0) {
+		return NULL;
+	}
 	RKext *minEntry = index->entries[imin];
 	if ((imax == imin) && (minEntry->vaddr <= vaddr) && ((minEntry->vaddr + minEntry->text_range.size) > vaddr)) {
 		return minEntry;
@@ -673,11 +681,14 @@ static RKext *r_kext_index_vget(RKextIndex *index, ut64 vaddr) {
 	return NULL;
 }
 
-static struct MACH0_(obj_t) *create_kext_mach0(RKernelCacheObj *obj, RKext *kext) {
+// the kext index only needs the layout of each kext, their symbol tables are
+// parsed when their symbols are asked for
+static struct MACH0_(obj_t) *create_kext_mach0(RKernelCacheObj *obj, RKext *kext, bool sections_only) {
 	RBuffer *buf = r_buf_new_slice (obj->cache_buf, kext->range.offset, r_buf_size (obj->cache_buf) - kext->range.offset);
 	struct MACH0_(opts_t) opts;
 	opts.verbose = true;
 	opts.header_at = 0;
+	opts.sections_only = sections_only;
 	struct MACH0_(obj_t) *mach0 = MACH0_(new_buf) (buf, &opts);
 	r_buf_free (buf);
 	if (!mach0) {
@@ -1017,22 +1028,11 @@ static void handle_data_sections(RBinSection *sect) {
 	}
 }
 
-static RList *symbols(RBinFile *bf) {
-	RList *ret = r_list_newf (free);
-	if (!ret) {
-		return NULL;
-	}
-
-	RKernelCacheObj *obj = (RKernelCacheObj*) bf->o->bin_obj;
-
+// the kernel symbols, with the syscalls and the mig routines, every kext stub
+// is named after the kernel symbol it points to
+static void kernel_symbols(RList *ret, RKernelCacheObj *obj, RBinFile *bf, HtPP *kernel_syms_by_addr) {
 	symbols_from_mach0 (ret, obj->mach0, bf, 0, 0);
 
-	HtPP *kernel_syms_by_addr = sdb_ht_new ();
-	if (!kernel_syms_by_addr) {
-		r_list_free (ret);
-		return NULL;
-	}
-
 	RListIter *iter;
 	RBinSymbol *sym;
 	ut64 enosys_addr = 0;
@@ -1065,36 +1065,92 @@ static RList *symbols(RBinFile *bf) {
 		subsystem->free = NULL;
 		r_list_free (subsystem);
 	}
+}
+
+static void kext_symbols(RList *ret, RKernelCacheObj *obj, RBinFile *bf, RKext *kext, HtPP *kernel_syms_by_addr) {
+	ut8 magicbytes[4];
+	r_buf_read_at (obj->cache_buf, kext->range.offset, magicbytes, 4);
+	int magic = r_read_le32 (magicbytes);
+	switch (magic) {
+	case MH_MAGIC_64: {
+		struct MACH0_(obj_t) *mach0 = create_kext_mach0 (obj, kext, false);
+		if (mach0) {
+			symbols_from_mach0 (ret, mach0, bf, kext->range.offset, r_list_length (ret));
+			MACH0_(mach0_free) (mach0);
+		}
+		symbols_from_stubs (ret, kernel_syms_by_addr, obj, bf, kext, r_list_length (ret));
+		process_constructors (obj, kext->mach0, ret, kext->range.offset, false, R_K_CONSTRUCTOR_TO_SYMBOL, kext_short_name (kext));
+		process_kmod_init_term (obj, kext, ret, &obj->kmod_inits, &obj->kmod_terms);
+		break;
+	}
+	default:
+		eprintf ("Unknown sub-bin\n");
+		break;
+	}
+	kext->symbols_loaded = true;
+}
+
+static RList *symbols(RBinFile *bf) {
+	RList *ret = r_list_newf (free);
+	if (!ret) {
+		return NULL;
+	}
+
+	RKernelCacheObj *obj = (RKernelCacheObj*) bf->o->bin_obj;
+
+	HtPP *kernel_syms_by_addr = sdb_ht_new ();
+	if (!kernel_syms_by_addr) {
+		r_list_free (ret);
+		return NULL;
+	}
+	kernel_symbols (ret, obj, bf, kernel_syms_by_addr);
 
 	ensure_kexts_initialized (obj);
 
 	RKext *kext;
 	int kiter;
-	ut64 *inits = NULL;
-	ut64 *terms = NULL;
 	r_kext_index_foreach (obj->kexts, kiter, kext) {
-		ut8 magicbytes[4];
-		r_buf_read_at (obj->cache_buf, kext->range.offset, magicbytes, 4);
-		int magic = r_read_le32 (magicbytes);
-		switch (magic) {
-		case MH_MAGIC_64:
-			symbols_from_mach0 (ret, kext->mach0, bf, kext->range.offset, r_list_length (ret));
-			symbols_from_stubs (ret, kernel_syms_by_addr, obj, bf, kext, r_list_length (ret));
-			process_constructors (obj, kext->mach0, ret, kext->range.offset, false, R_K_CONSTRUCTOR_TO_SYMBOL, kext_short_name (kext));
-			process_kmod_init_term (obj, kext, ret, &inits, &terms);
+		kext_symbols (ret, obj, bf, kext, kernel_syms_by_addr);
+	}
 
-			break;
-		default:
-			eprintf ("Unknown sub-bin\n");
-			break;
+	sdb_ht_free (kernel_syms_by_addr);
+
+	return ret;
+}
+
+// A kernelcache holds a few hundred kexts, their symbols can be asked one kext
+// at a time as their addresses get visited. The kernel symbols go along with
+// the first request because the kext stubs are named after them, and are
+// handed out for any address outside the kexts
+static RList *image_symbols(RBinFile *bf, ut64 vaddr) {
+	RKernelCacheObj *obj = (RKernelCacheObj*) bf->o->bin_obj;
+	if (!obj) {
+		return NULL;
+	}
+	if (!obj->kernel_syms_by_addr) {
+		obj->kernel_syms_by_addr = sdb_ht_new ();
+		obj->kernel_symbols = r_list_newf (free);
+		if (!obj->kernel_syms_by_addr || !obj->kernel_symbols) {
+			return NULL;
 		}
+		kernel_symbols (obj->kernel_symbols, obj, bf, obj->kernel_syms_by_addr);
 	}
 
-	R_FREE (inits);
-	R_FREE (terms);
-
-	sdb_ht_free (kernel_syms_by_addr);
+	ensure_kexts_initialized (obj);
 
+	RKext *kext = obj->kexts? r_kext_index_vget (obj->kexts, vaddr): NULL;
+	if (!kext) {
+		RList *ret = obj->kernel_symbols;
+		obj->kernel_symbols = NULL;
+		return ret;
+	}
+	if (kext->symbols_loaded) {
+		return NULL;
+	}
+	RList *ret = r_list_newf (free);
+	if (ret) {
+		kext_symbols (ret, obj, bf, kext, obj->kernel_syms_by_addr);
+	}
 	return ret;
 }
 
@@ -1682,6 +1738,10 @@ static void r_kernel_cache_free(RKernelCacheObj *obj) {
 		obj->rebase_info = NULL;
 	}
 
+	sdb_ht_free (obj->kernel_syms_by_addr);
+	r_list_free (obj->kernel_symbols);
+	R_FREE (obj->kmod_inits);
+	R_FREE (obj->kmod_terms);
 	R_FREE (obj);
 }
 
@@ -2006,6 +2066,7 @@ RBinPlugin r_bin_plugin_xnu_kernelcache = {
 	.entries = &entries,
 	.baddr = &baddr,
 	.symbols = &symbols,
+	.image_symbols = &image_symbols,
 	.sections = &sections,
 	.check_buffer = &check_buffer,
 	.info = &info
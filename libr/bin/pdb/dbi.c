@@ -10,6 +10,9 @@ static void free_dbi_stream(void *stream) {
 	SDbiStream *t = (SDbiStream *) stream;
 	SDBIExHeader *dbi_ex_header = 0;
 
+	if (!t->dbiexhdrs) {
+		return;
+	}
 	RListIter *it = r_list_iterator(t->dbiexhdrs);
 	while (r_list_iter_next(it)) {
 		dbi_ex_header = (SDBIExHeader *) r_list_iter_get(it);
@@ -115,26 +118,56 @@ void init_dbi_stream(SDbiStream *dbi_stream) {
 	dbi_stream->free_ = free_dbi_stream;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// only the headers are read, the module infos are skipped until they are
+/// asked for and the stream indices in the debug header are all that is
+/// needed to find the other streams
 ///////////////////////////////////////////////////////////////////////////////
 void parse_dbi_stream(void *parsed_pdb_stream, R_STREAM_FILE *stream_file) {
 	SDbiStream *dbi_stream = (SDbiStream *) parsed_pdb_stream;
-	SDBIExHeader *dbi_ex_header = 0;
 	int pos = 0;
-	char *dbiexhdr_data = 0, *p_tmp = 0;
-	int size = 0, sz = 0;
-	int i = 0;
 
 	parse_dbi_header (&dbi_stream->dbi_header, stream_file);
 	pos += sizeof (SDBIHeader) - 2;	// 2 because enum in C equal to 4, but
 									// to read just 2;
-	stream_file_seek (stream_file, pos, 0);
+	dbi_stream->dbiexhdrs_pos = pos;
+	dbi_stream->stream = *stream_file;
+	stream_file_seek (stream_file, pos + dbi_stream->dbi_header.module_size, 0);
 
+	// "Section Contribution"
+	stream_file_seek(stream_file, dbi_stream->dbi_header.seccon_size, 1);
+	// "Section Map"
+	stream_file_seek(stream_file, dbi_stream->dbi_header.secmap_size, 1);
+	// "File Info"
+	stream_file_seek(stream_file, dbi_stream->dbi_header.filinf_size, 1);
+	// "TSM"
+	stream_file_seek(stream_file, dbi_stream->dbi_header.tsmap_size, 1);
+	// "EC"
+	stream_file_seek(stream_file, dbi_stream->dbi_header.ecinfo_size, 1);
+
+	parse_dbg_header(&dbi_stream->dbg_header, stream_file);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+RList *dbi_stream_get_modules(SDbiStream *dbi_stream) {
+	SDBIExHeader *dbi_ex_header = 0;
+	char *dbiexhdr_data = 0, *p_tmp = 0;
+	int size = 0, sz = 0;
+	int i = 0;
+
+	if (dbi_stream->dbiexhdrs) {
+		return dbi_stream->dbiexhdrs;
+	}
 	size = dbi_stream->dbi_header.module_size;
-	dbiexhdr_data = (char *) malloc(size);
+	if (size < 0) {
+		return NULL;
+	}
+	dbiexhdr_data = (char *) malloc (R_MAX (size, 1));
 	if (!dbiexhdr_data) {
-		return;
+		return NULL;
 	}
-	stream_file_read (stream_file, size, dbiexhdr_data);
+	stream_file_seek (&dbi_stream->stream, dbi_stream->dbiexhdrs_pos, 0);
+	stream_file_read (&dbi_stream->stream, size, dbiexhdr_data);
 
 	dbi_stream->dbiexhdrs = r_list_new();
 	p_tmp = dbiexhdr_data;
@@ -145,6 +178,10 @@ void parse_dbi_stream(void *parsed_pdb_stream, R_STREAM_FILE *stream_file) {
 		}
 		// TODO: rewrite for signature where can to do chech CAN_READ true?
 		sz = parse_dbi_ex_header (p_tmp, size, dbi_ex_header);
+		if (sz <= 0) {
+			free (dbi_ex_header);
+			break;
+		}
 		if ((sz % PDB_ALIGN)) {
 			sz = sz + (PDB_ALIGN - (sz % PDB_ALIGN));
 		}
@@ -154,17 +191,5 @@ void parse_dbi_stream(void *parsed_pdb_stream, R_STREAM_FILE *stream_file) {
 	}
 
 	free (dbiexhdr_data);
-
-	// "Section Contribution"
-	stream_file_seek(stream_file, dbi_stream->dbi_header.seccon_size, 1);
-	// "Section Map"
-	stream_file_seek(stream_file, dbi_stream->dbi_header.secmap_size, 1);
-	// "File Info"
-	stream_file_seek(stream_file, dbi_stream->dbi_header.filinf_size, 1);
-	// "TSM"
-	stream_file_seek(stream_file, dbi_stream->dbi_header.tsmap_size, 1);
-	// "EC"
-	stream_file_seek(stream_file, dbi_stream->dbi_header.ecinfo_size, 1);
-
-	parse_dbg_header(&dbi_stream->dbg_header, stream_file);
+	return dbi_stream->dbiexhdrs;
 }
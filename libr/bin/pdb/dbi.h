@@ -4,4 +4,8 @@
 void init_dbi_stream(SDbiStream *dbi_stream);
 void parse_dbi_stream(void *parsed_pdb_stream, R_STREAM_FILE *stream_file);
 
+// decodes the module infos on first use
+///////////////////////////////////////////////////////////////////////////////
+RList *dbi_stream_get_modules(SDbiStream *dbi_stream);
+
 #endif // DBI_H
@@ -20,65 +20,110 @@ static int parse_global(char *data, int data_size, SGlobal *global) {
 	return read_bytes;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// only the offsets of the public symbol records are kept, a record is
+/// decoded the first time it is asked for, so looking up a few of them does
+/// not touch the pages of the others
 ///////////////////////////////////////////////////////////////////////////////
 void parse_gdata_stream(void *stream, R_STREAM_FILE *stream_file) {
-	unsigned short len = 0;
-	unsigned short leaf_type = 0;
-	char *data = 0;
+	unsigned short hdr[2];
 	SGDATAStream *data_stream = (SGDATAStream *) stream;
-	SGlobal *global = 0;
+	ut32 size = 0;
 
-	data_stream->globals_list = r_list_new ();
 	while (1) {
-		stream_file_read (stream_file, 2, (char *)&len);
-		if (len == 0) {
+		int pos = stream_file_tell (stream_file);
+		hdr[0] = 0;
+		stream_file_read (stream_file, sizeof (hdr), (char *)hdr);
+		if (hdr[0] < 2 || pos + 2 + hdr[0] > stream_file->end) {
 			break;
 		}
-		data = (char *) malloc (len);
-		if (!data) {
-			return;
-		}
-		stream_file_read (stream_file, len, data);
-
-		leaf_type = *(unsigned short *) (data);
-		if ((leaf_type == 0x110E) || (leaf_type == 0x1009)) {
-			global = (SGlobal *) malloc(sizeof(SGlobal));
-			if (!global) {
-				free (data);
-				return;
+		if ((hdr[1] == 0x110E) || (hdr[1] == 0x1009)) {
+			if (data_stream->count == size) {
+				size = size? size * 2: 256;
+				ut32 *offsets = realloc (data_stream->offsets, size * sizeof (ut32));
+				if (!offsets) {
+					break;
+				}
+				data_stream->offsets = offsets;
 			}
-			global->leaf_type = leaf_type;
-			parse_global (data + 2, len, global);
-			r_list_append (data_stream->globals_list, global);
+			data_stream->offsets[data_stream->count++] = pos;
 		}
+		stream_file_seek (stream_file, pos + 2 + hdr[0], 0);
+	}
+	data_stream->globals = R_NEWS0 (SGlobal *, R_MAX (data_stream->count, 1));
+	if (!data_stream->globals) {
+		data_stream->count = 0;
+	}
+	data_stream->stream = *stream_file;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SGlobal *gdata_stream_get(SGDATAStream *data_stream, ut32 i) {
+	unsigned short len = 0;
+	char *data;
+	SGlobal *global;
+
+	if (i >= data_stream->count) {
+		return NULL;
+	}
+	if (data_stream->globals[i]) {
+		return data_stream->globals[i];
+	}
+	stream_file_seek (&data_stream->stream, data_stream->offsets[i], 0);
+	stream_file_read (&data_stream->stream, 2, (char *)&len);
+	data = (char *) malloc (len);
+	if (!data) {
+		return NULL;
+	}
+	stream_file_read (&data_stream->stream, len, data);
+	global = R_NEW0 (SGlobal);
+	if (!global) {
 		free (data);
+		return NULL;
+	}
+	global->leaf_type = *(unsigned short *) (data);
+	parse_global (data + 2, len, global);
+	free (data);
+	if (!global->name.name) {
+		global->name.name = strdup ("");
 	}
+	data_stream->globals[i] = global;
+	return global;
+}
 
-	// TODO: for more fast access
-//	for g in self.globals:
-//        if not hasattr(g, 'symtype'): continue
-//        if g.symtype == 0:
-//            if g.name.startswith("_"):
-//                self.vars[g.name[1:]] = g
-//            else:
-//                self.vars[g.name] = g
-//        elif g.symtype == 2:
-//            self.funcs[g.name] = g
+///////////////////////////////////////////////////////////////////////////////
+/// the name index decodes every record once, on the first lookup
+///////////////////////////////////////////////////////////////////////////////
+int gdata_stream_find(SGDATAStream *data_stream, const char *name) {
+	ut32 i;
+
+	if (!data_stream->names) {
+		if (!(data_stream->names = ht_pp_new0 ())) {
+			return -1;
+		}
+		for (i = 0; i < data_stream->count; i++) {
+			SGlobal *global = gdata_stream_get (data_stream, i);
+			if (global) {
+				ht_pp_insert (data_stream->names, global->name.name, (void *)(size_t)(i + 1));
+			}
+		}
+	}
+	return (int)(size_t)ht_pp_find (data_stream->names, name, NULL) - 1;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void free_gdata_stream(void *stream) {
 	SGDATAStream *data_stream = (SGDATAStream *) stream;
-	SGlobal *global = 0;
-	RListIter *it = 0;
+	ut32 i;
 
-	it = r_list_iterator(data_stream->globals_list);
-	while (r_list_iter_next(it)) {
-		global = (SGlobal *) r_list_iter_get(it);
-		if (global->name.name) {
+	ht_pp_free (data_stream->names);
+	for (i = 0; data_stream->globals && i < data_stream->count; i++) {
+		SGlobal *global = data_stream->globals[i];
+		if (global) {
 			free (global->name.name);
+			free (global);
 		}
-		free (global);
 	}
-	r_list_free (data_stream->globals_list);
+	free (data_stream->globals);
+	free (data_stream->offsets);
 }
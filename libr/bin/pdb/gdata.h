@@ -4,4 +4,12 @@
 void parse_gdata_stream(void *stream, R_STREAM_FILE *stream_file);
 void free_gdata_stream(void *stream);
 
+// decodes the i-th public symbol on first use, NULL if it can't
+///////////////////////////////////////////////////////////////////////////////
+SGlobal *gdata_stream_get(SGDATAStream *data_stream, ut32 i);
+
+// index of the public symbol called name, -1 if there is none
+///////////////////////////////////////////////////////////////////////////////
+int gdata_stream_find(SGDATAStream *data_stream, const char *name);
+
 #endif // GDATA_H
@@ -337,6 +337,15 @@ static int pdb_read_root(R_PDB *pdb) {
 		page = (SPage *) r_list_iter_get (it);
 		if (page->stream_pages == 0) {
 			//eprintf ("Warning: no stream pages. Skipping.\n");
+			if (i == ePDB_STREAM_ROOT) {
+				// the old directory is empty in pdbs written by lld, keep
+				// its slot so the other streams are found at their index
+				pdb_stream = R_NEW0 (R_PDB_STREAM);
+				if (!pdb_stream) {
+					return 0;
+				}
+				r_list_append (pList, pdb_stream);
+			}
 			i++;
 			continue;
 		}
@@ -558,12 +567,16 @@ static void finish_pdb_parse(R_PDB *pdb) {
 			break;
 		case 2:
 			tpi_stream = (STpiStream *) r_list_iter_get (it);
-			free_pdb_stream (tpi_stream);
+			if (tpi_stream->free_) {
+				tpi_stream->free_ (tpi_stream);
+			}
 			free (tpi_stream);
 			break;
 		case 3:
 			dbi_stream = (SDbiStream *) r_list_iter_get (it);
-			free_pdb_stream (dbi_stream);
+			if (dbi_stream->free_) {
+				dbi_stream->free_ (dbi_stream);
+			}
 			free (dbi_stream);
 			break;
 		default:
@@ -898,7 +911,8 @@ static void print_types(R_PDB *pdb, int mode) {
 	int offset = 0;
 	SType *t = 0;
 	STypeInfo *tf = 0;
-	RListIter *it = 0, *it2 = 0;
+	RListIter *it2 = 0;
+	ut32 ti, ti_min, ti_max;
 	RList *plist = pdb->pdb_streams, *ptmp = NULL;
 	STpiStream *tpi_stream = r_list_get_n (plist, ePDB_STREAM_TPI);
 
@@ -906,18 +920,31 @@ static void print_types(R_PDB *pdb, int mode) {
 		eprintf ("There is no tpi stream in current pdb\n");
 		return;
 	}
+	ti_min = tpi_stream->header.ti_min;
+	ti_max = tpi_stream->header.ti_max;
+	if (pdb->name) {
+		ti_min = tpi_stream_find_type (tpi_stream, pdb->name);
+		ti_max = ti_min? ti_min + 1: 0;
+	}
 
 	if (mode == 'j') {
 		pdb->cb_printf ("{\"%s\":[", "types");
 	}
 
-	it = r_list_iterator (tpi_stream->types);
-	while (r_list_iter_next (it)) {
+	for (ti = ti_min; ti < ti_max; ti++) {
 		pos = 0;
 		i = 0;
 		members_amount = 0;
 		val = 0;
-		t = (SType *) r_list_iter_get (it);
+		// only the user defined types are printed, skip the rest undecoded
+		lt = tpi_stream_get_leaf_type (tpi_stream, ti);
+		if (lt != eLF_STRUCTURE && lt != eLF_UNION && lt != eLF_ENUM) {
+			continue;
+		}
+		t = tpi_stream_get_type (tpi_stream, ti);
+		if (!t) {
+			continue;
+		}
 		tf = &t->type_data;
 		lt = tf->leaf_type;
 		if ((tf->leaf_type == eLF_STRUCTURE) || (tf->leaf_type == eLF_UNION) || (tf->leaf_type == eLF_ENUM)) {
@@ -1074,6 +1101,7 @@ static void print_gvars(R_PDB *pdb, ut64 img_base, int format) {
 	RList *l = 0;
 	char *name;
 	int is_first = 1;
+	int i, first, end;
 
 	l = pdb->pdb_streams2;
 	it = r_list_iterator (l);
@@ -1114,9 +1142,16 @@ static void print_gvars(R_PDB *pdb, ut64 img_base, int format) {
 	if (!pe_stream) {
 		return;
 	}
-	it = r_list_iterator (gsym_data_stream->globals_list);
-	while (r_list_iter_next (it)) {
-		gdata = (SGlobal *) r_list_iter_get (it);
+	first = 0;
+	end = gsym_data_stream->count;
+	if (pdb->name) {
+		first = gdata_stream_find (gsym_data_stream, pdb->name);
+		end = first < 0? first: first + 1;
+	}
+	for (i = first; i < end; i++) {
+		if (!(gdata = gdata_stream_get (gsym_data_stream, i))) {
+			continue;
+		}
 		sctn_header = r_list_get_n (pe_stream->sections_hdrs, (gdata->segment - 1));
 		if (sctn_header) {
 			name = r_bin_demangle_msvc (gdata->name.name);
@@ -1179,7 +1214,7 @@ R_API bool init_pdb_parser(R_PDB *pdb, const char *filename) {
 	if (!pdb->cb_printf) {
 		pdb->cb_printf = (PrintfCallback) printf;
 	}
-	pdb->buf = r_buf_new_slurp (filename);
+	pdb->buf = r_buf_new_mmap (filename, R_PERM_R);
 	if (!pdb->buf) {
 		eprintf ("File reading error/empty file\n");
 		goto error;
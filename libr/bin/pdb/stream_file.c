@@ -21,52 +21,42 @@ int init_r_stream_file(R_STREAM_FILE *stream_file, RBuffer *buf, int *pages, int
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-static void stream_file_read_pages(R_STREAM_FILE *stream_file, int start_indx, int end_indx, char *res) {
-	int i, page_offset;
-
-	if ((end_indx - start_indx) > stream_file->end) {
-		stream_file->error = READ_PAGE_FAIL;
-		return;
-	}
-	end_indx = R_MIN (end_indx, stream_file->pages_amount);
-
-	for (i = start_indx; i < end_indx; i++) {
-		page_offset = stream_file->pages[i] * stream_file->page_size;
-		if (page_offset < 1) {
-			return;
+/// copies the bytes at stream_file->pos straight from the pages holding them,
+/// so reading a record only touches its own pages of the (mmaped) file.
+/// missing pages read as zeroes
+///////////////////////////////////////////////////////////////////////////////
+static void stream_file_read_at(R_STREAM_FILE *stream_file, int pos, int size, char *res) {
+	const ut64 page_size = stream_file->page_size;
+	while (size > 0) {
+		int pn, off;
+		GET_PAGE (pn, off, pos, stream_file->page_size);
+		int n = R_MIN (stream_file->page_size - off, size);
+		ut64 page_offset = (pn < stream_file->pages_amount)
+			? (ut64)(ut32)stream_file->pages[pn] * page_size: 0;
+		int r = page_offset? r_buf_read_at (stream_file->buf, page_offset + off, (ut8 *)res, n): 0;
+		if (r < n) {
+			memset (res + R_MAX (r, 0), 0, n - R_MAX (r, 0));
 		}
-		r_buf_seek (stream_file->buf, page_offset, R_BUF_SET);
-		r_buf_read_at (stream_file->buf, page_offset,
-			(ut8 *)res, stream_file->page_size);
-		res += stream_file->page_size;
+		res += n;
+		pos += n;
+		size -= n;
 	}
 }
 
 // size by default = -1
 ///////////////////////////////////////////////////////////////////////////////
 void stream_file_read(R_STREAM_FILE *stream_file, int size, char *res) {
-	int pn_start, off_start, pn_end, off_end;
+	if (stream_file->page_size < 1 || stream_file->pos < 0) {
+		stream_file->error = READ_PAGE_FAIL;
+		return;
+	}
 	if (size == -1) {
-		char *pdata = (char *) malloc(stream_file->pages_amount * stream_file->page_size);
-		if (pdata) {
-			GET_PAGE(pn_start, off_start, stream_file->pos, stream_file->page_size);
-			(void)off_end; // hack to remove unused warning
-			stream_file_read_pages (stream_file, 0, stream_file->pages_amount, pdata);
-			stream_file->pos = stream_file->end;
-			memcpy (res, pdata + off_start, stream_file->end - off_start);
-			free (pdata);
-		}
+		stream_file_read_at (stream_file, stream_file->pos,
+			stream_file->end - stream_file->pos, res);
+		stream_file->pos = stream_file->end;
 	} else {
-		GET_PAGE(pn_start, off_start, stream_file->pos, stream_file->page_size);
-		GET_PAGE(pn_end, off_end, stream_file->pos + size, stream_file->page_size);
-		(void)off_end; // hack to remove unused warning
-		char *pdata = (char *) calloc(stream_file->page_size * (pn_end + 1 - pn_start), 1);
-		if (pdata) {
-			stream_file_read_pages(stream_file, pn_start, pn_end + 1, pdata);
-			stream_file->pos += size;
-			memcpy(res, pdata + off_start, size);
-			free (pdata);
-		}
+		stream_file_read_at (stream_file, stream_file->pos, size, res);
+		stream_file->pos += size;
 	}
 }
 
@@ -3,7 +3,9 @@
 #include "stream_file.h"
 
 static unsigned int base_idx = 0;
-static RList *p_types_list;
+static STpiStream *p_tpi;
+
+static SType *tpi_type_at(unsigned int i);
 
 static void print_base_type(EBASE_TYPES base_type, char **name) {
 	switch (base_type) {
@@ -236,7 +238,7 @@ static int get_array_element_type(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -252,7 +254,7 @@ static int get_array_index_type(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -268,7 +270,7 @@ static int get_bitfield_base_type(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -284,7 +286,7 @@ static int get_class_struct_derived(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -300,7 +302,7 @@ static int get_class_struct_vshape(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -316,7 +318,7 @@ static int get_mfunction_return_type(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -332,7 +334,7 @@ static int get_mfunction_class_type(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -348,7 +350,7 @@ static int get_mfunction_this_type(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -364,7 +366,7 @@ static int get_mfunction_arglist(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -380,7 +382,7 @@ static int get_modifier_modified_type(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -396,7 +398,7 @@ static int get_pointer_utype(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -412,7 +414,7 @@ static int get_procedure_return_type(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -428,7 +430,7 @@ static int get_procedure_arglist(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -444,7 +446,7 @@ static int get_member_index(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -460,7 +462,7 @@ static int get_nesttype_index(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -476,7 +478,7 @@ static int get_onemethod_index(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -491,7 +493,7 @@ static int get_method_mlist(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -506,7 +508,7 @@ static int get_enum_utype(void *type, void **ret_type) {
 		*ret_type = 0;
 	} else {
 		curr_idx -= base_idx;
-		*ret_type = r_list_get_n(p_types_list, curr_idx);
+		*ret_type = tpi_type_at (curr_idx);
 	}
 
 	return curr_idx;
@@ -529,8 +531,9 @@ static void get_union_members(void *type, RList **l) {
 	} else {
 		SType *tmp = 0;
 		indx = lf_union->field_list - base_idx;
-		tmp = (SType *)r_list_get_n(p_types_list, indx);
-		*l = ((SLF_FIELDLIST *) tmp->type_data.type_info)->substructs;
+		tmp = tpi_type_at (indx);
+		*l = (tmp && tmp->type_data.type_info)
+			? ((SLF_FIELDLIST *) tmp->type_data.type_info)->substructs: 0;
 	}
 }
 
@@ -545,9 +548,9 @@ static void get_struct_class_members(void *type, RList **l) {
 	} else {
 		SType *tmp = 0;
 		indx = lf->field_list - base_idx;
-		tmp = (SType *)r_list_get_n(p_types_list, indx);
-		lf_fieldlist = (SLF_FIELDLIST *) tmp->type_data.type_info;
-		*l = lf_fieldlist->substructs;
+		tmp = tpi_type_at (indx);
+		lf_fieldlist = tmp? (SLF_FIELDLIST *) tmp->type_data.type_info: 0;
+		*l = lf_fieldlist? lf_fieldlist->substructs: 0;
 	}
 }
 
@@ -561,8 +564,9 @@ static void get_enum_members(void *type, RList **l) {
 	} else {
 		SType *tmp = 0;
 		indx = lf->field_list - base_idx;
-		tmp = (SType *)r_list_get_n(p_types_list, indx);
-		*l = ((SLF_FIELDLIST *) tmp->type_data.type_info)->substructs;
+		tmp = tpi_type_at (indx);
+		*l = (tmp && tmp->type_data.type_info)
+			? ((SLF_FIELDLIST *) tmp->type_data.type_info)->substructs: 0;
 	}
 }
 
@@ -968,12 +972,11 @@ static void free_lf_vtshape(void *type) {
 
 static void free_tpi_stream(void *stream) {
 	STpiStream *tpi_stream = (STpiStream *)stream;
-	RListIter *it;
 	SType *type = NULL;
+	ut32 i;
 
-	it = r_list_iterator (tpi_stream->types);
-	while (r_list_iter_next (it)) {
-		type = (SType *) r_list_iter_get (it);
+	for (i = 0; tpi_stream->types && i < tpi_stream->count; i++) {
+		type = tpi_stream->types[i];
 		if (!type) {
 			continue;
 		}
@@ -988,7 +991,14 @@ static void free_tpi_stream(void *stream) {
 		}
 		R_FREE (type);
 	}
-	r_list_free (tpi_stream->types);
+	R_FREE (tpi_stream->types);
+	R_FREE (tpi_stream->offsets);
+	R_FREE (tpi_stream->leaf_types);
+	ht_pp_free (tpi_stream->udt_names);
+	tpi_stream->udt_names = NULL;
+	if (p_tpi == tpi_stream) {
+		p_tpi = NULL;
+	}
 }
 
 static void get_array_print_type(void *type, char **name) {
@@ -2347,33 +2357,125 @@ static int parse_tpi_stypes(R_STREAM_FILE *stream, SType *type) {
 	return read_bytes;
 }
 
+// Only the record offsets and leaf types are read here, the records are
+// decoded on their first use by tpi_type_at, which keeps them cached by
+// type index for the lifetime of the stream.
 int parse_tpi_stream(void *parsed_pdb_stream, R_STREAM_FILE *stream) {
-	int i;
-	SType *type = 0;
+	ut32 i;
+	ut16 hdr[2];
 	STpiStream *tpi_stream = (STpiStream *) parsed_pdb_stream;
-	tpi_stream->types = r_list_new();
-	p_types_list = tpi_stream->types;
+	p_tpi = tpi_stream;
 
 	stream_file_read(stream, sizeof(STPIHeader), (char *)&tpi_stream->header);
 
 	base_idx = tpi_stream->header.ti_min;
-
-	for (i = tpi_stream->header.ti_min; i < tpi_stream->header.ti_max; i++) {
-		type = (SType *) malloc (sizeof (SType));
-		if (!type) {
+	if (tpi_stream->header.ti_max < tpi_stream->header.ti_min) {
+		return 0;
+	}
+	tpi_stream->count = tpi_stream->header.ti_max - tpi_stream->header.ti_min;
+	// every record takes at least 4 bytes
+	if (tpi_stream->count > stream->end / 4) {
+		return 0;
+	}
+	tpi_stream->types = R_NEWS0 (SType *, tpi_stream->count);
+	tpi_stream->offsets = R_NEWS0 (ut32, tpi_stream->count);
+	tpi_stream->leaf_types = R_NEWS0 (ut16, tpi_stream->count);
+	if (!tpi_stream->types || !tpi_stream->offsets || !tpi_stream->leaf_types) {
+		return 0;
+	}
+	for (i = 0; i < tpi_stream->count; i++) {
+		int pos = stream_file_tell (stream);
+		stream_file_read (stream, sizeof (hdr), (char *)hdr);
+		if (hdr[0] < 1 || pos + 2 + hdr[0] > stream->end) {
 			return 0;
 		}
-		type->tpi_idx = i;
-		type->type_data.type_info = 0;
-		type->type_data.leaf_type = eLF_MAX;
-		init_stype_info(&type->type_data);
-		if (!parse_tpi_stypes(stream, type)) {
-			free (type);
+		tpi_stream->offsets[i] = pos;
+		tpi_stream->leaf_types[i] = hdr[1];
+		stream_file_seek (stream, pos + 2 + hdr[0], 0);
+	}
+	tpi_stream->stream = *stream;
+	return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static SType *tpi_type_at(unsigned int i) {
+	STpiStream *tpi_stream = p_tpi;
+	SType *type;
+
+	if (!tpi_stream || i >= tpi_stream->count) {
+		return NULL;
+	}
+	if (tpi_stream->types[i]) {
+		return tpi_stream->types[i];
+	}
+	type = (SType *) malloc (sizeof (SType));
+	if (!type) {
+		return NULL;
+	}
+	type->tpi_idx = base_idx + i;
+	type->type_data.type_info = 0;
+	type->type_data.leaf_type = eLF_MAX;
+	init_stype_info(&type->type_data);
+	stream_file_seek (&tpi_stream->stream, tpi_stream->offsets[i], 0);
+	if (!parse_tpi_stypes (&tpi_stream->stream, type)) {
+		free (type);
+		return NULL;
+	}
+	tpi_stream->types[i] = type;
+	return type;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SType *tpi_stream_get_type(STpiStream *tpi_stream, ut32 ti) {
+	if (ti < tpi_stream->header.ti_min) {
+		return NULL;
+	}
+	p_tpi = tpi_stream;
+	base_idx = tpi_stream->header.ti_min;
+	return tpi_type_at (ti - tpi_stream->header.ti_min);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// the name index decodes every struct, union and enum once, the other
+/// records stay undecoded. Forward references are left out, so a name
+/// resolves to the complete type
+///////////////////////////////////////////////////////////////////////////////
+ut32 tpi_stream_find_type(STpiStream *tpi_stream, const char *name) {
+	ut32 ti;
+	if (!tpi_stream->udt_names) {
+		if (!(tpi_stream->udt_names = ht_pp_new0 ())) {
 			return 0;
 		}
-		r_list_append(tpi_stream->types, type);
+		for (ti = tpi_stream->header.ti_min; ti < tpi_stream->header.ti_max; ti++) {
+			ELeafType lt = tpi_stream_get_leaf_type (tpi_stream, ti);
+			if (lt != eLF_STRUCTURE && lt != eLF_UNION && lt != eLF_ENUM) {
+				continue;
+			}
+			SType *t = tpi_stream_get_type (tpi_stream, ti);
+			if (!t) {
+				continue;
+			}
+			STypeInfo *tf = &t->type_data;
+			char *udt_name = NULL;
+			int fwdref = 0;
+			if (tf->is_fwdref) {
+				tf->is_fwdref (tf, &fwdref);
+			}
+			if (tf->get_name) {
+				tf->get_name (tf, &udt_name);
+			}
+			if (!fwdref && udt_name) {
+				ht_pp_insert (tpi_stream->udt_names, udt_name, (void *)(size_t)ti);
+			}
+		}
 	}
-	return 1;
+	return (ut32)(size_t)ht_pp_find (tpi_stream->udt_names, name, NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ELeafType tpi_stream_get_leaf_type(STpiStream *tpi_stream, ut32 ti) {
+	ti -= tpi_stream->header.ti_min;
+	return (ti < tpi_stream->count)? tpi_stream->leaf_types[ti]: eLF_MAX;
 }
 
 void init_tpi_stream(STpiStream *tpi_stream) {
@@ -7,6 +7,18 @@ void init_tpi_stream(STpiStream *tpi_stream);
 ///////////////////////////////////////////////////////////////////////////////
 int parse_tpi_stream(void *parsed_pdb_stream, R_STREAM_FILE *stream);
 
+// decodes the record of type index ti on first use, NULL if it can't
+///////////////////////////////////////////////////////////////////////////////
+SType *tpi_stream_get_type(STpiStream *tpi_stream, ut32 ti);
+
+// type index of the struct, union or enum called name, 0 if there is none
+///////////////////////////////////////////////////////////////////////////////
+ut32 tpi_stream_find_type(STpiStream *tpi_stream, const char *name);
+
+// leaf type of ti without decoding the record
+///////////////////////////////////////////////////////////////////////////////
+ELeafType tpi_stream_get_leaf_type(STpiStream *tpi_stream, ut32 ti);
+
 // TODO: Remove to separate file
 int parse_sctring(SCString *sctr, unsigned char *leaf_data, unsigned int *read_bytes, unsigned int len);
 
@@ -1052,7 +1052,12 @@ typedef struct {
 
 typedef struct {
 	STPIHeader header;
-	RList *types;
+	ut32 count; // ti_max - ti_min
+	SType **types; // decoded on demand, by type index - ti_min
+	ut32 *offsets; // of every record in the stream
+	ut16 *leaf_types;
+	HtPP *udt_names; // struct, union and enum name -> type index, built on the first lookup
+	R_STREAM_FILE stream;
 
 	free_func free_;
 } STpiStream;
@@ -1158,7 +1163,9 @@ typedef struct {
 typedef struct {
 	SDBIHeader dbi_header;
 	SDbiDbgHeader dbg_header;
-	RList *dbiexhdrs;
+	RList *dbiexhdrs; // module infos, decoded on demand
+	int dbiexhdrs_pos;
+	R_STREAM_FILE stream;
 
 	free_func free_;
 } SDbiStream;
@@ -1217,11 +1224,15 @@ typedef struct {
 
 // GDATA structrens
 typedef struct {
-	RList *globals_list;
+	ut32 count;
+	ut32 *offsets; // of every public symbol record in the stream
+	struct SGlobal_ **globals; // decoded on demand, by index
+	HtPP *names; // name -> index + 1, built on the first lookup
+	R_STREAM_FILE stream;
 } SGDATAStream;
 
 R_PACKED (
-typedef struct {
+typedef struct SGlobal_ {
 	ut16 leaf_type;
 	ut32 symtype;
 	ut32 offset;
@@ -1152,17 +1152,16 @@ static void anal_hint_print(RAnalHint *hint, int mode, PJ *pj) {
 	}
 }
 
-// TODO: move this into anal/hint.c ?
-static int cb(void *p, const char *k, const char *v) {
+static bool cb(const RAnalHint *hint, void *p) {
 	HintListState *hls = p;
 	if (hls->mode == 's') {
-		r_cons_printf ("%s=%s\n", k, v);
+		char *v = r_anal_hint_to_string (hls->a, hint->addr);
+		r_cons_printf ("hint.0x%08"PFMT64x"=%s\n", hint->addr, v? v: "");
+		free (v);
 	} else {
-		RAnalHint *hint = r_anal_hint_from_string (hls->a, sdb_atoi (k + 5), v);
-		anal_hint_print (hint, hls->mode, hls->pj);
-		free (hint);
+		anal_hint_print ((RAnalHint *)hint, hls->mode, hls->pj);
 	}
-	return 1;
+	return true;
 }
 
 R_API void r_core_anal_hint_print(RAnal* a, ut64 addr, int mode) {
@@ -1180,7 +1179,7 @@ R_API void r_core_anal_hint_print(RAnal* a, ut64 addr, int mode) {
 		pj_end (pj);
 		r_cons_printf ("%s\n", pj_string (pj));
 	}
-	free (hint);
+	r_anal_hint_free (hint);
 }
 
 R_API void r_core_anal_hint_list(RAnal *a, int mode) {
@@ -1196,13 +1195,7 @@ R_API void r_core_anal_hint_list(RAnal *a, int mode) {
 		hls.pj = pj_new ();
 		pj_a (hls.pj);
 	}
-	SdbList *ls = sdb_foreach_list (a->sdb_hints, true);
-	SdbListIter *lsi;
-	SdbKv *kv;
-	ls_foreach (ls, lsi, kv) {
-		cb (&hls, sdbkv_key (kv), sdbkv_value (kv));
-	}
-	ls_free (ls);
+	r_anal_hint_foreach (a, cb, &hls);
 	if (hls.pj) {
 		pj_end (hls.pj);
 		r_cons_printf ("%s\n", pj_string (hls.pj));
@@ -1778,7 +1771,9 @@ R_API int r_core_anal_bb(RCore *core, RAnalFunction *fcn, ut64 addr, int head) {
 error:
 	rc = false;
 fin:
-	r_list_delete_data (fcn->bbs, bb);
+	if (r_list_delete_data (fcn->bbs, bb)) {
+		r_anal_fcn_bbindex_invalidate (fcn);
+	}
 	r_anal_bb_free (bb);
 	free (buf);
 	return rc;
@@ -2180,7 +2175,7 @@ R_API void r_core_anal_importxrefs(RCore *core) {
 	if (!obj) {
 		return;
 	}
-	r_list_foreach (obj->imports, iter, imp) {
+	r_list_foreach (r_bin_get_imports (core->bin), iter, imp) {
 		ut64 addr = lit ? r_core_bin_impaddr (core->bin, va, imp->name): 0;
 		if (addr) {
 			r_core_anal_codexrefs (core, addr);
@@ -3987,50 +3982,41 @@ static bool isSkippable(RBinSymbol *s) {
 	return false;
 }
 
-R_API int r_core_anal_all(RCore *core) {
+static void queue_addr(SetU *seen, RVector *addrs, ut64 addr) {
+	if (!set_u_contains (seen, addr)) {
+		set_u_add (seen, addr);
+		r_vector_push (addrs, &addr);
+	}
+}
+
+// Collect the function entrypoints known by RBin (symbols, main and entries)
+// in discovery order, skipping the addresses that were already queued.
+static void anal_all_entrypoints(RCore *core, RVector *addrs) {
 	RList *list;
 	RListIter *iter;
-	RFlagItem *item;
-	RAnalFunction *fcni;
 	RBinAddr *binmain;
 	RBinAddr *entry;
 	RBinSymbol *symbol;
-	int depth = core->anal->opt.depth;
-	bool anal_vars = r_config_get_i (core->config, "anal.vars");
-
-	/* Analyze Functions */
-	/* Entries */
-	item = r_flag_get (core->flags, "entry0");
-	if (item) {
-		r_core_anal_fcn (core, item->offset, -1, R_ANAL_REF_TYPE_NULL, depth - 1);
-		r_core_cmdf (core, "afn entry0 0x%08"PFMT64x, item->offset);
-	} else {
-		r_core_cmd0 (core, "af");
+	SetU *seen = set_u_new ();
+	if (!seen) {
+		return;
 	}
-
-	r_cons_break_push (NULL, NULL);
 	/* Symbols (Imports are already analyzed by rabin2 on init) */
 	if ((list = r_bin_get_symbols (core->bin)) != NULL) {
 		r_list_foreach (list, iter, symbol) {
-			if (r_cons_is_breaked ()) {
-				break;
-			}
 			// Stop analyzing PE imports further
 			if (isSkippable (symbol)) {
 				continue;
 			}
 			if (isValidSymbol (symbol)) {
-				ut64 addr = r_bin_get_vaddr (core->bin, symbol->paddr,
-					symbol->vaddr);
-				r_core_anal_fcn (core, addr, -1, R_ANAL_REF_TYPE_NULL, depth - 1);
+				queue_addr (seen, addrs, r_bin_get_vaddr (core->bin, symbol->paddr, symbol->vaddr));
 			}
 		}
 	}
 	/* Main */
 	if ((binmain = r_bin_get_sym (core->bin, R_BIN_SYM_MAIN))) {
 		if (binmain->paddr != UT64_MAX) {
-			ut64 addr = r_bin_get_vaddr (core->bin, binmain->paddr, binmain->vaddr);
-			r_core_anal_fcn (core, addr, -1, R_ANAL_REF_TYPE_NULL, depth - 1);
+			queue_addr (seen, addrs, r_bin_get_vaddr (core->bin, binmain->paddr, binmain->vaddr));
 		}
 	}
 	if ((list = r_bin_get_entries (core->bin))) {
@@ -4038,10 +4024,46 @@ R_API int r_core_anal_all(RCore *core) {
 			if (entry->paddr == UT64_MAX) {
 				continue;
 			}
-			ut64 addr = r_bin_get_vaddr (core->bin, entry->paddr, entry->vaddr);
-			r_core_anal_fcn (core, addr, -1, R_ANAL_REF_TYPE_NULL, depth - 1);
+			queue_addr (seen, addrs, r_bin_get_vaddr (core->bin, entry->paddr, entry->vaddr));
 		}
 	}
+	set_u_free (seen);
+}
+
+R_API int r_core_anal_all(RCore *core) {
+	RListIter *iter;
+	RFlagItem *item;
+	RAnalFunction *fcni;
+	RVector addrs;
+	size_t i;
+	int depth = core->anal->opt.depth;
+	bool anal_vars = r_config_get_i (core->config, "anal.vars");
+
+	/* Analyze Functions */
+	/* Entries */
+	item = r_flag_get (core->flags, "entry0");
+	if (item) {
+		r_core_anal_fcn (core, item->offset, -1, R_ANAL_REF_TYPE_NULL, depth - 1);
+		r_core_cmdf (core, "afn entry0 0x%08"PFMT64x, item->offset);
+	} else {
+		r_core_cmd0 (core, "af");
+	}
+
+	r_cons_break_push (NULL, NULL);
+	/* Symbols, main and entrypoints, each address is analyzed once.
+	 * This loop stays serial: r_core_anal_fcn mutates the shared function
+	 * tree, xrefs, flags and hints, and the arch plugins decode through a
+	 * single static capstone handle, none of which is locked. */
+	r_vector_init (&addrs, sizeof (ut64), NULL, NULL);
+	anal_all_entrypoints (core, &addrs);
+	for (i = 0; i < addrs.len; i++) {
+		if (r_cons_is_breaked ()) {
+			break;
+		}
+		ut64 *addr = r_vector_index_ptr (&addrs, i);
+		r_core_anal_fcn (core, *addr, -1, R_ANAL_REF_TYPE_NULL, depth - 1);
+	}
+	r_vector_clear (&addrs);
 	if (anal_vars) {
 		/* Set fcn type to R_ANAL_FCN_TYPE_SYM for symbols */
 		r_list_foreach (core->anal->fcns, iter, fcni) {
@@ -4420,6 +4442,152 @@ R_API void r_core_anal_undefine(RCore *core, ut64 off) {
 	r_anal_fcn_del (core->anal, off);
 }
 
+typedef struct {
+	RAnalFunction *fcn; // out of the anal trees until its analysis is redone
+	RList *vars;
+} PatchedFunction;
+
+// size the analysis gives to fcn, up to the end of its last block
+static ut32 fcn_bbs_end(RAnalFunction *fcn) {
+	RAnalBlock *bb;
+	RListIter *iter;
+	ut64 end = fcn->addr;
+	r_list_foreach (fcn->bbs, iter, bb) {
+		end = R_MAX (end, bb->addr + bb->size);
+	}
+	return end - fcn->addr;
+}
+
+static void fcn_patch_move_str(char **dst, char **src) {
+	if (*src) {
+		free (*dst);
+		*dst = *src;
+		*src = NULL;
+	}
+}
+
+// drops what a block cached about its neighbours in the function it
+// leaves, they are looked up again in the new one when needed
+static void fcn_patch_bb_reset(RAnalBlock *bb) {
+	bb->jumpbb = NULL;
+	bb->failbb = NULL;
+	bb->prev = NULL;
+	bb->next = NULL;
+	bb->head = NULL;
+	bb->tail = NULL;
+	R_FREE (bb->parent_reg_arena);
+	bb->parent_stackptr = INT_MAX;
+}
+
+/* Moves what the user set on the function before the patch to the one
+ * analyzed after it: name, signature, calling convention, bits, the size if
+ * it was forced and the blocks the new analysis did not find again outside
+ * the patched bytes, which is where the afb+ ones end up. */
+static void fcn_patch_restore(RAnal *anal, RAnalFunction *fcn, PatchedFunction *pf, ut64 from, ut64 to) {
+	RAnalFunction *old = pf->fcn;
+	RAnalBlock *bb;
+	RAnalVar *v;
+	RListIter *iter, *iter2;
+	const bool user_size = r_anal_fcn_size (old) != fcn_bbs_end (old);
+	bool moved = false;
+
+	fcn_patch_move_str (&fcn->name, &old->name);
+	fcn_patch_move_str (&fcn->dsc, &old->dsc);
+	fcn_patch_move_str (&fcn->rets, &old->rets);
+	fcn_patch_move_str (&fcn->attr, &old->attr);
+	r_anal_diff_free (fcn->diff);
+	fcn->diff = old->diff;
+	old->diff = NULL;
+	fcn->bits = old->bits;
+	fcn->cc = old->cc;
+	fcn->type = old->type;
+	fcn->fmod = old->fmod;
+	fcn->is_pure = old->is_pure;
+	fcn->is_noreturn = old->is_noreturn;
+	r_list_foreach_safe (old->bbs, iter, iter2, bb) {
+		if (bb->addr < to && bb->addr + bb->size > from) {
+			continue;
+		}
+		if (r_anal_fcn_bbget_in (anal, fcn, bb->addr)) {
+			continue;
+		}
+		r_list_split_iter (old->bbs, iter);
+		free (iter);
+		fcn_patch_bb_reset (bb);
+		r_anal_fcn_bbadd (fcn, bb);
+		moved = true;
+	}
+	if (moved) {
+		// the function tree is keyed by the extent of the blocks
+		r_anal_fcn_tree_delete (anal, fcn);
+		r_anal_fcn_update_tinyrange_bbs (fcn);
+		fcn->meta.min = UT64_MAX;
+		r_anal_fcn_tree_insert (anal, fcn);
+	}
+	if (user_size) {
+		r_anal_fcn_set_size (anal, fcn, r_anal_fcn_size (old));
+	} else if (moved) {
+		r_anal_fcn_set_size (anal, fcn, R_MAX (r_anal_fcn_size (fcn), fcn_bbs_end (fcn)));
+	}
+	// the analysis put back the default name and type of the vars it found
+	r_list_foreach (pf->vars, iter, v) {
+		r_anal_var_add (anal, fcn->addr, v->scope, v->delta, v->kind, v->type, v->size, v->isarg, v->name);
+	}
+}
+
+/* Called after [addr, addr + size) is written: drops the xrefs made by the
+ * code there and analyzes again the functions with a basic block in that
+ * range, keeping what the user set on them. Returns how many functions were
+ * analyzed. */
+R_API int r_core_anal_patch(RCore *core, ut64 addr, int size) {
+	RAnal *anal = core->anal;
+	RAnalFunction *f;
+	RAnalBlock *bb;
+	RListIter *iter, *iter2;
+	int i, n, count = 0;
+	if (size < 1) {
+		return 0;
+	}
+	const ut64 end = addr + size;
+	r_anal_refs_del_range (anal, addr, end);
+	RList *fcns = r_anal_get_fcn_in_range (anal, addr, end);
+	PatchedFunction *pf = NULL;
+	if (!fcns || !(n = r_list_length (fcns)) || !(pf = R_NEWS0 (PatchedFunction, n))) {
+		r_list_free (fcns);
+		return 0;
+	}
+	i = 0;
+	r_list_foreach (fcns, iter, f) {
+		pf[i].fcn = f;
+		pf[i].vars = r_anal_var_all_list (anal, f);
+		i++;
+		r_list_foreach (f->bbs, iter2, bb) {
+			r_anal_refs_del_range (anal, bb->addr, bb->addr + bb->size);
+		}
+		// not a user deletion, so cmd.fcn.delete is not run
+		r_anal_fcn_tree_delete (anal, f);
+		r_list_split (anal->fcns, f);
+	}
+	r_list_free (fcns);
+	const int depth = r_config_get_i (core->config, "anal.depth");
+	for (i = 0; i < n; i++) {
+		RAnalFunction *old = pf[i].fcn;
+		r_core_anal_fcn (core, old->addr, UT64_MAX, R_ANAL_REF_TYPE_NULL, depth);
+		f = r_anal_get_fcn_at (anal, old->addr, 0);
+		if (f) {
+			fcn_patch_restore (anal, f, &pf[i], addr, end);
+			r_anal_fcn_free (old);
+			count++;
+		} else {
+			// nothing to analyze there anymore, keep the function as it was
+			r_anal_fcn_insert (anal, old);
+		}
+		r_list_free (pf[i].vars);
+	}
+	free (pf);
+	return count;
+}
+
 /* Join function at addr2 into function at addr */
 // addr use to be core->offset
 R_API void r_core_anal_fcn_merge(RCore *core, ut64 addr, ut64 addr2) {
@@ -4471,6 +4639,8 @@ R_API void r_core_anal_fcn_merge(RCore *core, ut64 addr, ut64 addr2) {
 		}
 		r_anal_fcn_bbadd (f1, bb);
 	}
+	// index the blocks of f2 as part of f1
+	r_anal_fcn_update_tinyrange_bbs (f1);
 	// TODO: import data/code/refs
 	// update size
 	f1->addr = R_MIN (addr, addr2);
@@ -162,6 +162,91 @@ R_API int r_core_bin_set_by_name(RCore *core, const char * name) {
 	return false;
 }
 
+static void bin_flags_lazy(RFlag *f, ut64 off, void *user) {
+	r_core_bin_load_lazy ((RCore *)user, off);
+}
+
+static int bin_symbols_from(RCore *r, RList *symbols, int mode, ut64 laddr, int va, ut64 at, const char *name, bool exponly, const char *args);
+
+// whether the symbols of the current binfile are set one image at a time
+static bool bin_by_image(RCore *r) {
+	RBinFile *bf = r_bin_cur (r->bin);
+	return bf && r_list_contains (r->bin_images, (void *)(size_t)bf->id);
+}
+
+// Returns false once the symbols of all the images are set
+static bool bin_image_symbols(RCore *r, RBinFile *bf, ut64 addr) {
+	int va = bf->o->info->has_va;
+	if (addr == UT64_MAX || (bf->o->loaded & R_BIN_REQ_SYMBOLS)) {
+		// all of them are needed, or something else asked for the whole list
+		r_core_bin_info (r, R_CORE_BIN_ACC_SYMBOLS, R_MODE_SET, va, NULL, NULL);
+		return false;
+	}
+	RList *symbols = r_bin_file_get_image_symbols (bf, addr);
+	if (symbols) {
+		r_flag_bulk_begin (r->flags);
+		bin_symbols_from (r, symbols, R_MODE_SET, r_bin_get_laddr (r->bin), va ? VA_TRUE : VA_FALSE, 0, NULL, false, NULL);
+		r_flag_bulk_end (r->flags);
+		r_list_free (symbols);
+	}
+	return true;
+}
+
+// Strings, relocs, imports, symbols and classes take most of the time spent
+// opening big binaries, so with bin.lazy they are left for the first command
+// or flag lookup that may need them. Caches made of many images (dyld,
+// kernelcache) go further and set the symbols of each image as its addresses
+// are visited.
+static void bin_defer(RCore *r, RBinFile *binfile) {
+	void *id = (void *)(size_t)binfile->id;
+	if (!r_list_contains (r->bin_lazy, id)) {
+		r_list_append (r->bin_lazy, id);
+	}
+	r_flag_set_lazy (r->flags, bin_flags_lazy, r);
+}
+
+// addr is the address about to be used, UT64_MAX loads everything
+R_API void r_core_bin_load_lazy(RCore *core, ut64 addr) {
+	r_return_if_fail (core);
+	r_flag_set_lazy (core->flags, NULL, NULL);
+	if (r_list_empty (core->bin_lazy) && r_list_empty (core->bin_images)) {
+		return;
+	}
+	RList *ids = core->bin_lazy;
+	core->bin_lazy = r_list_new ();
+	RBinFile *cur = r_bin_cur (core->bin);
+	RListIter *iter, *iter2;
+	void *id;
+	// this may run in the middle of any command, keep its flag space
+	r_flag_space_push (core->flags, r_flag_space_cur_name (core->flags));
+	r_list_foreach (ids, iter, id) {
+		RBinFile *bf = r_bin_file_find_by_id (core->bin, (ut32)(size_t)id);
+		if (bf && bf->o && bf->o->info && r_bin_file_set_cur_binfile (core->bin, bf)) {
+			int acc = R_CORE_BIN_ACC_LAZY;
+			if (bf->o->plugin && bf->o->plugin->image_symbols) {
+				acc &= ~R_CORE_BIN_ACC_SYMBOLS;
+				r_list_append (core->bin_images, id);
+			}
+			r_core_bin_info (core, acc, R_MODE_SET, bf->o->info->has_va, NULL, NULL);
+		}
+	}
+	r_list_foreach_safe (core->bin_images, iter, iter2, id) {
+		RBinFile *bf = r_bin_file_find_by_id (core->bin, (ut32)(size_t)id);
+		if (!bf || !bf->o || !bf->o->info || !r_bin_file_set_cur_binfile (core->bin, bf)
+				|| !bin_image_symbols (core, bf, addr)) {
+			r_list_delete (core->bin_images, iter);
+		}
+	}
+	r_flag_space_pop (core->flags);
+	if (cur && r_bin_cur (core->bin) != cur) {
+		r_bin_file_set_cur_binfile (core->bin, cur);
+	}
+	r_list_free (ids);
+	if (!r_list_empty (core->bin_images)) {
+		r_flag_set_lazy (core->flags, bin_flags_lazy, core);
+	}
+}
+
 R_API int r_core_bin_set_env(RCore *r, RBinFile *binfile) {
 	r_return_val_if_fail (r, false);
 
@@ -183,7 +268,11 @@ R_API int r_core_bin_set_env(RCore *r, RBinFile *binfile) {
 			r_config_set (r->config, "anal.cpu", arch);
 		}
 		r_asm_use (r->assembler, arch);
-		r_core_bin_info (r, R_CORE_BIN_ACC_ALL, R_MODE_SET, va, NULL, NULL);
+		bool lazy = r_config_get_i (r->config, "bin.lazy");
+		r_core_bin_info (r, lazy? R_CORE_BIN_ACC_ALL & ~R_CORE_BIN_ACC_LAZY: R_CORE_BIN_ACC_ALL, R_MODE_SET, va, NULL, NULL);
+		if (lazy) {
+			bin_defer (r, binfile);
+		}
 		r_core_bin_set_cur (r, binfile);
 		return true;
 	}
@@ -630,6 +719,9 @@ static int bin_info(RCore *r, int mode, ut64 laddr) {
 	}
 	havecode = is_executable (obj) | (obj->entries != NULL);
 	compiled = get_compile_time (bf->sdb);
+	// the language is guessed when the symbols are loaded, this is
+	// just a guess from the imports and libraries until then
+	const char *lang = IS_MODE_SET (mode)? info->lang: r_bin_lang_guess (bf);
 
 	if (IS_MODE_SET (mode)) {
 		r_config_set (r->config, "file.type", info->rclass);
@@ -641,8 +733,8 @@ static int bin_info(RCore *r, int mode, ut64 laddr) {
 			// eprintf ("m /root %s 0", info->arch);
 	//		r_core_cmdf (r, "m /root hfs @ 0", info->arch);
 		} else {
-			if (info->lang) {
-				r_config_set (r->config, "bin.lang", info->lang);
+			if (lang) {
+				r_config_set (r->config, "bin.lang", lang);
 			}
 			r_config_set (r->config, "asm.os", info->os);
 			if (info->rclass && !strcmp (info->rclass, "pe")) {
@@ -697,8 +789,8 @@ static int bin_info(RCore *r, int mode, ut64 laddr) {
 				r_str_bool (info->big_endian),
 				info->bits,
 				r_str_bool (R_BIN_DBG_STRIPPED &info->dbg_info));
-			if (info->lang && *info->lang) {
-				r_cons_printf ("e bin.lang=%s\n", info->lang);
+			if (lang && *lang) {
+				r_cons_printf ("e bin.lang=%s\n", lang);
 			}
 			if (info->rclass && *info->rclass) {
 				r_cons_printf ("e file.type=%s\n",
@@ -761,7 +853,7 @@ static int bin_info(RCore *r, int mode, ut64 laddr) {
 		pair_str ("guid", info->guid, mode, false);
 		pair_str ("intrp", info->intrp, mode, false);
 		pair_ut64x ("laddr", laddr, mode, false);
-		pair_str ("lang", info->lang, mode, false);
+		pair_str ("lang", lang, mode, false);
 		pair_bool ("linenum", R_BIN_DBG_LINENUMS & info->dbg_info, mode, false);
 		pair_bool ("lsyms", R_BIN_DBG_SYMS & info->dbg_info, mode, false);
 		pair_str ("machine", info->machine, mode, false);
@@ -881,7 +973,13 @@ static int bin_dwarf(RCore *core, int mode) {
 	if (plugin && plugin->lines) {
 		list = plugin->lines (binfile);
 	} else if (core->bin) {
-		// TODO: complete and speed-up support for dwarf
+		if (mode == R_MODE_SET) {
+			// loading only indexes the units, lines are decoded on the first lookup
+			if (!binfile->dwarf) {
+				binfile->dwarf = r_bin_dwarf_index_new (binfile);
+			}
+			return binfile->dwarf != NULL;
+		}
 		RBinDwarfDebugAbbrev *da = NULL;
 		da = r_bin_dwarf_parse_abbrev (core->bin, mode);
 		r_bin_dwarf_parse_info (da, core->bin, mode);
@@ -1004,9 +1102,15 @@ static int bin_dwarf(RCore *core, int mode) {
 }
 
 R_API int r_core_pdb_info(RCore *core, const char *file, ut64 baddr, int mode) {
+	return r_core_pdb_find (core, file, baddr, NULL, mode);
+}
+
+// when name is set only the type or global symbol with that name is shown
+R_API int r_core_pdb_find(RCore *core, const char *file, ut64 baddr, const char *name, int mode) {
 	R_PDB pdb = R_EMPTY;
 
 	pdb.cb_printf = r_cons_printf;
+	pdb.name = name;
 	if (!init_pdb_parser (&pdb, file)) {
 		return false;
 	}
@@ -1072,6 +1176,7 @@ static int bin_source(RCore *r, int mode) {
 	RListIter *iter2;
 	char* srcline;
 	SdbKv *kv;
+	r_bin_dwarf_addrinfo (binfile);
 	SdbList *ls = sdb_foreach_list (binfile->sdb_addrinfo, false);
 	ls_foreach (ls, iter, kv) {
 		char *v = sdbkv_value (kv);
@@ -1496,6 +1601,10 @@ static int bin_relocs(RCore *r, int mode, int va) {
 	R_TIME_BEGIN;
 
 	va = VA_TRUE; // XXX relocs always vaddr?
+	if (bin_demangle && !bin_by_image (r)) {
+		// the language to demangle with is guessed with the symbols
+		r_bin_get_symbols (r->bin);
+	}
 	//this has been created for reloc object files
 	RBNode *relocs = r_bin_patch_relocs (r->bin);
 	if (!relocs) {
@@ -1650,89 +1759,14 @@ static int bin_relocs(RCore *r, int mode, int va) {
 	return relocs != NULL;
 }
 
-#define MYDB 1
-/* this is a hacky workaround that needs proper refactoring in Rbin to use Sdb */
-#if MYDB
-static Sdb *mydb = NULL;
-static RList *osymbols = NULL;
-
-static RBinSymbol *get_symbol(RBin *bin, RList *symbols, const char *name, ut64 addr) {
-	RBinSymbol *symbol, *res = NULL;
-	RListIter *iter;
-	if (mydb && symbols && symbols != osymbols) {
-		sdb_free (mydb);
-		mydb = NULL;
-		osymbols = symbols;
-	}
-	if (mydb) {
-		if (name) {
-			res = (RBinSymbol*)(void*)(size_t)
-				sdb_num_get (mydb, sdb_fmt ("%x", sdb_hash (name)), NULL);
-		} else {
-			res = (RBinSymbol*)(void*)(size_t)
-				sdb_num_get (mydb, sdb_fmt ("0x"PFMT64x, addr), NULL);
-		}
-	} else {
-		mydb = sdb_new0 ();
-		r_list_foreach (symbols, iter, symbol) {
-			if (!symbol->name) {
-				continue;
-			}
-			/* ${name}=${ptrToSymbol} */
-			if (!sdb_num_add (mydb, sdb_fmt ("%x", sdb_hash (symbol->name)), (ut64)(size_t)symbol, 0)) {
-			//	eprintf ("DUP (%s)\n", symbol->name);
-			}
-			/* 0x${vaddr}=${ptrToSymbol} */
-			if (!sdb_num_add (mydb, sdb_fmt ("0x"PFMT64x, symbol->vaddr), (ut64)(size_t)symbol, 0)) {
-			//	eprintf ("DUP (%s)\n", symbol->name);
-			}
-			if (name) {
-				if (!res && !strcmp (symbol->name, name)) {
-					res = symbol;
-				}
-			} else {
-				if (symbol->vaddr == addr) {
-					res = symbol;
-				}
-			}
-		}
-		osymbols = symbols;
-	}
-	return res;
-}
-#else
-static RList *osymbols = NULL;
-static RBinSymbol *get_symbol(RBin *bin, RList *symbols, const char *name, ut64 addr) {
-	RBinSymbol *symbol;
-	RListIter *iter;
-	// XXX this is slow, we should use a hashtable here
-	r_list_foreach (symbols, iter, symbol) {
-		if (name) {
-			if (!strcmp (symbol->name, name))
-				return symbol;
-		} else {
-			if (symbol->vaddr == addr) {
-				return symbol;
-			}
-		}
-	}
-	return NULL;
-}
-#endif
-
 /* XXX: This is a hack to get PLT references in rabin2 -i */
 /* imp. is a prefix that can be rewritten by the symbol table */
 R_API ut64 r_core_bin_impaddr(RBin *bin, int va, const char *name) {
-	RList *symbols;
-
 	if (!name || !*name) {
 		return false;
 	}
-	if (!(symbols = r_bin_get_symbols (bin))) {
-		return false;
-	}
 	char *impname = r_str_newf ("imp.%s", name);
-	RBinSymbol *s = get_symbol (bin, symbols, impname, 0LL);
+	RBinSymbol *s = r_bin_get_symbol_by_name (bin, impname);
 	// maybe ut64_MAX to indicate import not found?
 	ut64 addr = 0LL;
 	if (s) {
@@ -1766,6 +1800,10 @@ static int bin_imports(RCore *r, int mode, int va, const char *name) {
 	if (!info) {
 		return false;
 	}
+	if (bin_demangle && !bin_by_image (r)) {
+		// the language to demangle with is guessed with the symbols
+		r_bin_get_symbols (r->bin);
+	}
 
 	RList *imports = r_bin_get_imports (r->bin);
 	int cdsz = info? (info->bits == 64? 8: info->bits == 32? 4: info->bits == 16 ? 4: 0): 0;
@@ -1857,13 +1895,6 @@ static int bin_imports(RCore *r, int mode, int va, const char *name) {
 		free (s);
 	}
 	r_table_free (table);
-#if MYDB
-	// NOTE: if we comment out this, it will leak.. but it will be faster
-	// because it will keep the cache across multiple RBin calls
-	osymbols = NULL;
-	sdb_free (mydb);
-	mydb = NULL;
-#endif
 	return true;
 }
 
@@ -2015,7 +2046,7 @@ static void select_flag_space(RCore *core, RBinSymbol *symbol) {
 	}
 }
 
-static int bin_symbols(RCore *r, int mode, ut64 laddr, int va, ut64 at, const char *name, bool exponly, const char *args) {
+static int bin_symbols_from(RCore *r, RList *symbols, int mode, ut64 laddr, int va, ut64 at, const char *name, bool exponly, const char *args) {
 	RBinInfo *info = r_bin_get_info (r->bin);
 	RList *entries = r_bin_get_entries (r->bin);
 	RBinSymbol *symbol;
@@ -2035,9 +2066,12 @@ static int bin_symbols(RCore *r, int mode, ut64 laddr, int va, ut64 at, const ch
 	}
 
 	bool is_arm = info && info->arch && !strncmp (info->arch, "arm", 3);
+	if (IS_MODE_SET (mode) && info->lang) {
+		// guessed now that the symbols are loaded
+		r_config_set (r->config, "bin.lang", info->lang);
+	}
 	const char *lang = bin_demangle ? r_config_get (r->config, "bin.lang") : NULL;
 
-	RList *symbols = r_bin_get_symbols (r->bin);
 	r_spaces_push (&r->anal->meta_spaces, "bin");
 
 	if (IS_MODE_JSON (mode) && !printHere) {
@@ -2286,6 +2320,10 @@ next:
 	return true;
 }
 
+static int bin_symbols(RCore *r, int mode, ut64 laddr, int va, ut64 at, const char *name, bool exponly, const char *args) {
+	return bin_symbols_from (r, r_bin_get_symbols (r->bin), mode, laddr, va, at, name, exponly, args);
+}
+
 static char *build_hash_string(int mode, const char *chksum, ut8 *data, ut32 datalen) {
 	char *chkstr = NULL, *aux, *ret = NULL;
 	const char *ptr = chksum;
@@ -3775,6 +3813,11 @@ R_API int r_core_bin_info(RCore *core, int action, int mode, int va, RCoreBinFil
 
 	// use our internal values for va
 	va = va ? VA_TRUE : VA_FALSE;
+	// strings, relocs and symbols add flags in no particular address order,
+	// let the flag index sort them once at the end instead of on every set
+	if (IS_MODE_SET (mode)) {
+		r_flag_bulk_begin (core->flags);
+	}
 #if 0
 	if (r_config_get_i (core->config, "anal.strings")) {
 		r_core_cmd0 (core, "aar");
@@ -3867,6 +3910,9 @@ R_API int r_core_bin_info(RCore *core, int action, int mode, int va, RCoreBinFil
 			}
 		}
 	}
+	if (IS_MODE_SET (mode)) {
+		r_flag_bulk_end (core->flags);
+	}
 	return ret;
 }
 
@@ -281,6 +281,12 @@ static bool cb_analsleep(void *user, void *data) {
 	return true;
 }
 
+static bool cb_analopcache(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	return r_anal_op_cache_set_size (core->anal, node->i_value);
+}
+
 static bool cb_analmaxrefs(void *user, void *data) {
 	RCore *core = (RCore*) user;
 	RConfigNode *node = (RConfigNode*) data;
@@ -915,6 +921,13 @@ static bool cb_usextr(void *user, void *data) {
 	return true;
 }
 
+static bool cb_binmmap(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	core->bin->use_mmap = node->i_value;
+	return true;
+}
+
 static bool cb_strpurge(void *user, void *data) {
 	RCore *core = (RCore*) user;
 	RConfigNode *node = (RConfigNode*) data;
@@ -1052,6 +1065,13 @@ static bool cb_cfgcorelog(void *user, void *data) {
 	return true;
 }
 
+static bool cb_cfg_tasks_quantum(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode *) data;
+	core->tasks_quantum = node->i_value;
+	return true;
+}
+
 static bool cb_cfgdebug(void *user, void *data) {
 	RCore *core = (RCore*) user;
 	RConfigNode *node = (RConfigNode*) data;
@@ -2189,6 +2209,24 @@ static bool cb_contiguous(void *user, void *data) {
 	return true;
 }
 
+static bool cb_searchalgo(void *user, void *data) {
+	RCore *core = (RCore *)user;
+	RConfigNode *node = (RConfigNode *) data;
+	if (*node->value == '?') {
+		print_node_options (node);
+		return false;
+	}
+	if (!strcmp (node->value, "multi")) {
+		r_search_set_algo (core->search, R_SEARCH_ALGO_MULTI);
+	} else if (!strcmp (node->value, "brute")) {
+		r_search_set_algo (core->search, R_SEARCH_ALGO_BRUTE);
+	} else {
+		eprintf ("Unknown search.algo '%s'\n", node->value);
+		return false;
+	}
+	return true;
+}
+
 static bool cb_searchalign(void *user, void *data) {
 	RCore *core = (RCore *)user;
 	RConfigNode *node = (RConfigNode *) data;
@@ -2402,6 +2440,24 @@ static bool cb_binmaxstrbuf(void *user, void *data) {
 	return true;
 }
 
+static bool cb_binstrthreads(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode *) data;
+	if (core->bin) {
+		core->bin->strthreads = R_MAX (1, node->i_value);
+	}
+	return true;
+}
+
+static bool cb_bindbgthreads(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode *) data;
+	if (core->bin) {
+		core->bin->dbgthreads = R_MAX (1, node->i_value);
+	}
+	return true;
+}
+
 static bool cb_binmaxstr(void *user, void *data) {
 	RCore *core = (RCore *) user;
 	RConfigNode *node = (RConfigNode *) data;
@@ -2847,10 +2903,12 @@ R_API int r_core_config_init(RCore *core) {
 	SETICB ("anal.depth", 64, &cb_analdepth, "Max depth at code analysis"); // XXX: warn if depth is > 50 .. can be problematic
 	SETICB ("anal.graph_depth", 256, &cb_analgraphdepth, "Max depth for path search");
 	SETICB ("anal.sleep", 0, &cb_analsleep, "Sleep N usecs every so often during analysis. Avoid 100% CPU usage");
+	SETICB ("anal.opcache", 4096, &cb_analopcache, "Keep the last N decoded ops to avoid decoding them again (0 to disable, see aoC)");
 	SETCB ("anal.ignbithints", "false", &cb_anal_ignbithints, "Ignore the ahb hints (only obey asm.bits)");
 	SETPREF ("anal.calls", "false", "Make basic af analysis walk into calls");
 	SETPREF ("anal.autoname", "false", "Speculatively set a name for the functions, may result in some false positives");
 	SETPREF ("anal.hasnext", "false", "Continue analysis after each function");
+	SETPREF ("anal.onwrite", "false", "Analyze again the functions and xrefs depending on the bytes written (wx, wa, ..)");
 	SETICB ("anal.nonull", 0, &cb_anal_nonull, "Do not analyze regions of N null bytes");
 	SETPREF ("anal.esil", "false", "Use the new ESIL code analysis");
 	SETCB ("anal.strings", "false", &cb_analstrings, "Identify and register strings during analysis (aar only)");
@@ -2923,6 +2981,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETI ("esil.addr.size", 64, "Maximum address size in accessed by the ESIL VM");
 	SETPREF ("esil.breakoninvalid", "false", "Break esil execution when instruction is invalid");
 	SETI ("esil.timeout", 0, "A timeout (in seconds) for when we should give up emulating");
+	SETPREF ("esil.blocks", "true", "Decode basic blocks once and run them in a row in aec, aecu and aecue");
 	/* asm */
 	//asm.os needs to be first, since other asm.* depend on it
 	n = NODECB ("asm.os", R_SYS_OS, &cb_asmos);
@@ -3092,6 +3151,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("bin.hashlimit", "10M", "Only compute hash when opening a file if smaller than this size");
 	SETCB ("bin.usextr", "true", &cb_usextr, "Use extract plugins when loading files");
 	SETCB ("bin.useldr", "true", &cb_useldr, "Use loader plugins when loading files");
+	SETCB ("bin.mmap", "true", &cb_binmmap, "Map local files when loading bin info instead of reading them through io");
 	SETCB ("bin.str.purge", "", &cb_strpurge, "Purge strings (e bin.str.purge=? provides more detail)");
 	SETPREF ("bin.b64str", "false", "Try to debase64 the strings");
 	SETCB ("bin.at", "false", &cb_binat, "RBin.cur depends on RCore.offset");
@@ -3108,10 +3168,13 @@ R_API int r_core_config_init(RCore *core) {
 	SETI ("bin.baddr", -1, "Base address of the binary");
 	SETI ("bin.laddr", 0, "Base address for loading library ('*.so')");
 	SETCB ("bin.dbginfo", "true", &cb_bindbginfo, "Load debug information at startup if available");
+	SETICB ("bin.dbginfo.threads", 1, &cb_bindbgthreads, "Decode the DWARF line programs with N threads (same results)");
 	SETPREF ("bin.relocs", "true", "Load relocs information at startup if available");
+	SETPREF ("bin.lazy", "true", "Load strings, relocs, imports, symbols and classes when first needed instead of at startup");
 	SETICB ("bin.minstr", 0, &cb_binminstr, "Minimum string length for r_bin");
 	SETICB ("bin.maxstr", 0, &cb_binmaxstr, "Maximum string length for r_bin");
 	SETICB ("bin.maxstrbuf", 1024*1024*10, & cb_binmaxstrbuf, "Maximum size of range to load strings from");
+	SETICB ("bin.str.threads", 1, &cb_binstrthreads, "Scan for strings with N threads (same results and order)");
 	n = NODECB ("bin.str.enc", "guess", &cb_binstrenc);
 	SETDESC (n, "Default string encoding of binary");
 	SETOPTIONS (n, "latin1", "utf8", "utf16le", "utf32le", "guess", NULL);
@@ -3129,6 +3192,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("prj.zip", "false", "Use ZIP format for project files");
 	SETPREF ("prj.gpg", "false", "TODO: Encrypt project with GnuPGv2");
 	SETPREF ("prj.simple", "false", "Use simple project saving style (functions, comments, options)");
+	SETPREF ("prj.snapshot", "false", "Load the analysis snapshot of the file (see Pb) when opening it");
 
 	/* cfg */
 	SETPREF ("cfg.r2wars", "false", "Enable some tweaks for the r2wars game");
@@ -3137,6 +3201,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETICB ("time.zone", 0, &cb_timezone, "Time zone, in hours relative to GMT: +2, -1,..");
 	SETCB ("cfg.corelog", "false", &cb_cfgcorelog, "Log changes using the T api needed for realtime syncing");
 	SETPREF ("cfg.newtab", "false", "Show descriptions in command completion");
+	SETICB ("cfg.tasks.quantum", 10000, &cb_cfg_tasks_quantum, "Microseconds a task runs before yielding to other tasks (0 = yield on every break check)");
 	SETCB ("cfg.debug", "false", &cb_cfgdebug, "Debugger mode");
 	p = r_sys_getenv ("EDITOR");
 #if __WINDOWS__
@@ -3541,11 +3606,15 @@ R_API int r_core_config_init(RCore *core) {
 	/* search */
 	SETCB ("search.contiguous", "true", &cb_contiguous, "Accept contiguous/adjacent search hits");
 	SETICB ("search.align", 0, &cb_searchalign, "Only catch aligned search hits");
+	n = NODECB ("search.algo", "brute", &cb_searchalgo);
+	SETDESC (n, "Keyword search algorithm (multi: single pass over the data for all keywords)");
+	SETOPTIONS (n, "brute", "multi", NULL);
 	SETI ("search.chunk", 0, "Chunk size for /+ (default size is asm.bits/8");
 	SETI ("search.esilcombo", 8, "Stop search after N consecutive hits");
 	SETI ("search.distance", 0, "Search string distance");
 	SETPREF ("search.flags", "true", "All search results are flagged, otherwise only printed");
 	SETPREF ("search.overlap", "false", "Look for overlapped search hits");
+	SETI ("search.threads", 1, "Scan for keywords with N threads (hits are reported in address order)");
 	SETI ("search.maxhits", 0, "Maximum number of hits (0: no limit)");
 	SETI ("search.from", -1, "Search start address");
 	n = NODECB ("search.in", "io.maps", &cb_searchin);
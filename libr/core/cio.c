@@ -399,6 +399,9 @@ R_API bool r_core_write_at(RCore *core, ut64 addr, const ut8 *buf, int size) {
 		return false;
 	}
 	bool ret = r_io_write_at (core->io, addr, buf, size);
+	if (ret && core->io->cb_core_post_write) {
+		core->io->cb_core_post_write (core->io->user, addr, (ut8 *)buf, size);
+	}
 	if (addr >= core->offset && addr <= core->offset + core->blocksize - 1) {
 		r_core_block_read (core);
 	}
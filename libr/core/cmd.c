@@ -4464,7 +4464,21 @@ static bool core_cmd_tsr2cmd(RCore *core, const char *cstr, bool log) {
 	return res;
 }
 
+// the bin info deferred with bin.lazy also adds metadata and hints, load it
+// before running anything but the commands known not to need it, with the
+// symbols of the image at the current seek for the caches that load them one
+// image at a time. Flag lookups load it on their own
+static bool cmd_needs_bin_lazy(const char *cmd) {
+	while (IS_WHITECHAR (*cmd)) {
+		cmd++;
+	}
+	return *cmd && !strchr ("ie?=#so", *cmd);
+}
+
 R_API int r_core_cmd(RCore *core, const char *cstr, int log) {
+	if (cstr && (!r_list_empty (core->bin_lazy) || !r_list_empty (core->bin_images)) && cmd_needs_bin_lazy (cstr)) {
+		r_core_bin_load_lazy (core, core->offset);
+	}
 	if (core->use_tree_sitter_r2cmd) {
 		return core_cmd_tsr2cmd (core, cstr, log)? 0: 1;
 	}
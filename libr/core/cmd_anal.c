@@ -611,6 +611,7 @@ static const char *help_msg_ao[] = {
 	"aod", " [mnemonic]", "describe opcode for asm.arch",
 	"aoda", "", "show all mnemonic descriptions",
 	"aoc", " [cycles]", "analyze which op could be executed in [cycles]",
+	"aoC", "[-]", "show decode cache stats (e anal.opcache), aoC- to flush it",
 	"ao", " 5", "display opcode analysis of 5 opcodes",
 	"ao*", "", "display opcode in r commands",
 	NULL
@@ -955,14 +956,14 @@ static void var_help(RCore *core, char ch) {
 }
 
 static void var_accesses_list(RAnal *a, RAnalFunction *fcn, int delta, const char *typestr) {
-	const char *var_local = sdb_fmt ("var.0x%"PFMT64x".%d.%d.%s",
-			fcn->addr, 1, delta, typestr);
-	const char *xss = sdb_const_get (a->sdb_fcns, var_local, 0);
-	if (xss && *xss) {
-		r_cons_printf ("%s\n", xss);
-	} else {
-		r_cons_newline ();
+	RVector *xs = r_anal_var_accesses (a, fcn->addr, 1, delta, *typestr == 'w');
+	const char *comma = "";
+	ut64 *addr;
+	r_vector_foreach (xs, addr) {
+		r_cons_printf ("%s0x%"PFMT64x, comma, *addr);
+		comma = ",";
 	}
+	r_cons_newline ();
 }
 
 static void list_vars(RCore *core, RAnalFunction *fcn, int type, const char *name) {
@@ -2292,12 +2293,15 @@ static bool anal_fcn_del_bb(RCore *core, const char *input) {
 		if (!strcmp (input, "*")) {
 			r_list_free (fcn->bbs);
 			fcn->bbs = NULL;
+			r_anal_fcn_update_tinyrange_bbs (fcn);
 		} else {
 			RAnalBlock *b;
 			RListIter *iter;
 			r_list_foreach (fcn->bbs, iter, b) {
 				if (b->addr == addr) {
 					r_list_delete (fcn->bbs, iter);
+					r_anal_fcn_bbindex_invalidate (fcn);
+					r_anal_fcn_update_tinyrange_bbs (fcn);
 					return true;
 				}
 			}
@@ -4598,6 +4602,251 @@ tail_return:
 	return tail_return_value;
 }
 
+// Block emulation for aec, aecu and aecue
+//
+// r_core_esil_step reads, decodes and checks every instruction again each
+// time it runs. Here the straight-line code starting at pc is decoded once
+// per run into a block, and its ops are executed in a row, resolving the pc
+// register once. Exec traps, pins and misaligned or invalid instructions end
+// a block and that instruction goes through r_core_esil_step, so they keep
+// the same behaviour. ESIL memory writes and r_core_write_at inside the
+// decoded code mark it dirty, and blocks are decoded again.
+
+#define ESIL_BLOCK_MAXOPS 256
+
+typedef struct {
+	ut64 addr;
+	int size;
+	char *esil;
+} EsilBlockOp;
+
+typedef struct {
+	int count; // 0 if the op at the block address must be single stepped
+	EsilBlockOp *ops;
+} EsilBlock;
+
+static void esil_block_free(HtUPKv *kv) {
+	EsilBlock *b = kv->value;
+	int i;
+	for (i = 0; i < b->count; i++) {
+		free (b->ops[i].esil);
+	}
+	free (b->ops);
+	free (b);
+}
+
+static bool esil_block_ends(RAnalOp *op) {
+	switch (op->type & R_ANAL_OP_TYPE_MASK) {
+	case R_ANAL_OP_TYPE_JMP:
+	case R_ANAL_OP_TYPE_UJMP:
+	case R_ANAL_OP_TYPE_CJMP:
+	case R_ANAL_OP_TYPE_MJMP:
+	case R_ANAL_OP_TYPE_UCJMP:
+	case R_ANAL_OP_TYPE_CALL:
+	case R_ANAL_OP_TYPE_UCALL:
+	case R_ANAL_OP_TYPE_CCALL:
+	case R_ANAL_OP_TYPE_UCCALL:
+	case R_ANAL_OP_TYPE_RET:
+	case R_ANAL_OP_TYPE_CRET:
+	case R_ANAL_OP_TYPE_SWI:
+	case R_ANAL_OP_TYPE_CSWI:
+	case R_ANAL_OP_TYPE_TRAP:
+		return true;
+	}
+	return false;
+}
+
+static EsilBlock *esil_block_decode(RCore *core, ut64 addr) {
+	RAnalEsil *esil = core->anal->esil;
+	const int align = r_anal_archinfo (core->anal, R_ANAL_ARCHINFO_DATA_ALIGN);
+	EsilBlock *b = R_NEW0 (EsilBlock);
+	if (!b || !(b->ops = R_NEWS0 (EsilBlockOp, ESIL_BLOCK_MAXOPS))) {
+		free (b);
+		return NULL;
+	}
+	ut64 at = addr;
+	ut8 code[32];
+	while (b->count < ESIL_BLOCK_MAXOPS) {
+		if (esil->exectrap && !r_io_is_valid_offset (core->io, at, R_PERM_X)) {
+			break;
+		}
+		if ((align > 1 && at % align) || r_anal_pin_call (core->anal, at)) {
+			break;
+		}
+		RAnalOp op = {0};
+		(void) r_io_read_at_mapped (core->io, at, code, sizeof (code));
+		int ret = r_anal_op (core->anal, &op, at, code, sizeof (code), R_ANAL_OP_MASK_ESIL | R_ANAL_OP_MASK_HINT);
+		if (ret < 1 || op.size < 1 || op.delay) {
+			r_anal_op_fini (&op);
+			break;
+		}
+		EsilBlockOp *bop = &b->ops[b->count++];
+		bop->addr = at;
+		bop->size = op.size;
+		bop->esil = strdup (r_strbuf_get (&op.esil));
+		at += op.size;
+		bool ends = esil_block_ends (&op);
+		r_anal_op_fini (&op);
+		if (!bop->esil) {
+			b->count--;
+			break;
+		}
+		if (ends) {
+			break;
+		}
+	}
+	if (b->count) {
+		if (esil->code_from >= esil->code_to) {
+			esil->code_from = addr;
+			esil->code_to = at;
+		} else {
+			esil->code_from = R_MIN (esil->code_from, addr);
+			esil->code_to = R_MAX (esil->code_to, at);
+		}
+	}
+	return b;
+}
+
+static bool esil_block_mode(RCore *core) {
+	if (!r_config_get_i (core->config, "esil.blocks")) {
+		return false;
+	}
+	// these need to see every step
+	if (r_config_get_i (core->config, "cfg.r2wars") || r_config_get_i (core->config, "dbg.follow") > 0) {
+		return false;
+	}
+	if (core->dbg->trace->enabled || (core->anal->cur && core->anal->cur->esil_post_loop)) {
+		return false;
+	}
+	return true;
+}
+
+// Same as r_core_esil_step (core, until_addr, until_expr, NULL, false)
+static void esil_continue(RCore *core, ut64 until_addr, const char *until_expr) {
+	if (!core->anal->esil) {
+		initializeEsil (core);
+	}
+	RAnalEsil *esil = core->anal->esil;
+	if (!esil || !esil_block_mode (core)) {
+		r_core_esil_step (core, until_addr, until_expr, NULL, false);
+		return;
+	}
+	RReg *reg = core->anal->reg;
+	RRegItem *ri_pc = r_reg_get (reg, r_reg_get_name (reg, R_REG_NAME_PC), -1);
+	if (!ri_pc) {
+		r_core_esil_step (core, until_addr, until_expr, NULL, false);
+		return;
+	}
+	if (until_expr && !strcmp (until_expr, "0")) {
+		// plain aec
+		until_expr = NULL;
+	}
+	const int esiltimeout = r_config_get_i (core->config, "esil.timeout");
+	const ut64 startTime = r_sys_now ();
+	HtUP *blocks = ht_up_new (NULL, esil_block_free, NULL);
+	ut64 pc = r_reg_get_value (reg, ri_pc);
+	bool stop = false;
+	esil->code_from = esil->code_to = 0;
+	esil->code_dirty = false;
+	r_cons_break_push (NULL, NULL);
+	while (!stop && blocks) {
+		if (r_cons_is_breaked ()) {
+			eprintf ("[+] ESIL emulation interrupted at 0x%08" PFMT64x "\n", pc);
+			break;
+		}
+		if (esiltimeout > 0 && ((r_sys_now () - startTime) >> 20) >= esiltimeout) {
+			eprintf ("[ESIL] Timeout exceeded.\n");
+			break;
+		}
+		if (esil->code_dirty) {
+			ht_up_free (blocks);
+			blocks = ht_up_new (NULL, esil_block_free, NULL);
+			esil->code_from = esil->code_to = 0;
+			esil->code_dirty = false;
+		}
+		EsilBlock *b = ht_up_find (blocks, pc, NULL);
+		if (!b) {
+			b = esil_block_decode (core, pc);
+			if (!b || !ht_up_insert (blocks, pc, b)) {
+				break;
+			}
+		}
+		if (!b->count) {
+			if (r_anal_pin_call (core->anal, pc)) {
+				// the step loop ends the run when a pin moves pc, and
+				// can't tell it from a branch once it's back: hand over
+				r_core_esil_step (core, until_addr, until_expr, NULL, false);
+				pc = r_reg_get_value (reg, ri_pc);
+				break;
+			}
+			// let the single stepper trap or report it
+			const ut64 prev = pc;
+			if (!r_core_esil_step (core, UT64_MAX, NULL, NULL, false)) {
+				break;
+			}
+			esil = core->anal->esil;
+			pc = r_reg_get_value (reg, ri_pc);
+			if (!esil || pc == prev || esil->trap == R_ANAL_TRAP_EXEC_ERR) {
+				// nothing was run or an exec trap, the step loop returns there
+				break;
+			}
+			if (r_bp_get_at (core->dbg->bp, pc)) {
+				r_cons_printf ("[ESIL] hit breakpoint at 0x%"PFMT64x "\n", pc);
+				stop = true;
+			} else if (until_addr != UT64_MAX) {
+				stop = pc == until_addr;
+			} else if (esil->trap) {
+				stop = true;
+			} else if (until_expr) {
+				stop = r_anal_esil_condition (esil, until_expr);
+			}
+			continue;
+		}
+		int i;
+		for (i = 0; i < b->count && !stop; i++) {
+			EsilBlockOp *op = &b->ops[i];
+			const ut64 next = op->addr + op->size;
+			esil->trap = 0;
+			r_reg_set_value (reg, ri_pc, next);
+			r_anal_esil_set_pc (esil, op->addr);
+			if (*op->esil) {
+				r_anal_esil_parse (esil, op->esil);
+				r_anal_esil_stack_free (esil);
+			}
+			pc = r_reg_get_value (reg, ri_pc);
+			if (r_bp_get_at (core->dbg->bp, pc)) {
+				r_cons_printf ("[ESIL] hit breakpoint at 0x%"PFMT64x "\n", pc);
+				stop = true;
+			} else if (until_addr != UT64_MAX) {
+				stop = pc == until_addr;
+			} else if (esil->trap) {
+				if (esil->verbose) {
+					eprintf ("TRAP\n");
+				}
+				stop = true;
+			} else if (until_expr && r_anal_esil_condition (esil, until_expr)) {
+				if (esil->verbose) {
+					eprintf ("ESIL BREAK!\n");
+				}
+				stop = true;
+			}
+			if (pc != next || esil->code_dirty || esil != core->anal->esil) {
+				break;
+			}
+		}
+		if (esil != core->anal->esil) {
+			// a command hook reinitialized esil
+			break;
+		}
+	}
+	r_cons_break_pop ();
+	r_asm_set_pc (core->assembler, pc);
+	if (core->anal->esil) {
+		core->anal->esil->code_from = core->anal->esil->code_to = 0;
+	}
+	ht_up_free (blocks);
+}
+
 R_API int r_core_esil_step_back(RCore *core) {
 	RAnalEsil *esil = core->anal->esil;
 	RListIter *tail;
@@ -5723,7 +5972,7 @@ static void cmd_anal_esil(RCore *core, const char *input) {
 			} else {
 				until_expr = "0";
 			}
-			r_core_esil_step (core, until_addr, until_expr, NULL, false);
+			esil_continue (core, until_addr, until_expr);
 			r_core_cmd0 (core, ".ar*");
 		}
 		break;
@@ -6151,6 +6400,18 @@ static void cmd_anal_opcode(RCore *core, const char *input) {
 		r_config_set_i (core->config, "asm.xrefs", xr);
 	}
 	break;
+	case 'C': // "aoC"
+		if (input[1] == '-') {
+			r_anal_op_cache_flush (core->anal);
+			core->anal->opcache.hits = 0;
+			core->anal->opcache.misses = 0;
+		} else {
+			RAnalOpCache *c = &core->anal->opcache;
+			const ut64 total = c->hits + c->misses;
+			r_cons_printf ("size %u\nhits %"PFMT64u"\nmisses %"PFMT64u"\nratio %.2f%%\n",
+				c->size, c->hits, c->misses, total? c->hits * 100.0 / total: 0.0);
+		}
+		break;
 	case 'd': // "aod"
 		if (input[1] == 'a') { // "aoda"
 			// list sdb database
@@ -6840,8 +7101,114 @@ static char *get_buf_asm(RCore *core, ut64 from, ut64 addr, RAnalFunction *fcn,
 	return buf_asm;
 }
 
-#define var_ref_list(a,d,t) sdb_fmt ("var.0x%"PFMT64x".%d.%d.%s",\
-		a, 1, d, (t == 'R')?"reads":"writes");
+typedef struct {
+	RCore *core;
+	ut64 addr;
+	int mode;
+	PJ *pj;
+	RAnalRef prev;
+	int count;
+} AxtUser;
+
+// axt* separates the comments with a trailing comma, so each one is
+// printed once the next ref (or the end of the walk) is known
+static void axt_comment(AxtUser *u, bool more) {
+	// TODO: implement multi-line comments
+	r_cons_printf ("CCa 0x%" PFMT64x " \"XREF type %d at 0x%" PFMT64x"%s\n",
+		u->prev.addr, u->prev.type, u->addr, more? ",": "");
+}
+
+static bool axt_ref(RAnalRef *ref, void *user) {
+	AxtUser *u = user;
+	RCore *core = u->core;
+	RAnalFunction *fcn;
+	char *str;
+	u->count++;
+	switch (u->mode) {
+	case 'q': // "axtq"
+		r_cons_printf ("0x%" PFMT64x "\n", ref->addr);
+		break;
+	case 'j': { // "axtj"
+		PJ *pj = u->pj;
+		fcn = r_anal_get_fcn_in (core->anal, ref->addr, 0);
+		str = get_buf_asm (core, u->addr, ref->addr, fcn, false);
+		pj_o (pj);
+		pj_kn (pj, "from", ref->addr);
+		pj_ks (pj, "type", r_anal_xrefs_type_tostring (ref->type));
+		pj_ks (pj, "opcode", str);
+		if (fcn) {
+			pj_kn (pj, "fcn_addr", fcn->addr);
+			pj_ks (pj, "fcn_name", fcn->name);
+		}
+		RFlagItem *fi = r_flag_get_at (core->flags, fcn? fcn->addr: ref->addr, true);
+		if (fi) {
+			if (fcn) {
+				if (strcmp (fcn->name, fi->name)) {
+					pj_ks (pj, "flag", fi->name);
+				}
+			} else {
+				pj_k (pj, "name");
+				if (fi->offset != ref->addr) {
+					int delta = (int)(ref->addr - fi->offset);
+					char *name_ref = r_str_newf ("%s+%d", fi->name, delta);
+					pj_s (pj, name_ref);
+					free (name_ref);
+				} else {
+					pj_s (pj, fi->name);
+				}
+			}
+			if (fi->realname && strcmp (fi->name, fi->realname)) {
+				char *escaped = r_str_escape (fi->realname);
+				if (escaped) {
+					pj_ks (pj, "realname", escaped);
+					free (escaped);
+				}
+			}
+		}
+		char *refname = core->anal->coreb.getNameDelta (core, ref->at);
+		if (refname) {
+			r_str_replace_ch (refname, ' ', 0, true);
+			pj_ks (pj, "refname", refname);
+			free (refname);
+		}
+		pj_end (pj);
+		free (str);
+		break;
+	}
+	case 'g': // "axtg" nodes
+		str = r_core_cmd_strf (core, "fd 0x%"PFMT64x, ref->addr);
+		if (!str) {
+			str = strdup ("?\n");
+		}
+		r_str_trim_tail (str);
+		r_cons_printf ("agn 0x%" PFMT64x " \"%s\"\n", ref->addr, str);
+		free (str);
+		break;
+	case 'e': // "axtg" edges
+		r_cons_printf ("age 0x%" PFMT64x " 0x%"PFMT64x"\n", ref->addr, u->addr);
+		break;
+	case '*': // "axt*"
+		if (u->count > 1) {
+			axt_comment (u, true);
+		}
+		u->prev = *ref;
+		break;
+	default: { // "axt"
+		fcn = r_anal_get_fcn_in (core->anal, ref->addr, 0);
+		char *buf_asm = get_buf_asm (core, u->addr, ref->addr, fcn, true);
+		char *comment = r_meta_get_string (core->anal, R_META_TYPE_COMMENT, ref->addr);
+		char *buf_fcn = comment
+			? r_str_newf ("%s; %s", fcn ?  fcn->name : "(nofunc)", strtok (comment, "\n"))
+			: r_str_newf ("%s", fcn ? fcn->name : "(nofunc)");
+		r_cons_printf ("%s 0x%" PFMT64x " [%s] %s\n",
+			buf_fcn, ref->addr, r_anal_xrefs_type_tostring (ref->type), buf_asm);
+		free (buf_asm);
+		free (buf_fcn);
+		break;
+	}
+	}
+	return true;
+}
 
 static bool cmd_anal_refs(RCore *core, const char *input) {
 	ut64 addr = core->offset;
@@ -6946,10 +7313,6 @@ static bool cmd_anal_refs(RCore *core, const char *input) {
 		free (ptr);
 	} break;
 	case 't': { // "axt"
-		RList *list = NULL;
-		RAnalFunction *fcn;
-		RAnalRef *ref;
-		RListIter *iter;
 		char *space = strchr (input, ' ');
 		char *tmp = NULL;
 		char *name = space ? strdup (space + 1): NULL;
@@ -6961,27 +7324,18 @@ static bool cmd_anal_refs(RCore *core, const char *input) {
 			if (fcn) {
 				RAnalVar *var = r_anal_var_get_byname (core->anal, fcn->addr, varname);
 				if (var) {
-					const char *rvar = var_ref_list (fcn->addr, var->delta, 'R');
-					const char *wvar = var_ref_list (fcn->addr, var->delta, 'W');
-					char *res = sdb_get (core->anal->sdb_fcns, rvar, 0);
-					char *res1 = sdb_get (core->anal->sdb_fcns, wvar, 0);
-					const char *ref;
-					RListIter *iter;
-					RList *list = (res && *res)? r_str_split_list (res, ",", 0): NULL;
-					RList *list1 = (res1 && *res1)? r_str_split_list (res1, ",", 0): NULL;
-					r_list_join (list , list1);
-					r_list_foreach (list, iter, ref) {
-						ut64 addr = r_num_math (NULL, ref);
-						char *op = get_buf_asm (core, core->offset, addr, fcn, true);
-						r_cons_printf ("%s 0x%"PFMT64x" [DATA] %s\n", fcn?  fcn->name : "(nofunc)", addr, op);
-						free (op);
+					int xs_type;
+					for (xs_type = 0; xs_type < 2; xs_type++) {
+						RVector *xs = r_anal_var_accesses (core->anal, fcn->addr, 1, var->delta, xs_type);
+						ut64 *xs_addr;
+						r_vector_foreach (xs, xs_addr) {
+							char *op = get_buf_asm (core, core->offset, *xs_addr, fcn, true);
+							r_cons_printf ("%s 0x%"PFMT64x" [DATA] %s\n", fcn?  fcn->name : "(nofunc)", *xs_addr, op);
+							free (op);
+						}
 					}
-					free (res);
-					free (res1);
 					R_FREE (name);
 					r_anal_var_free (var);
-					r_list_free (list);
-					r_list_free (list1);
 					break;
 				}
 			}
@@ -6991,118 +7345,40 @@ static bool cmd_anal_refs(RCore *core, const char *input) {
 		} else {
 			addr = core->offset;
 		}
-		list = r_anal_xrefs_get (core->anal, addr);
-		if (list) {
-			if (input[1] == 'q') { // "axtq"
-				r_list_foreach (list, iter, ref) {
-					r_cons_printf ("0x%" PFMT64x "\n", ref->addr);
-				}
-			} else if (input[1] == 'j') { // "axtj"
-				PJ *pj = pj_new ();
-				if (!pj) {
-					return false;
-				}
-				pj_a (pj);
-				r_list_foreach (list, iter, ref) {
-					fcn = r_anal_get_fcn_in (core->anal, ref->addr, 0);
-					char *str = get_buf_asm (core, addr, ref->addr, fcn, false);
-					pj_o (pj);
-					pj_kn (pj, "from", ref->addr);
-					pj_ks (pj, "type", r_anal_xrefs_type_tostring (ref->type));
-					pj_ks (pj, "opcode", str);
-					if (fcn) {
-						pj_kn (pj, "fcn_addr", fcn->addr);
-						pj_ks (pj, "fcn_name", fcn->name);
-					}
-					RFlagItem *fi = r_flag_get_at (core->flags, fcn? fcn->addr: ref->addr, true);
-					if (fi) {
-						if (fcn) {
-							if (strcmp (fcn->name, fi->name)) {
-								pj_ks (pj, "flag", fi->name);
-							}
-						} else {
-							pj_k (pj, "name");
-							if (fi->offset != ref->addr) {
-								int delta = (int)(ref->addr - fi->offset);
-								char *name_ref = r_str_newf ("%s+%d", fi->name, delta);
-								pj_s (pj, name_ref);
-								free (name_ref);
-							} else {
-								pj_s (pj, fi->name);
-							}
-						}
-						if (fi->realname && strcmp (fi->name, fi->realname)) {
-							char *escaped = r_str_escape (fi->realname);
-							if (escaped) {
-								pj_ks (pj, "realname", escaped);
-								free (escaped);
-							}
-						}
-					}
-					char *refname = core->anal->coreb.getNameDelta (core, ref->at);
-					if (refname) {
-						r_str_replace_ch (refname, ' ', 0, true);
-						pj_ks (pj, "refname", refname);
-						free (refname);
-					}
-					pj_end (pj);
-					free (str);
-				}
-				pj_end (pj);
-				r_cons_printf ("%s", pj_string (pj));
-				pj_free (pj);
-				r_cons_newline ();
-			} else if (input[1] == 'g') { // axtg
-				r_list_foreach (list, iter, ref) {
-					char *str = r_core_cmd_strf (core, "fd 0x%"PFMT64x, ref->addr);
-					if (!str) {
-						str = strdup ("?\n");
-					}
-					r_str_trim_tail (str);
-					r_cons_printf ("agn 0x%" PFMT64x " \"%s\"\n", ref->addr, str);
-					free (str);
-				}
+		AxtUser u = { .core = core, .addr = addr, .mode = input[1] };
+		switch (input[1]) {
+		case 'j': // "axtj"
+			u.pj = pj_new ();
+			if (!u.pj) {
+				return false;
+			}
+			pj_a (u.pj);
+			r_anal_xrefs_foreach (core->anal, addr, axt_ref, &u);
+			pj_end (u.pj);
+			r_cons_println (pj_string (u.pj));
+			pj_free (u.pj);
+			break;
+		case 'g': // "axtg"
+			r_anal_xrefs_foreach (core->anal, addr, axt_ref, &u);
+			if (u.count > 0) {
 				if (input[2] != '*') {
 					RAnalFunction *fcn = r_anal_get_fcn_in (core->anal, addr, 0);
 					r_cons_printf ("agn 0x%" PFMT64x " \"%s\"\n", addr, fcn?fcn->name: "$$");
 				}
-				r_list_foreach (list, iter, ref) {
-					r_cons_printf ("age 0x%" PFMT64x " 0x%"PFMT64x"\n", ref->addr, addr);
-				}
-			} else if (input[1] == '*') { // axt*
-				// TODO: implement multi-line comments
-				r_list_foreach (list, iter, ref)
-					r_cons_printf ("CCa 0x%" PFMT64x " \"XREF type %d at 0x%" PFMT64x"%s\n",
-						ref->addr, ref->type, addr, iter->n? ",": "");
-			} else { // axt
-				RAnalFunction *fcn;
-				char *comment;
-				r_list_foreach (list, iter, ref) {
-					fcn = r_anal_get_fcn_in (core->anal, ref->addr, 0);
-					char *buf_asm = get_buf_asm (core, addr, ref->addr, fcn, true);
-					comment = r_meta_get_string (core->anal, R_META_TYPE_COMMENT, ref->addr);
-					char *buf_fcn = comment
-						? r_str_newf ("%s; %s", fcn ?  fcn->name : "(nofunc)", strtok (comment, "\n"))
-						: r_str_newf ("%s", fcn ? fcn->name : "(nofunc)");
-					r_cons_printf ("%s 0x%" PFMT64x " [%s] %s\n",
-						buf_fcn, ref->addr, r_anal_xrefs_type_tostring (ref->type), buf_asm);
-					free (buf_asm);
-					free (buf_fcn);
-				}
+				u.mode = 'e';
+				r_anal_xrefs_foreach (core->anal, addr, axt_ref, &u);
 			}
-		} else {
-			if (input[1] == 'j') { // "axtj"
-				PJ *pj = pj_new ();
-				if (!pj) {
-					return false;
-				}
-				pj_a (pj);
-				pj_end (pj);
-				r_cons_println (pj_string (pj));
-				pj_free (pj);
+			break;
+		case '*': // "axt*"
+			r_anal_xrefs_foreach (core->anal, addr, axt_ref, &u);
+			if (u.count > 0) {
+				axt_comment (&u, false);
 			}
+			break;
+		default: // "axt" "axtq"
+			r_anal_xrefs_foreach (core->anal, addr, axt_ref, &u);
+			break;
 		}
-		r_list_free (list);
 	} break;
 	case 'f':
 		if (input[1] == 'f') { // "axff"
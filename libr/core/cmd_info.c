@@ -70,6 +70,7 @@ static const char *help_msg_id[] = {
 	"idp", " [file.pdb]", "Load pdb file information",
 	"idpi", " [file.pdb]", "Show pdb file information",
 	"idpi*", "", "Show symbols from pdb as flags (prefix with dot to import)",
+	"idpn", " [name]", "Show the pdb type or global symbol with this name",
 	"idpd", "", "Download pdb file on remote server",
 	NULL
 };
@@ -786,19 +787,20 @@ static int cmd_info(void *data, const char *input) {
 			goto done;
 		}
 		case 's': { // "is"
-			RBinObject *obj = r_bin_cur_object (core->bin);
+			RList *symbols = r_bin_get_symbols (core->bin);
+			const int nsymbols = symbols? r_list_length (symbols): 0;
 			// Case for isj.
 			if (input[1] == 'j' && input[2] == '.') {
 				mode = R_MODE_JSON;
-				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 2, (obj && obj->symbols)? r_list_length (obj->symbols): 0);
+				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 2, nsymbols);
 			} else if (input[1] == 'q' && input[2] == 'q') {
 				mode = R_MODE_SIMPLEST;
-				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 1, (obj && obj->symbols)? r_list_length (obj->symbols): 0);
+				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 1, nsymbols);
 			} else if (input[1] == 'q' && input[2] == '.') {
 				mode = R_MODE_SIMPLE;
 				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 2, 0);
 			} else {
-				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 1, (obj && obj->symbols)? r_list_length (obj->symbols): 0);
+				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 1, nsymbols);
 			}
 			while (*(++input)) ;
 			input--;
@@ -844,9 +846,22 @@ static int cmd_info(void *data, const char *input) {
 					}
 					input++;
 					break;
-				case 'i':
+				case 'n': // "idpn"
+				case 'i': {
+					char *pdb_name = NULL;
 					info = r_bin_get_info (core->bin);
 					filename = strchr (input, ' ');
+					if (input[2] == 'n') {
+						// the name takes the argument, the file is found as with idpi
+						pdb_name = filename? r_str_trim_dup (filename): NULL;
+						filename = NULL;
+						if (!pdb_name || !*pdb_name) {
+							eprintf ("Usage: idpn [name]\n");
+							free (pdb_name);
+							while (input[2]) input++;
+							break;
+						}
+					}
 					while (input[2]) input++;
 					if (filename) {
 						*filename++ = '\0';
@@ -856,6 +871,7 @@ static int cmd_info(void *data, const char *input) {
 						/* Autodetect local file */
 						if (!info || !info->debug_file_name) {
 							eprintf ("Cannot get file's debug information\n");
+							free (pdb_name);
 							break;
 						}
 						// Check raw path for debug filename
@@ -894,6 +910,7 @@ static int cmd_info(void *data, const char *input) {
 					if (!file_found) {
 						eprintf ("File '%s' not found in file directory or symbol store\n", r_file_basename (info->debug_file_name));
 						free (filename);
+						free (pdb_name);
 						break;
 					}
 					ut64 baddr = 0;
@@ -902,9 +919,11 @@ static int cmd_info(void *data, const char *input) {
 					} else {
 						eprintf ("Warning: Cannot find base address, flags will probably be misplaced\n");
 					}
-					r_core_pdb_info (core, filename, baddr, mode);
+					r_core_pdb_find (core, filename, baddr, pdb_name, mode);
 					free (filename);
+					free (pdb_name);
 					break;
+				}
 				case '?':
 				default:
 					r_core_cmd_help (core, help_msg_id);
@@ -920,9 +939,9 @@ static int cmd_info(void *data, const char *input) {
 			}
 			break;
 		case 'i': { // "ii"
-			RBinObject *obj = r_bin_cur_object (core->bin);
+			RList *imports = r_bin_get_imports (core->bin);
 			RBININFO ("imports", R_CORE_BIN_ACC_IMPORTS, NULL,
-				(obj && obj->imports)? r_list_length (obj->imports): 0);
+				imports? r_list_length (imports): 0);
 			break;
 		}
 		case 'I': // "iI"
@@ -1016,8 +1035,9 @@ static int cmd_info(void *data, const char *input) {
 					input++;
 				}
 				if (obj) {
+					RList *strings = r_bin_get_strings (core->bin);
 					RBININFO ("strings", R_CORE_BIN_ACC_STRINGS, NULL,
-						(obj && obj->strings)? r_list_length (obj->strings): 0);
+						strings? r_list_length (strings): 0);
 				}
 			}
 			break;
@@ -1029,12 +1049,13 @@ static int cmd_info(void *data, const char *input) {
 				RBinClass *cls;
 				RListIter *iter;
 				RBinObject *obj = r_bin_cur_object (core->bin);
+				RList *classes = r_bin_get_classes (core->bin);
 				if (!obj) {
 					break;
 				}
 				bool fullGraph = true;
 				if (fullGraph) {
-					r_list_foreach (obj->classes, iter, cls) {
+					r_list_foreach (classes, iter, cls) {
 						if (cls->super) {
 							r_cons_printf ("agn %s\n", cls->super);
 							r_cons_printf ("agn %s\n", cls->name);
@@ -1044,7 +1065,7 @@ static int cmd_info(void *data, const char *input) {
 						}
 					}
 				} else {
-					r_list_foreach (obj->classes, iter, cls) {
+					r_list_foreach (classes, iter, cls) {
 						if (cls->super && !strstr (cls->super, "NSObject")) {
 							r_cons_printf ("agn %s\n", cls->super);
 							r_cons_printf ("agn %s\n", cls->name);
@@ -1058,6 +1079,7 @@ static int cmd_info(void *data, const char *input) {
 				RBinSymbol *sym;
 				RListIter *iter, *iter2;
 				RBinObject *obj = r_bin_cur_object (core->bin);
+				RList *classes = r_bin_get_classes (core->bin);
 				if (!obj) {
 					break;
 				}
@@ -1082,7 +1104,7 @@ static int cmd_info(void *data, const char *input) {
 					}
 					int count = 0;
 					int mode = input[1];
-					r_list_foreach (obj->classes, iter, cls) {
+					r_list_foreach (classes, iter, cls) {
 						if (radare2) {
 							r_cons_printf ("ac %s\n", cls->name);
 							r_list_foreach (cls->methods, iter2, sym) {
@@ -1142,16 +1164,16 @@ static int cmd_info(void *data, const char *input) {
 						goto done;
 					}
 					goto done;
-				} else if (obj->classes) {
-					playMsg (core, "classes", r_list_length (obj->classes));
+				} else if (classes) {
+					playMsg (core, "classes", r_list_length (classes));
 					if (strstr (input, "qq")) { // "icqq"
-						r_list_foreach (obj->classes, iter, cls) {
+						r_list_foreach (classes, iter, cls) {
 							if (!isKnownPackage (cls->name)) {
 								r_cons_printf ("%s\n", cls->name);
 							}
 						}
 					} else if (input[1] == 'l' && obj) { // "icl"
-						r_list_foreach (obj->classes, iter, cls) {
+						r_list_foreach (classes, iter, cls) {
 							r_list_foreach (cls->methods, iter2, sym) {
 								const char *comma = iter2->p? " ": "";
 								r_cons_printf ("%s0x%"PFMT64d, comma, sym->vaddr);
@@ -1162,20 +1184,21 @@ static int cmd_info(void *data, const char *input) {
 						}
 					} else if (input[1] == 'c' && obj) { // "icc"
 						mode = R_MODE_CLASSDUMP;
-						RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, r_list_length (obj->classes));
+						RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, r_list_length (classes));
 						input = " ";
 					} else { // "icq"
 						if (input[2] == 'j') {
 							mode |= R_MODE_JSON; // default mode is R_MODE_SIMPLE
 						}
-						RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, r_list_length (obj->classes));
+						RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, r_list_length (classes));
 					}
 					goto done;
 				}
 			} else { // "ic"
 				RBinObject *obj = r_bin_cur_object (core->bin);
-				if (obj && obj->classes) {
-					int len = r_list_length (obj->classes);
+				RList *classes = r_bin_get_classes (core->bin);
+				if (obj && classes) {
+					int len = r_list_length (classes);
 					RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, len);
 				}
 			}
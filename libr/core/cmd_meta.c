@@ -257,6 +257,11 @@ static int cmd_meta_lineinfo(RCore *core, const char *input) {
 		free (pheap);
 		return 0;
 	}
+	RBinFile *bf = r_bin_cur (core->bin);
+	if (bf) {
+		// the dwarf rows are only indexed on load
+		r_bin_dwarf_addrinfo (bf);
+	}
 	if (*p == '-') {
 		p++;
 		remove = true;
@@ -309,7 +314,6 @@ static int cmd_meta_lineinfo(RCore *core, const char *input) {
 			}
 			sp = pheap = (char *)o;
 		}
-		RBinFile *bf = r_bin_cur (core->bin);
 		ret = 0;
 		if (bf && bf->sdb_addrinfo) {
 			ret = cmd_meta_add_fileline (bf->sdb_addrinfo, sp, offset);
@@ -7,6 +7,7 @@
 static const char *help_msg_P[] = {
 	"Usage:", "P[?osi] [file]", "Project management",
 	"P", "", "list all projects",
+	"Pb", "[?] [file]", "save analysis snapshot (see Pb?)",
 	"Pc", " [file]", "show project script to console",
 	"Pd", " [file]", "delete project",
 	"Pi", " [file]", "show project information",
@@ -35,8 +36,19 @@ static const char *help_msg_Pn[] = {
 	NULL
 };
 
+static const char *help_msg_Pb[] = {
+	"Usage:", "Pb[o-f] [file]", "Binary analysis snapshots, keyed by the file sha1",
+	"Pb", " ([file])", "save functions, xrefs, flags, meta, vars and types",
+	"Pbo", " ([file])", "replace the analysis with the snapshot",
+	"Pb-", " ([file])", "delete the snapshot",
+	"Pbf", "", "show the snapshot path for the current file",
+	"NOTE:", "", "See 'e prj.snapshot' to load it when opening the file",
+	NULL
+};
+
 static void cmd_project_init(RCore *core) {
 	DEFINE_CMD_DESCRIPTOR (core, P);
+	DEFINE_CMD_DESCRIPTOR (core, Pb);
 	DEFINE_CMD_DESCRIPTOR (core, Pn);
 }
 
@@ -101,6 +113,44 @@ static int cmd_project(void *data, const char *input) {
 			eprintf ("Usage: PS [file]\n");
 		}
 		break;
+	case 'b': // "Pb"
+	{
+		const char *path = strchr (input, ' ');
+		path = path? r_str_trim_ro (path): NULL;
+		if (path && !*path) {
+			path = NULL;
+		}
+		switch (input[1]) {
+		case '?':
+			r_core_cmd_help (core, help_msg_Pb);
+			break;
+		case 'o': // "Pbo"
+			r_core_snapshot_load (core, path);
+			break;
+		case '-': // "Pb-"
+		case 'f': // "Pbf"
+		{
+			char *p = path? strdup (path): r_core_snapshot_path (core);
+			if (!p) {
+				eprintf ("Cannot compute the snapshot path (see bin.hashlimit)\n");
+			} else if (input[1] == 'f') {
+				r_cons_println (p);
+			} else if (!r_file_rm (p)) {
+				eprintf ("Cannot delete %s\n", p);
+			}
+			free (p);
+			break;
+		}
+		case ' ':
+		case 0:
+			r_core_snapshot_save (core, path);
+			break;
+		default:
+			r_core_cmd_help (core, help_msg_Pb);
+			break;
+		}
+		break;
+	}
 	case 'n': // "Pn"
 		if (input[1] == '?') {
 			r_core_cmd_help (core, help_msg_Pn);
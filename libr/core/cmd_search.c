@@ -2371,7 +2371,14 @@ static void do_string_search(RCore *core, RInterval search_itv, struct search_pa
 		/* TODO: launch search in background support */
 		// REMOVE OLD FLAGS r_core_cmdf (core, "f-%s*", r_config_get (core->config, "search.prefix"));
 		r_search_set_callback (core->search, &_cb_hit, param);
-		if (!(buf = malloc (core->blocksize))) {
+		const int nthreads = r_config_get_i (core->config, "search.threads");
+		const int maxlen = r_search_kw_maxlen (search);
+		ut64 bsize = core->blocksize;
+		if (nthreads > 1 && !search->bckwrds && !param->crypto_search) {
+			// big blocks to keep the threads busy, plus room to read ahead
+			bsize = R_MAX (bsize, (ut64)nthreads << 20);
+		}
+		if (!(buf = malloc (bsize + maxlen))) {
 			return;
 		}
 		if (search->bckwrds) {
@@ -2425,7 +2432,7 @@ static void do_string_search(RCore *core, RInterval search_itv, struct search_pa
 					}
 					(void)r_io_read_at (core->io, at - len, buf, len);
 				} else {
-					len = R_MIN (core->blocksize, to - at);
+					len = R_MIN (bsize, to - at);
 					if (!r_io_is_valid_offset (core->io, at, 0)) {
 						break;
 					}
@@ -2446,7 +2453,13 @@ static void do_string_search(RCore *core, RInterval search_itv, struct search_pa
 						}
 					}
 				} else {
-					(void)r_search_update (core->search, at, buf, len);
+					int buflen = len;
+					if (nthreads > 1 && maxlen > 1 && !search->bckwrds && at + len < to) {
+						// let hits crossing into the next block be reported from this one
+						buflen += R_MIN (maxlen - 1, to - at - len);
+						(void)r_io_read_at (core->io, at + len, buf + len, buflen - len);
+					}
+					(void)r_search_update_threads (core->search, at, buf, len, buflen, nthreads);
 					if (core->search->maxhits > 0 && core->search->nhits >= core->search->maxhits) {
 						goto done;
 					}
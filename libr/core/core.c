@@ -306,6 +306,15 @@ static void core_post_write_callback(void *user, ut64 maddr, ut8 *bytes, int cnt
 	RBinSection *sec;
 	ut64 vaddr;
 
+	// some anal plugins read the memory around the ops they decode
+	r_anal_op_cache_flush (core->anal);
+	RAnalEsil *esil = core->anal->esil;
+	if (esil && maddr < esil->code_to && maddr + cnt > esil->code_from) {
+		esil->code_dirty = true;
+	}
+	if (r_config_get_i (core->config, "anal.onwrite")) {
+		r_core_anal_patch (core, maddr, cnt);
+	}
 	if (!r_config_get_i (core->config, "asm.cmt.patch")) {
 		return;
 	}
@@ -323,7 +332,10 @@ static void core_post_write_callback(void *user, ut64 maddr, ut8 *bytes, int cnt
 		return;
 	}
 
-	if ((sec = r_bin_get_section_at (r_bin_cur_object (core->bin), maddr, false))) {
+	// r_core_write_at passes virtual addresses when io.va is set
+	if (core->io->va) {
+		vaddr = maddr;
+	} else if ((sec = r_bin_get_section_at (r_bin_cur_object (core->bin), maddr, false))) {
 		vaddr = maddr + sec->vaddr - sec->paddr;
 	} else {
 		vaddr = maddr;
@@ -2291,11 +2303,10 @@ static int mywrite(const ut8 *buf, int len) {
 }
 
 static bool exists_var(RPrint *print, ut64 func_addr, char *str) {
-	char *name_key = sdb_fmt ("var.0x%"PFMT64x ".%d.%s", func_addr, 1, str);
-	if (sdb_const_get_len (((RCore*)(print->user))->anal->sdb_fcns, name_key, NULL, 0)) {
-		return true;
-	}
-	return false;
+	RAnalVar *var = r_anal_var_get_byname (((RCore*)(print->user))->anal, func_addr, str);
+	bool found = var != NULL;
+	r_anal_var_free (var);
+	return found;
 }
 
 static bool r_core_anal_log(struct r_anal_t *anal, const char *msg) {
@@ -2646,6 +2657,8 @@ R_API bool r_core_init(RCore *core) {
 	ZERO_FILL (core->root_cmd_descriptor);
 	core->print = r_print_new ();
 	core->ropchain = r_list_newf ((RListFree)free);
+	core->bin_lazy = r_list_new ();
+	core->bin_images = r_list_new ();
 	r_core_bind (core, &(core->print->coreb));
 	core->print->user = core;
 	core->print->num = core->num;
@@ -2866,6 +2879,11 @@ R_API RCore *r_core_fini(RCore *c) {
 	//update_sdb (c);
 	// avoid double free
 	r_list_free (c->ropchain);
+	if (c->flags) {
+		r_flag_set_lazy (c->flags, NULL, NULL);
+	}
+	r_list_free (c->bin_lazy);
+	r_list_free (c->bin_images);
 	r_event_free (c->ev);
 	R_FREE (c->cmdlog);
 	r_th_lock_free (c->lock);
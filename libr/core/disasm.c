@@ -288,6 +288,10 @@ typedef struct {
 	const char *strip;
 	int maxflags;
 	int asm_types;
+	// merged ranges of the metadata intersecting [meta_from, meta_to)
+	RVector meta_ranges; // RInterval
+	ut64 meta_from;
+	ut64 meta_to;
 } RDisasmState;
 
 static void ds_setup_print_pre(RDisasmState *ds, bool tail, bool middle);
@@ -820,6 +824,7 @@ static RDisasmState * ds_init(RCore *core) {
 			ds->linesopts |= R_ANAL_REFLINE_TYPE_UTF8;
 		}
 	}
+	r_vector_init (&ds->meta_ranges, sizeof (RInterval), NULL, NULL);
 	return ds;
 }
 
@@ -878,13 +883,54 @@ static void ds_free(RDisasmState *ds) {
 	free (ds->osl);
 	free (ds->sl);
 	free (ds->_tabsbuf);
+	r_vector_clear (&ds->meta_ranges);
 	R_FREE (ds);
 }
 
+static bool ds_meta_range_cb(const RAnalMetaItem *item, void *user) {
+	RVector *ranges = user;
+	RInterval *last = r_vector_empty (ranges)? NULL: r_vector_index_ptr (ranges, ranges->len - 1);
+	RInterval itv = { item->from, R_MAX (item->size, 1) };
+	// items come sorted by address, so overlapping ones extend the last range
+	if (last && itv.addr <= r_itv_end (*last)) {
+		if (r_itv_end (itv) > r_itv_end (*last)) {
+			last->size = r_itv_end (itv) - last->addr;
+		}
+		return true;
+	}
+	return r_vector_push (ranges, &itv) != NULL;
+}
+
+// Tells if any metadata covers at. The metadata of the whole screen is fetched
+// in one tree walk, so lines without metadata skip all the r_meta lookups
+static bool ds_meta_at(RDisasmState *ds, ut64 at) {
+	RVector *ranges = &ds->meta_ranges;
+	if (at < ds->meta_from || at >= ds->meta_to) {
+		const ut64 span = R_MAX (ds->len, 0x100);
+		ds->meta_from = at;
+		ds->meta_to = (at + span < at)? UT64_MAX: at + span;
+		r_vector_clear (ranges);
+		r_meta_foreach_in (ds->core->anal, R_META_TYPE_ANY, ds->meta_from, ds->meta_to, ds_meta_range_cb, ranges);
+	}
+	size_t lo = 0, hi = ranges->len;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		RInterval *itv = r_vector_index_ptr (ranges, mid);
+		if (at < itv->addr) {
+			hi = mid;
+		} else if (at >= r_itv_end (*itv)) {
+			lo = mid + 1;
+		} else {
+			return true;
+		}
+	}
+	return false;
+}
+
 /* XXX move to r_print */
 static char *colorize_asm_string(RCore *core, RDisasmState *ds, bool print_color) {
 	char *source = ds->opstr? ds->opstr: r_asm_op_get_asm (&ds->asmop);
-	char *hlstr = r_meta_get_string (ds->core->anal, R_META_TYPE_HIGHLIGHT, ds->at);
+	char *hlstr = ds_meta_at (ds, ds->at)? r_meta_get_string (ds->core->anal, R_META_TYPE_HIGHLIGHT, ds->at): NULL;
 	bool partial_reset = line_highlighted (ds) ? true : ((hlstr && *hlstr) ? true : false);
 	free (hlstr);
 	RAnalFunction *f = ds->show_color_args ? fcnIn (ds, ds->vat, R_ANAL_FCN_TYPE_NULL) : NULL;
@@ -1103,7 +1149,7 @@ static void ds_build_op_str(RDisasmState *ds, bool print_color) {
 		int i = 0;
 		char *word = NULL;
 		char *bgcolor = NULL;
-		char *wcdata = r_meta_get_string (ds->core->anal, R_META_TYPE_HIGHLIGHT, ds->at);
+		char *wcdata = ds_meta_at (ds, ds->at)? r_meta_get_string (ds->core->anal, R_META_TYPE_HIGHLIGHT, ds->at): NULL;
 		int argc = 0;
 		char **wc_array = r_str_argv (wcdata, &argc);
 		for (i = 0; i < argc; i++) {
@@ -2070,8 +2116,9 @@ static void ds_show_comments_right(RDisasmState *ds) {
 		return;
 	}
 	RFlagItem *item = r_flag_get_i (core->flags, ds->at);
-	char *comment = r_meta_get_string (core->anal, R_META_TYPE_COMMENT, ds->at);
-	char *vartype = r_meta_get_string (core->anal, R_META_TYPE_VARTYPE, ds->at);
+	const bool has_meta = ds_meta_at (ds, ds->at);
+	char *comment = has_meta? r_meta_get_string (core->anal, R_META_TYPE_COMMENT, ds->at): NULL;
+	char *vartype = has_meta? r_meta_get_string (core->anal, R_META_TYPE_VARTYPE, ds->at): NULL;
 	if (!comment) {
 		if (vartype) {
 			ds->comment = r_str_newf ("%s; %s", COLOR_ARG (ds, color_func_var_type), vartype);
@@ -2378,33 +2425,38 @@ static void ds_update_ref_lines(RDisasmState *ds) {
 	}
 }
 
+typedef struct {
+	ut64 at;
+	ut64 size;
+} MetaSize;
+
+// size of the data-like metadata starting at the given address
+static bool ds_meta_size_cb(const RAnalMetaItem *item, void *user) {
+	MetaSize *ms = user;
+	if (item->from != ms->at) {
+		return true;
+	}
+	switch (item->type) {
+	case R_META_TYPE_DATA:
+	case R_META_TYPE_STRING:
+	case R_META_TYPE_FORMAT:
+	case R_META_TYPE_MAGIC:
+	case R_META_TYPE_HIDE:
+		ms->size = item->size;
+		break;
+	}
+	return true;
+}
+
 static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 	RCore *core = ds->core;
 	int ret;
-	const char *info;
-	Sdb *s = core->anal->sdb_meta;
-	char key[100];
-	ut64 mt_sz = UT64_MAX;
+	MetaSize mt = { ds->at, UT64_MAX };
+	const bool has_meta = ds_meta_at (ds, ds->at);
 
 	//handle meta info to fix ds->oplen
-	snprintf (key, sizeof (key) - 1, "meta.0x%"PFMT64x, ds->at);
-	info = sdb_const_get (s, key, 0);
-	if (info) {
-		for (;*info; info++) {
-			switch (*info) {
-			case R_META_TYPE_DATA:
-			case R_META_TYPE_STRING:
-			case R_META_TYPE_FORMAT:
-			case R_META_TYPE_MAGIC:
-			case R_META_TYPE_HIDE:
-				snprintf (key, sizeof (key) - 1,
-						"meta.%c.0x%"PFMT64x, *info, ds->at);
-				sdb_const_get (s, key, 0);
-				mt_sz = sdb_array_get_num (s, key, 0, 0);
-				//if (mt_sz) { break; }
-				break;
-			}
-		}
+	if (has_meta) {
+		r_meta_foreach_in (core->anal, R_META_TYPE_ANY, ds->at, ds->at + 1, ds_meta_size_cb, &mt);
 	}
 	if (ds->hint && ds->hint->bits) {
 		if (!ds->core->anal->opt.ignbithints) {
@@ -2424,7 +2476,7 @@ static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 		ds->asmop.size = 1;
 	}
 	// handle meta here //
-	if (!ds->asm_meta) {
+	if (!ds->asm_meta && has_meta) {
 		int i = 0;
 		// TODO: do in range
 		RAnalMetaItem *meta = r_meta_find_in (core->anal, ds->at, R_META_TYPE_ANY, R_META_WHERE_HERE);
@@ -2533,8 +2585,8 @@ static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 		char *ba = r_asm_op_get_asm (&ds->asmop);
 		*ba = toupper ((ut8)*ba);
 	}
-	if (info && mt_sz != UT64_MAX) {
-		ds->oplen = mt_sz;
+	if (mt.size != UT64_MAX) {
+		ds->oplen = mt.size;
 	}
 	return ret;
 }
@@ -2913,7 +2965,7 @@ static bool ds_print_meta_infos(RDisasmState *ds, ut8* buf, int len, int idx, in
 	RAnalMetaItem *mi, *fmi;
 	RCore *core = ds->core;
 	RListIter *iter;
-	if (!ds->asm_meta) {
+	if (!ds->asm_meta || !ds_meta_at (ds, ds->at)) {
 		return false;
 	}
 #if 0
@@ -3262,7 +3314,7 @@ static bool ds_print_labels(RDisasmState *ds, RAnalFunction *f) {
 
 #if 0
 static void ds_print_import_name(RDisasmState *ds) {
-	RListIter *iter = NULL;
+	RBIter it;
 	RBinReloc *rel = NULL;
 	RCore * core = ds->core;
 
@@ -3270,8 +3322,9 @@ static void ds_print_import_name(RDisasmState *ds) {
 	case R_ANAL_OP_TYPE_JMP:
 	case R_ANAL_OP_TYPE_CJMP:
 	case R_ANAL_OP_TYPE_CALL:
-		if (core->bin->cur->o->imports && core->bin->cur->o->relocs) {
-			r_list_foreach (core->bin->cur->o->relocs, iter, rel) {
+		if (r_bin_get_imports (core->bin)) {
+			RBNode *relocs = r_bin_get_relocs (core->bin);
+			r_rbtree_foreach (relocs, it, rel, RBinReloc, vrb) {
 				if ((rel->vaddr == ds->analop.jump) &&
 					(rel->import != NULL)) {
 					if (ds->show_color) {
@@ -3479,7 +3532,7 @@ static bool ds_print_core_vmode(RDisasmState *ds, int pos) {
 			}
 		}
 	}
-	if (ds->asm_hint_lea) {
+	if (ds->asm_hint_lea && ds_meta_at (ds, ds->at)) {
 		RAnalMetaItem *mi = r_meta_find (ds->core->anal, ds->at, R_META_TYPE_ANY, R_META_WHERE_HERE);
 		if (mi && mi->from) {
 			int obits = ds->core->assembler->bits;
@@ -4511,20 +4564,14 @@ static void delete_last_comment(RDisasmState *ds) {
 
 static bool can_emulate_metadata(RCore * core, ut64 at) {
 	const char *emuskipmeta = r_config_get (core->config, "emu.skip");
-	char key[32];
-	Sdb *s = core->anal->sdb_meta;
-	snprintf (key, sizeof (key)-1, "meta.0x%"PFMT64x, at);
-	const char *infos = sdb_const_get (s, key, 0);
-	if (!infos) {
-		/* no metadata: let's emulate this */
-		return true;
-	}
-	for (; *infos; infos++) {
-		/*
-		 * don't emulate if at least one metadata type
-		 * can't be emulated
-		 */
-		if (*infos != ',' && strchr(emuskipmeta, *infos)) {
+	/* don't emulate if at least one metadata type can't be emulated */
+	for (; emuskipmeta && *emuskipmeta; emuskipmeta++) {
+		if (*emuskipmeta == ',') {
+			continue;
+		}
+		RAnalMetaItem *mi = r_meta_find (core->anal, at, *emuskipmeta, R_META_WHERE_HERE);
+		if (mi) {
+			r_meta_item_free (mi);
 			return false;
 		}
 	}
@@ -4817,7 +4864,7 @@ static void ds_print_comments_right(RDisasmState *ds) {
 	RCore *core = ds->core;
 	ds_print_relocs (ds);
 	bool is_code = (!ds->hint) || (ds->hint && ds->hint->type != 'd');
-	RAnalMetaItem *mi = r_meta_find (ds->core->anal, ds->at, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	RAnalMetaItem *mi = ds_meta_at (ds, ds->at)? r_meta_find (ds->core->anal, ds->at, R_META_TYPE_ANY, R_META_WHERE_HERE): NULL;
 	if (mi) {
 		is_code = mi->type != 'd';
 		r_meta_item_free (mi);
@@ -5214,7 +5261,7 @@ toro:
 			if (of != f) {
 				char cmt[32];
 				get_bits_comment (core, f, cmt, sizeof (cmt));
-				char *comment = r_meta_get_string (core->anal, R_META_TYPE_COMMENT, ds->at);
+				char *comment = ds_meta_at (ds, ds->at)? r_meta_get_string (core->anal, R_META_TYPE_COMMENT, ds->at): NULL;
 				if (comment) {
 					ds_pre_xrefs (ds, true);
 					r_cons_printf ("; %s\n", comment);
@@ -0,0 +1,544 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_core.h>
+
+// Binary analysis snapshots
+//
+// Projects are r2 scripts: loading one replays every af+/afb+/ax/f/C
+// command, and afb+ even re-runs the basic block analysis on x86. A
+// snapshot stores the same state (functions, basic blocks, xrefs, flags
+// and the meta, hints, vars, types and classes databases) as fixed-size
+// records pointing into a string table, so loading it is a single mmap and
+// a linear walk inserting the records into the live structures.
+//
+// Snapshots are keyed by the sha1 of the file and live in
+// ~/.cache/radare2/snapshots/<sha1>.r2s. They store host-endian records and
+// are rejected when opened on a host with a different byte order or word
+// size.
+
+#define SNAP_MAGIC "R2SNAP\x00\x01"
+#define SNAP_VERSION 1
+#define SNAP_BOM 0x01020304
+#define SNAP_DIR R_JOIN_3_PATHS (R2_HOME_CACHEDIR, "snapshots", "")
+
+enum {
+	SNAP_STRS,
+	SNAP_FCNS,
+	SNAP_BBS,
+	SNAP_OPPOS,
+	SNAP_XREFS,
+	SNAP_FLAGS,
+	SNAP_KVS,
+	SNAP_NSECTIONS
+};
+
+typedef struct {
+	char magic[8];
+	ut32 version;
+	ut32 bom;
+	ut32 nsections;
+	ut32 ptrsize;
+} SnapHeader;
+
+typedef struct {
+	ut64 offset;
+	ut64 count; // number of records, bytes for SNAP_STRS
+} SnapSection;
+
+// strings are offsets into SNAP_STRS, 0 is NULL (the table starts with a 0 byte)
+typedef struct {
+	ut64 addr;
+	ut64 size;
+	ut32 name;
+	ut32 cc;
+	ut32 bb_first;
+	ut32 bb_count;
+	st32 type;
+	st32 bits;
+	st32 stack;
+	st32 maxstack;
+	st32 ninstr;
+	ut32 attrs;
+} SnapFcn;
+
+#define SNAP_FCN_FOLDED 1
+#define SNAP_FCN_NORETURN 2
+#define SNAP_FCN_BP_FRAME 4
+
+typedef struct {
+	ut64 addr;
+	ut64 jump;
+	ut64 fail;
+	st32 size;
+	st32 type;
+	st32 ninstr;
+	ut32 oppos_first; // offsets of the instructions after the first one
+	ut32 oppos_count;
+	ut32 pad;
+} SnapBlock;
+
+typedef struct {
+	ut64 from;
+	ut64 to;
+	ut64 type;
+} SnapXref;
+
+typedef struct {
+	ut64 offset;
+	ut64 size;
+	ut32 name;
+	ut32 realname;
+	ut32 space;
+	ut32 comment;
+	ut32 color;
+	ut32 alias;
+} SnapFlag;
+
+typedef struct {
+	ut32 db;
+	ut32 key;
+	ut32 value;
+	ut32 pad;
+} SnapKV;
+
+typedef struct {
+	RCore *core;
+	RBuffer *strs;
+	HtPP *strs_ht;
+	RVector fcns;
+	RVector bbs;
+	RVector oppos;
+	RVector xrefs;
+	RVector flags;
+	RVector kvs;
+	ut32 db;
+	bool fail;
+} SnapWriter;
+
+static Sdb *snap_db(RAnal *anal, ut32 db) {
+	switch (db) {
+	case 0: return anal->sdb_types;
+	case 1: return anal->sdb_meta;
+	case 2: return anal->sdb_hints;
+	case 3: return anal->sdb_fcns;
+	case 4: return anal->sdb_classes;
+	case 5: return anal->sdb_classes_attrs;
+	}
+	return NULL;
+}
+
+static ut32 snap_str(SnapWriter *w, const char *s) {
+	bool found = false;
+	if (!s) {
+		return 0;
+	}
+	ut32 off = (ut32)(size_t)ht_pp_find (w->strs_ht, s, &found);
+	if (found) {
+		return off;
+	}
+	off = (ut32)r_buf_size (w->strs);
+	if (!r_buf_append_bytes (w->strs, (const ut8 *)s, strlen (s) + 1)) {
+		w->fail = true;
+		return 0;
+	}
+	ht_pp_insert (w->strs_ht, s, (void *)(size_t)off);
+	return off;
+}
+
+static void snap_push(SnapWriter *w, RVector *v, void *rec) {
+	if (!r_vector_push (v, rec)) {
+		w->fail = true;
+	}
+}
+
+static bool snap_add_ref(RAnalRef *ref, void *user) {
+	SnapWriter *w = user;
+	SnapXref x = { ref->at, ref->addr, ref->type };
+	snap_push (w, &w->xrefs, &x);
+	return !w->fail;
+}
+
+static bool snap_add_flag(RFlagItem *fi, void *user) {
+	SnapWriter *w = user;
+	SnapFlag f = {
+		.offset = fi->offset,
+		.size = fi->size,
+		.name = snap_str (w, fi->name),
+		.realname = fi->realname != fi->name? snap_str (w, fi->realname): 0,
+		.space = fi->space? snap_str (w, fi->space->name): 0,
+		.comment = snap_str (w, fi->comment),
+		.color = snap_str (w, fi->color),
+		.alias = snap_str (w, fi->alias),
+	};
+	snap_push (w, &w->flags, &f);
+	return !w->fail;
+}
+
+static int snap_add_kv(void *user, const char *k, const char *v) {
+	SnapWriter *w = user;
+	SnapKV kv = { w->db, snap_str (w, k), snap_str (w, v), 0 };
+	snap_push (w, &w->kvs, &kv);
+	return !w->fail;
+}
+
+static void snap_add_fcn(SnapWriter *w, RAnalFunction *fcn) {
+	RListIter *iter;
+	RAnalBlock *bb;
+	SnapFcn f = {
+		.addr = fcn->addr,
+		.size = r_anal_fcn_size (fcn),
+		.name = snap_str (w, fcn->name),
+		.cc = snap_str (w, fcn->cc),
+		.bb_first = w->bbs.len,
+		.bb_count = r_list_length (fcn->bbs),
+		.type = fcn->type,
+		.bits = fcn->bits,
+		.stack = fcn->stack,
+		.maxstack = fcn->maxstack,
+		.ninstr = fcn->ninstr,
+		.attrs = (fcn->folded? SNAP_FCN_FOLDED: 0)
+			| (fcn->is_noreturn? SNAP_FCN_NORETURN: 0)
+			| (fcn->bp_frame? SNAP_FCN_BP_FRAME: 0),
+	};
+	snap_push (w, &w->fcns, &f);
+	r_list_foreach (fcn->bbs, iter, bb) {
+		int i, npos = bb->op_pos? R_MAX (R_MIN (bb->ninstr - 1, bb->op_pos_size), 0): 0;
+		SnapBlock b = {
+			.addr = bb->addr,
+			.jump = bb->jump,
+			.fail = bb->fail,
+			.size = bb->size,
+			.type = bb->type,
+			.ninstr = bb->ninstr,
+			.oppos_first = w->oppos.len,
+			.oppos_count = npos,
+		};
+		snap_push (w, &w->bbs, &b);
+		for (i = 0; i < npos; i++) {
+			snap_push (w, &w->oppos, &bb->op_pos[i]);
+		}
+	}
+}
+
+static bool snap_write(SnapWriter *w, const char *file) {
+	SnapHeader hdr = { .version = SNAP_VERSION, .bom = SNAP_BOM,
+		.nsections = SNAP_NSECTIONS, .ptrsize = sizeof (void *) };
+	SnapSection secs[SNAP_NSECTIONS] = {{ 0 }};
+	ut64 strs_len = 0;
+	const ut8 *strs = r_buf_data (w->strs, &strs_len);
+	const void *data[SNAP_NSECTIONS] = { strs, w->fcns.a, w->bbs.a, w->oppos.a,
+		w->xrefs.a, w->flags.a, w->kvs.a };
+	const RVector *vecs[SNAP_NSECTIONS] = { NULL, &w->fcns, &w->bbs, &w->oppos,
+		&w->xrefs, &w->flags, &w->kvs };
+	ut64 off = R_ROUND (sizeof (hdr) + sizeof (secs), 8);
+	int i;
+
+	memcpy (hdr.magic, SNAP_MAGIC, sizeof (hdr.magic));
+	for (i = 0; i < SNAP_NSECTIONS; i++) {
+		ut64 size = vecs[i]? vecs[i]->len * vecs[i]->elem_size: strs_len;
+		secs[i].offset = off;
+		secs[i].count = vecs[i]? vecs[i]->len: strs_len;
+		off = R_ROUND (off + size, 8);
+	}
+	if (off > ST32_MAX) {
+		eprintf ("Snapshot too big\n");
+		return false;
+	}
+	ut8 *buf = calloc (1, off);
+	if (!buf) {
+		return false;
+	}
+	memcpy (buf, &hdr, sizeof (hdr));
+	memcpy (buf + sizeof (hdr), secs, sizeof (secs));
+	for (i = 0; i < SNAP_NSECTIONS; i++) {
+		ut64 size = vecs[i]? vecs[i]->len * vecs[i]->elem_size: strs_len;
+		if (size) {
+			memcpy (buf + secs[i].offset, data[i], size);
+		}
+	}
+	bool ret = r_file_dump (file, buf, (int)off, false);
+	free (buf);
+	return ret;
+}
+
+R_API char *r_core_snapshot_path(RCore *core) {
+	RListIter *iter;
+	RBinFileHash *h;
+	RBinObject *o = r_bin_cur_object (core->bin);
+	if (!o || !o->info) {
+		return NULL;
+	}
+	if (r_list_empty (o->info->file_hashes)) {
+		ut64 limit = r_config_get_i (core->config, "bin.hashlimit");
+		if (!r_bin_file_hash (core->bin, limit, NULL, NULL)) {
+			return NULL;
+		}
+	}
+	r_list_foreach (o->info->file_hashes, iter, h) {
+		if (!strcmp (h->type, "sha1")) {
+			char *dir = r_str_home (SNAP_DIR);
+			char *path = dir? r_str_newf ("%s%s.r2s", dir, h->hex): NULL;
+			free (dir);
+			return path;
+		}
+	}
+	return NULL;
+}
+
+// Save the analysis state to file, or to r_core_snapshot_path when file is NULL
+R_API bool r_core_snapshot_save(RCore *core, const char *file) {
+	RListIter *iter;
+	RAnalFunction *fcn;
+	SnapWriter w = { .core = core };
+	char *path = file? strdup (file): r_core_snapshot_path (core);
+	bool ret = false;
+	ut32 db;
+
+	if (!path) {
+		eprintf ("Cannot compute the snapshot path (see bin.hashlimit)\n");
+		return false;
+	}
+	w.strs = r_buf_new ();
+	w.strs_ht = ht_pp_new0 ();
+	r_vector_init (&w.fcns, sizeof (SnapFcn), NULL, NULL);
+	r_vector_init (&w.bbs, sizeof (SnapBlock), NULL, NULL);
+	r_vector_init (&w.oppos, sizeof (ut16), NULL, NULL);
+	r_vector_init (&w.xrefs, sizeof (SnapXref), NULL, NULL);
+	r_vector_init (&w.flags, sizeof (SnapFlag), NULL, NULL);
+	r_vector_init (&w.kvs, sizeof (SnapKV), NULL, NULL);
+	if (!w.strs || !w.strs_ht || !r_buf_append_bytes (w.strs, (const ut8 *)"", 1)) {
+		goto beach;
+	}
+	ut64 t0 = r_sys_now ();
+	r_list_foreach (core->anal->fcns, iter, fcn) {
+		snap_add_fcn (&w, fcn);
+	}
+	r_anal_refs_foreach (core->anal, UT64_MAX, snap_add_ref, &w);
+	r_flag_foreach (core->flags, snap_add_flag, &w);
+	// hints live in their own tree, sdb_hints only holds them while saving
+	r_anal_hint_save (core->anal, core->anal->sdb_hints);
+	for (db = 0; snap_db (core->anal, db); db++) {
+		w.db = db;
+		sdb_foreach (snap_db (core->anal, db), snap_add_kv, &w);
+	}
+	sdb_reset (core->anal->sdb_hints);
+	// vars live in their own tables too, they are stored as sdb_fcns (db 3) keys
+	Sdb *vars = sdb_new0 ();
+	if (vars) {
+		r_anal_var_save (core->anal, vars);
+		w.db = 3;
+		sdb_foreach (vars, snap_add_kv, &w);
+		sdb_free (vars);
+	} else {
+		w.fail = true;
+	}
+	if (w.fail) {
+		eprintf ("Cannot allocate the snapshot\n");
+		goto beach;
+	}
+	if (!file) {
+		char *dir = r_file_dirname (path);
+		r_sys_mkdirp (dir);
+		free (dir);
+	}
+	ret = snap_write (&w, path);
+	if (ret) {
+		eprintf ("Snapshot saved to %s (%d functions, %d xrefs, %d flags) in %.3fs\n", path,
+			(int)w.fcns.len, (int)w.xrefs.len, (int)w.flags.len, (r_sys_now () - t0) / 1000000.0);
+	} else {
+		eprintf ("Cannot write %s\n", path);
+	}
+beach:
+	r_buf_free (w.strs);
+	ht_pp_free (w.strs_ht);
+	r_vector_clear (&w.fcns);
+	r_vector_clear (&w.bbs);
+	r_vector_clear (&w.oppos);
+	r_vector_clear (&w.xrefs);
+	r_vector_clear (&w.flags);
+	r_vector_clear (&w.kvs);
+	free (path);
+	return ret;
+}
+
+typedef struct {
+	const ut8 *buf;
+	const SnapSection *secs;
+	const char *strs;
+	ut64 strs_len;
+} SnapReader;
+
+static const char *snap_get_str(SnapReader *r, ut32 off) {
+	return (off && off < r->strs_len)? r->strs + off: NULL;
+}
+
+static const void *snap_section(SnapReader *r, int kind, size_t elem_size, ut64 len) {
+	const SnapSection *s = &r->secs[kind];
+	ut64 size = s->count * elem_size;
+	if (s->count > len || s->offset > len || size > len - s->offset) {
+		return NULL;
+	}
+	return r->buf + s->offset;
+}
+
+static void snap_reset(RCore *core) {
+	RAnal *anal = core->anal;
+	ut32 db;
+	for (db = 0; snap_db (anal, db); db++) {
+		sdb_reset (snap_db (anal, db));
+	}
+	r_anal_hint_clear (anal);
+	r_meta_free (anal);
+	r_anal_var_clear (anal);
+	r_list_free (anal->fcns);
+	anal->fcns = r_anal_fcn_list_new ();
+	anal->fcn_tree = NULL;
+	anal->fcn_addr_tree = NULL;
+	r_anal_xrefs_init (anal);
+}
+
+static RAnalFunction *snap_load_fcn(RAnal *anal, SnapReader *r, const SnapFcn *f, const SnapBlock *bbs, const ut16 *oppos) {
+	RAnalFunction *fcn = r_anal_fcn_new ();
+	ut32 i, j;
+	if (!fcn) {
+		return NULL;
+	}
+	const char *name = snap_get_str (r, f->name);
+	const char *cc = snap_get_str (r, f->cc);
+	fcn->addr = fcn->meta.min = f->addr;
+	fcn->name = name? strdup (name): r_str_newf ("fcn.%08"PFMT64x, f->addr);
+	fcn->cc = cc? r_str_constpool_get (&anal->constpool, cc): NULL;
+	fcn->type = f->type;
+	fcn->bits = f->bits;
+	fcn->stack = f->stack;
+	fcn->maxstack = f->maxstack;
+	fcn->ninstr = f->ninstr;
+	fcn->folded = f->attrs & SNAP_FCN_FOLDED;
+	fcn->is_noreturn = f->attrs & SNAP_FCN_NORETURN;
+	fcn->bp_frame = f->attrs & SNAP_FCN_BP_FRAME;
+	for (i = 0; i < f->bb_count; i++) {
+		const SnapBlock *b = &bbs[f->bb_first + i];
+		RAnalBlock *bb = r_anal_bb_new ();
+		if (!bb) {
+			break;
+		}
+		bb->addr = b->addr;
+		bb->jump = b->jump;
+		bb->fail = b->fail;
+		r_anal_bb_set_size (anal, bb, b->size);
+		bb->type = b->type;
+		bb->ninstr = b->ninstr;
+		for (j = 0; j < b->oppos_count; j++) {
+			r_anal_bb_set_offset (bb, j + 1, oppos[b->oppos_first + j]);
+		}
+		r_anal_fcn_bbadd (fcn, bb);
+	}
+	r_anal_fcn_update_tinyrange_bbs (fcn);
+	r_anal_fcn_set_size (NULL, fcn, f->size);
+	return fcn;
+}
+
+// Replace the analysis state with the one in file, or in r_core_snapshot_path when file is NULL
+R_API bool r_core_snapshot_load(RCore *core, const char *file) {
+	char *path = file? strdup (file): r_core_snapshot_path (core);
+	RMmap *m = NULL;
+	bool ret = false;
+	ut64 i;
+
+	if (!path) {
+		return false;
+	}
+	if (!r_file_exists (path) || !(m = r_file_mmap (path, false, 0)) || !m->buf) {
+		eprintf ("Cannot open snapshot %s\n", path);
+		goto beach;
+	}
+	const ut64 len = m->len;
+	const SnapHeader *hdr = (const SnapHeader *)m->buf;
+	if (len < sizeof (SnapHeader) + SNAP_NSECTIONS * sizeof (SnapSection)
+			|| memcmp (hdr->magic, SNAP_MAGIC, sizeof (hdr->magic))
+			|| hdr->version != SNAP_VERSION || hdr->bom != SNAP_BOM
+			|| hdr->nsections != SNAP_NSECTIONS || hdr->ptrsize != sizeof (void *)) {
+		eprintf ("Invalid or incompatible snapshot %s\n", path);
+		goto beach;
+	}
+	SnapReader r = { .buf = m->buf, .secs = (const SnapSection *)(m->buf + sizeof (SnapHeader)) };
+	r.strs = snap_section (&r, SNAP_STRS, 1, len);
+	r.strs_len = r.secs[SNAP_STRS].count;
+	const SnapFcn *fcns = snap_section (&r, SNAP_FCNS, sizeof (SnapFcn), len);
+	const SnapBlock *bbs = snap_section (&r, SNAP_BBS, sizeof (SnapBlock), len);
+	const ut16 *oppos = snap_section (&r, SNAP_OPPOS, sizeof (ut16), len);
+	const SnapXref *xrefs = snap_section (&r, SNAP_XREFS, sizeof (SnapXref), len);
+	const SnapFlag *flags = snap_section (&r, SNAP_FLAGS, sizeof (SnapFlag), len);
+	const SnapKV *kvs = snap_section (&r, SNAP_KVS, sizeof (SnapKV), len);
+	const ut64 nbbs = r.secs[SNAP_BBS].count, noppos = r.secs[SNAP_OPPOS].count;
+	if (!r.strs || !fcns || !bbs || !oppos || !xrefs || !flags || !kvs
+			|| !r.strs_len || r.strs[r.strs_len - 1]) {
+		eprintf ("Corrupted snapshot %s\n", path);
+		goto beach;
+	}
+	for (i = 0; i < r.secs[SNAP_FCNS].count; i++) {
+		const SnapFcn *f = &fcns[i];
+		if ((ut64)f->bb_first + f->bb_count > nbbs) {
+			eprintf ("Corrupted snapshot %s\n", path);
+			goto beach;
+		}
+	}
+	for (i = 0; i < nbbs; i++) {
+		if ((ut64)bbs[i].oppos_first + bbs[i].oppos_count > noppos) {
+			eprintf ("Corrupted snapshot %s\n", path);
+			goto beach;
+		}
+	}
+
+	ut64 t0 = r_sys_now ();
+	snap_reset (core);
+	for (i = 0; i < r.secs[SNAP_KVS].count; i++) {
+		Sdb *db = snap_db (core->anal, kvs[i].db);
+		const char *k = snap_get_str (&r, kvs[i].key);
+		if (db && k) {
+			sdb_set (db, k, snap_get_str (&r, kvs[i].value), 0);
+		}
+	}
+	r_anal_hint_load (core->anal, core->anal->sdb_hints);
+	sdb_reset (core->anal->sdb_hints);
+	r_anal_var_load (core->anal, core->anal->sdb_fcns);
+	r_meta_reindex (core->anal);
+	for (i = 0; i < r.secs[SNAP_FCNS].count; i++) {
+		RAnalFunction *fcn = snap_load_fcn (core->anal, &r, &fcns[i], bbs, oppos);
+		if (fcn && !r_anal_fcn_insert (core->anal, fcn)) {
+			r_anal_fcn_free (fcn);
+		}
+	}
+	for (i = 0; i < r.secs[SNAP_XREFS].count; i++) {
+		r_anal_xrefs_set (core->anal, xrefs[i].from, xrefs[i].to, xrefs[i].type);
+	}
+	// function flags were added by r_anal_fcn_insert, the snapshot ones win
+	r_flag_unset_all (core->flags);
+	for (i = 0; i < r.secs[SNAP_FLAGS].count; i++) {
+		const SnapFlag *f = &flags[i];
+		const char *name = snap_get_str (&r, f->name);
+		if (!name) {
+			continue;
+		}
+		r_flag_space_set (core->flags, snap_get_str (&r, f->space));
+		RFlagItem *fi = r_flag_set (core->flags, name, f->offset - core->flags->base, f->size);
+		if (fi) {
+			const char *realname = snap_get_str (&r, f->realname);
+			if (realname) {
+				r_flag_item_set_realname (fi, realname);
+			}
+			r_flag_item_set_comment (fi, snap_get_str (&r, f->comment));
+			r_flag_item_set_color (fi, snap_get_str (&r, f->color));
+			r_flag_item_set_alias (fi, snap_get_str (&r, f->alias));
+		}
+	}
+	r_flag_space_set (core->flags, NULL);
+	eprintf ("Snapshot loaded from %s (%d functions, %d xrefs, %d flags) in %.3fs\n", path,
+		(int)r.secs[SNAP_FCNS].count, (int)r.secs[SNAP_XREFS].count,
+		(int)r.secs[SNAP_FLAGS].count, (r_sys_now () - t0) / 1000000.0);
+	ret = true;
+beach:
+	r_file_mmap_free (m);
+	free (path);
+	return ret;
+}
@@ -259,6 +259,13 @@ R_API void r_core_task_schedule(RCoreTask *current, RTaskState next_state) {
 		return;
 	}
 
+	// keep running until the time slice is over, switching tasks on every
+	// yield point (r_cons_is_breaked) makes them all crawl
+	if (!stop && core->oneshots_enqueued == 0 && core->tasks_quantum
+			&& r_sys_now () - current->dispatched_at < core->tasks_quantum) {
+		return;
+	}
+
 	core->current_task = NULL;
 
 	TASK_SIGSET_T old_sigset;
@@ -306,6 +313,7 @@ R_API void r_core_task_schedule(RCoreTask *current, RTaskState next_state) {
 
 	if (!stop) {
 		core->current_task = current;
+		current->dispatched_at = r_sys_now ();
 		if (current->cons_context) {
 			r_cons_context_load (current->cons_context);
 		} else {
@@ -346,6 +354,7 @@ static void task_wakeup(RCoreTask *current) {
 	}
 
 	core->current_task = current;
+	current->dispatched_at = r_sys_now ();
 
 	if (current->cons_context) {
 		r_cons_context_load (current->cons_context);
@@ -29,18 +29,133 @@ static const char *str_callback(RNum *user, ut64 off, int *ok) {
 	return NULL;
 }
 
-static void flag_skiplist_free(void *data) {
-	RFlagsAtOffset *item = (RFlagsAtOffset *)data;
-	r_list_free (item->flags);
-	free (data);
+/* Items by name: an open addressing table with linear probing. Slot i holds
+ * by_name[i], whose name hashes to by_name_hash[i]; the item owns the name. */
+
+static inline ut32 name_hash(const char *name) {
+	ut32 h = sdb_hash (name);
+	h ^= h >> 16;
+	h *= 0x45d9f3b;
+	h ^= h >> 16;
+	return h;
+}
+
+static RFlagItem *names_find(RFlag *f, const char *name) {
+	if (!f->by_name_count) {
+		return NULL;
+	}
+	const ut32 mask = f->by_name_size - 1;
+	const ut32 h = name_hash (name);
+	ut32 i;
+	for (i = h & mask; f->by_name[i]; i = (i + 1) & mask) {
+		if (f->by_name_hash[i] == h && !strcmp (f->by_name[i]->name, name)) {
+			return f->by_name[i];
+		}
+	}
+	return NULL;
+}
+
+static void names_put(RFlagItem **slots, ut32 *hashes, ut32 mask, RFlagItem *item, ut32 h) {
+	ut32 i = h & mask;
+	while (slots[i]) {
+		i = (i + 1) & mask;
+	}
+	slots[i] = item;
+	hashes[i] = h;
+}
+
+static bool names_grow(RFlag *f) {
+	const ut32 size = f->by_name_size? f->by_name_size * 2: 1024;
+	RFlagItem **slots = calloc (size, sizeof (RFlagItem *));
+	ut32 *hashes = malloc (size * sizeof (ut32));
+	if (!slots || !hashes) {
+		free (slots);
+		free (hashes);
+		return false;
+	}
+	ut32 i;
+	for (i = 0; i < f->by_name_size; i++) {
+		if (f->by_name[i]) {
+			names_put (slots, hashes, size - 1, f->by_name[i], f->by_name_hash[i]);
+		}
+	}
+	free (f->by_name);
+	free (f->by_name_hash);
+	f->by_name = slots;
+	f->by_name_hash = hashes;
+	f->by_name_size = size;
+	return true;
+}
+
+// the name of the item must not be in the table yet
+static bool names_insert(RFlag *f, RFlagItem *item) {
+	if ((f->by_name_count + 1) * 4 > f->by_name_size * 3 && !names_grow (f)) {
+		return false;
+	}
+	names_put (f->by_name, f->by_name_hash, f->by_name_size - 1, item, name_hash (item->name));
+	f->by_name_count++;
+	return true;
+}
+
+static void names_delete(RFlag *f, RFlagItem *item) {
+	if (!f->by_name_count) {
+		return;
+	}
+	const ut32 mask = f->by_name_size - 1;
+	ut32 i = name_hash (item->name) & mask;
+	while (f->by_name[i] != item) {
+		if (!f->by_name[i]) {
+			return;
+		}
+		i = (i + 1) & mask;
+	}
+	// shift back the entries of the same probe run, no tombstones needed
+	ut32 j = i;
+	for (;;) {
+		j = (j + 1) & mask;
+		if (!f->by_name[j]) {
+			break;
+		}
+		ut32 home = f->by_name_hash[j] & mask;
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			f->by_name[i] = f->by_name[j];
+			f->by_name_hash[i] = f->by_name_hash[j];
+			i = j;
+		}
+	}
+	f->by_name[i] = NULL;
+	f->by_name_count--;
 }
 
-static int flag_skiplist_cmp(const void *va, const void *vb) {
-	const RFlagsAtOffset *a = (RFlagsAtOffset *)va, *b = (RFlagsAtOffset *)vb;
-	if (a->off == b->off) {
-		return 0;
+static void names_free(RFlag *f) {
+	ut32 i;
+	for (i = 0; i < f->by_name_size; i++) {
+		r_flag_item_free (f->by_name[i]);
 	}
-	return a->off < b->off? -1: 1;
+	R_FREE (f->by_name);
+	R_FREE (f->by_name_hash);
+	f->by_name_size = 0;
+	f->by_name_count = 0;
+}
+
+// the owner's lazy loader runs before the first lookup that may need it, it
+// is unset while it runs and it sets itself again if flags remain to load
+static inline void flags_load(RFlag *f, ut64 off) {
+	RFlagLazyLoad cb = f->lazy_load;
+	if (cb) {
+		f->lazy_load = NULL;
+		cb (f, off, f->lazy_user);
+	}
+}
+
+// a missing name may be one of the flags still to load
+static RFlagItem *names_get(RFlag *f, const char *name) {
+	RFlagItem *item = names_find (f, name);
+	if (!item && f->lazy_load) {
+		flags_load (f, UT64_MAX);
+		item = names_find (f, name);
+	}
+	return item;
 }
 
 static ut64 num_callback(RNum *user, const char *name, int *ok) {
@@ -48,7 +163,7 @@ static ut64 num_callback(RNum *user, const char *name, int *ok) {
 	if (ok) {
 		*ok = 0;
 	}
-	RFlagItem *item = ht_pp_find (f->ht_name, name, NULL);
+	RFlagItem *item = names_get (f, name);
 	if (item) {
 		// NOTE: to avoid warning infinite loop here we avoid recursivity
 		if (item->alias) {
@@ -62,61 +177,403 @@ static ut64 num_callback(RNum *user, const char *name, int *ok) {
 	return 0LL;
 }
 
+// Names are stored right after the item they belong to, in the same
+// allocation, and the name hashtable uses them as keys without copying.
+static inline bool name_is_inline(RFlagItem *item) {
+	return item->name == (char *)(item + 1);
+}
+
 static void free_item_realname(RFlagItem *item) {
 	if (item->name != item->realname) {
 		free (item->realname);
 	}
 }
 
-static void free_item_name(RFlagItem *item) {
-	if (item->name != item->realname) {
+static void free_item_names(RFlagItem *item) {
+	free_item_realname (item);
+	if (!name_is_inline (item)) {
 		free (item->name);
 	}
 }
 
+static RFlagItem *flag_item_new(const char *name) {
+	size_t len = strlen (name);
+	RFlagItem *item = malloc (sizeof (RFlagItem) + len + 1);
+	if (!item) {
+		return NULL;
+	}
+	memset (item, 0, sizeof (RFlagItem));
+	item->name = (char *)(item + 1);
+	memcpy (item->name, name, len + 1);
+	item->realname = item->name;
+	return item;
+}
+
+/* The offsets holding flags are indexed in three parts:
+ *  - by_off/by_off_addr: sorted arrays, binary searched
+ *  - by_off_pending: a write buffer of new offsets, merged into the arrays
+ *    in O(n + m) once it outgrows an eighth of them
+ *  - by_off_bulk: new offsets appended while r_flag_bulk_begin is active,
+ *    sorted once and merged when the bulk load ends
+ * Offsets whose last flag goes away stay in the arrays as empty entries
+ * until the next merge. Merges never happen in the middle of a foreach, so
+ * callbacks can set and unset flags freely. */
+
+#define FLAGS_IN_ROWS 0
+#define FLAGS_IN_PENDING 1
+#define FLAGS_IN_BULK 2
+#define FLAGS_MIN_MERGE 4096
+#define FLAGS_MAX_SKIP 64 /* empty entries a nearest lookup steps over before merging */
+
+#define PENDING_AT(x) container_of ((RBNode*)(x), RFlagsAtOffset, rb)
+
+static int _pending_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	const ut64 a = *(const ut64 *)incoming;
+	const ut64 b = PENDING_AT (in_tree)->off;
+	return a < b? -1: a > b;
+}
+
+static void flags_at_free(RFlagsAtOffset *e) {
+	r_list_purge (&e->flags);
+	free (e);
+}
+
+static void _pending_free(RBNode *node) {
+	flags_at_free (PENDING_AT (node));
+}
+
+static void _pending_free_empty(RBNode *node) {
+	RFlagsAtOffset *e = PENDING_AT (node);
+	if (r_list_empty (&e->flags)) {
+		flags_at_free (e);
+	}
+}
+
+static int _bulk_cmp(const void *a, const void *b) {
+	const RFlagsAtOffset *ea = *(const RFlagsAtOffset **)a;
+	const RFlagsAtOffset *eb = *(const RFlagsAtOffset **)b;
+	return ea->off < eb->off? -1: ea->off > eb->off;
+}
+
+// first row whose offset is >= off
+static ut32 rows_lower(RFlag *f, ut64 off) {
+	ut32 lo = 0, hi = f->by_off_len;
+	while (lo < hi) {
+		ut32 mid = lo + (hi - lo) / 2;
+		if (f->by_off_addr[mid] < off) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// first row whose offset is > off
+static ut32 rows_upper(RFlag *f, ut64 off) {
+	ut32 lo = 0, hi = f->by_off_len;
+	while (lo < hi) {
+		ut32 mid = lo + (hi - lo) / 2;
+		if (f->by_off_addr[mid] <= off) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static void rows_free(RFlag *f) {
+	ut32 i;
+	for (i = 0; i < f->by_off_len; i++) {
+		flags_at_free (f->by_off[i]);
+	}
+	R_FREE (f->by_off);
+	R_FREE (f->by_off_addr);
+	f->by_off_len = 0;
+	f->by_off_deleted = 0;
+}
+
+static void bulk_free(RFlag *f, bool entries) {
+	if (entries) {
+		void **it;
+		r_pvector_foreach (&f->by_off_bulk, it) {
+			flags_at_free (*it);
+		}
+	}
+	r_pvector_clear (&f->by_off_bulk);
+	R_FREE (f->by_off_bulk_slots);
+	f->by_off_bulk_size = 0;
+}
+
+static void index_free(RFlag *f) {
+	rows_free (f);
+	r_rbtree_free (f->by_off_pending, _pending_free);
+	f->by_off_pending = NULL;
+	f->by_off_npending = 0;
+	bulk_free (f, true);
+}
+
+// Merge the write buffer and the bulk entries into the arrays, dropping the
+// offsets left without flags
+static bool flags_merge(RFlag *f) {
+	RPVector *bulk = &f->by_off_bulk;
+	const ut32 nbulk = r_pvector_len (bulk);
+	const ut32 n = f->by_off_len - f->by_off_deleted + f->by_off_npending + nbulk;
+	ut64 *addr = malloc ((n + 1) * sizeof (ut64));
+	RFlagsAtOffset **rows = malloc ((n + 1) * sizeof (RFlagsAtOffset *));
+	if (!addr || !rows) {
+		free (addr);
+		free (rows);
+		return false;
+	}
+	if (nbulk > 1) {
+		qsort (bulk->v.a, nbulk, sizeof (void *), _bulk_cmp);
+	}
+	RBIter it = r_rbtree_first (f->by_off_pending);
+	ut32 i = 0, j = 0, k = 0;
+	for (;;) {
+		RFlagsAtOffset *p = r_rbtree_iter_has (it)? r_rbtree_iter_get (&it, RFlagsAtOffset, rb): NULL;
+		RFlagsAtOffset *b = j < nbulk? r_pvector_at (bulk, j): NULL;
+		RFlagsAtOffset *e = (p && (!b || p->off < b->off))? p: b;
+		// the merged rows before the next new offset, without touching
+		// the entries unless some of them may be empty
+		ut32 end = e? rows_lower (f, e->off): f->by_off_len;
+		if (end < i) {
+			end = i;
+		}
+		if (f->by_off_deleted) {
+			for (; i < end; i++) {
+				if (r_list_empty (&f->by_off[i]->flags)) {
+					flags_at_free (f->by_off[i]);
+				} else {
+					addr[k] = f->by_off_addr[i];
+					rows[k++] = f->by_off[i];
+				}
+			}
+		} else if (end > i) {
+			memcpy (addr + k, f->by_off_addr + i, (end - i) * sizeof (ut64));
+			memcpy (rows + k, f->by_off + i, (end - i) * sizeof (RFlagsAtOffset *));
+			k += end - i;
+			i = end;
+		}
+		if (!e) {
+			break;
+		}
+		if (e == p) {
+			r_rbtree_iter_next (&it);
+		} else {
+			j++;
+		}
+		if (r_list_empty (&e->flags)) {
+			// pending ones are released with the tree below
+			if (e != p) {
+				flags_at_free (e);
+			}
+			continue;
+		}
+		e->where = FLAGS_IN_ROWS;
+		addr[k] = e->off;
+		rows[k++] = e;
+	}
+	r_rbtree_free (f->by_off_pending, _pending_free_empty);
+	f->by_off_pending = NULL;
+	f->by_off_npending = 0;
+	bulk_free (f, false);
+	free (f->by_off);
+	free (f->by_off_addr);
+	f->by_off = rows;
+	f->by_off_addr = addr;
+	f->by_off_len = k;
+	f->by_off_deleted = 0;
+	return true;
+}
+
+static void flags_maybe_merge(RFlag *f) {
+	if (f->walking || f->bulk) {
+		return;
+	}
+	if (f->by_off_npending > R_MAX (FLAGS_MIN_MERGE, f->by_off_len / 8)
+			|| f->by_off_deleted > R_MAX (FLAGS_MIN_MERGE, f->by_off_len / 2)) {
+		flags_merge (f);
+	}
+}
+
+// Bulk entries are found by offset through an open addressing table, they
+// are only dropped all at once by the merge
+static inline ut32 off_hash(ut64 off) {
+	return (ut32)((off * 0x9e3779b97f4a7c15ULL) >> 32);
+}
+
+static RFlagsAtOffset *bulk_find(RFlag *f, ut64 off) {
+	if (!f->by_off_bulk_size) {
+		return NULL;
+	}
+	const ut32 mask = f->by_off_bulk_size - 1;
+	ut32 i;
+	for (i = off_hash (off) & mask; f->by_off_bulk_slots[i]; i = (i + 1) & mask) {
+		if (f->by_off_bulk_slots[i]->off == off) {
+			return f->by_off_bulk_slots[i];
+		}
+	}
+	return NULL;
+}
+
+static void bulk_put(RFlagsAtOffset **slots, ut32 mask, RFlagsAtOffset *e) {
+	ut32 i = off_hash (e->off) & mask;
+	while (slots[i]) {
+		i = (i + 1) & mask;
+	}
+	slots[i] = e;
+}
+
+static bool bulk_insert(RFlag *f, RFlagsAtOffset *e) {
+	RPVector *bulk = &f->by_off_bulk;
+	const ut32 n = r_pvector_len (bulk);
+	if ((n + 1) * 2 > f->by_off_bulk_size) {
+		const ut32 size = f->by_off_bulk_size? f->by_off_bulk_size * 2: 1024;
+		RFlagsAtOffset **slots = calloc (size, sizeof (RFlagsAtOffset *));
+		if (!slots) {
+			return false;
+		}
+		void **it;
+		r_pvector_foreach (bulk, it) {
+			bulk_put (slots, size - 1, *it);
+		}
+		free (f->by_off_bulk_slots);
+		f->by_off_bulk_slots = slots;
+		f->by_off_bulk_size = size;
+	}
+	if (!r_pvector_push (bulk, e)) {
+		return false;
+	}
+	bulk_put (f->by_off_bulk_slots, f->by_off_bulk_size - 1, e);
+	return true;
+}
+
+// the entry for the given offset, even if it has no flags left
+static RFlagsAtOffset *flags_find(RFlag *f, ut64 off) {
+	ut32 i = rows_lower (f, off);
+	if (i < f->by_off_len && f->by_off_addr[i] == off) {
+		return f->by_off[i];
+	}
+	if (f->by_off_pending) {
+		RBNode *node = r_rbtree_find (f->by_off_pending, &off, _pending_cmp, NULL);
+		if (node) {
+			return PENDING_AT (node);
+		}
+	}
+	return bulk_find (f, off);
+}
+
 /* return the list of flag at the nearest position.
    dir == -1 -> result <= off
    dir == 0 ->  result == off
    dir == 1 ->  result >= off*/
 static RFlagsAtOffset *r_flag_get_nearest_list(RFlag *f, ut64 off, int dir) {
-	RFlagsAtOffset key = { .off = off };
-	RFlagsAtOffset *flags = (dir >= 0)
-		? r_skiplist_get_geq (f->by_off, &key)
-		: r_skiplist_get_leq (f->by_off, &key);
-	return (dir == 0 && flags && flags->off != off)? NULL: flags;
+	flags_load (f, off);
+	if (!dir) {
+		RFlagsAtOffset *e = flags_find (f, off);
+		return (e && !r_list_empty (&e->flags))? e: NULL;
+	}
+	if (r_pvector_len (&f->by_off_bulk) && !f->walking) {
+		// bulk entries are not sorted yet
+		flags_merge (f);
+	}
+	RFlagsAtOffset *row = NULL, *p = NULL;
+	RBIter it;
+	ut32 i, skip = 0;
+	if (dir < 0) {
+		for (i = rows_upper (f, off); i > 0; i--, skip++) {
+			if (!r_list_empty (&f->by_off[i - 1]->flags)) {
+				row = f->by_off[i - 1];
+				break;
+			}
+			if (skip == FLAGS_MAX_SKIP && !f->walking && flags_merge (f)) {
+				// long runs of empty entries are left by mass unsets
+				return r_flag_get_nearest_list (f, off, dir);
+			}
+		}
+		it = r_rbtree_upper_bound_backward (f->by_off_pending, &off, _pending_cmp, NULL);
+		for (; r_rbtree_iter_has (it); r_rbtree_iter_prev (&it)) {
+			RFlagsAtOffset *e = r_rbtree_iter_get (&it, RFlagsAtOffset, rb);
+			if (!r_list_empty (&e->flags)) {
+				p = e;
+				break;
+			}
+		}
+	} else {
+		for (i = rows_lower (f, off); i < f->by_off_len; i++, skip++) {
+			if (!r_list_empty (&f->by_off[i]->flags)) {
+				row = f->by_off[i];
+				break;
+			}
+			if (skip == FLAGS_MAX_SKIP && !f->walking && flags_merge (f)) {
+				return r_flag_get_nearest_list (f, off, dir);
+			}
+		}
+		it = r_rbtree_lower_bound_forward (f->by_off_pending, &off, _pending_cmp, NULL);
+		for (; r_rbtree_iter_has (it); r_rbtree_iter_next (&it)) {
+			RFlagsAtOffset *e = r_rbtree_iter_get (&it, RFlagsAtOffset, rb);
+			if (!r_list_empty (&e->flags)) {
+				p = e;
+				break;
+			}
+		}
+	}
+	if (!row || !p) {
+		return row? row: p;
+	}
+	return ((dir < 0) == (row->off > p->off))? row: p;
 }
 
 static void remove_offsetmap(RFlag *f, RFlagItem *item) {
 	r_return_if_fail (f && item);
-	RFlagsAtOffset *flags = r_flag_get_nearest_list (f, item->offset, 0);
-	if (flags) {
-		r_list_delete_data (flags->flags, item);
-		if (r_list_empty (flags->flags)) {
-			r_skiplist_delete (f->by_off, flags);
+	RFlagsAtOffset *flags = flags_find (f, item->offset);
+	if (!flags || !r_list_delete_data (&flags->flags, item) || !r_list_empty (&flags->flags)) {
+		return;
+	}
+	switch (flags->where) {
+	case FLAGS_IN_ROWS:
+		f->by_off_deleted++;
+		flags_maybe_merge (f);
+		break;
+	case FLAGS_IN_PENDING:
+		// a foreach may be walking the tree
+		if (!f->walking) {
+			r_rbtree_delete (&f->by_off_pending, &flags->off, _pending_cmp, _pending_free, NULL);
+			f->by_off_npending--;
 		}
+		break;
 	}
 }
 
 static RFlagsAtOffset *flags_at_offset(RFlag *f, ut64 off) {
-	RFlagsAtOffset *res = r_flag_get_nearest_list (f, off, 0);
+	RFlagsAtOffset *res = flags_find (f, off);
 	if (res) {
+		if (res->where == FLAGS_IN_ROWS && r_list_empty (&res->flags)) {
+			f->by_off_deleted--;
+		}
 		return res;
 	}
 
 	// there is no existing flagsAtOffset, we create one now
-	res = R_NEW (RFlagsAtOffset);
+	res = R_NEW0 (RFlagsAtOffset);
 	if (!res) {
 		return NULL;
 	}
-
-	res->flags = r_list_new ();
-	if (!res->flags) {
-		free (res);
-		return NULL;
-	}
-
 	res->off = off;
-	r_skiplist_insert (f->by_off, res);
+	if (f->bulk) {
+		if (!bulk_insert (f, res)) {
+			free (res);
+			return NULL;
+		}
+		res->where = FLAGS_IN_BULK;
+		return res;
+	}
+	res->where = FLAGS_IN_PENDING;
+	r_rbtree_insert (&f->by_off_pending, &res->off, &res->rb, _pending_cmp, NULL);
+	f->by_off_npending++;
 	return res;
 }
 
@@ -131,11 +588,11 @@ static char *filter_item_name(const char *name) {
 	return res;
 }
 
-static void set_name(RFlagItem *item, char *name) {
-	free_item_name (item);
-	item->name = name;
-	free_item_realname (item);
-	item->realname = item->name;
+/* true if filter_item_name would return the name unchanged. Most callers,
+ * like the bin loader, pass names they already filtered, so those are used
+ * as they are instead of being copied and filtered again. */
+static bool name_is_filtered(const char *name) {
+	return r_name_check (name) && *name != '_' && name[strlen (name) - 1] != '_';
 }
 
 static bool update_flag_item_offset(RFlag *f, RFlagItem *item, ut64 newoff, bool is_new, bool force) {
@@ -150,7 +607,7 @@ static bool update_flag_item_offset(RFlag *f, RFlagItem *item, ut64 newoff, bool
 			return false;
 		}
 
-		r_list_append (flagsAtOffset->flags, item);
+		r_list_append (&flagsAtOffset->flags, item);
 		return true;
 	}
 
@@ -168,20 +625,30 @@ static bool update_flag_item_name(RFlag *f, RFlagItem *item, const char *newname
 	if (!fname) {
 		return false;
 	}
-	bool res = (item->name)
-		? ht_pp_update_key (f->ht_name, item->name, fname)
-		: ht_pp_insert (f->ht_name, fname, item);
-	if (res) {
-		set_name (item, fname);
-		return true;
+	RFlagItem *other = names_find (f, fname);
+	if (other) {
+		free (fname);
+		return false;
 	}
-	free (fname);
-	return false;
-}
-
-static void ht_free_flag(HtPPKv *kv) {
-	free (kv->key);
-	r_flag_item_free (kv->value);
+	char *oldname = item->name;
+	char *oldrealname = item->realname;
+	names_delete (f, item);
+	item->name = item->realname = fname;
+	if (!names_insert (f, item)) {
+		// the old name fits back in the slot it just left
+		item->name = oldname;
+		item->realname = oldrealname;
+		names_insert (f, item);
+		free (fname);
+		return false;
+	}
+	if (oldrealname != oldname) {
+		free (oldrealname);
+	}
+	if (oldname != (char *)(item + 1)) {
+		free (oldname);
+	}
+	return true;
 }
 
 static bool count_flags(RFlagItem *fi, void *user) {
@@ -233,8 +700,7 @@ R_API RFlag *r_flag_new() {
 	f->zones = NULL;
 #endif
 	f->tags = sdb_new0 ();
-	f->ht_name = ht_pp_new (NULL, ht_free_flag, NULL);
-	f->by_off = r_skiplist_new (flag_skiplist_free, flag_skiplist_cmp);
+	r_pvector_init (&f->by_off_bulk, NULL);
 #if R_FLAG_ZONE_USE_SDB
 	sdb_free (f->zones);
 #else
@@ -269,16 +735,14 @@ R_API void r_flag_item_free(RFlagItem *item) {
 	free (item->color);
 	free (item->comment);
 	free (item->alias);
-	/* release only one of the two pointers if they are the same */
-	free_item_name (item);
-	free (item->realname);
+	free_item_names (item);
 	free (item);
 }
 
 R_API RFlag *r_flag_free(RFlag *f) {
 	r_return_val_if_fail (f, NULL);
-	r_skiplist_free (f->by_off);
-	ht_pp_free (f->ht_name);
+	index_free (f);
+	names_free (f);
 	sdb_free (f->tags);
 	r_spaces_fini (&f->spaces);
 	r_num_free (f->num);
@@ -501,7 +965,7 @@ R_API bool r_flag_exist_at(RFlag *f, const char *flag_prefix, ut16 fp_size, ut64
  * Otherwise, NULL is returned. */
 R_API RFlagItem *r_flag_get(RFlag *f, const char *name) {
 	r_return_val_if_fail (f, NULL);
-	RFlagItem *r = ht_pp_find (f->ht_name, name, NULL);
+	RFlagItem *r = names_get (f, name);
 	return r? evalFlag (f, r): NULL;
 }
 
@@ -607,7 +1071,8 @@ R_API RFlagItem *r_flag_get_at(RFlag *f, ut64 off, bool closest) {
 		return NULL;
 	}
 	if (flags_at->off == off) {
-		r_list_foreach (flags_at->flags, iter, item) {
+		const RList *list = &flags_at->flags;
+		r_list_foreach (list, iter, item) {
 			if (IS_FI_NOTIN_SPACE (f, item)) {
 				continue;
 			}
@@ -626,7 +1091,8 @@ R_API RFlagItem *r_flag_get_at(RFlag *f, ut64 off, bool closest) {
 		return NULL;
 	}
 	while (!nice && flags_at) {
-		r_list_foreach (flags_at->flags, iter, item) {
+		const RList *list = &flags_at->flags;
+		r_list_foreach (list, iter, item) {
 			if (IS_FI_NOTIN_SPACE (f, item)) {
 				continue;
 			}
@@ -665,8 +1131,8 @@ R_API RList *r_flag_all_list(RFlag *f, bool by_space) {
 
 /* return the list of flag items that are associated with a given offset */
 R_API const RList* /*<RFlagItem*>*/ r_flag_get_list(RFlag *f, ut64 off) {
-	const RFlagsAtOffset *item = r_flag_get_nearest_list (f, off, 0);
-	return item ? item->flags : NULL;
+	RFlagsAtOffset *item = r_flag_get_nearest_list (f, off, 0);
+	return item ? &item->flags : NULL;
 }
 
 R_API char *r_flag_get_liststr(RFlag *f, ut64 off) {
@@ -714,35 +1180,62 @@ R_API RFlagItem *r_flag_set(RFlag *f, const char *name, ut64 off, ut32 size) {
 	r_return_val_if_fail (f && name && *name, NULL);
 
 	bool is_new = false;
-	char *itemname = filter_item_name (name);
-	if (!itemname) {
-		return NULL;
+	char *itemname = NULL;
+	if (!name_is_filtered (name)) {
+		name = itemname = filter_item_name (name);
+		if (!itemname) {
+			return NULL;
+		}
 	}
 
-	RFlagItem *item = r_flag_get (f, itemname);
-	free (itemname);
+	RFlagItem *item = r_flag_get (f, name);
 	if (item && item->offset == off) {
+		free (itemname);
 		item->size = size;
 		return item;
 	}
 
 	if (!item) {
-		item = R_NEW0 (RFlagItem);
-		if (!item) {
-			goto err;
+		item = flag_item_new (name);
+		if (!item || !names_insert (f, item)) {
+			free (itemname);
+			r_flag_item_free (item);
+			return NULL;
 		}
 		is_new = true;
 	}
+	free (itemname);
 
 	item->space = r_flag_space_cur (f);
 	item->size = size;
 
 	update_flag_item_offset (f, item, off + f->base, is_new, true);
-	update_flag_item_name (f, item, name, true);
 	return item;
-err:
-	r_flag_item_free (item);
-	return NULL;
+}
+
+/* While a bulk load is running, new offsets are appended without keeping
+ * them sorted. They are sorted once and merged into the offset index when
+ * the outermost r_flag_bulk_end is called, or before the first query that
+ * needs them in order. Lookups by name or exact offset work as usual. */
+R_API void r_flag_bulk_begin(RFlag *f) {
+	r_return_if_fail (f);
+	f->bulk++;
+}
+
+R_API void r_flag_bulk_end(RFlag *f) {
+	r_return_if_fail (f && f->bulk > 0);
+	if (!--f->bulk && !f->walking && r_pvector_len (&f->by_off_bulk)) {
+		flags_merge (f);
+	}
+}
+
+/* cb is called before the first lookup by offset, walk or missing name, so the
+ * owner can set some of its flags only when they are needed. It gets the offset
+ * looked up, or UT64_MAX when all of them are needed */
+R_API void r_flag_set_lazy(RFlag *f, RFlagLazyLoad cb, void *user) {
+	r_return_if_fail (f);
+	f->lazy_load = cb;
+	f->lazy_user = user;
 }
 
 /* add/replace/remove the alias of a flag item */
@@ -778,6 +1271,7 @@ R_API const char *r_flag_item_set_color(RFlagItem *item, const char *color) {
  * true is returned if everything works well, false otherwise */
 R_API int r_flag_rename(RFlag *f, RFlagItem *item, const char *name) {
 	r_return_val_if_fail (f && item && name && *name, false);
+	flags_load (f, UT64_MAX);
 	return update_flag_item_name (f, item, name, false);
 }
 
@@ -788,7 +1282,8 @@ R_API int r_flag_rename(RFlag *f, RFlagItem *item, const char *name) {
 R_API bool r_flag_unset(RFlag *f, RFlagItem *item) {
 	r_return_val_if_fail (f && item, false);
 	remove_offsetmap (f, item);
-	ht_pp_delete (f->ht_name, item->name);
+	names_delete (f, item);
+	r_flag_item_free (item);
 	return true;
 }
 
@@ -833,16 +1328,17 @@ R_API int r_flag_unset_glob(RFlag *f, const char *glob) {
  * returns true if the item is found and unset, false otherwise. */
 R_API bool r_flag_unset_name(RFlag *f, const char *name) {
 	r_return_val_if_fail (f, false);
-	RFlagItem *item = ht_pp_find (f->ht_name, name, NULL);
+	RFlagItem *item = names_get (f, name);
 	return item && r_flag_unset (f, item);
 }
 
 /* unset all flag items in the RFlag f */
 R_API void r_flag_unset_all(RFlag *f) {
 	r_return_if_fail (f);
-	ht_pp_free (f->ht_name);
-	f->ht_name = ht_pp_new (NULL, ht_free_flag, NULL);
-	r_skiplist_purge (f->by_off);
+	// the ones still to load go too, along with whatever comes with them
+	flags_load (f, UT64_MAX);
+	index_free (f);
+	names_free (f);
 	r_spaces_fini (&f->spaces);
 	new_spaces (f);
 }
@@ -923,22 +1419,93 @@ R_API int r_flag_count(RFlag *f, const char *glob) {
 	return count;
 }
 
+typedef struct {
+	RFlag *f;
+	ut32 i, end;             // merged rows
+	RFlagsAtOffset **pend;   // pending offsets, sorted, for nested walks
+	ut32 j, npend;
+} FlagsWalk;
+
+static void collect_pending(RBNode *node, RFlagsAtOffset **out, ut32 *n) {
+	if (node) {
+		collect_pending (node->child[0], out, n);
+		out[(*n)++] = PENDING_AT (node);
+		collect_pending (node->child[1], out, n);
+	}
+}
+
+static void walk_begin(RFlag *f, FlagsWalk *w) {
+	flags_load (f, UT64_MAX);
+	memset (w, 0, sizeof (*w));
+	w->f = f;
+	if (!f->walking && (f->by_off_npending || f->by_off_deleted || r_pvector_len (&f->by_off_bulk))) {
+		flags_merge (f);
+	}
+	f->walking++;
+	w->end = f->by_off_len;
+	// a walk nested in another one can't merge, take a snapshot instead
+	ut32 nbulk = r_pvector_len (&f->by_off_bulk);
+	if (f->by_off_npending + nbulk) {
+		w->pend = malloc ((f->by_off_npending + nbulk) * sizeof (RFlagsAtOffset *));
+		if (w->pend) {
+			collect_pending (f->by_off_pending, w->pend, &w->npend);
+			if (nbulk) {
+				memcpy (w->pend + w->npend, f->by_off_bulk.v.a, nbulk * sizeof (void *));
+				w->npend += nbulk;
+				qsort (w->pend, w->npend, sizeof (void *), _bulk_cmp);
+			}
+		}
+	}
+}
+
+static RFlagsAtOffset *walk_next(FlagsWalk *w) {
+	for (;;) {
+		RFlagsAtOffset *row = w->i < w->end? w->f->by_off[w->i]: NULL;
+		RFlagsAtOffset *p = w->j < w->npend? w->pend[w->j]: NULL;
+		RFlagsAtOffset *e;
+		if (row && (!p || row->off < p->off)) {
+			e = row;
+			w->i++;
+		} else if (p) {
+			e = p;
+			w->j++;
+		} else {
+			return NULL;
+		}
+		if (!r_list_empty (&e->flags)) {
+			return e;
+		}
+	}
+}
+
+static void walk_end(FlagsWalk *w) {
+	free (w->pend);
+	w->f->walking--;
+	flags_maybe_merge (w->f);
+}
+
 #define FOREACH_BODY(condition) \
-	RSkipListNode *it, *tmp; \
+	FlagsWalk w; \
 	RFlagsAtOffset *flags_at; \
 	RListIter *it2, *tmp2;	  \
 	RFlagItem *fi; \
-	r_skiplist_foreach_safe (f->by_off, it, tmp, flags_at) { \
-		if (flags_at) { \
-			r_list_foreach_safe (flags_at->flags, it2, tmp2, fi) {	\
-				if (condition) { \
-					if (!cb (fi, user)) { \
-						return; \
-					} \
+	walk_begin (f, &w); \
+	while ((flags_at = walk_next (&w))) { \
+		bool stop = false; \
+		RList *list = &flags_at->flags; \
+		r_list_foreach_safe (list, it2, tmp2, fi) {	\
+			if (condition) { \
+				if (!cb (fi, user)) { \
+					stop = true; \
+					break; \
 				} \
 			} \
 		} \
-	}
+		if (stop) { \
+			break; \
+		} \
+	} \
+	walk_end (&w);
 
 R_API void r_flag_foreach(RFlag *f, RFlagItemCb cb, void *user) {
 	FOREACH_BODY (true);
@@ -263,6 +263,27 @@ typedef struct r_anal_fcn_meta_t {
 	int sgec;           // edge cardinality of the functions callgraph
 } RAnalFcnMeta;
 
+/* blocks of a function sorted by address, see r_anal_fcn_bbindex */
+typedef struct r_anal_bb_index_t {
+	struct r_anal_bb_t **bbs;
+	ut32 count;
+	ut32 capacity;
+	// fcn->bbs when the index was built, to notice changes
+	const RList *list;
+	const RListIter *head;
+	const RListIter *tail;
+	int length;
+} RAnalBlockIndex;
+
+/* merged block range of a function, node of anal->fcn_ranges */
+typedef struct r_anal_fcn_range_t {
+	RBNode rb;
+	ut64 from;
+	ut64 to; // exclusive
+	ut64 rb_max_to; // maximum to in the subtree
+	struct r_anal_function_t *fcn;
+} RAnalFcnRange;
+
 /* Store various function information,
  * variables, arguments, refs and even
  * description */
@@ -296,8 +317,12 @@ typedef struct r_anal_function_t {
 	RList *fcn_locs; //sorted list of a function *.loc refs
 	//RList *locals; // list of local labels -> moved to anal->sdb_fcns
 	RList *bbs;
+	RAnalBlockIndex *bbindex; // built on demand from bbs
 	RAnalFcnMeta meta;
 	RRangeTiny bbr;
+	RAnalFcnRange *ranges; // one per bbr pair, indexed in anal->fcn_ranges
+	int nranges;
+	struct r_anal_t *anal; // set while the function is in the anal trees
 	RBNode rb;
 	RBNode addr_rb;
 	RList *imports; // maybe bound to class?
@@ -639,6 +664,30 @@ typedef struct r_anal_hint_cb_t {
 	void (*on_bits) (struct r_anal_t *a, ut64 addr, int bits, bool set);
 } RHintCb;
 
+/* compact xref store, see anal/xrefs.c */
+typedef struct r_anal_xrefs_t {
+	// refs sorted by (from, to), kept as separate arrays to avoid padding
+	ut64 *from;
+	ut64 *to;
+	ut8 *type;
+	// indices into the arrays above sorted by (to, from)
+	ut32 *rev;
+	ut32 len;
+	ut32 deleted; // tombstones in the arrays, dropped on the next merge
+	// write buffer, merged into the arrays in bulk
+	RBTree pending_fwd;
+	RBTree pending_rev;
+	ut32 npending;
+} RAnalXrefs;
+
+/* decoded ops by address, see anal/op.c */
+typedef struct r_anal_op_cache_t {
+	struct r_anal_op_cache_slot_t *slots;
+	ut32 size; // power of two, 0 when disabled
+	ut64 hits;
+	ut64 misses;
+} RAnalOpCache;
+
 typedef struct r_anal_t {
 	char *cpu;
 	char *os;
@@ -652,6 +701,7 @@ typedef struct r_anal_t {
 	RList *fcns;
 	RBNode *fcn_tree; // keyed on meta.min
 	RBNode *fcn_addr_tree; // keyed on addr
+	RBNode *fcn_ranges; // RAnalFcnRange interval tree, see fcn.c
 	RListRange *fcnstore;
 	RList *refs;
 	RList *vartypes;
@@ -682,9 +732,9 @@ typedef struct r_anal_t {
 	Sdb *sdb_types;
 	Sdb *sdb_fmts;
 	Sdb *sdb_meta; // TODO: Future r_meta api
+	RBNode *meta; // RAnalMetaItem interval tree mirroring sdb_meta, see meta.c
 	Sdb *sdb_zigns;
-	HtUP *dict_refs;
-	HtUP *dict_xrefs;
+	RAnalXrefs xrefs;
 	bool recursive_noreturn;
 	RSpaces meta_spaces;
 	RSpaces zign_spaces;
@@ -693,6 +743,8 @@ typedef struct r_anal_t {
 	//moved from RAnalFcn
 	Sdb *sdb; // root
 	Sdb *sdb_fcns;
+	HtUP *vars; // function address => its variables, see var.c
+	HtUP *var_refs; // instruction address => variables it accesses
 	Sdb *sdb_pins;
 #define DEPRECATE 1
 #if DEPRECATE
@@ -712,6 +764,8 @@ typedef struct r_anal_t {
 	//RList *noreturn;
 	RBNode *rb_hints_ranges; // <RAnalRange>
 	bool merge_hints;
+	RBNode *hints; // typed hint records sorted by address, see hint.c
+	int hints_count;
 	RListComparator columnSort;
 	int stackptr;
 	bool (*log)(struct r_anal_t *anal, const char *msg);
@@ -726,6 +780,8 @@ typedef struct r_anal_t {
 	SetU *visited;
 	RStrConstPool constpool;
 	RList *leaddrs;
+	RAnalOpCache opcache;
+	int bb_maxsize; // largest size given to r_anal_bb_set_size, bounds the block lookups
 } RAnal;
 
 typedef struct r_anal_hint_t {
@@ -1197,6 +1253,11 @@ typedef struct r_anal_esil_t {
 	void *user;
 	int stack_fd;	// ahem, let's not do this
 	RList *sessions; // <RAnalEsilSession*>
+	HtPP *codes; // expression => compiled words, see r_anal_esil_parse
+	/* code cached by the block emulator (aec), writes in [code_from, code_to) set code_dirty */
+	ut64 code_from;
+	ut64 code_to;
+	bool code_dirty;
 } RAnalEsil;
 
 #undef ESIL
@@ -1450,6 +1511,7 @@ R_API RList *r_anal_bb_list_new(void);
 R_API void r_anal_bb_free(RAnalBlock *bb);
 R_API int r_anal_bb(RAnal *anal, RAnalBlock *bb, ut64 addr, const ut8 *buf, ut64 len, int head);
 R_API RAnalBlock *r_anal_bb_from_offset(RAnal *anal, ut64 off);
+R_API void r_anal_bb_set_size(RAnal *anal, RAnalBlock *bb, int size);
 R_API int r_anal_bb_is_in_offset(RAnalBlock *bb, ut64 addr);
 R_API bool r_anal_bb_set_offset(RAnalBlock *bb, int i, ut16 v);
 R_API ut16 r_anal_bb_offset_inst(RAnalBlock *bb, int i);
@@ -1465,7 +1527,6 @@ R_API RAnalOp *r_anal_op_new(void);
 R_API void r_anal_op_free(void *op);
 R_API void r_anal_op_init(RAnalOp *op);
 R_API bool r_anal_op_fini(RAnalOp *op);
-R_API RAnalVar *get_link_var(RAnal *anal, ut64 faddr, RAnalVar *var);
 R_API int r_anal_op_reg_delta(RAnal *anal, ut64 addr, const char *name);
 R_API bool r_anal_op_is_eob(RAnalOp *op);
 R_API RList *r_anal_op_list_new(void);
@@ -1474,6 +1535,8 @@ R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr,
 R_API RAnalOp *r_anal_op_hexstr(RAnal *anal, ut64 addr,
 		const char *hexstr);
 R_API char *r_anal_op_to_string(RAnal *anal, RAnalOp *op);
+R_API bool r_anal_op_cache_set_size(RAnal *anal, int size);
+R_API void r_anal_op_cache_flush(RAnal *anal);
 
 R_API RAnalEsil *r_anal_esil_new(int stacksize, int iotrap, unsigned int addrsize);
 R_API void r_anal_esil_trace(RAnalEsil *esil, RAnalOp *op);
@@ -1510,6 +1573,7 @@ R_API void r_anal_esil_interrupts_fini(RAnalEsil *esil);
 
 R_API void r_anal_esil_mem_ro(RAnalEsil *esil, int mem_readonly);
 R_API void r_anal_esil_stats(RAnalEsil *esil, int enable);
+R_API void r_anal_esil_codes_flush(RAnalEsil *esil);
 
 /* session */
 R_API void r_anal_esil_session_list(RAnalEsil *esil);
@@ -1534,6 +1598,7 @@ R_API RAnalFunction *r_anal_fcn_new(void);
 R_API int r_anal_fcn_is_in_offset (RAnalFunction *fcn, ut64 addr);
 R_API bool r_anal_fcn_in(RAnalFunction *fcn, ut64 addr);
 R_API RList *r_anal_get_fcn_in_list(RAnal *anal, ut64 addr, int type);
+R_API RList *r_anal_get_fcn_in_range(RAnal *anal, ut64 from, ut64 to);
 R_API RAnalFunction *r_anal_get_fcn_at(RAnal *anal, ut64 addr, int type);
 R_API RAnalFunction *r_anal_get_fcn_in(RAnal *anal, ut64 addr, int type);
 R_API RAnalFunction *r_anal_get_fcn_in_bounds(RAnal *anal, ut64 addr, int type);
@@ -1597,6 +1662,8 @@ R_API int r_anal_str_to_fcn(RAnal *a, RAnalFunction *f, const char *_str);
 R_API int r_anal_fcn_count (RAnal *a, ut64 from, ut64 to);
 R_API RAnalBlock *r_anal_fcn_bbget_in(const RAnal *anal, RAnalFunction *fcn, ut64 addr);
 R_API RAnalBlock *r_anal_fcn_bbget_at(RAnalFunction *fcn, ut64 addr);
+R_API const RAnalBlockIndex *r_anal_fcn_bbindex(RAnalFunction *fcn);
+R_API void r_anal_fcn_bbindex_invalidate(RAnalFunction *fcn);
 R_API bool r_anal_fcn_contains(RAnalFunction *fcn, ut64 addr);
 R_API bool r_anal_fcn_bbadd(RAnalFunction *fcn, RAnalBlock *bb);
 R_API int r_anal_fcn_resize (RAnal *anal, RAnalFunction *fcn, int newsize);
@@ -1616,7 +1683,10 @@ R_API RList *r_anal_fcn_get_xrefs(RAnal *anal, RAnalFunction *fcn);
 R_API int r_anal_xrefs_from(RAnal *anal, RList *list, const char *kind, const RAnalRefType type, ut64 addr);
 R_API int r_anal_xrefs_set(RAnal *anal, ut64 from, ut64 to, const RAnalRefType type);
 R_API int r_anal_xrefs_deln(RAnal *anal, ut64 from, ut64 to, const RAnalRefType type);
+R_API int r_anal_refs_del_range(RAnal *anal, ut64 from, ut64 to);
 R_API int r_anal_xref_del(RAnal *anal, ut64 at, ut64 addr);
+R_API bool r_anal_refs_foreach(RAnal *anal, ut64 from, RAnalRefCmp cb, void *user);
+R_API bool r_anal_xrefs_foreach(RAnal *anal, ut64 to, RAnalRefCmp cb, void *user);
 
 R_API RList* r_anal_fcn_get_vars (RAnalFunction *anal);
 R_API RList* r_anal_get_fcns (RAnal *anal);
@@ -1651,6 +1721,13 @@ R_API int r_anal_var_access_add(RAnal *anal, RAnalVar *var, ut64 from, int set);
 R_API int r_anal_var_access_del(RAnal *anal, RAnalVar *var, ut64 from);
 R_API RAnalVarAccess *r_anal_var_access_get(RAnal *anal, RAnalVar *var, ut64 from);
 R_API RAnalVar *r_anal_var_get_byname (RAnal *anal, ut64 addr, const char* name);
+typedef bool (* RAnalVarCb)(const RAnalVar *var, void *user);
+R_API bool r_anal_var_foreach_at(RAnal *a, ut64 addr, RAnalVarCb cb, void *user);
+R_API RVector *r_anal_var_accesses(RAnal *a, ut64 var_addr, int scope, int delta, int xs_type);
+R_API RAnalVar *get_link_var(RAnal *anal, ut64 faddr, RAnalVar *var);
+R_API void r_anal_var_clear(RAnal *a);
+R_API void r_anal_var_save(RAnal *a, Sdb *db);
+R_API void r_anal_var_load(RAnal *a, Sdb *db);
 R_API void r_anal_extract_vars(RAnal *anal, RAnalFunction *fcn, RAnalOp *op);
 R_API void r_anal_extract_rarg(RAnal *anal, RAnalOp *op, RAnalFunction *fcn, int *reg_set, int *count);
 
@@ -1669,6 +1746,7 @@ R_API char *r_anal_fcn_format_sig(R_NONNULL RAnal *anal, R_NONNULL RAnalFunction
 
 /* project */
 R_API bool r_anal_xrefs_init (RAnal *anal);
+R_API void r_anal_xrefs_fini (RAnal *anal);
 
 #define R_ANAL_THRESHOLDFCN 0.7F
 #define R_ANAL_THRESHOLDBB 0.7F
@@ -1754,7 +1832,11 @@ R_API void r_anal_data_free (RAnalData *d);
 #include <r_cons.h>
 R_API char *r_anal_data_to_string(RAnalData *d, RConsPrintablePalette *pal);
 
+typedef bool (* RAnalMetaCb)(const RAnalMetaItem *item, void *user);
+
 R_API void r_meta_free(RAnal *m);
+R_API void r_meta_reindex(RAnal *a);
+R_API bool r_meta_foreach_in(RAnal *a, int type, ut64 from, ut64 to, RAnalMetaCb cb, void *user);
 R_API RList *r_meta_find_list_in(RAnal *a, ut64 at, int type, int where);
 R_API void r_meta_space_unset_for(RAnal *a, const RSpace *space);
 R_API int r_meta_space_count_for(RAnal *a, const RSpace *space_name);
@@ -1786,6 +1868,8 @@ R_API void r_meta_print(RAnal *a, RAnalMetaItem *d, int rad, PJ *pj, bool show_f
 
 /* hints */
 
+typedef bool (* RAnalHintCb)(const RAnalHint *hint, void *user);
+
 R_API void r_anal_build_range_on_hints (RAnal *a, ut64 addr, int bits);
 R_API void r_anal_merge_hint_ranges(RAnal *a);
 //R_API void r_anal_hint_list (RAnal *anal, int mode);
@@ -1829,6 +1913,11 @@ R_API void r_anal_hint_unset_fail(RAnal *a, ut64 addr);
 R_API void r_anal_hint_unset_stackframe(RAnal *a, ut64 addr);
 
 R_API int r_anal_hint_get_bits_at(RAnal *a, ut64 addr, const char *str);
+R_API char *r_anal_hint_to_string(RAnal *a, ut64 addr);
+R_API bool r_anal_hint_foreach(RAnal *a, RAnalHintCb cb, void *user);
+R_API int r_anal_hint_count(RAnal *a);
+R_API void r_anal_hint_save(RAnal *a, Sdb *db);
+R_API void r_anal_hint_load(RAnal *a, Sdb *db);
 R_API int r_anal_range_tree_find_bits_at(RBNode *root, ut64 addr);
 
 R_API int r_anal_esil_eval(RAnal *anal, const char *str);
@@ -262,6 +262,10 @@ typedef struct r_bin_object_t {
 	Sdb *kv;
 	Sdb *addr2klassmethod;
 	void *bin_obj; // internal pointer used by formats
+	ut64 loaded; // R_BIN_REQ_* items already built, the others are loaded on first use
+	HtUP *symbols_by_addr;
+	HtPP *symbols_by_name;
+	RListIter *symbols_indexed; // last symbol in the indices above
 } RBinObject;
 
 // XXX: RbinFile may hold more than one RBinObject
@@ -288,6 +292,7 @@ typedef struct r_bin_file_t {
 	Sdb *sdb;
 	Sdb *sdb_info;
 	Sdb *sdb_addrinfo;
+	RBinDwarfIndex *dwarf; // lazy DWARF reader, see dwarf.c
 	struct r_bin_t *rbin;
 } RBinFile;
 
@@ -310,6 +315,8 @@ typedef struct r_bin_t {
 	int minstrlen;
 	int maxstrlen;
 	ut64 maxstrbuf;
+	int strthreads;
+	int dbgthreads;
 	int rawstr;
 	Sdb *sdb;
 	RIDStorage *ids;
@@ -334,6 +341,7 @@ typedef struct r_bin_t {
 	bool verbose;
 	bool use_xtr; // use extract plugins when loading a file?
 	bool use_ldr; // use loader plugins when loading a file?
+	bool use_mmap; // map local files instead of reading them through io
 	RStrConstPool constpool;
 } RBin;
 
@@ -430,6 +438,8 @@ typedef struct r_bin_plugin_t {
 	RList/*<RBinSection>*/* (*sections)(RBinFile *bf);
 	RList/*<RBinDwarfRow>*/* (*lines)(RBinFile *bf);
 	RList/*<RBinSymbol>*/* (*symbols)(RBinFile *bf);
+	// symbols of the sub-image mapped at vaddr, each image is returned once
+	RList/*<RBinSymbol>*/* (*image_symbols)(RBinFile *bf, ut64 vaddr);
 	RList/*<RBinImport>*/* (*imports)(RBinFile *bf);
 	RList/*<RBinString>*/* (*strings)(RBinFile *bf);
 	RBinInfo/*<RBinInfo>*/* (*info)(RBinFile *bf);
@@ -705,6 +715,8 @@ R_API RList *r_bin_get_classes(RBin *bin);
 R_API RList *r_bin_get_strings(RBin *bin);
 R_API RList *r_bin_file_get_trycatch(RBinFile *bf);
 R_API RList *r_bin_get_symbols(RBin *bin);
+R_API RBinSymbol *r_bin_get_symbol_at(RBin *bin, ut64 vaddr);
+R_API RBinSymbol *r_bin_get_symbol_by_name(RBin *bin, const char *name);
 R_API RList *r_bin_reset_strings(RBin *bin);
 R_API int r_bin_is_string(RBin *bin, ut64 va);
 R_API int r_bin_is_big_endian(RBin *bin);
@@ -714,6 +726,7 @@ R_API ut64 r_bin_file_get_vaddr(RBinFile *bf, ut64 paddr, ut64 vaddr);
 R_API ut64 r_bin_a2b(RBin *bin, ut64 addr);
 
 R_API int r_bin_load_languages(RBinFile *binfile);
+R_API const char *r_bin_lang_guess(RBinFile *binfile);
 R_API RBinFile *r_bin_cur(RBin *bin);
 R_API RBinObject *r_bin_cur_object(RBin *bin);
 
@@ -739,6 +752,7 @@ R_API void r_bin_file_free(void /*RBinFile*/ *bf_);
 R_API RBinFile *r_bin_file_at(RBin *bin, ut64 addr);
 R_API RBinFile *r_bin_file_find_by_object_id(RBin *bin, ut32 binobj_id);
 R_API RList *r_bin_file_get_symbols(RBinFile *bf);
+R_API RList *r_bin_file_get_image_symbols(RBinFile *bf, ut64 vaddr);
 //
 R_API ut64 r_bin_file_get_vaddr(RBinFile *bf, ut64 paddr, ut64 vaddr);
 // RBinFile.add
@@ -798,6 +812,10 @@ R_API int r_bin_dwarf_parse_info(RBinDwarfDebugAbbrev *da, RBin *a, int mode);
 R_API RList *r_bin_dwarf_parse_line(RBin *a, int mode);
 R_API RList *r_bin_dwarf_parse_aranges(RBin *a, int mode);
 R_API RBinDwarfDebugAbbrev *r_bin_dwarf_parse_abbrev(RBin *a, int mode);
+R_API RBinDwarfIndex *r_bin_dwarf_index_new(RBinFile *bf);
+R_API void r_bin_dwarf_index_free(RBinDwarfIndex *di);
+R_API bool r_bin_dwarf_addr2line(RBinFile *bf, ut64 addr, char *file, int len, int *line);
+R_API bool r_bin_dwarf_addrinfo(RBinFile *bf);
 
 R_API RList *r_bin_get_mem(RBin *bin);
 
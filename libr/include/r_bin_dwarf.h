@@ -244,6 +244,24 @@ extern "C" {
 #define DW_FORM_exprloc			0x18
 #define DW_FORM_flag_present		0x19
 #define DW_FORM_ref_sig8		0x20
+#define DW_FORM_strx			0x1a
+#define DW_FORM_addrx			0x1b
+#define DW_FORM_ref_sup4		0x1c
+#define DW_FORM_strp_sup		0x1d
+#define DW_FORM_data16			0x1e
+#define DW_FORM_line_strp		0x1f
+#define DW_FORM_implicit_const		0x21
+#define DW_FORM_loclistx		0x22
+#define DW_FORM_rnglistx		0x23
+#define DW_FORM_ref_sup8		0x24
+#define DW_FORM_strx1			0x25
+#define DW_FORM_strx2			0x26
+#define DW_FORM_strx3			0x27
+#define DW_FORM_strx4			0x28
+#define DW_FORM_addrx1			0x29
+#define DW_FORM_addrx2			0x2a
+#define DW_FORM_addrx3			0x2b
+#define DW_FORM_addrx4			0x2c
 
 #define DW_OP_addr			0x03
 #define DW_OP_deref			0x06
@@ -724,6 +742,49 @@ typedef struct {
 	size_t file_names_count;
 } RBinDwarfLNPHeader;
 
+/* compact line table, rows index the file names */
+typedef struct {
+	ut64 address;
+	ut32 file;
+	ut32 line;
+} RBinDwarfLineRow;
+
+typedef struct {
+	RVector rows; // RBinDwarfLineRow
+	RPVector files; // char *
+} RBinDwarfLineTable;
+
+typedef struct {
+	ut64 offset; // of the unit header in .debug_info
+	ut64 stmt_list; // of its line program in .debug_line, UT64_MAX if none
+	char *comp_dir;
+	bool root; // the root DIE has been read
+	RBinDwarfLineTable *lines; // sorted by address, decoded on the first query
+} RBinDwarfUnit;
+
+typedef struct {
+	ut64 addr;
+	ut64 size;
+	ut64 unit; // offset of the unit in .debug_info
+} RBinDwarfARange;
+
+typedef struct {
+	ut64 paddr;
+	ut64 size;
+} RBinDwarfSection;
+
+typedef struct r_bin_dwarf_index_t {
+	RBinDwarfSection info;
+	RBinDwarfSection abbrev;
+	RBinDwarfSection line;
+	RBinDwarfSection str;
+	bool big_endian;
+	RVector units; // RBinDwarfUnit sorted by offset
+	RVector aranges; // RBinDwarfARange sorted by address
+	RBinDwarfDebugAbbrev *da; // parsed with the first root DIE
+	bool addrinfo; // rows replayed into sdb_addrinfo, which answers from then on
+} RBinDwarfIndex;
+
 #define r_bin_dwarf_line_new(o,a,f,l) o->address=a, o->file = strdup (f?f:""), o->line = l, o->column =0,o
 
 R_API int r_bin_dwarf_parse_info_raw(Sdb *s, RBinDwarfDebugAbbrev *da,
@@ -305,6 +305,7 @@ typedef struct r_core_t {
 	struct r_core_task_t *main_task;
 	RThreadLock *tasks_lock;
 	int tasks_running;
+	ut64 tasks_quantum; // usecs a task keeps running before yielding to the queued ones
 	bool oneshot_running;
 	int max_cmd_depth;
 	ut8 switch_file_view;
@@ -333,6 +334,8 @@ typedef struct r_core_t {
 	bool scr_gadgets;
 	bool log_events; // core.c:cb_event_handler : log actions from events if cfg.log.events is set
 	RList *ropchain;
+	RList *bin_lazy; // ids of the binfiles whose symbols and such are not loaded yet
+	RList *bin_images; // ids of the binfiles whose symbols are loaded one image at a time
 	bool use_tree_sitter_r2cmd;
 
 	RMainCallback r_main_radare2;
@@ -581,6 +584,7 @@ R_API void r_core_anal_fcn_merge (RCore *core, ut64 addr, ut64 addr2);
 R_API const char *r_core_anal_optype_colorfor(RCore *core, ut64 addr, bool verbose);
 R_API ut64 r_core_anal_address (RCore *core, ut64 addr);
 R_API void r_core_anal_undefine (RCore *core, ut64 off);
+R_API int r_core_anal_patch(RCore *core, ut64 addr, int size);
 R_API void r_core_anal_hint_print (RAnal* a, ut64 addr, int mode);
 R_API void r_core_anal_hint_list (RAnal *a, int mode);
 R_API int r_core_anal_search(RCore *core, ut64 from, ut64 to, ut64 ref, int mode);
@@ -659,6 +663,7 @@ R_API int r_core_bb_starts_in_middle(RCore *core, ut64 at, int oplen);
 R_API bool r_core_bin_raise (RCore *core, ut32 bfid);
 
 R_API int r_core_bin_set_env (RCore *r, RBinFile *binfile);
+R_API void r_core_bin_load_lazy(RCore *core, ut64 addr);
 R_API int r_core_bin_set_by_fd (RCore *core, ut64 bin_fd);
 R_API int r_core_bin_set_by_name (RCore *core, const char *name);
 R_API int r_core_bin_reload(RCore *core, const char *file, ut64 baseaddr);
@@ -688,6 +693,11 @@ R_API bool r_core_project_save(RCore *core, const char *file);
 R_API char *r_core_project_info(RCore *core, const char *file);
 R_API char *r_core_project_notes_file (RCore *core, const char *file);
 
+/* snapshot.c */
+R_API char *r_core_snapshot_path(RCore *core);
+R_API bool r_core_snapshot_save(RCore *core, const char *file);
+R_API bool r_core_snapshot_load(RCore *core, const char *file);
+
 R_API char *r_core_sysenv_begin(RCore *core, const char *cmd);
 R_API void r_core_sysenv_end(RCore *core, const char *cmd);
 
@@ -721,6 +731,8 @@ R_API void r_core_recover_vars(RCore *core, RAnalFunction *fcn, bool argonly);
 #define R_CORE_BIN_ACC_HASHES 0x10000000
 #define R_CORE_BIN_ACC_TRYCATCH 0x20000000
 #define R_CORE_BIN_ACC_ALL	0x504FFF
+// loaded when first needed instead of when the file is opened, with bin.lazy
+#define R_CORE_BIN_ACC_LAZY	(R_CORE_BIN_ACC_STRINGS | R_CORE_BIN_ACC_RELOCS | R_CORE_BIN_ACC_IMPORTS | R_CORE_BIN_ACC_SYMBOLS | R_CORE_BIN_ACC_CLASSES)
 
 #define R_CORE_PRJ_FLAGS	0x0001
 #define R_CORE_PRJ_EVAL		0x0002
@@ -746,6 +758,7 @@ R_API int r_core_bin_set_arch_bits (RCore *r, const char *name, const char * arc
 R_API int r_core_bin_update_arch_bits (RCore *r);
 R_API char *r_core_bin_method_flags_str(ut64 flags, int mode);
 R_API int r_core_pdb_info(RCore *core, const char *file, ut64 baddr, int mode);
+R_API int r_core_pdb_find(RCore *core, const char *file, ut64 baddr, const char *name, int mode);
 
 /* rtr */
 R_API int r_core_rtr_cmds (RCore *core, const char *port);
@@ -877,6 +890,7 @@ typedef struct r_core_task_t {
 	bool dispatched;
 	RThreadCond *dispatch_cond;
 	RThreadLock *dispatch_lock;
+	ut64 dispatched_at; // r_sys_now () when the task got scheduled
 	RThread *thread;
 	char *cmd;
 	char *res;
@@ -33,11 +33,13 @@ typedef struct r_flag_zone_item_t {
 
 typedef struct r_flags_at_offset_t {
 	ut64 off;
-	RList *flags;   /* list of RFlagItem at offset */
+	RBNode rb;      /* node in RFlag.by_off_pending */
+	RList flags;    /* list of RFlagItem at offset */
+	int where;      /* which part of the offset index holds it */
 } RFlagsAtOffset;
 
 typedef struct r_flag_item_t {
-	char *name;     /* unique name, escaped to avoid issues with r2 shell */
+	char *name;     /* unique name, escaped to avoid issues with r2 shell, usually stored right after the item */
 	char *realname; /* real name, without any escaping */
 	bool demangled; /* real name from demangling? */
 	ut64 offset;    /* offset flagged by this item */
@@ -48,14 +50,40 @@ typedef struct r_flag_item_t {
 	char *alias;    /* used to define a flag based on a math expression (e.g. foo + 3) */
 } RFlagItem;
 
+struct r_flag_t;
+// off is the offset being looked up, or UT64_MAX when all the flags are needed
+typedef void (*RFlagLazyLoad)(struct r_flag_t *f, ut64 off, void *user);
+
 typedef struct r_flag_t {
 	RSpaces spaces;   /* handle flag spaces */
 	st64 base;         /* base address for all flag items */
 	bool realnames;
 	Sdb *tags;
 	RNum *num;
-	RSkipList *by_off; /* flags sorted by offset, value=RFlagsAtOffset */
-	HtPP *ht_name; /* hashmap key=item name, value=RFlagItem * */
+	/* flags by offset: by_off[i] holds the flags at by_off_addr[i], sorted.
+	 * Offsets added since the last merge wait in by_off_pending, or in
+	 * by_off_bulk while a bulk load is running */
+	ut64 *by_off_addr;
+	RFlagsAtOffset **by_off;
+	ut32 by_off_len;
+	ut32 by_off_deleted;  /* merged offsets left without flags */
+	RBTree by_off_pending;
+	ut32 by_off_npending;
+	RPVector by_off_bulk;
+	RFlagsAtOffset **by_off_bulk_slots; /* by_off_bulk entries hashed by offset */
+	ut32 by_off_bulk_size;
+	int bulk;
+	int walking;          /* nested foreach depth, merges wait until it is back to 0 */
+	/* items by name: open addressing, by_name_hash[i] is the hash of by_name[i]->name */
+	RFlagItem **by_name;
+	ut32 *by_name_hash;
+	ut32 by_name_size;
+	ut32 by_name_count;
+	/* sets the flags left for later by the owner, called before the
+	 * first lookup that may need them. It may set itself again when
+	 * it only loaded the flags around the offset looked up */
+	RFlagLazyLoad lazy_load;
+	void *lazy_user;
 	PrintfCallback cb_printf;
 #if R_FLAG_ZONE_USE_SDB
 	Sdb *zones;
@@ -116,6 +144,9 @@ R_API bool r_flag_unset_off(RFlag *f, ut64 addr);
 R_API void r_flag_unset_all (RFlag *f);
 R_API RFlagItem *r_flag_set(RFlag *fo, const char *name, ut64 addr, ut32 size);
 R_API RFlagItem *r_flag_set_next(RFlag *fo, const char *name, ut64 addr, ut32 size);
+R_API void r_flag_bulk_begin(RFlag *f);
+R_API void r_flag_bulk_end(RFlag *f);
+R_API void r_flag_set_lazy(RFlag *f, RFlagLazyLoad cb, void *user);
 R_API void r_flag_item_set_alias(RFlagItem *item, const char *alias);
 R_API void r_flag_item_free (RFlagItem *item);
 R_API void r_flag_item_set_comment(RFlagItem *item, const char *comment);
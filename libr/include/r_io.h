@@ -95,8 +95,8 @@ typedef struct r_io_t {
 	RPVector map_skyline_shadow; // map parts that are not covered by others
 	RIDStorage *files;
 	RCache *buffer;
-	RList *cache;	//sdblist?
-	RBNode cacheTree;
+	RBTree cache; // interval tree of RIOCache, augmented with the max end address
+	ut64 cache_seq; // write order of the cached items, later writes win
 	ut8 *write_mask;
 	int write_mask_len;
 	RIOUndo undo;
@@ -113,7 +113,7 @@ typedef struct r_io_t {
 	PrintfCallback cb_printf;
 	int (*cb_core_cmd)(void *user, const char *str);
 	char* (*cb_core_cmdstr)(void *user, const char *str);
-	void (*cb_core_post_write)(void *user, ut64 maddr, ut8 *orig_bytes, int orig_len);
+	void (*cb_core_post_write)(void *user, ut64 maddr, ut8 *bytes, int len);
 } RIO;
 
 typedef struct r_io_desc_t {
@@ -204,6 +204,9 @@ typedef struct r_io_cache_t {
 	ut8 *data;
 	ut8 *odata;
 	int written;
+	ut64 seq;
+	RBNode rb;
+	ut64 rb_max_addr;
 } RIOCache;
 
 #define R_IO_DESC_CACHE_SIZE (sizeof(ut64) * 8)
@@ -25,6 +25,7 @@ typedef struct R_PDB {
 	RList *pdb_streams;
 	RList *pdb_streams2;
 	RBuffer *buf; // mmap of file
+	const char *name; // when set, only the type or global with this name is printed
 //	int curr;
 
 	void (*print_gvars)(struct R_PDB *pdb, ut64 img_base, int format);
@@ -25,6 +25,11 @@ enum {
 	R_SEARCH_LAST
 };
 
+enum {
+	R_SEARCH_ALGO_BRUTE, // slide every keyword over the buffer
+	R_SEARCH_ALGO_MULTI, // single pass over the buffer for all keywords
+};
+
 #define R_SEARCH_DISTANCE_MAX 10
 
 #define R_SEARCH_KEYWORD_TYPE_BINARY 'i'
@@ -48,15 +53,24 @@ typedef struct r_search_hit_t {
 	ut64 addr;
 } RSearchHit;
 
+// bytes of the previous block kept around to find hits spanning two blocks
+typedef struct r_search_leftover_t {
+	ut64 end;
+	int len;
+	ut8 data[];
+} RSearchLeftover;
+
 typedef int (*RSearchCallback)(RSearchKeyword *kw, void *user, ut64 where);
 
 typedef struct r_search_t {
 	int n_kws; // hit${n_kws}_${count}
 	int mode;
+	int algo; // search.algo, R_SEARCH_ALGO_*
 	ut32 pattern_size;
 	ut32 string_min; // max length of strings for R_SEARCH_STRING
 	ut32 string_max; // min length of strings for R_SEARCH_STRING
 	void *data; // data used by search algorithm
+	void *kw_index; // keyword index for R_SEARCH_ALGO_MULTI, built on first use
 	void *user; // user data passed to callback
 	RSearchCallback callback;
 	ut64 nhits;
@@ -79,12 +93,14 @@ typedef struct r_search_t {
 
 R_API RSearch *r_search_new(int mode);
 R_API int r_search_set_mode(RSearch *s, int mode);
+R_API bool r_search_set_algo(RSearch *s, int algo);
 R_API RSearch *r_search_free(RSearch *s);
 
 /* keyword management */
 R_API RList *r_search_find(RSearch *s, ut64 addr, const ut8 *buf, int len);
 R_API int r_search_update(RSearch *s, ut64 from, const ut8 *buf, long len);
 R_API int r_search_update_i(RSearch *s, ut64 from, const ut8 *buf, long len);
+R_API int r_search_update_threads(RSearch *s, ut64 from, const ut8 *buf, int len, int buflen, int nthreads);
 
 R_API void r_search_keyword_free (RSearchKeyword *kw);
 R_API RSearchKeyword* r_search_keyword_new(const ut8 *kw, int kwlen, const ut8 *bm, int bmlen, const char *data);
@@ -95,6 +111,7 @@ R_API RSearchKeyword* r_search_keyword_new_hexmask(const char *kwstr, const char
 R_API RSearchKeyword *r_search_keyword_new_regexp (const char *str, const char *data);
 
 R_API int r_search_kw_add(RSearch *s, RSearchKeyword *kw);
+R_API int r_search_kw_maxlen(RSearch *s);
 R_API void r_search_reset(RSearch *s, int mode);
 R_API void r_search_kw_reset(RSearch *s);
 R_API void r_search_string_prepare_backward(RSearch *s);
@@ -109,6 +126,8 @@ R_API int r_search_bmh(const RSearchKeyword *kw, const ut64 from, const ut8 *buf
 
 // TODO: is this an internal API?
 R_API int r_search_mybinparse_update(RSearch *s, ut64 from, const ut8 *buf, int len);
+R_API int r_search_multi_update(RSearch *s, ut64 from, const ut8 *buf, int len);
+R_API void r_search_multi_reset(RSearch *s);
 R_API int r_search_aes_update(RSearch *s, ut64 from, const ut8 *buf, int len);
 R_API int r_search_rsa_update(RSearch *s, ut64 from, const ut8 *buf, int len);
 R_API int r_search_magic_update(RSearch *_s, ut64 from, const ut8 *buf, int len);
@@ -24,6 +24,7 @@ typedef st64 (*RBufferSeek)(RBuffer *b, st64 addr, int whence);
 typedef ut8 *(*RBufferGetWholeBuf)(RBuffer *b, ut64 *sz);
 typedef void (*RBufferFreeWholeBuf)(RBuffer *b);
 typedef RList *(*RBufferNonEmptyList)(RBuffer *b);
+typedef const ut8 *(*RBufferBorrow)(RBuffer *b, ut64 addr, ut64 len);
 
 typedef struct r_buffer_methods_t {
 	RBufferInit init;
@@ -36,6 +37,7 @@ typedef struct r_buffer_methods_t {
 	RBufferGetWholeBuf get_whole_buf;
 	RBufferFreeWholeBuf free_whole_buf;
 	RBufferNonEmptyList nonempty_list;
+	RBufferBorrow borrow;
 } RBufferMethods;
 
 struct r_buf_t {
@@ -89,6 +91,8 @@ R_API st64 r_buf_read(RBuffer *b, ut8 *buf, ut64 len);
 R_API ut8 r_buf_read8(RBuffer *b);
 R_API st64 r_buf_fread(RBuffer *b, ut8 *buf, const char *fmt, int n);
 R_API st64 r_buf_read_at(RBuffer *b, ut64 addr, ut8 *buf, ut64 len);
+R_API const ut8 *r_buf_borrow_at(RBuffer *b, ut64 addr, ut64 len);
+R_API bool r_buf_pinned(RBuffer *b);
 R_API ut8 r_buf_read8_at(RBuffer *b, ut64 addr);
 R_API ut64 r_buf_tell(RBuffer *b);
 R_API st64 r_buf_seek(RBuffer *b, st64 addr, int whence);
@@ -0,0 +1,8 @@
+#ifndef R_VERSION_H
+#define R_VERSION_H 1
+#define R2_VERSION_COMMIT 1
+#define R2_VERSION "4.1.0-git"
+#define R2_GITTAP "4.1.0-git"
+#define R2_GITTIP "be708946463551e26c9cde671dbee0945fd8ca0a"
+#define R2_BIRTH "2026-10-17__03:06:02"
+#endif
@@ -1,16 +1,8 @@
 /* radare - LGPL - Copyright 2008-2018 - pancake */
 
-// TODO: implement a more intelligent way to store cached memory
-
 #include "r_io.h"
 
-#if 0
-#define CACHE_CONTAINER(x) container_of ((RBNode*)x, RCache, rb)
-
-static void _fcn_tree_calc_max_addr(RBNode *node) {
-	RIOCache *c = CACHE_CONTAINER (node);
-}
-#endif // 0
+#define CACHE_CONTAINER(x) container_of ((RBNode*)(x), RIOCache, rb)
 
 static void cache_item_free(RIOCache *cache) {
 	if (!cache) {
@@ -21,83 +13,182 @@ static void cache_item_free(RIOCache *cache) {
 	free (cache);
 }
 
-R_API bool r_io_cache_at(RIO *io, ut64 addr) {
-	RIOCache *c;
-	RListIter *iter;
-	r_list_foreach (io->cache, iter, c) {
-		if (r_itv_contain (c->itv, addr)) {
+static inline ut64 cache_item_last(const RIOCache *c) {
+	const ut64 size = r_itv_size (c->itv);
+	return r_itv_begin (c->itv) + (size ? size - 1 : 0);
+}
+
+// _cache_tree_{cmp,calc_max_addr,free} are used by the interval tree.
+// Items are keyed by their start address, ties are broken by write order.
+static int _cache_tree_cmp(const void *a_, const RBNode *b_, void *user) {
+	const RIOCache *a = (const RIOCache *)a_;
+	const RIOCache *b = CACHE_CONTAINER (b_);
+	const ut64 from0 = r_itv_begin (a->itv), from1 = r_itv_begin (b->itv);
+	if (from0 != from1) {
+		return from0 < from1 ? -1 : 1;
+	}
+	if (a->seq != b->seq) {
+		return a->seq < b->seq ? -1 : 1;
+	}
+	return 0;
+}
+
+static void _cache_tree_calc_max_addr(RBNode *node) {
+	int i;
+	RIOCache *c = CACHE_CONTAINER (node);
+	c->rb_max_addr = cache_item_last (c);
+	for (i = 0; i < 2; i++) {
+		if (node->child[i]) {
+			RIOCache *c1 = CACHE_CONTAINER (node->child[i]);
+			if (c1->rb_max_addr > c->rb_max_addr) {
+				c->rb_max_addr = c1->rb_max_addr;
+			}
+		}
+	}
+}
+
+static void _cache_tree_free(RBNode *node) {
+	cache_item_free (CACHE_CONTAINER (node));
+}
+
+static int _cache_seq_cmp(const void *a_, const void *b_) {
+	const RIOCache *a = a_, *b = b_;
+	return a->seq < b->seq ? -1 : (a->seq > b->seq ? 1 : 0);
+}
+
+// Append to out every item intersecting [from, to] (to is inclusive) in O(log(n) + k)
+static void _cache_tree_collect(RBNode *node, ut64 from, ut64 to, RPVector *out) {
+	while (node) {
+		RIOCache *c = CACHE_CONTAINER (node);
+		if (c->rb_max_addr < from) {
+			return;
+		}
+		_cache_tree_collect (node->child[0], from, to, out);
+		if (r_itv_begin (c->itv) > to) {
+			return;
+		}
+		if (r_itv_size (c->itv) && from <= cache_item_last (c)) {
+			r_pvector_push (out, c);
+		}
+		node = node->child[1];
+	}
+}
+
+// Returns true if any item intersects [from, to] (to is inclusive)
+static bool _cache_tree_any(RBNode *node, ut64 from, ut64 to) {
+	while (node) {
+		RIOCache *c = CACHE_CONTAINER (node);
+		if (c->rb_max_addr < from) {
+			return false;
+		}
+		if (_cache_tree_any (node->child[0], from, to)) {
 			return true;
 		}
+		if (r_itv_begin (c->itv) > to) {
+			return false;
+		}
+		if (r_itv_size (c->itv) && from <= cache_item_last (c)) {
+			return true;
+		}
+		node = node->child[1];
 	}
 	return false;
 }
 
+// Collect the items intersecting [from, from + len) sorted by write order
+static void cache_items_in(RIO *io, ut64 from, ut64 len, RPVector *out) {
+	r_pvector_init (out, NULL);
+	if (!len) {
+		return;
+	}
+	const ut64 to = (from + len - 1 < from)? UT64_MAX: from + len - 1;
+	_cache_tree_collect (io->cache, from, to, out);
+	if (r_pvector_len (out) > 1) {
+		r_pvector_sort (out, _cache_seq_cmp);
+	}
+}
+
+R_API bool r_io_cache_at(RIO *io, ut64 addr) {
+	return _cache_tree_any (io->cache, addr, addr);
+}
+
 R_API void r_io_cache_init(RIO *io) {
-	io->cache = r_list_newf ((RListFree)cache_item_free);
+	io->cache = NULL;
+	io->cache_seq = 0;
 	io->buffer = r_cache_new ();
 	io->cached = 0;
 }
 
 R_API void r_io_cache_fini (RIO *io) {
-	r_list_free (io->cache);
+	r_rbtree_free (io->cache, _cache_tree_free);
 	r_cache_free (io->buffer);
 	io->cache = NULL;
+	io->cache_seq = 0;
 	io->buffer = NULL;
 	io->cached = 0;
 }
 
 R_API void r_io_cache_commit(RIO *io, ut64 from, ut64 to) {
-	RListIter *iter;
-	RIOCache *c;
-	RInterval range = (RInterval){from, to - from};
-	r_list_foreach (io->cache, iter, c) {
-		// if (from <= c->to - 1 && c->from <= to - 1) {
-		if (r_itv_overlap (c->itv, range)) {
-			int cached = io->cached;
-			io->cached = 0;
-			if (r_io_write_at (io, r_itv_begin (c->itv), c->data, r_itv_size (c->itv))) {
-				c->written = true;
-			} else {
-				eprintf ("Error writing change at 0x%08"PFMT64x"\n", r_itv_begin (c->itv));
-			}
-			io->cached = cached;
-			// break; // XXX old behavior, revisit this
+	RPVector items;
+	void **it;
+	cache_items_in (io, from, to - from, &items);
+	r_pvector_foreach (&items, it) {
+		RIOCache *c = *it;
+		int cached = io->cached;
+		io->cached = 0;
+		if (r_io_write_at (io, r_itv_begin (c->itv), c->data, r_itv_size (c->itv))) {
+			c->written = true;
+		} else {
+			eprintf ("Error writing change at 0x%08"PFMT64x"\n", r_itv_begin (c->itv));
 		}
+		io->cached = cached;
+		// break; // XXX old behavior, revisit this
 	}
+	r_pvector_clear (&items);
 }
 
 R_API void r_io_cache_reset(RIO *io, int set) {
 	io->cached = set;
-	r_list_purge (io->cache);
+	r_rbtree_free (io->cache, _cache_tree_free);
+	io->cache = NULL;
+	io->cache_seq = 0;
 }
 
 R_API int r_io_cache_invalidate(RIO *io, ut64 from, ut64 to) {
-	int invalidated = 0;
-	RListIter *iter, *tmp;
-	RIOCache *c;
-	RInterval range = (RInterval){from, to - from};
-	r_list_foreach_prev_safe (io->cache, iter, tmp, c) {
-		if (r_itv_overlap (c->itv, range)) {
-			int cached = io->cached;
-			io->cached = 0;
-			r_io_write_at (io, r_itv_begin (c->itv), c->odata, r_itv_size (c->itv));
-			io->cached = cached;
-			c->written = false;
-			r_list_delete (io->cache, iter);
-			invalidated++;
-		}
+	int i, invalidated = 0;
+	RPVector items;
+	cache_items_in (io, from, to - from, &items);
+	// restore the original bytes from the newest write to the oldest
+	for (i = r_pvector_len (&items) - 1; i >= 0; i--) {
+		RIOCache *c = r_pvector_at (&items, i);
+		int cached = io->cached;
+		io->cached = 0;
+		r_io_write_at (io, r_itv_begin (c->itv), c->odata, r_itv_size (c->itv));
+		io->cached = cached;
+		c->written = false;
+		r_rbtree_aug_delete (&io->cache, c, _cache_tree_cmp, _cache_tree_free, _cache_tree_calc_max_addr, NULL);
+		invalidated++;
 	}
+	r_pvector_clear (&items);
 	return invalidated;
 }
 
 R_API int r_io_cache_list(RIO *io, int rad) {
 	int i, j = 0;
-	RListIter *iter;
+	RPVector items;
+	RBIter iter;
 	RIOCache *c;
+	void **it;
+	r_pvector_init (&items, NULL);
+	r_rbtree_foreach (io->cache, iter, c, RIOCache, rb) {
+		r_pvector_push (&items, c);
+	}
+	r_pvector_sort (&items, _cache_seq_cmp);
 	if (rad == 2) {
 		io->cb_printf ("[");
 	}
-	r_list_foreach (io->cache, iter, c) {
+	r_pvector_foreach (&items, it) {
+		c = *it;
 		const int dataSize = r_itv_size (c->itv);
 		if (rad == 1) {
 			io->cb_printf ("wx ");
@@ -122,7 +213,7 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 				io->cb_printf ("%02x", c->data[i]);
 			}
 			io->cb_printf ("\",\"written\":%s}%s", c->written
-				? "true": "false", iter->n? ",": "");
+				? "true": "false", j + 1 < r_pvector_len (&items)? ",": "");
 		} else if (rad == 0) {
 			io->cb_printf ("idx=%d addr=0x%08"PFMT64x" size=%d ", j, r_itv_begin (c->itv), dataSize);
 			for (i = 0; i < dataSize; i++) {
@@ -139,6 +230,7 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 	if (rad == 2) {
 		io->cb_printf ("]\n");
 	}
+	r_pvector_clear (&items);
 	return false;
 }
 
@@ -168,27 +260,30 @@ R_API bool r_io_cache_write(RIO *io, ut64 addr, const ut8 *buf, int len) {
 		io->cachemode = cm;
 	}
 	memcpy (ch->data, buf, len);
-	r_list_append (io->cache, ch);
+	ch->seq = io->cache_seq++;
+	r_rbtree_aug_insert (&io->cache, ch, &ch->rb, _cache_tree_cmp, _cache_tree_calc_max_addr, NULL);
 	return true;
 }
 
 R_API bool r_io_cache_read(RIO *io, ut64 addr, ut8 *buf, int len) {
-	bool covered = false;
-	RListIter *iter;
-	RIOCache *c;
-	RInterval range = (RInterval){ addr, len };
-	r_list_foreach (io->cache, iter, c) {
-		if (r_itv_overlap (c->itv, range)) {
-			const ut64 begin = r_itv_begin (c->itv);
-			if (addr < begin) {
-				int l = R_MIN (addr + len - begin, r_itv_size (c->itv));
-				memcpy (buf + begin - addr, c->data, l);
-			} else {
-				int l = R_MIN (r_itv_end (c->itv) - addr, len);
-				memcpy (buf, c->data + addr - begin, l);
-			}
-			covered = true;
+	RPVector items;
+	void **it;
+	if (len < 1) {
+		return false;
+	}
+	cache_items_in (io, addr, len, &items);
+	r_pvector_foreach (&items, it) {
+		RIOCache *c = *it;
+		const ut64 begin = r_itv_begin (c->itv);
+		if (addr < begin) {
+			int l = R_MIN (addr + len - begin, r_itv_size (c->itv));
+			memcpy (buf + begin - addr, c->data, l);
+		} else {
+			int l = R_MIN (r_itv_end (c->itv) - addr, len);
+			memcpy (buf, c->data + addr - begin, l);
 		}
 	}
+	const bool covered = !r_pvector_empty (&items);
+	r_pvector_clear (&items);
 	return covered;
 }
@@ -88,6 +88,7 @@ static int rabin_show_help(int v) {
 		" RABIN2_NOPLUGINS: # do not load shared plugins (speedup loading)\n"
 		" RABIN2_DEMANGLE=0:e bin.demangle     # do not demangle symbols\n"
 		" RABIN2_MAXSTRBUF: e bin.maxstrbuf    # specify maximum buffer size\n"
+		" RABIN2_STRTHREADS:e bin.str.threads  # scan for strings with N threads\n"
 		" RABIN2_STRFILTER: e bin.str.filter   #  r2 -qc 'e bin.str.filter=?" "?' -\n"
 		" RABIN2_STRPURGE:  e bin.str.purge    # try to purge false positives\n"
 		" RABIN2_DEBASE64:  e bin.debase64     # try to debase64 all strings\n"
@@ -606,6 +607,10 @@ R_API int r_main_rabin2(int argc, char **argv) {
 		r_config_set (core.config, "bin.maxstrbuf", tmp);
 		free (tmp);
 	}
+	if ((tmp = r_sys_getenv ("RABIN2_STRTHREADS"))) {
+		r_config_set (core.config, "bin.str.threads", tmp);
+		free (tmp);
+	}
 	if ((tmp = r_sys_getenv ("RABIN2_STRFILTER"))) {
 		r_config_set (core.config, "bin.str.filter", tmp);
 		free (tmp);
@@ -1006,6 +1011,8 @@ R_API int r_main_rabin2(int argc, char **argv) {
 	}
 	bin->minstrlen = r_config_get_i (core.config, "bin.minstr");
 	bin->maxstrbuf = r_config_get_i (core.config, "bin.maxstrbuf");
+	bin->strthreads = r_config_get_i (core.config, "bin.str.threads");
+	bin->dbgthreads = r_config_get_i (core.config, "bin.dbginfo.threads");
 
 	r_bin_force_plugin (bin, forcebin);
 	r_bin_load_filter (bin, action);
@@ -1319,6 +1319,13 @@ R_API int r_main_radare2(int argc, char **argv) {
 				(void)r_bin_file_hash (r.bin, limit, iod->name, NULL);
 				//eprintf ("WARNING: File hash not calculated\n");
 			}
+			if (!has_project && iod && r_config_get_i (r.config, "prj.snapshot")) {
+				char *snap = r_core_snapshot_path (&r);
+				if (snap && r_file_exists (snap)) {
+					r_core_snapshot_load (&r, snap);
+				}
+				free (snap);
+			}
 			npath = r_config_get (r.config, "file.path");
 			if (!quiet && path && *path && npath && strcmp (path, npath)) {
 				eprintf ("WARNING: file.path change: %s => %s\n", path, npath);
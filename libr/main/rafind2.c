@@ -31,6 +31,9 @@ static RPrint *pr = NULL;
 static RList *keywords;
 static const char *comma = "";
 static bool json = false;
+static int algo = R_SEARCH_ALGO_BRUTE;
+static bool bench = false;
+static int nthreads = 1;
 
 static int hit(RSearchKeyword *kw, void *user, ut64 addr) {
 	int delta = addr - cur;
@@ -118,12 +121,14 @@ static int hit(RSearchKeyword *kw, void *user, ut64 addr) {
 }
 
 static int show_help(char *argv0, int line) {
-	printf ("Usage: %s [-mXnzZhqv] [-a align] [-b sz] [-f/t from/to] [-[e|s|S] str] [-x hex] -|file|dir ..\n", argv0);
+	printf ("Usage: %s [-mXnzZhqvB] [-a align] [-A algo] [-b sz] [-T threads] [-f/t from/to] [-[e|s|S] str] [-x hex] -|file|dir ..\n", argv0);
 	if (line) {
 		return 0;
 	}
 	printf (
 	" -a [align] only accept aligned hits\n"
+	" -A [algo]  keyword search algorithm (brute, multi)\n"
+	" -B         report search throughput on stderr\n"
 	" -b [size]  set block size\n"
 	" -e [regex] search for regex matches (can be used multiple times)\n"
 	" -f [from]  start searching from address 'from'\n"
@@ -137,6 +142,7 @@ static int show_help(char *argv0, int line) {
 	" -s [str]   search for a specific string (can be used multiple times)\n"
 	" -S [str]   search for a specific wide string (can be used multiple times). Assumes str is UTF-8.\n"
 	" -t [to]    stop search at address 'to'\n"
+	" -T [n]     scan keywords with n threads (hits are still reported in address order)\n"
 	" -q         quiet - do not show headings (filenames) above matching contents (default for searching a single file)\n"
 	" -v         print version and exit\n"
 	" -x [hex]   search for hexpair string (909090) (can be used multiple times)\n"
@@ -251,8 +257,22 @@ static int rafind_open_file(const char *file, const ut8 *data, int datalen) {
 		r_search_kw_add (rs, r_search_keyword_new_hexmask ("00", NULL)); //XXX
 	}
 
+	r_search_set_algo (rs, algo);
+	const int maxlen = r_search_kw_maxlen (rs);
+	if (nthreads > 1) {
+		// big blocks to keep the threads busy, plus room to read ahead
+		bsize = R_MAX (bsize, (ut64)nthreads << 20);
+		ut8 *nbuf = realloc (buf, bsize + maxlen);
+		if (!nbuf) {
+			eprintf ("Cannot allocate %"PFMT64d" bytes\n", bsize);
+			result = 1;
+			goto done;
+		}
+		buf = nbuf;
+	}
 	curfile = file;
 	r_search_begin (rs);
+	ut64 t0 = r_sys_now ();
 	(void)r_io_seek (io, from, R_IO_SEEK_SET);
 	result = 0;
 	for (cur = from; !last && cur < to; cur += bsize) {
@@ -272,11 +292,24 @@ static int rafind_open_file(const char *file, const ut8 *data, int datalen) {
 			bsize = ret;
 		}
 
-		if (r_search_update (rs, cur, buf, ret) == -1) {
+		int buflen = ret;
+		if (nthreads > 1 && ret > 0 && !last && maxlen > 1) {
+			// let hits crossing into the next block be reported from this one
+			int n = r_io_pread_at (io, cur + ret, buf + ret, R_MIN (maxlen - 1, to - cur - ret));
+			if (n > 0) {
+				buflen += n;
+			}
+		}
+		if (r_search_update_threads (rs, cur, buf, ret, buflen, nthreads) == -1) {
 			eprintf ("search: update read error at 0x%08"PFMT64x"\n", cur);
 			break;
 		}
 	}
+	if (bench) {
+		ut64 dt = R_MAX (r_sys_now () - t0, 1);
+		ut64 sz = R_MIN (cur, to) - from;
+		eprintf ("%"PFMT64d" bytes in %.3fs, %.3f GB/s\n", sz, dt / 1000000.0, (double)sz / dt / 1000.0);
+	}
 done:
 	r_cons_free ();
 err:
@@ -328,11 +361,24 @@ R_API int r_main_rafind2(int argc, char **argv) {
 	int c;
 
 	keywords = r_list_new ();
-	while ((c = r_getopt (argc, argv, "a:ie:b:jmM:s:S:x:Xzf:t:E:rqnhvZ")) != -1) {
+	while ((c = r_getopt (argc, argv, "a:A:ie:b:BjmM:s:S:x:Xzf:t:T:E:rqnhvZ")) != -1) {
 		switch (c) {
 		case 'a':
 			align = r_num_math (NULL, r_optarg);
 			break;
+		case 'A':
+			if (!strcmp (r_optarg, "multi")) {
+				algo = R_SEARCH_ALGO_MULTI;
+			} else if (!strcmp (r_optarg, "brute")) {
+				algo = R_SEARCH_ALGO_BRUTE;
+			} else {
+				eprintf ("Unknown search algorithm '%s'\n", r_optarg);
+				return 1;
+			}
+			break;
+		case 'B':
+			bench = true;
+			break;
 		case 'r':
 			rad = 1;
 			break;
@@ -388,6 +434,9 @@ R_API int r_main_rafind2(int argc, char **argv) {
 		case 't':
 			to = r_num_math (NULL, r_optarg);
 			break;
+		case 'T':
+			nthreads = R_MAX (1, (int)r_num_math (NULL, r_optarg));
+			break;
 		case 'X':
 			pr = r_print_new ();
 			break;
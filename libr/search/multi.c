@@ -0,0 +1,247 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_search.h>
+#include <ctype.h>
+
+// Multi-pattern keyword search (search.algo=multi)
+//
+// Instead of sliding every keyword over the buffer, keywords are indexed by
+// the values their first two bytes can take (honoring binmask and icase), and
+// the buffer is walked once: a 64Kbit bitmap (8KB, stays in L1) rejects most
+// offsets with a single bit test, and only the keywords in the matching bucket
+// are compared. Keywords which can't be bucketed (one byte long, or too many
+// masked/case-insensitive prefix variants) are tried at every offset.
+//
+// Hits are reported in address order. Backward, inverse and distance
+// searches fall back to r_search_mybinparse_update.
+
+#define MULTI_BUCKETS 0x10000
+#define MULTI_MAX_VARIANTS 256
+
+typedef struct {
+	ut8 bitmap[MULTI_BUCKETS / 8];
+	ut32 *off; // MULTI_BUCKETS + 1 offsets into kws
+	RSearchKeyword **kws;
+	RSearchKeyword **rest;
+	int nrest;
+	int longest;
+} RSearchMulti;
+
+static inline bool byte_match(RSearchKeyword *kw, int j, ut8 a) {
+	ut8 b = kw->bin_keyword[j];
+	if (kw->icase) {
+		a = tolower (a);
+		b = tolower (b);
+	}
+	if (kw->binmask_length > 0) {
+		ut8 m = kw->bin_binmask[j % kw->binmask_length];
+		return (a & m) == (b & m);
+	}
+	return a == b;
+}
+
+static inline bool kw_match(RSearchKeyword *kw, const ut8 *buf, int from) {
+	int j;
+	for (j = 0; j < kw->keyword_length; j++) {
+		if (!byte_match (kw, j, buf[from + j])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Fill vals with the byte values that match position j of kw, returns how many
+static int kw_variants(RSearchKeyword *kw, int j, ut8 *vals) {
+	int v, n = 0;
+	for (v = 0; v < 256; v++) {
+		if (byte_match (kw, j, v)) {
+			vals[n++] = v;
+		}
+	}
+	return n;
+}
+
+static void multi_free(RSearchMulti *m) {
+	if (m) {
+		free (m->off);
+		free (m->kws);
+		free (m->rest);
+		free (m);
+	}
+}
+
+R_API void r_search_multi_reset(RSearch *s) {
+	multi_free (s->kw_index);
+	s->kw_index = NULL;
+}
+
+static void multi_add(RSearchMulti *m, RSearchKeyword *kw, bool fill) {
+	ut8 v0[256], v1[256];
+	int i, j;
+	int n0 = kw_variants (kw, 0, v0);
+	int n1 = kw_variants (kw, 1, v1);
+	for (i = 0; i < n0; i++) {
+		for (j = 0; j < n1; j++) {
+			ut16 k = v0[i] | (v1[j] << 8);
+			if (fill) {
+				m->kws[m->off[k]++] = kw;
+			} else {
+				m->off[k + 1]++;
+				m->bitmap[k >> 3] |= 1 << (k & 7);
+			}
+		}
+	}
+}
+
+static bool kw_bucketable(RSearchKeyword *kw) {
+	ut8 vals[256];
+	if (kw->keyword_length < 2) {
+		return false;
+	}
+	return kw_variants (kw, 0, vals) * kw_variants (kw, 1, vals) <= MULTI_MAX_VARIANTS;
+}
+
+static RSearchMulti *multi_new(RSearch *s) {
+	RListIter *iter;
+	RSearchKeyword *kw;
+	ut32 i, total;
+	RSearchMulti *m = R_NEW0 (RSearchMulti);
+	if (!m) {
+		return NULL;
+	}
+	m->off = calloc (MULTI_BUCKETS + 1, sizeof (ut32));
+	m->rest = calloc (r_list_length (s->kws) + 1, sizeof (RSearchKeyword *));
+	if (!m->off || !m->rest) {
+		multi_free (m);
+		return NULL;
+	}
+	// count, then turn the counts into offsets and fill the buckets
+	r_list_foreach (s->kws, iter, kw) {
+		m->longest = R_MAX (m->longest, kw->keyword_length);
+		if (kw_bucketable (kw)) {
+			multi_add (m, kw, false);
+		} else {
+			m->rest[m->nrest++] = kw;
+		}
+	}
+	for (i = 0; i < MULTI_BUCKETS; i++) {
+		m->off[i + 1] += m->off[i];
+	}
+	total = m->off[MULTI_BUCKETS];
+	m->kws = calloc (total + 1, sizeof (RSearchKeyword *));
+	if (!m->kws) {
+		multi_free (m);
+		return NULL;
+	}
+	r_list_foreach (s->kws, iter, kw) {
+		if (kw_bucketable (kw)) {
+			multi_add (m, kw, true);
+		}
+	}
+	// filling advanced each offset to the start of the next bucket
+	memmove (m->off + 1, m->off, MULTI_BUCKETS * sizeof (ut32));
+	m->off[0] = 0;
+	return m;
+}
+
+// Returns 0 on error, 2 if search.maxhits is reached, otherwise 1
+static inline int multi_try(RSearch *s, RSearchKeyword *kw, const ut8 *data, int datalen, int i, ut64 addr) {
+	if (i + kw->keyword_length > datalen) {
+		return 1;
+	}
+	if (!s->overlap && kw->count && addr < kw->last) {
+		return 1;
+	}
+	if (!kw_match (kw, data, i)) {
+		return 1;
+	}
+	return r_search_hit_new (s, kw, addr);
+}
+
+// Look for keywords starting at data[0, nstarts), matched bytes can go up to datalen
+static int multi_scan(RSearch *s, RSearchMulti *m, const ut8 *data, int datalen, int nstarts, ut64 base) {
+	int i, k, t;
+	for (i = 0; i < nstarts; i++) {
+		const ut64 addr = base + i;
+		if (i + 1 < datalen) {
+			ut16 v = data[i] | (data[i + 1] << 8);
+			if (m->bitmap[v >> 3] & (1 << (v & 7))) {
+				ut32 b;
+				for (b = m->off[v]; b < m->off[v + 1]; b++) {
+					if ((t = multi_try (s, m->kws[b], data, datalen, i, addr)) != 1) {
+						return t;
+					}
+				}
+			}
+		}
+		for (k = 0; k < m->nrest; k++) {
+			if ((t = multi_try (s, m->rest[k], data, datalen, i, addr)) != 1) {
+				return t;
+			}
+		}
+	}
+	return 1;
+}
+
+// Supported search variants: binmask, icase, overlap
+R_API int r_search_multi_update(RSearch *s, ut64 from, const ut8 *buf, int len) {
+	RSearchMulti *m;
+	RSearchLeftover *left;
+	const int old_nhits = s->nhits;
+	int t;
+
+	if (s->bckwrds || s->inverse || s->distance) {
+		return r_search_mybinparse_update (s, from, buf, len);
+	}
+	if (!s->kw_index) {
+		s->kw_index = multi_new (s);
+		if (!s->kw_index) {
+			return -1;
+		}
+	}
+	m = s->kw_index;
+	const int longest = m->longest;
+	if (!longest) {
+		return 0;
+	}
+	if (s->data) {
+		left = s->data;
+		if (left->end != from) {
+			left->len = 0;
+		}
+	} else {
+		left = malloc (sizeof (RSearchLeftover) + (size_t)2 * (longest - 1));
+		if (!left) {
+			return -1;
+		}
+		s->data = left;
+		left->len = 0;
+	}
+
+	// hits starting in the tail of the previous block
+	ut64 len1 = left->len + R_MIN (longest - 1, len);
+	memcpy (left->data + left->len, buf, len1 - left->len);
+	t = multi_scan (s, m, left->data, len1, left->len, from - left->len);
+	if (t != 1) {
+		return t? s->nhits - old_nhits: -1;
+	}
+	t = multi_scan (s, m, buf, len, len, from);
+	if (t != 1) {
+		return t? s->nhits - old_nhits: -1;
+	}
+
+	if (len < longest - 1) {
+		if (len1 < longest) {
+			left->len = len1;
+		} else {
+			left->len = longest - 1;
+			memmove (left->data, left->data + len1 - longest + 1, longest - 1);
+		}
+	} else {
+		left->len = longest - 1;
+		memcpy (left->data, buf + len - longest + 1, longest - 1);
+	}
+	left->end = from + len;
+
+	return s->nhits - old_nhits;
+}
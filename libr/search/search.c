@@ -9,12 +9,6 @@
 
 R_LIB_VERSION (r_search);
 
-typedef struct {
-	ut64 end;
-	int len;
-	ut8 data[];
-} RSearchLeftover;
-
 R_API RSearch *r_search_new(int mode) {
 	RSearch *s = R_NEW0 (RSearch);
 	if (!s) {
@@ -56,6 +50,7 @@ R_API RSearch *r_search_free(RSearch *s) {
 	r_list_free (s->kws);
 	//r_io_free(s->iob.io); this is supposed to be a weak reference
 	free (s->data);
+	r_search_multi_reset (s);
 	free (s);
 	return NULL;
 }
@@ -77,7 +72,11 @@ R_API int r_search_magic_update(RSearch *s, ut64 from, const ut8 *buf, int len)
 R_API int r_search_set_mode(RSearch *s, int mode) {
 	s->update = NULL;
 	switch (mode) {
-	case R_SEARCH_KEYWORD: s->update = r_search_mybinparse_update; break;
+	case R_SEARCH_KEYWORD:
+		s->update = s->algo == R_SEARCH_ALGO_MULTI
+			? r_search_multi_update
+			: r_search_mybinparse_update;
+		break;
 	case R_SEARCH_XREFS: s->update = r_search_xrefs_update; break;
 	case R_SEARCH_REGEXP: s->update = r_search_regexp_update; break;
 	case R_SEARCH_AES: s->update = r_search_aes_update; break;
@@ -92,6 +91,19 @@ R_API int r_search_set_mode(RSearch *s, int mode) {
 	return false;
 }
 
+R_API bool r_search_set_algo(RSearch *s, int algo) {
+	switch (algo) {
+	case R_SEARCH_ALGO_BRUTE:
+	case R_SEARCH_ALGO_MULTI:
+		s->algo = algo;
+		if (s->mode == R_SEARCH_KEYWORD) {
+			r_search_set_mode (s, s->mode);
+		}
+		return true;
+	}
+	return false;
+}
+
 R_API int r_search_begin(RSearch *s) {
 	RListIter *iter;
 	RSearchKeyword *kw;
@@ -513,6 +525,7 @@ R_API int r_search_kw_add(RSearch *s, RSearchKeyword *kw) {
 	}
 	kw->kwidx = s->n_kws++;
 	r_list_append (s->kws, kw);
+	r_search_multi_reset (s);
 	return true;
 }
 
@@ -521,6 +534,7 @@ R_API void r_search_string_prepare_backward(RSearch *s) {
 	RListIter *iter;
 	RSearchKeyword *kw;
 	// Precondition: !kw->binmask_length || kw->keyword_length % kw->binmask_length == 0
+	r_search_multi_reset (s);
 	r_list_foreach (s->kws, iter, kw) {
 		ut8 *i = kw->bin_keyword, *j = kw->bin_keyword + kw->keyword_length;
 		while (i < j) {
@@ -549,4 +563,5 @@ R_API void r_search_kw_reset(RSearch *s) {
 	r_list_purge (s->kws);
 	r_list_purge (s->hits);
 	R_FREE (s->data);
+	r_search_multi_reset (s);
 }
@@ -0,0 +1,171 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_search.h>
+#include <r_th.h>
+
+// Threaded keyword search
+//
+// The buffer is split in one chunk per thread, every chunk is scanned by a
+// private RSearch with its own copy of the keywords (hits update kw->count
+// and kw->last, so keywords can't be shared) reading up to maxlen - 1 bytes
+// past its end, so hits crossing the chunk boundaries are found by the chunk
+// they start in. All hits are then replayed in address order through
+// r_search_hit_new on the caller's RSearch, which applies search.overlap,
+// search.contiguous, search.align and search.maxhits exactly as a serial
+// scan would, and invokes the user callback from the calling thread.
+
+#define THREADS_MIN_CHUNK 0x10000
+
+typedef struct {
+	RSearch *s;
+	const ut8 *buf;
+	ut64 from;
+	int len; // hits must start in [from, from + len)
+	int buflen; // bytes readable from buf
+	RVector hits; // RSearchHit, kw points to the caller's keyword
+	int ret;
+} RSearchChunk;
+
+static int chunk_hit(RSearchKeyword *kw, void *user, ut64 addr) {
+	RSearchChunk *c = user;
+	if (addr >= c->from + c->len) {
+		// belongs to the next chunk
+		return 1;
+	}
+	RSearchHit hit = { kw->data, addr };
+	return r_vector_push (&c->hits, &hit)? 1: 0;
+}
+
+static int hit_cmp(const void *a, const void *b) {
+	const RSearchHit *ha = a, *hb = b;
+	if (ha->addr != hb->addr) {
+		return ha->addr < hb->addr? -1: 1;
+	}
+	return ha->kw->kwidx - hb->kw->kwidx;
+}
+
+static RThreadFunctionRet chunk_th(RThread *th) {
+	RSearchChunk *c = th->user;
+	c->ret = r_search_update (c->s, c->from, c->buf, c->buflen);
+	qsort (c->hits.a, c->hits.len, c->hits.elem_size, hit_cmp);
+	return R_TH_STOP;
+}
+
+static RSearch *chunk_search(RSearch *s, RSearchChunk *c) {
+	RListIter *iter;
+	RSearchKeyword *kw;
+	RSearch *cs = r_search_new (R_SEARCH_KEYWORD);
+	if (!cs) {
+		return NULL;
+	}
+	r_search_set_algo (cs, s->algo);
+	cs->overlap = true;
+	cs->contiguous = true;
+	r_list_foreach (s->kws, iter, kw) {
+		RSearchKeyword *ckw = r_search_keyword_new (kw->bin_keyword, kw->keyword_length,
+			kw->bin_binmask, kw->binmask_length, (const char *)kw);
+		if (!ckw) {
+			r_search_free (cs);
+			return NULL;
+		}
+		ckw->icase = kw->icase;
+		ckw->type = kw->type;
+		r_search_kw_add (cs, ckw);
+	}
+	r_search_set_callback (cs, chunk_hit, c);
+	r_search_begin (cs);
+	return cs;
+}
+
+R_API int r_search_kw_maxlen(RSearch *s) {
+	RListIter *iter;
+	RSearchKeyword *kw;
+	int longest = 0;
+	r_list_foreach (s->kws, iter, kw) {
+		longest = R_MAX (longest, kw->keyword_length);
+	}
+	return longest;
+}
+
+// Report the hits starting in [from, from + len). buf holds buflen >= len bytes, so
+// hits crossing from + len are found when buflen reaches len + r_search_kw_maxlen - 1.
+// The next call is expected to start at from + len.
+R_API int r_search_update_threads(RSearch *s, ut64 from, const ut8 *buf, int len, int buflen, int nthreads) {
+	const int old_nhits = s->nhits;
+	int i, ret = 0;
+	if (s->maxhits && s->nhits >= s->maxhits) {
+		return 0;
+	}
+	if (nthreads < 2 || s->mode != R_SEARCH_KEYWORD || s->bckwrds || s->inverse || s->distance) {
+		return r_search_update (s, from, buf, len);
+	}
+	// small buffers go through the same path, so hits are never left behind in s->data
+	nthreads = R_MAX (1, R_MIN (nthreads, len / THREADS_MIN_CHUNK));
+	const int maxlen = r_search_kw_maxlen (s);
+	const int per = (len + nthreads - 1) / nthreads;
+	RSearchChunk *chunks = R_NEWS0 (RSearchChunk, nthreads);
+	RThread **ths = R_NEWS0 (RThread *, nthreads);
+	if (!chunks || !ths) {
+		free (chunks);
+		free (ths);
+		return -1;
+	}
+	for (i = 0; i < nthreads; i++) {
+		RSearchChunk *c = &chunks[i];
+		const int start = i * per;
+		c->from = from + start;
+		c->buf = buf + start;
+		c->len = R_MIN (per, len - start);
+		c->buflen = R_MIN (c->len + maxlen - 1, buflen - start);
+		r_vector_init (&c->hits, sizeof (RSearchHit), NULL, NULL);
+		c->s = chunk_search (s, c);
+		if (!c->s) {
+			ret = -1;
+			goto beach;
+		}
+	}
+	for (i = 0; nthreads > 1 && i < nthreads; i++) {
+		ths[i] = r_th_new (chunk_th, &chunks[i], 0);
+	}
+	for (i = 0; i < nthreads; i++) {
+		if (ths[i]) {
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+		} else {
+			// single chunk or could not spawn a thread, scan it here
+			RThread th = { .user = &chunks[i] };
+			chunk_th (&th);
+		}
+	}
+	// chunks are consecutive and sorted, so this replays the hits in address order
+	for (i = 0; i < nthreads; i++) {
+		RSearchChunk *c = &chunks[i];
+		RSearchHit *hit;
+		if (c->ret == -1) {
+			ret = -1;
+			goto beach;
+		}
+		r_vector_foreach (&c->hits, hit) {
+			RSearchKeyword *kw = hit->kw;
+			if (!s->overlap && kw->count && hit->addr < kw->last) {
+				continue;
+			}
+			int t = r_search_hit_new (s, kw, hit->addr);
+			if (!t) {
+				ret = -1;
+				goto beach;
+			}
+			if (t > 1) {
+				goto beach;
+			}
+		}
+	}
+beach:
+	for (i = 0; i < nthreads; i++) {
+		r_search_free (chunks[i].s);
+		r_vector_clear (&chunks[i].hits);
+	}
+	free (chunks);
+	free (ths);
+	return ret == -1? -1: s->nhits - old_nhits;
+}
@@ -572,6 +572,29 @@ R_API st64 r_buf_read_at(RBuffer *b, ut64 addr, ut8 *buf, ut64 len) {
 	return r_buf_read (b, buf, len);
 }
 
+// Returns a read-only view of [addr, addr + len) without copying it, or NULL if
+// the buffer is not backed by contiguous memory (file, io, sparse) or the range
+// is out of bounds. Callers fall back to r_buf_read_at in that case. The pointer
+// is valid until the buffer is written, resized or freed.
+R_API const ut8 *r_buf_borrow_at(RBuffer *b, ut64 addr, ut64 len) {
+	r_return_val_if_fail (b && b->methods, NULL);
+	if (!b->methods->borrow || addr + len < addr) {
+		return NULL;
+	}
+	return b->methods->borrow (b, addr, len);
+}
+
+// True when the views r_buf_borrow_at lends stay valid for as long as the
+// buffer lives, even across writes and resizes: a mapped file keeps its
+// mapping until fini, while byte buffers may move on realloc.
+R_API bool r_buf_pinned(RBuffer *b) {
+	r_return_val_if_fail (b && b->methods, false);
+	if (b->methods == &buffer_ref_methods) {
+		return r_buf_pinned (get_priv_ref (b)->parent);
+	}
+	return b->methods == &buffer_mmap_methods;
+}
+
 R_API st64 r_buf_write_at(RBuffer *b, ut64 addr, const ut8 *buf, ut64 len) {
 	r_return_val_if_fail (b && buf && !b->readonly, -1);
 	st64 r = r_buf_seek (b, addr, R_BUF_SET);
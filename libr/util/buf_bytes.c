@@ -127,6 +127,14 @@ static ut8 *buf_bytes_get_whole_buf(RBuffer *b, ut64 *sz) {
 	return priv->buf;
 }
 
+static const ut8 *buf_bytes_borrow(RBuffer *b, ut64 addr, ut64 len) {
+	struct buf_bytes_priv *priv = get_priv_bytes (b);
+	if (!priv->buf || addr > priv->length || len > priv->length - addr) {
+		return NULL;
+	}
+	return priv->buf + addr;
+}
+
 static const RBufferMethods buffer_bytes_methods = {
 	.init = buf_bytes_init,
 	.fini = buf_bytes_fini,
@@ -135,5 +143,6 @@ static const RBufferMethods buffer_bytes_methods = {
 	.get_size = buf_bytes_get_size,
 	.resize = buf_bytes_resize,
 	.seek = buf_bytes_seek,
-	.get_whole_buf = buf_bytes_get_whole_buf
+	.get_whole_buf = buf_bytes_get_whole_buf,
+	.borrow = buf_bytes_borrow,
 };
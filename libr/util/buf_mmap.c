@@ -10,6 +10,8 @@ struct buf_mmap_priv {
 	// NOTE: this needs to be first, so that bytes operations will work without changes
 	struct buf_bytes_priv bytes_priv;
 	RMmap *mmap;
+	// private copy of a read-only mapping, made on the first write
+	ut8 *copy;
 };
 
 static inline struct buf_mmap_priv *get_priv_mmap(RBuffer *b) {
@@ -39,14 +41,51 @@ static bool buf_mmap_init(RBuffer *b, const void *user) {
 
 static bool buf_mmap_fini(RBuffer *b) {
 	struct buf_mmap_priv *priv = get_priv_mmap (b);
+	free (priv->copy);
 	r_file_mmap_free (priv->mmap);
 	R_FREE (b->priv);
 	return true;
 }
 
+// writing to a read-only mapping would fault, the contents are copied out
+// instead. The mapping is kept until fini because pointers borrowed from it
+// may still be in use.
+static bool buf_mmap_own(struct buf_mmap_priv *priv) {
+	if (priv->copy || priv->mmap->rw) {
+		return true;
+	}
+	priv->copy = malloc (R_MAX (priv->bytes_priv.length, 1));
+	if (!priv->copy) {
+		return false;
+	}
+	memcpy (priv->copy, priv->bytes_priv.buf, priv->bytes_priv.length);
+	priv->bytes_priv.buf = priv->copy;
+	return true;
+}
+
+static st64 buf_mmap_write(RBuffer *b, const ut8 *buf, ut64 len) {
+	struct buf_mmap_priv *priv = get_priv_mmap (b);
+	if (!buf_mmap_own (priv)) {
+		return -1;
+	}
+	return buf_bytes_write (b, buf, len);
+}
+
 static bool buf_mmap_resize(RBuffer *b, ut64 newsize) {
 	struct buf_mmap_priv *priv = get_priv_mmap (b);
-	if (newsize > priv->mmap->len) {
+	if (!buf_mmap_own (priv)) {
+		return false;
+	}
+	if (priv->copy) {
+		if (newsize > priv->bytes_priv.length) {
+			ut8 *t = realloc (priv->copy, newsize);
+			if (!t) {
+				return false;
+			}
+			memset (t + priv->bytes_priv.length, b->Oxff_priv, newsize - priv->bytes_priv.length);
+			priv->copy = priv->bytes_priv.buf = t;
+		}
+	} else if (newsize > priv->mmap->len) {
 		ut8 *t = r_mem_mmap_resize (priv->mmap, newsize);
 		if (!t) {
 			return false;
@@ -61,8 +100,10 @@ static const RBufferMethods buffer_mmap_methods = {
 	.init = buf_mmap_init,
 	.fini = buf_mmap_fini,
 	.read = buf_bytes_read,
-	.write = buf_bytes_write,
+	.write = buf_mmap_write,
 	.get_size = buf_bytes_get_size,
 	.resize = buf_mmap_resize,
 	.seek = buf_bytes_seek,
+	.get_whole_buf = buf_bytes_get_whole_buf,
+	.borrow = buf_bytes_borrow,
 };
@@ -90,6 +90,14 @@ static st64 buf_ref_seek(RBuffer *b, st64 addr, int whence) {
 	return priv->cur;
 }
 
+static const ut8 *buf_ref_borrow(RBuffer *b, ut64 addr, ut64 len) {
+	struct buf_ref_priv *priv = get_priv_ref (b);
+	if (addr > priv->size || len > priv->size - addr) {
+		return NULL;
+	}
+	return r_buf_borrow_at (priv->parent, priv->base + addr, len);
+}
+
 static const RBufferMethods buffer_ref_methods = {
 	.init = buf_ref_init,
 	.fini = buf_ref_fini,
@@ -97,4 +105,5 @@ static const RBufferMethods buffer_ref_methods = {
 	.get_size = buf_ref_get_size,
 	.resize = buf_ref_resize,
 	.seek = buf_ref_seek,
+	.borrow = buf_ref_borrow,
 };
@@ -2,7 +2,8 @@
 
 #include <r_util.h>
 
-R_API int r_name_validate_char(const char ch) {
+// inlined in the loops below, they run for every char of every flag name
+static inline bool is_name_char(const char ch) {
 	if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (IS_DIGIT(ch))) {
 		return true;
 	}
@@ -15,6 +16,10 @@ R_API int r_name_validate_char(const char ch) {
 	return false;
 }
 
+R_API int r_name_validate_char(const char ch) {
+	return is_name_char (ch);
+}
+
 R_API int r_name_check(const char *name) {
 	/* Cannot start by number */
 	if (!name || !*name || IS_DIGIT (*name)) {
@@ -22,7 +27,7 @@ R_API int r_name_check(const char *name) {
 	}
 	/* Cannot contain non-alphanumeric chars + [:._] */
 	for (; *name != '\0'; name++) {
-		if (!r_name_validate_char (*name)) {
+		if (!is_name_char (*name)) {
 			return false;
 		}
 	}
@@ -49,7 +54,7 @@ R_API int r_name_filter(char *name, int maxlen) {
 			*name = '\0';
 			break;
 		}
-		if (!r_name_validate_char (*name) && *name != '\\') {
+		if (!is_name_char (*name) && *name != '\\') {
 			*name = '_';
 			//		r_str_ccpy (name, name+1, 0);
 			//name--;
@@ -92,7 +97,7 @@ R_API char *r_name_filter2(const char *name) {
 	}
 	char *res = strdup (name);
 	for (i = 0; res[i]; i++) {
-		if (!r_name_validate_char (res[i])) {
+		if (!is_name_char (res[i])) {
 			res[i] = '_';
 		}
 	}
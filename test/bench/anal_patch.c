@@ -0,0 +1,80 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+// Patches a function with anal.onwrite set, after pdr and agf cached the
+// links between its blocks, and runs them again. The user block added with
+// afb+ is carried over to the function analyzed after the patch, so its
+// cached links must point into that one: build with -fsanitize=address or
+// run under valgrind to catch reads of the blocks freed with the old one.
+// Also times the incremental analysis of a write against a full aaa.
+//
+// usage: anal_patch [writes]
+
+#include <r_core.h>
+
+// 0x1000: push rbp; mov rbp, rsp; test edi, edi; je 0x100d
+// 0x1008: mov eax, 1
+// 0x100d: pop rbp; ret
+// 0x1100: jmp 0x1000
+#define FCN "554889e585ff7405b8010000005dc3"
+#define USER_BB "e9fbfeffff"
+
+static bool check_links(RCore *core) {
+	RAnalFunction *fcn = r_anal_get_fcn_at (core->anal, 0x1000, 0);
+	RListIter *iter;
+	RAnalBlock *bb;
+	bool ok = fcn && r_anal_fcn_bbget_at (fcn, 0x1100);
+	if (!fcn) {
+		return false;
+	}
+	r_list_foreach (fcn->bbs, iter, bb) {
+		RAnalBlock *jump = r_anal_bb_get_jumpbb (fcn, bb);
+		RAnalBlock *fail = r_anal_bb_get_failbb (fcn, bb);
+		if ((jump && !r_list_contains (fcn->bbs, jump)) || (fail && !r_list_contains (fcn->bbs, fail))) {
+			eprintf ("block 0x%"PFMT64x" links outside of its function\n", bb->addr);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+int main(int argc, char **argv) {
+	const int writes = argc > 1? atoi (argv[1]): 1000;
+	int i;
+
+	RCore *core = r_core_new ();
+	if (!core) {
+		return 1;
+	}
+	r_core_cmd0 (core, "o malloc://0x10000 0");
+	r_core_cmd0 (core, "e asm.arch=x86; e asm.bits=64; e io.cache=true");
+	r_core_cmd0 (core, "wx " FCN " @ 0x1000; wx " USER_BB " @ 0x1100");
+	r_core_cmd0 (core, "af @ 0x1000; afb+ 0x1000 0x1100 5 0x1000 0x100d");
+	r_cons_push ();
+	r_core_cmd0 (core, "pdr @ 0x1000; agf @ 0x1000");
+	r_cons_pop ();
+	const bool before = check_links (core);
+
+	r_config_set_i (core->config, "anal.onwrite", true);
+	ut64 t0 = r_sys_now ();
+	for (i = 0; i < writes; i++) {
+		r_core_cmdf (core, "wx b8%02x000000 @ 0x1008", i & 0xff);
+	}
+	const double incr = (r_sys_now () - t0) / 1000000.0;
+	r_cons_push ();
+	r_core_cmd0 (core, "pdr @ 0x1000; agf @ 0x1000");
+	r_cons_pop ();
+	const bool after = check_links (core);
+
+	r_config_set_i (core->config, "anal.onwrite", false);
+	t0 = r_sys_now ();
+	for (i = 0; i < writes; i++) {
+		r_core_cmdf (core, "wx b8%02x000000 @ 0x1008; af- 0x1000; aaa", i & 0xff);
+	}
+	const double full = (r_sys_now () - t0) / 1000000.0;
+
+	printf ("links before the patch: %s, after: %s\n", before? "ok": "BAD", after? "ok": "BAD");
+	printf ("%d writes: anal.onwrite %.3fs, af- + aaa %.3fs (%.2fx)\n",
+		writes, incr, full, incr > 0? full / incr: 0);
+	r_core_free (core);
+	return before && after? 0: 1;
+}
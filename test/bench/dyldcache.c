@@ -0,0 +1,83 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+// Times opening a dyld shared cache, listing its sections, loading the
+// symbols of the image holding the first __text section and then all of
+// them, with the peak resident size after each step. The symbols of that
+// image are checked against the ones the full listing has in its range.
+//
+// usage: dyldcache <cache> [nommap]
+//
+// mkdyldcache.py generates a synthetic cache to run it on.
+
+#include <r_bin.h>
+#include <sys/resource.h>
+
+static long maxrss(void) {
+	struct rusage ru;
+	getrusage (RUSAGE_SELF, &ru);
+	return ru.ru_maxrss;
+}
+
+static void report(const char *what, int count, ut64 t0) {
+	printf ("%-14s %8d %6"PFMT64d" ms %7ld KB\n", what, count, (r_sys_now () - t0) / 1000, maxrss ());
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		eprintf ("usage: dyldcache <cache> [nommap]\n");
+		return 1;
+	}
+	RIO *io = r_io_new ();
+	RBin *bin = r_bin_new ();
+	RBinOptions opt;
+	int wrong = 0;
+	bin->use_mmap = argc < 3 || strcmp (argv[2], "nommap");
+	r_io_bind (io, &bin->iob);
+	r_bin_options_init (&opt, -1, 0, 0, false);
+
+	ut64 t0 = r_sys_now ();
+	if (!r_bin_open (bin, argv[1], &opt)) {
+		eprintf ("Cannot open %s\n", argv[1]);
+		return 1;
+	}
+	report ("open", 0, t0);
+
+	t0 = r_sys_now ();
+	RList *sections = r_bin_get_sections (bin);
+	report ("sections", sections? r_list_length (sections): 0, t0);
+
+	RListIter *iter;
+	RBinSection *text = NULL, *s;
+	r_list_foreach (sections, iter, s) {
+		if (r_str_endswith (s->name, "__text")) {
+			text = s;
+			break;
+		}
+	}
+	RList *image = NULL;
+	if (text) {
+		t0 = r_sys_now ();
+		image = r_bin_file_get_image_symbols (r_bin_cur (bin), text->vaddr);
+		report ("image symbols", image? r_list_length (image): 0, t0);
+	}
+
+	t0 = r_sys_now ();
+	RList *symbols = r_bin_get_symbols (bin);
+	report ("symbols", symbols? r_list_length (symbols): 0, t0);
+
+	if (image && symbols) {
+		RBinSymbol *sym;
+		int in_range = 0;
+		r_list_foreach (symbols, iter, sym) {
+			in_range += sym->vaddr >= text->vaddr && sym->vaddr < text->vaddr + text->vsize;
+		}
+		wrong = in_range != r_list_length (image);
+		if (wrong) {
+			printf ("%d image symbols, %d in the full listing\n", r_list_length (image), in_range);
+		}
+	}
+	r_list_free (image);
+	r_bin_free (bin);
+	r_io_free (io);
+	return wrong? 1: 0;
+}
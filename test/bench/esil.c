@@ -0,0 +1,51 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+// Times aecu over a small x86-64 loop with esil.blocks off (one instruction
+// per r_core_esil_step) and on (straight-line code decoded once), and checks
+// both runs end with the same registers.
+//
+// usage: esil [iterations]
+
+#include <r_core.h>
+
+// 0x1000: inc rcx; mov rax, rcx; add rax, 1; mov [0x2000], rax
+//         mov rdx, [0x2000]; dec rdx; cmp rcx, N; jne 0x1000
+#define LOOP "48ffc1" "4889c8" "4883c001" "4889042500200000" \
+	"488b142500200000" "48ffca" "4881f9%08x" "75da"
+#define LOOP_END 0x1026
+
+static double run(RCore *core, bool blocks, ut32 iters, ut64 *rcx, ut64 *rdx) {
+	r_config_set_i (core->config, "esil.blocks", blocks);
+	r_core_cmd0 (core, "aei; aeim 0x100000 0x10000");
+	r_core_cmd0 (core, "aer rip=0x1000; aer rcx=0");
+	ut64 t0 = r_sys_now ();
+	r_core_cmdf (core, "aecu 0x%x", LOOP_END);
+	double secs = (r_sys_now () - t0) / 1000000.0;
+	*rcx = r_reg_getv (core->anal->reg, "rcx");
+	*rdx = r_reg_getv (core->anal->reg, "rdx");
+	r_core_cmd0 (core, "aeim-; aei-");
+	return secs;
+}
+
+int main(int argc, char **argv) {
+	const ut32 iters = argc > 1? atoi (argv[1]): 200000;
+	ut64 rcx0, rdx0, rcx1, rdx1;
+
+	RCore *core = r_core_new ();
+	if (!core) {
+		return 1;
+	}
+	r_core_cmd0 (core, "o malloc://0x10000 0");
+	r_core_cmd0 (core, "e asm.arch=x86; e asm.bits=64");
+	r_core_cmdf (core, "wx " LOOP " @ 0x1000", r_swap_ut32 (iters));
+	const double t0 = run (core, false, iters, &rcx0, &rdx0);
+	const double t1 = run (core, true, iters, &rcx1, &rdx1);
+	const ut64 insns = (ut64)iters * 8;
+	printf ("step:   %.3fs %.0f insns/s\n", t0, insns / t0);
+	printf ("blocks: %.3fs %.0f insns/s (%.2fx)\n", t1, insns / t1, t0 / t1);
+	const bool ok = rcx0 == iters && rcx0 == rcx1 && rdx0 == rdx1;
+	printf ("rcx 0x%"PFMT64x"/0x%"PFMT64x" rdx 0x%"PFMT64x"/0x%"PFMT64x" %s\n",
+		rcx0, rcx1, rdx0, rdx1, ok? "ok": "MISMATCH");
+	r_core_free (core);
+	return ok? 0: 1;
+}
@@ -0,0 +1,90 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+// Times r_anal_get_fcn_in over functions made of spread out blocks and
+// checks every answer against a scan of the blocks of all the functions.
+//
+// usage: fcn_ranges [fcns] [blocks] [lookups] [interleaved|contiguous]
+
+#include <r_anal.h>
+
+#define BB_SIZE 16
+
+static bool fcn_has(RAnalFunction *fcn, ut64 addr) {
+	RListIter *iter;
+	RAnalBlock *bb;
+	r_list_foreach (fcn->bbs, iter, bb) {
+		if (addr >= bb->addr && addr < bb->addr + bb->size) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static RAnalFunction *fcn_scan(RAnal *anal, ut64 addr) {
+	RListIter *iter;
+	RAnalFunction *fcn, *first = NULL;
+	r_list_foreach (anal->fcns, iter, fcn) {
+		if (fcn_has (fcn, addr) && (!first || fcn->meta.min < first->meta.min)) {
+			first = fcn;
+		}
+	}
+	return first;
+}
+
+int main(int argc, char **argv) {
+	const int nfcns = argc > 1? atoi (argv[1]): 2000;
+	const int nbbs = argc > 2? atoi (argv[2]): 8;
+	const int lookups = argc > 3? atoi (argv[3]): 1000000;
+	const bool interleaved = argc < 5 || strcmp (argv[4], "contiguous");
+	const ut64 base = 0x100000;
+	const ut64 span = (ut64)nfcns * nbbs * BB_SIZE;
+	int i, j, found = 0, wrong = 0;
+	if (nfcns < 1 || nbbs < 1 || lookups < 1) {
+		eprintf ("usage: fcn_ranges [fcns] [blocks] [lookups] [interleaved|contiguous]\n");
+		return 1;
+	}
+	RAnal *anal = r_anal_new ();
+	for (i = 0; i < nfcns; i++) {
+		RAnalFunction *fcn = r_anal_fcn_new ();
+		for (j = 0; j < nbbs; j++) {
+			RAnalBlock *bb = r_anal_bb_new ();
+			ut64 n = interleaved? (ut64)j * nfcns + i: (ut64)i * nbbs + j;
+			bb->addr = base + n * BB_SIZE;
+			bb->size = BB_SIZE;
+			r_anal_fcn_bbadd (fcn, bb);
+		}
+		fcn->addr = ((RAnalBlock *)r_list_first (fcn->bbs))->addr;
+		fcn->name = r_str_newf ("fcn.%08"PFMT64x, fcn->addr);
+		r_anal_fcn_update_tinyrange_bbs (fcn);
+		RAnalBlock *last = r_list_last (fcn->bbs);
+		r_anal_fcn_set_size (NULL, fcn, last->addr + last->size - fcn->addr);
+		r_anal_fcn_insert (anal, fcn);
+	}
+	ut64 *addrs = malloc (lookups * sizeof (ut64));
+	if (!addrs) {
+		return 1;
+	}
+	srand (1);
+	for (i = 0; i < lookups; i++) {
+		addrs[i] = base + (((ut64)rand () << 16) ^ rand ()) % (span + BB_SIZE);
+	}
+	ut64 t0 = r_sys_now ();
+	for (i = 0; i < lookups; i++) {
+		found += r_anal_get_fcn_in (anal, addrs[i], 0) != NULL;
+	}
+	ut64 t1 = r_sys_now ();
+	printf ("%d fcns x %d blocks, %s: %d lookups in %"PFMT64d" ms, %d found\n",
+		nfcns, nbbs, interleaved? "interleaved": "contiguous", lookups,
+		(t1 - t0) / 1000, found);
+	for (i = 0; i < lookups && i < 10000; i++) {
+		if (r_anal_get_fcn_in (anal, addrs[i], 0) != fcn_scan (anal, addrs[i])) {
+			wrong++;
+		}
+	}
+	if (wrong) {
+		printf ("%d lookups differ from the scan\n", wrong);
+	}
+	free (addrs);
+	r_anal_free (anal);
+	return wrong? 1: 0;
+}
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+# Writes a synthetic arm64 dyld shared cache for the dyldcache benchmark:
+# every image has one __TEXT segment and a symbol table pointing into a
+# string pool shared by all the images, like the real caches do.
+#
+# usage: mkdyldcache.py <output> [images]
+
+import struct
+import sys
+
+BASE = 0x180000000
+IMG_SIZE = 0x1000
+NSYM = 200
+POOL_SIZE = 24 << 20
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit('usage: mkdyldcache.py <output> [images]')
+    out = sys.argv[1]
+    n = int(sys.argv[2]) if len(sys.argv) > 2 else 1000
+    maps_off = 0x100
+    imgs_off = 0x200
+    paths_off = imgs_off + n * 32
+    paths = b''
+    path_offs = []
+    for i in range(n):
+        path_offs.append(paths_off + len(paths))
+        paths += b'/usr/lib/system/libfake%05d.dylib\0' % i
+    text_start = (paths_off + len(paths) + 0xfff) & ~0xfff
+    text_end = text_start + n * IMG_SIZE
+    data_start = text_end
+    accel_off = data_start
+    slide_off = accel_off + 0x100
+    pool_off = slide_off + 0x100
+    pool = bytearray(b'\0')
+    names = []
+    while len(pool) < POOL_SIZE:
+        names.append(len(pool))
+        pool += b'_fake_symbol_%08d_with_a_reasonably_long_name\0' % len(names)
+    symtabs_off = (pool_off + len(pool) + 7) & ~7
+    end = symtabs_off + n * NSYM * 16
+    buf = bytearray(end)
+    # header: magic, mappings, images, slide info, accelerator info
+    hdr = struct.pack('<16s4I7Q16sQII4Q', b'dyld_v1   arm64\0', maps_off, 2, imgs_off, n,
+        0, 0, 0, slide_off, 24, 0, 0, b'\0' * 16, 0, 0, 0,
+        BASE + accel_off, 72, 0, 0)
+    buf[0:len(hdr)] = hdr
+    buf[maps_off:maps_off + 64] = struct.pack('<3Q2I', BASE, text_end, 0, 5, 5) + \
+        struct.pack('<3Q2I', BASE + data_start, end - data_start, data_start, 3, 3)
+    for i in range(n):
+        at = imgs_off + i * 32
+        buf[at:at + 32] = struct.pack('<3Q2I', BASE + text_start + i * IMG_SIZE, 0, 0, path_offs[i], 0)
+    buf[paths_off:paths_off + len(paths)] = paths
+    # slide info v3 without pages, the cache is not slid
+    buf[slide_off:slide_off + 24] = struct.pack('<4IQ', 3, 4096, 0, 0, 0)
+    buf[pool_off:pool_off + len(pool)] = pool
+    for i in range(n):
+        at = text_start + i * IMG_SIZE
+        va = BASE + at
+        seg = struct.pack('<II16sQQQQIIII', 0x19, 72 + 80, b'__TEXT', va, IMG_SIZE, at, IMG_SIZE, 5, 5, 1, 0)
+        sec = struct.pack('<16s16sQQIIIIIIII', b'__text', b'__TEXT', va + 0x400, 0xc00, at + 0x400, 2, 0, 0, 0x80000400, 0, 0, 0)
+        sym_at = symtabs_off + i * NSYM * 16
+        symtab = struct.pack('<6I', 2, 24, sym_at, NSYM, pool_off, len(pool))
+        cmds = seg + sec + symtab
+        mh = struct.pack('<8I', 0xfeedfacf, 0x0100000c, 0, 6, 2, len(cmds), 0, 0)
+        buf[at:at + 32 + len(cmds)] = mh + cmds
+        for j in range(NSYM):
+            k = (i * NSYM + j) % len(names)
+            at = sym_at + j * 16
+            buf[at:at + 16] = struct.pack('<IBBHQ', names[k], 0x0f, 1, 0, va + 0x400 + j * 4)
+    with open(out, 'wb') as f:
+        f.write(buf)
+
+
+if __name__ == '__main__':
+    main()
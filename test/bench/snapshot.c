@@ -0,0 +1,96 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+// Analyzes a binary, saves it as a project and as a snapshot, then times
+// reopening it both ways in a fresh core and checks that both give back
+// the same functions, blocks, xrefs and flags.
+//
+// usage: snapshot <binary> [analysis command, "aa" by default]
+
+#include <r_core.h>
+
+static RCore *open_core(const char *file, const char *prjdir) {
+	RCore *core = r_core_new ();
+	if (!core) {
+		return NULL;
+	}
+	r_config_set_i (core->config, "scr.interactive", false);
+	r_config_set (core->config, "dir.projects", prjdir);
+	if (file && (!r_core_file_open (core, file, R_PERM_R, 0)
+			|| !r_core_bin_load (core, file, UT64_MAX))) {
+		eprintf ("Cannot open %s\n", file);
+		r_core_free (core);
+		return NULL;
+	}
+	return core;
+}
+
+static void counts(RCore *core, const char *what, double ms) {
+	RListIter *iter;
+	RAnalFunction *fcn;
+	int bbs = 0;
+	r_list_foreach (core->anal->fcns, iter, fcn) {
+		bbs += r_list_length (fcn->bbs);
+	}
+	printf ("%-14s %9.1f ms  fcns %d  bbs %d  xrefs %d  flags %d\n", what, ms,
+		r_list_length (core->anal->fcns), bbs, r_anal_xrefs_count (core->anal),
+		r_flag_count (core->flags, NULL));
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		eprintf ("usage: snapshot <binary> [analysis command]\n");
+		return 1;
+	}
+	const char *file = argv[1];
+	const char *cmd = argc > 2? argv[2]: "aa";
+	char *dir = r_file_tmpdir ();
+	char *prjdir = r_str_newf ("%s" R_SYS_DIR "r2bench-prj", dir);
+	char *snap = r_str_newf ("%s" R_SYS_DIR "r2bench.r2s", dir);
+	free (dir);
+	r_sys_mkdirp (prjdir);
+
+	RCore *core = open_core (file, prjdir);
+	if (!core) {
+		return 1;
+	}
+	ut64 t0 = r_sys_now ();
+	r_core_cmd0 (core, cmd);
+	counts (core, cmd, (r_sys_now () - t0) / 1000.0);
+	t0 = r_sys_now ();
+	if (!r_core_project_save (core, "r2bench")) {
+		eprintf ("Cannot save the project\n");
+		return 1;
+	}
+	printf ("project save   %9.1f ms\n", (r_sys_now () - t0) / 1000.0);
+	t0 = r_sys_now ();
+	if (!r_core_snapshot_save (core, snap)) {
+		eprintf ("Cannot save the snapshot\n");
+		return 1;
+	}
+	printf ("snapshot save  %9.1f ms  %"PFMT64d" bytes\n", (r_sys_now () - t0) / 1000.0, (st64)r_file_size (snap));
+	r_core_free (core);
+
+	// the project reopens the binary by itself
+	core = open_core (NULL, prjdir);
+	t0 = r_sys_now ();
+	if (!r_core_project_open (core, "r2bench", false)) {
+		eprintf ("Cannot open the project\n");
+		return 1;
+	}
+	counts (core, "project open", (r_sys_now () - t0) / 1000.0);
+	r_core_free (core);
+
+	core = open_core (file, prjdir);
+	t0 = r_sys_now ();
+	if (!r_core_snapshot_load (core, snap)) {
+		eprintf ("Cannot load the snapshot\n");
+		return 1;
+	}
+	counts (core, "snapshot load", (r_sys_now () - t0) / 1000.0);
+	r_core_free (core);
+
+	r_file_rm (snap);
+	free (snap);
+	free (prjdir);
+	return 0;
+}
@@ -0,0 +1,183 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+// Checks that the raw string scan (izz) gives the same strings, in the same
+// order, with bin.str.threads=1 and with more threads, and times both. The
+// input is a generated file dense with ascii, wide, wide32 and utf8 strings
+// (plus short ascii strings right before wide ones, and mostly ascii utf16
+// runs) over random bytes, so every chunk boundary falls inside or right
+// next to a string whatever the thread count.
+//
+// usage: strscan [file] [threads...]
+
+#include <r_bin.h>
+#include <r_io.h>
+
+#define GEN_SIZE (8 << 20)
+
+static void put_ascii(ut8 *p, int n) {
+	int i;
+	for (i = 0; i < n; i++) {
+		p[i] = 'a' + rand () % 26;
+	}
+}
+
+static int gen_string(ut8 *p, int left) {
+	int i, n = 2 + rand () % 40;
+	switch (rand () % 6) {
+	case 0: // ascii
+		put_ascii (p, R_MIN (n, left));
+		return R_MIN (n + 1, left);
+	case 1: // wide
+		n = R_MIN (n, left / 2);
+		for (i = 0; i < n; i++) {
+			p[i * 2] = 'A' + rand () % 26;
+			p[i * 2 + 1] = 0;
+		}
+		return n * 2;
+	case 2: // wide32
+		n = R_MIN (n, left / 4);
+		for (i = 0; i < n; i++) {
+			p[i * 4] = '0' + rand () % 10;
+			p[i * 4 + 1] = p[i * 4 + 2] = p[i * 4 + 3] = 0;
+		}
+		return n * 4;
+	case 3: // utf8 (two byte sequences mixed with ascii)
+		n = R_MIN (n, left / 2);
+		for (i = 0; i + 1 < n; i += 2) {
+			p[i] = 0xc3;
+			p[i + 1] = 0xa0 + rand () % 0x1f;
+		}
+		return i;
+	case 4: // short ascii followed by a wide string
+		if (left < 32) {
+			return 0;
+		}
+		put_ascii (p, 2);
+		p[2] = 0;
+		for (i = 0; i < 8; i++) {
+			p[3 + i * 2] = 'w';
+			p[4 + i * 2] = 0;
+		}
+		return 20;
+	default: // utf16 with a few non ascii chars
+		n = R_MIN (n, left / 2);
+		for (i = 0; i < n; i++) {
+			p[i * 2] = (i % 7)? 'a' + rand () % 26: 0xe9;
+			p[i * 2 + 1] = (i % 9)? 0: 0x03;
+		}
+		return n * 2;
+	}
+}
+
+static char *gen_file(void) {
+	ut8 *buf = calloc (GEN_SIZE, 1);
+	if (!buf) {
+		return NULL;
+	}
+	int i = 0;
+	srand (1);
+	while (i < GEN_SIZE) {
+		const int left = GEN_SIZE - i;
+		switch (rand () % 4) {
+		case 0: // random bytes
+		{
+			int j, n = R_MIN (rand () % 64, left);
+			for (j = 0; j < n; j++) {
+				buf[i + j] = rand ();
+			}
+			i += n;
+			break;
+		}
+		case 1: // zeros
+			i += R_MIN (rand () % 64, left);
+			break;
+		default:
+			i += gen_string (buf + i, left);
+			i++;
+			break;
+		}
+	}
+	char *path = r_file_temp ("strscan");
+	if (path && !r_file_dump (path, buf, GEN_SIZE, false)) {
+		R_FREE (path);
+	}
+	free (buf);
+	return path;
+}
+
+static RList *scan(RBin *bin, int threads, double *secs) {
+	bin->strthreads = threads;
+	ut64 t0 = r_sys_now ();
+	RList *list = r_bin_raw_strings (r_bin_cur (bin), 0);
+	*secs = (r_sys_now () - t0) / 1000000.0;
+	return list;
+}
+
+static bool same_strings(RList *a, RList *b) {
+	RListIter *ia, *ib;
+	RBinString *sa, *sb;
+	int n = 0;
+	if (r_list_length (a) != r_list_length (b)) {
+		eprintf ("%d strings instead of %d\n", r_list_length (b), r_list_length (a));
+	}
+	ib = r_list_iterator (b);
+	r_list_foreach (a, ia, sa) {
+		if (!ib) {
+			return false;
+		}
+		sb = r_list_iter_get (ib);
+		if (sa->paddr != sb->paddr || sa->size != sb->size || sa->type != sb->type
+				|| sa->ordinal != sb->ordinal || strcmp (sa->string, sb->string)) {
+			eprintf ("string %d differs: 0x%"PFMT64x" %s / 0x%"PFMT64x" %s\n",
+				n, sa->paddr, sa->string, sb->paddr, sb->string);
+			return false;
+		}
+		n++;
+	}
+	return !ib && r_list_length (a) == r_list_length (b);
+}
+
+int main(int argc, char **argv) {
+	static const int defthreads[] = { 2, 3, 4, 5, 8 };
+	char *tmp = NULL;
+	const char *file = argc > 1? argv[1]: NULL;
+	int i, fails = 0;
+
+	if (!file) {
+		file = tmp = gen_file ();
+		if (!file) {
+			eprintf ("Cannot write the test file\n");
+			return 1;
+		}
+	}
+	RIO *io = r_io_new ();
+	RBin *bin = r_bin_new ();
+	r_io_bind (io, &bin->iob);
+	RBinOptions opt;
+	r_bin_options_init (&opt, 0, 0, 0, false);
+	if (!r_bin_open (bin, file, &opt)) {
+		eprintf ("Cannot open %s\n", file);
+		return 1;
+	}
+	double t1, tn;
+	RList *ref = scan (bin, 1, &t1);
+	printf ("threads=1: %d strings in %.3fs\n", r_list_length (ref), t1);
+	const int n = argc > 2? argc - 2: R_ARRAY_SIZE (defthreads);
+	for (i = 0; i < n; i++) {
+		const int threads = argc > 2? atoi (argv[i + 2]): defthreads[i];
+		RList *list = scan (bin, threads, &tn);
+		const bool ok = same_strings (ref, list);
+		printf ("threads=%d: %d strings in %.3fs (%.2fx) %s\n", threads,
+			r_list_length (list), tn, tn > 0? t1 / tn: 0, ok? "ok": "MISMATCH");
+		fails += !ok;
+		r_list_free (list);
+	}
+	r_list_free (ref);
+	r_bin_free (bin);
+	r_io_free (io);
+	if (tmp) {
+		r_file_rm (tmp);
+		free (tmp);
+	}
+	return fails? 1: 0;
+}